@@ -0,0 +1,140 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+
+double bench_wall_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// 已排序样本的第 p 百分位（最近秩法）
+static double percentile(const double *sorted, int count, double p)
+{
+    int rank = (int)ceil(p / 100.0 * count);
+    if (rank < 1) {
+        rank = 1;
+    }
+    return sorted[rank - 1];
+}
+
+int bench_measure(const bench_config_t *config, bench_fn fn, void *ctx, bench_stats_t *stats)
+{
+    int repeats = config->repeats > 0 ? config->repeats : 1;
+    double *samples = (double *)malloc(repeats * sizeof(double));
+    if (!samples) {
+        return CONV_ERR_NOMEM;
+    }
+
+    // 预热：排除首次缺页、冷缓存和线程池唤醒的开销
+    for (int i = 0; i < config->warmup; i++) {
+        fn(ctx);
+    }
+    for (int i = 0; i < repeats; i++) {
+        double start = bench_wall_time();
+        fn(ctx);
+        samples[i] = bench_wall_time() - start;
+    }
+
+    double sum = 0;
+    for (int i = 0; i < repeats; i++) {
+        sum += samples[i];
+    }
+    double mean = sum / repeats;
+    double variance = 0;
+    for (int i = 0; i < repeats; i++) {
+        variance += (samples[i] - mean) * (samples[i] - mean);
+    }
+
+    qsort(samples, repeats, sizeof(double), compare_double);
+    stats->samples = repeats;
+    stats->min = samples[0];
+    stats->median = repeats % 2 ? samples[repeats / 2] : 0.5 * (samples[repeats / 2 - 1] + samples[repeats / 2]);
+    stats->p90 = percentile(samples, repeats, 90);
+    stats->p99 = percentile(samples, repeats, 99);
+    stats->mean = mean;
+    stats->stddev = repeats > 1 ? sqrt(variance / (repeats - 1)) : 0;   // 样本标准差
+
+    free(samples);
+    return CONV_OK;
+}
+
+void bench_reference_conv(const conv_desc_t *desc, const float *input, const float *weights,
+                          const float *bias, float *output)
+{
+    int output_h = conv_output_h(desc);
+    int output_w = conv_output_w(desc);
+    int k_size = desc->k_size;
+    int group_input = desc->input_channel / desc->groups;
+    int group_output = desc->output_channel / desc->groups;
+
+    for (int n = 0; n < desc->batch; n++) {
+        const float *input_n = input + (size_t)n * desc->input_channel * desc->input_h * desc->input_w;
+        float *output_n = output + (size_t)n * desc->output_channel * output_h * output_w;
+        for (int oc = 0; oc < desc->output_channel; oc++) {
+            // 第 oc 个输出通道所在分组的输入通道
+            const float *group_ptr = input_n + (size_t)(oc / group_output) * group_input * desc->input_h * desc->input_w;
+            for (int oy = 0; oy < output_h; oy++) {
+                for (int ox = 0; ox < output_w; ox++) {
+                    double sum = bias ? bias[oc] : 0.0;
+                    for (int ic = 0; ic < group_input; ic++) {
+                        const float *input_ptr = group_ptr + (size_t)ic * desc->input_h * desc->input_w;
+                        const float *weight_ptr = weights + ((size_t)oc * group_input + ic) * k_size * k_size;
+                        for (int kr = 0; kr < k_size; kr++) {
+                            int iy = oy * desc->stride - desc->padding + kr * desc->dilation;
+                            if (iy < 0 || iy >= desc->input_h) {
+                                continue;
+                            }
+                            for (int kc = 0; kc < k_size; kc++) {
+                                int ix = ox * desc->stride - desc->padding + kc * desc->dilation;
+                                if (ix >= 0 && ix < desc->input_w) {
+                                    sum += (double)input_ptr[iy * desc->input_w + ix] * weight_ptr[kr * k_size + kc];
+                                }
+                            }
+                        }
+                    }
+                    output_n[((size_t)oc * output_h + oy) * output_w + ox] = (float)sum;
+                }
+            }
+        }
+    }
+}
+
+double bench_conv_flops(const conv_desc_t *desc)
+{
+    return 2.0 * desc->batch * desc->output_channel * conv_output_h(desc) * conv_output_w(desc) *
+           (desc->input_channel / desc->groups) * desc->k_size * desc->k_size;   // 乘法和加法
+}
+
+void bench_print_json(FILE *out, const bench_result_t *r)
+{
+    const conv_desc_t *d = &r->desc;
+
+    fprintf(out, "{\"kernel\": \"%s\", \"batch\": %d, \"c_in\": %d, \"c_out\": %d, \"h\": %d, \"w\": %d, "
+                 "\"k\": %d, \"stride\": %d, \"pad\": %d, \"dilation\": %d, \"groups\": %d, \"threads\": %d, "
+                 "\"warmup\": %d, \"repeats\": %d, \"dispatch\": \"%s\", ",
+            r->kernel, d->batch, d->input_channel, d->output_channel, d->input_h, d->input_w,
+            d->k_size, d->stride, d->padding, d->dilation, d->groups, r->threads,
+            r->config.warmup, r->stats.samples, conv_kernel_info());
+    fprintf(out, "\"min_ms\": %.6f, \"median_ms\": %.6f, \"p90_ms\": %.6f, \"p99_ms\": %.6f, "
+                 "\"mean_ms\": %.6f, \"stddev_ms\": %.6f, \"gflops\": %.3f",
+            r->stats.min * 1e3, r->stats.median * 1e3, r->stats.p90 * 1e3, r->stats.p99 * 1e3,
+            r->stats.mean * 1e3, r->stats.stddev * 1e3, r->gflops);
+    fprintf(out, ", \"workspace_bytes\": %zu", r->workspace);
+    if (r->max_error >= 0) {
+        fprintf(out, ", \"max_abs_error\": %.3e", r->max_error);
+    }
+    fprintf(out, "}\n");
+}
@@ -0,0 +1,74 @@
+#ifndef ARM64_CONV_BENCH_H
+#define ARM64_CONV_BENCH_H
+
+// 基准测试框架
+// 预热若干次后重复计时，使用单调墙上时间（CLOCK_MONOTONIC），统计中位数、p90、p99和标准差；
+// 每个 (卷积实现, 形状) 输出一行JSON，便于不同实现在相同条件下比较
+// clock() 统计的是进程所有线程的CPU时间，多线程时不能反映延迟，这里不再使用
+
+#include <stdio.h>
+
+#include "../lib/conv.h"
+
+// 计时参数
+typedef struct {
+    int warmup;          // 预热次数，不计入统计
+    int repeats;         // 计时次数
+} bench_config_t;
+
+// 计时统计，单位为秒
+typedef struct {
+    int samples;
+    double min, median, p90, p99, mean, stddev;
+} bench_stats_t;
+
+// 单调墙上时间（秒）
+double bench_wall_time(void);
+
+// 被测函数，每次调用执行一次完整的卷积
+typedef void (*bench_fn)(void *ctx);
+
+// 预热 config->warmup 次，再计时 config->repeats 次，结果写入 stats
+// 成功返回 CONV_OK，内存不足返回 CONV_ERR_NOMEM
+int bench_measure(const bench_config_t *config, bench_fn fn, void *ctx, bench_stats_t *stats);
+
+// 卷积实现
+// prepare 在计时前调用一次（权重打包等），run 为被计时的部分，release 释放 prepare 的结果
+// arg 原样传给 supported 和 prepare（例如库算法的枚举值）；supported 为NULL表示支持所有形状
+// workspace 返回 run 使用的临时内存（字节，即输入、输出和权重之外的峰值内存），NULL表示不使用临时内存
+typedef struct {
+    const char *name;
+    const void *arg;
+    int (*supported)(const void *arg, const conv_desc_t *desc);
+    int (*prepare)(const void *arg, const conv_desc_t *desc, const float *weights, const float *bias, void **state);
+    int (*run)(void *state, const float *input, float *output);
+    void (*release)(void *state);
+    size_t (*workspace)(void *state);
+} bench_kernel_t;
+
+// 已注册的卷积实现，*count 返回个数
+const bench_kernel_t *bench_kernels(int *count);
+
+// 朴素参考实现（双精度累加），支持batch、步长、填充、空洞和分组，用于检查各实现的误差
+void bench_reference_conv(const conv_desc_t *desc, const float *input, const float *weights,
+                          const float *bias, float *output);
+
+// 一次测量的结果
+typedef struct {
+    const char *kernel;
+    conv_desc_t desc;
+    int threads;
+    bench_config_t config;
+    bench_stats_t stats;
+    double gflops;           // 按中位数计算
+    double max_error;        // 与参考实现的最大绝对误差，未检查时为负数
+    size_t workspace;        // 临时内存的字节数
+} bench_result_t;
+
+// 输出一行JSON
+void bench_print_json(FILE *out, const bench_result_t *result);
+
+// 卷积的浮点运算次数（乘法和加法）
+double bench_conv_flops(const conv_desc_t *desc);
+
+#endif // ARM64_CONV_BENCH_H
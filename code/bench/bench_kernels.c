@@ -0,0 +1,313 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+
+// 已注册的卷积实现
+//   c_loop_origin：C_loop_Origin.c 中的基准实现
+//   set1 / set2 的原始实现：直接包含各实验的源文件（main 和重复定义的 src_im2col 按文件改名），
+//     与基准实现使用同样的适配函数，只支持它们本来处理的形状（正方形、stride=1、无填充）；
+//     只有ARM64汇编的实现仅在 ARM64 上注册
+//   其余为卷积库中的各算法（set1 的直接卷积、set2 的 Im2col + SGEMM 等均已移植到库中），
+//   权重在 prepare 中通过 conv_prepare 打包，不计入计时
+
+// 原始源文件中有未使用的变量，不在这里报告
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-variable"
+
+// set1：直接卷积的循环展开与汇编版本
+#define main set1_c_loop_kernel3x3_main
+#include "../set1/C_loop_Kernel3x3.c"
+#undef main
+#define main set1_c_loop_kernel_any_main
+#include "../set1/C_loop_Kernel_any.c"
+#undef main
+#ifdef __aarch64__
+#define main set1_asm_loop_kernel3x3_main
+#include "../set1/asm_loop_Kernel3x3.c"
+#undef main
+#define main set1_asm_loop_kernel_any_main
+#include "../set1/asm_loop_Kernel_any.c"
+#undef main
+#endif
+
+// set2：Im2col + 各版本的矩阵乘法
+#define main set2_c_sgemm_op1_main
+#define src_im2col set2_c_sgemm_op1_im2col
+#include "../set2/C_Sgemm_op1.c"
+#undef src_im2col
+#undef main
+#define main set2_c_sgemm_op4_main
+#define src_im2col set2_c_sgemm_op4_im2col
+#include "../set2/C_Sgemm_op4.c"
+#undef src_im2col
+#undef main
+#define main set2_c_sgemm_op16_main
+#define src_im2col set2_c_sgemm_op16_im2col
+#include "../set2/C_Sgemm_op16.c"
+#undef src_im2col
+#undef main
+#ifdef __aarch64__
+#define main set2_asm_sgemm_op4_main
+#define src_im2col set2_asm_sgemm_op4_im2col
+#include "../set2/asm_Sgemm_op4.c"
+#undef src_im2col
+#undef main
+#define main set2_asm_sgemm_op16_main
+#define src_im2col set2_asm_sgemm_op16_im2col
+#include "../set2/asm_Sgemm_op16.c"
+#undef src_im2col
+#undef main
+#endif
+
+#pragma GCC diagnostic pop
+
+// 主卷积函数（与 C_loop_Origin.c 相同）
+static void convolution(float *input_feature, const float *weights, const float *bias, float *output_feature, int output_channel, int input_channel,
+                        int k_size, int output_wh, int input_wh)
+{
+    int row, col, output_filter, input_filter, kernel_row, kernel_col;
+
+    for (row = 0; row < output_wh; row++) {
+        for (col = 0; col < output_wh; col++) {
+            for (output_filter = 0; output_filter < output_channel; output_filter++) {
+                float temp = 0;
+                for (input_filter = 0; input_filter < input_channel; input_filter++) {
+                    for (kernel_row = 0; kernel_row < k_size; kernel_row++) {
+                        for (kernel_col = 0; kernel_col < k_size; kernel_col++) {
+                            temp = temp + (input_feature[input_filter * input_wh * input_wh + (row + kernel_row) * input_wh + (col + kernel_col)]
+                                        * weights[output_filter * input_channel * k_size * k_size + input_filter * k_size * k_size +
+                                                 kernel_row * k_size + kernel_col]);
+                        }
+                    }
+                }
+                output_feature[output_filter * output_wh * output_wh + row * output_wh + col] = temp + bias[output_filter];
+            }
+        }
+    }
+}
+
+// 原始实现的函数签名
+typedef void (*loop_conv_fn)(float *input_feature, const float *weights, const float *bias, float *output_feature,
+                             int output_channel, int input_channel, int k_size, int output_wh, int input_wh);
+typedef float *(*im2col_fn)(const float *input_feature, int input_channel, int input_wh, int k_size, int output_wh);
+typedef int (*sgemm_fn)(float *a, float *b, float *c, int m, int k, int n);
+
+// 原始实现，作为 origin_* 的 arg：conv 非NULL时为直接卷积（k_size 非0时只支持该尺寸的卷积核），
+// 否则为 im2col + sgemm，再单独加偏置（与 set2 各 main() 的流程相同）
+typedef struct {
+    loop_conv_fn conv;
+    int k_size;
+    im2col_fn im2col;
+    sgemm_fn sgemm;
+} origin_kernel_t;
+
+typedef struct {
+    const origin_kernel_t *kernel;
+    conv_desc_t desc;
+    float *weights;       // set2 的矩阵乘法接口不是 const
+    float *bias;          // convolution 要求有偏置，无偏置时为全0
+} origin_state_t;
+
+// 原始实现只处理正方形输入、stride=1、无填充、无空洞、不分组
+static int origin_supported(const void *arg, const conv_desc_t *desc)
+{
+    const origin_kernel_t *kernel = (const origin_kernel_t *)arg;
+    return desc->input_h == desc->input_w && desc->stride == 1 && desc->padding == 0 && desc->dilation == 1 &&
+           desc->groups == 1 && (kernel->k_size == 0 || desc->k_size == kernel->k_size);
+}
+
+static int origin_prepare(const void *arg, const conv_desc_t *desc, const float *weights, const float *bias,
+                          void **state)
+{
+    origin_state_t *s = (origin_state_t *)malloc(sizeof(origin_state_t));
+
+    if (!s) {
+        return CONV_ERR_NOMEM;
+    }
+    s->kernel = (const origin_kernel_t *)arg;
+    s->desc = *desc;
+    s->weights = (float *)weights;
+    s->bias = (float *)calloc(desc->output_channel, sizeof(float));
+    if (!s->bias) {
+        free(s);
+        return CONV_ERR_NOMEM;
+    }
+    if (bias) {
+        memcpy(s->bias, bias, desc->output_channel * sizeof(float));
+    }
+    *state = s;
+    return CONV_OK;
+}
+
+static int origin_run(void *state, const float *input, float *output)
+{
+    origin_state_t *s = (origin_state_t *)state;
+    const conv_desc_t *d = &s->desc;
+    int output_wh = conv_output_h(d);
+    size_t input_image = (size_t)d->input_channel * d->input_h * d->input_w;
+    size_t output_image = (size_t)d->output_channel * output_wh * output_wh;
+
+    int plane = output_wh * output_wh;
+    int k = d->input_channel * d->k_size * d->k_size;
+
+    for (int n = 0; n < d->batch; n++) {
+        float *in = (float *)input + n * input_image;
+        float *out = output + n * output_image;
+        if (s->kernel->conv) {
+            s->kernel->conv(in, s->weights, s->bias, out, d->output_channel, d->input_channel, d->k_size, output_wh,
+                            d->input_w);
+            continue;
+        }
+        float *im2col_feature = s->kernel->im2col(in, d->input_channel, d->input_w, d->k_size, output_wh);
+        if (!im2col_feature) {
+            return CONV_ERR_NOMEM;
+        }
+        // 部分矩阵乘法是 C = A * B + C
+        memset(out, 0, output_image * sizeof(float));
+        s->kernel->sgemm(s->weights, im2col_feature, out, d->output_channel, k, plane);
+        for (int oc = 0; oc < d->output_channel; oc++) {
+            for (int i = 0; i < plane; i++) {
+                out[oc * plane + i] += s->bias[oc];
+            }
+        }
+        free(im2col_feature);
+    }
+    return CONV_OK;
+}
+
+// set2 的im2col矩阵（每张图像分配一次）
+static size_t origin_workspace(void *state)
+{
+    origin_state_t *s = (origin_state_t *)state;
+    const conv_desc_t *d = &s->desc;
+
+    if (s->kernel->conv) {
+        return 0;
+    }
+    return (size_t)d->input_channel * d->k_size * d->k_size * conv_output_h(d) * conv_output_w(d) * sizeof(float);
+}
+
+static void origin_release(void *state)
+{
+    origin_state_t *s = (origin_state_t *)state;
+    free(s->bias);
+    free(s);
+}
+
+// 卷积库中的算法，arg 指向 conv_algo_t
+static int lib_supported(const void *arg, const conv_desc_t *desc)
+{
+    return conv_algo_supported(desc, *(const conv_algo_t *)arg);
+}
+
+// 句柄和它的工作区都在 prepare 中准备好，计时的 run 不再分配内存
+typedef struct {
+    conv_handle_t *handle;
+    void *workspace;
+    size_t workspace_size;
+} lib_state_t;
+
+static void lib_release(void *state)
+{
+    lib_state_t *s = (lib_state_t *)state;
+    conv_handle_destroy(s->handle);
+    free(s->workspace);
+    free(s);
+}
+
+static int lib_prepare(const void *arg, const conv_desc_t *desc, const float *weights, const float *bias,
+                       void **state)
+{
+    lib_state_t *s = (lib_state_t *)calloc(1, sizeof(lib_state_t));
+    if (!s) {
+        return CONV_ERR_NOMEM;
+    }
+    int ret = conv_prepare(desc, *(const conv_algo_t *)arg, weights, bias, &s->handle);
+    if (ret != CONV_OK) {
+        free(s);
+        return ret;
+    }
+    s->workspace_size = conv_prepared_workspace_size(s->handle);
+    if (s->workspace_size &&
+        posix_memalign(&s->workspace, CONV_WORKSPACE_ALIGN, s->workspace_size) != 0) {
+        s->workspace = NULL;
+        lib_release(s);
+        return CONV_ERR_NOMEM;
+    }
+    *state = s;
+    return CONV_OK;
+}
+
+static int lib_run(void *state, const float *input, float *output)
+{
+    lib_state_t *s = (lib_state_t *)state;
+    return conv2d_prepared_ws(s->handle, input, output, s->workspace, s->workspace_size);
+}
+
+static size_t lib_workspace(void *state)
+{
+    return ((lib_state_t *)state)->workspace_size;
+}
+
+static const conv_algo_t lib_algos[] = {
+    CONV_ALGO_AUTO,
+    CONV_ALGO_DIRECT,
+    CONV_ALGO_IM2COL_SGEMM,
+    CONV_ALGO_IMPLICIT_GEMM,
+    CONV_ALGO_WINOGRAD_2X2,
+    CONV_ALGO_WINOGRAD_4X4,
+    CONV_ALGO_DILATED,
+    CONV_ALGO_DEPTHWISE,
+};
+
+#define LIB_KERNEL(name, index) \
+    { name, &lib_algos[index], lib_supported, lib_prepare, lib_run, lib_release, lib_workspace }
+
+static const origin_kernel_t origin_kernels[] = {
+    { convolution, 0, NULL, NULL },
+    { convolution_optimized, 3, NULL, NULL },
+    { convolution_any_kernel, 0, NULL, NULL },
+    { NULL, 0, set2_c_sgemm_op1_im2col, C_Sgemm_op1 },
+    { NULL, 0, set2_c_sgemm_op4_im2col, C_Sgemm_op4 },
+    { NULL, 0, set2_c_sgemm_op16_im2col, C_Sgemm_op16 },
+#ifdef __aarch64__
+    { convolution_asm_optimized, 3, NULL, NULL },
+    { convolution_any_kernel_asm, 0, NULL, NULL },
+    { NULL, 0, set2_asm_sgemm_op4_im2col, asm_Sgemm_op4 },
+    { NULL, 0, set2_asm_sgemm_op16_im2col, asm_Sgemm_op16 },
+#endif
+};
+
+#define ORIGIN_KERNEL(name, index) \
+    { name, &origin_kernels[index], origin_supported, origin_prepare, origin_run, origin_release, origin_workspace }
+
+static const bench_kernel_t kernels[] = {
+    ORIGIN_KERNEL("c_loop_origin", 0),
+    ORIGIN_KERNEL("c_loop_kernel3x3", 1),
+    ORIGIN_KERNEL("c_loop_kernel_any", 2),
+    ORIGIN_KERNEL("c_sgemm_op1", 3),
+    ORIGIN_KERNEL("c_sgemm_op4", 4),
+    ORIGIN_KERNEL("c_sgemm_op16", 5),
+#ifdef __aarch64__
+    ORIGIN_KERNEL("asm_loop_kernel3x3", 6),
+    ORIGIN_KERNEL("asm_loop_kernel_any", 7),
+    ORIGIN_KERNEL("asm_sgemm_op4", 8),
+    ORIGIN_KERNEL("asm_sgemm_op16", 9),
+#endif
+    LIB_KERNEL("auto", 0),
+    LIB_KERNEL("direct", 1),
+    LIB_KERNEL("im2col_sgemm", 2),
+    LIB_KERNEL("implicit_gemm", 3),
+    LIB_KERNEL("winograd_f2", 4),
+    LIB_KERNEL("winograd_f4", 5),
+    LIB_KERNEL("dilated", 6),
+    LIB_KERNEL("depthwise", 7),
+};
+
+const bench_kernel_t *bench_kernels(int *count)
+{
+    *count = sizeof(kernels) / sizeof(kernels[0]);
+    return kernels;
+}
@@ -0,0 +1,375 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+// 卷积基准测试：对每个形状运行所有支持该形状的实现，按形状打印结果表，可同时输出JSON
+// 编译：clang -O3 -o convbench *.c ../lib/*.c -lm -lpthread
+// 用法：./convbench [选项]
+//   -s C_in,C_out,H,W,k,stride,pad,dilation[,batch[,groups]]   添加一个形状（可重复）
+//   -f 文件        从文件读取形状，每行一个，格式同 -s，'#' 之后为注释
+//   -k 实现名      只运行指定的实现（可重复）
+//   -w / -r        预热次数 / 计时次数
+//   -t 线程数      0 使用全部CPU核心
+//   -n             不与参考实现比较误差（大形状的参考实现很慢）
+//   -o 文件        每个 (实现, 形状) 输出一行JSON到该文件，"-" 为标准输出（此时不打印表格）
+// 未指定 -s / -f 时使用内置的默认形状
+
+// 默认形状：各实验 main() 中的固定参数，以及 C_in = 64..512 的典型网络层
+static const int default_shapes[][10] = {
+    // C_in, C_out, H, W, k, stride, pad, dilation, batch, groups
+    { 1, 16, 256, 256, 7, 1, 0, 1, 1, 1 },      // C_loop_Origin.c
+    { 1, 16, 256, 256, 3, 1, 0, 1, 1, 1 },      // set1 / set2 的 3x3 实验
+    { 3, 16, 640, 640, 5, 1, 0, 1, 1, 1 },      // set1/asm_loop_Kernel_any.c
+    { 32, 32, 128, 128, 3, 1, 0, 1, 1, 1 },     // set1/C_Winograd_Kernel3x3.c
+    { 32, 64, 256, 256, 3, 1, 0, 1, 1, 1 },     // set2/asm_Sgemm_mt.c
+    { 64, 64, 28, 28, 3, 1, 1, 1, 8, 1 },       // set2/asm_Sgemm_batch.c
+    { 1, 1, 256, 256, 3, 1, 0, 2, 1, 1 },       // set3/asm_delated.c
+    { 64, 64, 56, 56, 3, 1, 1, 1, 1, 1 },       // ResNet conv2_x
+    { 128, 128, 28, 28, 3, 1, 1, 1, 1, 1 },     // ResNet conv3_x
+    { 256, 256, 14, 14, 3, 1, 1, 1, 1, 1 },     // ResNet conv4_x
+    { 512, 512, 7, 7, 3, 1, 1, 1, 1, 1 },       // ResNet conv5_x
+    { 256, 512, 14, 14, 3, 2, 1, 1, 1, 1 },     // 下采样
+    { 256, 256, 33, 33, 3, 1, 12, 12, 1, 1 },   // DeepLab ASPP
+    { 32, 32, 112, 112, 3, 1, 1, 1, 1, 32 },    // MobileNetV2 深度卷积
+    { 144, 144, 56, 56, 3, 2, 1, 1, 1, 144 },   // MobileNetV2 深度卷积（下采样）
+};
+
+#define MAX_SELECTED_KERNELS 16
+#define MAX_SHAPES           256
+
+typedef struct {
+    const bench_kernel_t *kernel;
+    void *state;
+    const float *input;
+    float *output;
+} run_ctx_t;
+
+static void run_once(void *ctx)
+{
+    run_ctx_t *c = (run_ctx_t *)ctx;
+    c->kernel->run(c->state, c->input, c->output);
+}
+
+static int kernel_selected(const char *name, const char **selected, int selected_count)
+{
+    if (selected_count == 0) {
+        return 1;
+    }
+    for (int i = 0; i < selected_count; i++) {
+        if (strcmp(name, selected[i]) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 字节数按 B / KB / MB 显示
+static void format_bytes(char *buf, size_t size, size_t bytes)
+{
+    if (bytes < 1024) {
+        snprintf(buf, size, "%zu B", bytes);
+    } else if (bytes < ((size_t)1 << 20)) {
+        snprintf(buf, size, "%.1f KB", bytes / 1024.0);
+    } else {
+        snprintf(buf, size, "%.1f MB", bytes / 1048576.0);
+    }
+}
+
+// 一个形状的结果表：每个实现一行，最快（中位数最小）的实现标 *
+static void print_table(const conv_desc_t *desc, const bench_result_t *results, int count)
+{
+    int best = -1;
+    for (int i = 0; i < count; i++) {
+        if (best < 0 || results[i].stats.median < results[best].stats.median) {
+            best = i;
+        }
+    }
+
+    printf("\nN=%d C_in=%d C_out=%d H=%d W=%d k=%d stride=%d pad=%d dilation=%d groups=%d -> %dx%d, %.3f GFLOP\n",
+           desc->batch, desc->input_channel, desc->output_channel, desc->input_h, desc->input_w,
+           desc->k_size, desc->stride, desc->padding, desc->dilation, desc->groups,
+           conv_output_h(desc), conv_output_w(desc), bench_conv_flops(desc) / 1e9);
+    printf("  %-16s %12s %12s %12s %10s %8s %12s %12s\n",
+           "kernel", "median(ms)", "p90(ms)", "stddev(ms)", "GFLOPS", "vs best", "max error", "workspace");
+    for (int i = 0; i < count; i++) {
+        const bench_result_t *r = &results[i];
+        char error[32];
+        char workspace[32];
+        if (r->max_error >= 0) {
+            snprintf(error, sizeof(error), "%.2e", r->max_error);
+        } else {
+            snprintf(error, sizeof(error), "-");
+        }
+        format_bytes(workspace, sizeof(workspace), r->workspace);
+        printf("%c %-16s %12.3f %12.3f %12.3f %10.2f %7.2fx %12s %12s\n", i == best ? '*' : ' ',
+               r->kernel, r->stats.median * 1e3, r->stats.p90 * 1e3, r->stats.stddev * 1e3,
+               r->gflops, r->stats.median / results[best].stats.median, error, workspace);
+    }
+    fflush(stdout);
+}
+
+// 对一个形状运行所有选中的实现，json 非NULL时每个结果输出一行JSON，table 非0时打印结果表
+// 失败返回非0
+static int bench_shape(const conv_desc_t *desc, const bench_config_t *config, int check,
+                       const char **selected, int selected_count, FILE *json, int table)
+{
+    size_t input_count = (size_t)desc->batch * desc->input_channel * desc->input_h * desc->input_w;
+    size_t weight_count = (size_t)desc->output_channel * (desc->input_channel / desc->groups) * desc->k_size *
+                          desc->k_size;
+    size_t output_count = (size_t)desc->batch * desc->output_channel * conv_output_h(desc) * conv_output_w(desc);
+    float *input = (float *)malloc(input_count * sizeof(float));
+    float *weights = (float *)malloc(weight_count * sizeof(float));
+    float *bias = (float *)malloc(desc->output_channel * sizeof(float));
+    float *output = (float *)malloc(output_count * sizeof(float));
+    float *reference = check ? (float *)malloc(output_count * sizeof(float)) : NULL;
+    int kernel_count;
+    const bench_kernel_t *kernels = bench_kernels(&kernel_count);
+    bench_result_t *results = (bench_result_t *)malloc(kernel_count * sizeof(bench_result_t));
+    int result_count = 0;
+    int failed = 0;
+
+    if (!input || !weights || !bias || !output || (check && !reference) || !results) {
+        fprintf(stderr, "内存分配失败!\n");
+        free(input);
+        free(weights);
+        free(bias);
+        free(output);
+        free(reference);
+        free(results);
+        return 1;
+    }
+
+    // 有正有负的数据，使抵消误差能体现出来
+    for (size_t i = 0; i < input_count; i++) {
+        input[i] = (float)(rand() % 21 - 10) / 10.0f;
+    }
+    for (size_t i = 0; i < weight_count; i++) {
+        weights[i] = (float)(rand() % 21 - 10) / 10.0f;
+    }
+    for (int i = 0; i < desc->output_channel; i++) {
+        bias[i] = 0.1f;
+    }
+    if (check) {
+        bench_reference_conv(desc, input, weights, bias, reference);
+    }
+
+    for (int k = 0; k < kernel_count; k++) {
+        const bench_kernel_t *kernel = &kernels[k];
+        if (!kernel_selected(kernel->name, selected, selected_count) ||
+            (kernel->supported && !kernel->supported(kernel->arg, desc))) {
+            continue;
+        }
+
+        run_ctx_t ctx;
+        ctx.kernel = kernel;
+        ctx.input = input;
+        ctx.output = output;
+        if (kernel->prepare(kernel->arg, desc, weights, bias, &ctx.state) != CONV_OK) {
+            fprintf(stderr, "%s: 准备失败\n", kernel->name);
+            failed = 1;
+            continue;
+        }
+
+        bench_result_t *result = &results[result_count];
+        result->kernel = kernel->name;
+        result->desc = *desc;
+        result->threads = conv_get_num_threads();
+        result->config = *config;
+        result->max_error = -1;
+        if (bench_measure(config, run_once, &ctx, &result->stats) != CONV_OK) {
+            fprintf(stderr, "%s: 内存分配失败\n", kernel->name);
+            kernel->release(ctx.state);
+            failed = 1;
+            continue;
+        }
+        result->gflops = bench_conv_flops(desc) / 1e9 / result->stats.median;
+        result->workspace = kernel->workspace ? kernel->workspace(ctx.state) : 0;
+        kernel->release(ctx.state);
+
+        if (check) {
+            double max_error = 0;
+            for (size_t i = 0; i < output_count; i++) {
+                double error = fabs((double)output[i] - reference[i]);
+                if (!(error <= max_error)) {   // NaN 也记为最大误差
+                    max_error = error;
+                }
+            }
+            result->max_error = max_error;
+        }
+        if (json) {
+            bench_print_json(json, result);
+            fflush(json);
+        }
+        result_count++;
+    }
+
+    if (table && result_count > 0) {
+        print_table(desc, results, result_count);
+    }
+
+    free(input);
+    free(weights);
+    free(bias);
+    free(output);
+    free(reference);
+    free(results);
+    return failed;
+}
+
+// 解析 "C_in,C_out,H,W,k,stride,pad,dilation[,batch[,groups]]"，成功返回 CONV_OK
+static int parse_shape(const char *text, conv_desc_t *desc)
+{
+    int v[10];
+    int count = sscanf(text, " %d , %d , %d , %d , %d , %d , %d , %d , %d , %d",
+                       &v[0], &v[1], &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9]);
+    if (count < 8) {
+        return CONV_ERR_INVALID;
+    }
+    conv_desc_init(desc, v[0], v[2], v[3], v[1], v[4]);
+    desc->stride = v[5];
+    desc->padding = v[6];
+    desc->dilation = v[7];
+    desc->batch = count >= 9 ? v[8] : 1;
+    desc->groups = count == 10 ? v[9] : 1;
+    return conv_desc_check(desc);
+}
+
+// 从文件读取形状追加到 shapes，返回读到的个数，出错返回 -1
+static int read_shape_file(const char *path, conv_desc_t *shapes, int capacity)
+{
+    FILE *file = fopen(path, "r");
+    char line[256];
+    int count = 0;
+    int line_number = 0;
+
+    if (!file) {
+        fprintf(stderr, "无法打开形状文件 %s\n", path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), file)) {
+        char *comment = strchr(line, '#');
+        line_number++;
+        if (comment) {
+            *comment = '\0';
+        }
+        if (strspn(line, " \t\r\n") == strlen(line)) {
+            continue;
+        }
+        if (count == capacity) {
+            fprintf(stderr, "%s: 形状过多（最多 %d 个）\n", path, capacity);
+            fclose(file);
+            return -1;
+        }
+        if (parse_shape(line, &shapes[count]) != CONV_OK) {
+            fprintf(stderr, "%s:%d: 无效的形状\n", path, line_number);
+            fclose(file);
+            return -1;
+        }
+        count++;
+    }
+    fclose(file);
+    return count;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "用法: %s [-s C_in,C_out,H,W,k,stride,pad,dilation[,batch[,groups]]] [-f 形状文件] [-k 实现名]\n"
+                    "       [-w 预热次数] [-r 计时次数] [-t 线程数] [-n] [-o JSON输出文件]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    bench_config_t config;
+    const char *selected[MAX_SELECTED_KERNELS];
+    int selected_count = 0;
+    static conv_desc_t shapes[MAX_SHAPES];
+    int shape_count = 0;
+    int check = 1;
+    int threads = 1;
+    FILE *json = NULL;
+    int opt;
+
+    config.warmup = 3;
+    config.repeats = 20;
+    while ((opt = getopt(argc, argv, "s:f:w:r:t:k:no:h")) != -1) {
+        switch (opt) {
+        case 's':
+            if (shape_count == MAX_SHAPES || parse_shape(optarg, &shapes[shape_count]) != CONV_OK) {
+                fprintf(stderr, "无效的形状: %s\n", optarg);
+                return 1;
+            }
+            shape_count++;
+            break;
+        case 'f': {
+            int count = read_shape_file(optarg, shapes + shape_count, MAX_SHAPES - shape_count);
+            if (count < 0) {
+                return 1;
+            }
+            shape_count += count;
+            break;
+        }
+        case 'w':
+            config.warmup = atoi(optarg);
+            break;
+        case 'r':
+            config.repeats = atoi(optarg);
+            break;
+        case 't':
+            threads = atoi(optarg);
+            break;
+        case 'k':
+            if (selected_count < MAX_SELECTED_KERNELS) {
+                selected[selected_count++] = optarg;
+            }
+            break;
+        case 'n':
+            check = 0;
+            break;
+        case 'o':
+            json = strcmp(optarg, "-") == 0 ? stdout : fopen(optarg, "w");
+            if (!json) {
+                fprintf(stderr, "无法打开输出文件 %s\n", optarg);
+                return 1;
+            }
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (config.warmup < 0 || config.repeats <= 0 || optind != argc) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (shape_count == 0) {
+        for (int i = 0; i < (int)(sizeof(default_shapes) / sizeof(default_shapes[0])); i++) {
+            const int *s = default_shapes[i];
+            conv_desc_init(&shapes[i], s[0], s[2], s[3], s[1], s[4]);
+            shapes[i].stride = s[5];
+            shapes[i].padding = s[6];
+            shapes[i].dilation = s[7];
+            shapes[i].batch = s[8];
+            shapes[i].groups = s[9];
+            shape_count++;
+        }
+    }
+    conv_set_num_threads(threads);
+    if (json != stdout) {
+        printf("内核: %s\n", conv_kernel_info());
+    }
+
+    int failed = 0;
+    for (int i = 0; i < shape_count; i++) {
+        failed |= bench_shape(&shapes[i], &config, check, selected, selected_count, json, json != stdout);
+    }
+
+    conv_set_num_threads(1);
+    if (json && json != stdout) {
+        fclose(json);
+    }
+    return failed;
+}
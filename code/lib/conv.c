@@ -0,0 +1,459 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conv_internal.h"
+#include "thread_pool.h"
+
+void conv_desc_init(conv_desc_t *desc, int input_channel, int input_h, int input_w,
+                    int output_channel, int k_size)
+{
+    memset(desc, 0, sizeof(*desc));
+    desc->batch = 1;
+    desc->input_channel = input_channel;
+    desc->input_h = input_h;
+    desc->input_w = input_w;
+    desc->output_channel = output_channel;
+    desc->k_size = k_size;
+    desc->stride = 1;
+    desc->padding = 0;
+    desc->dilation = 1;
+    desc->groups = 1;
+}
+
+// 与 set3 中 calculate_output_size 相同
+static int calculate_output_size(int input_size, int kernel_size, int dilation, int stride, int padding)
+{
+    int effective_kernel_size = (kernel_size - 1) * dilation + 1;
+    return (input_size + 2 * padding - effective_kernel_size) / stride + 1;
+}
+
+int conv_output_h(const conv_desc_t *desc)
+{
+    return calculate_output_size(desc->input_h, desc->k_size, desc->dilation, desc->stride, desc->padding);
+}
+
+int conv_output_w(const conv_desc_t *desc)
+{
+    return calculate_output_size(desc->input_w, desc->k_size, desc->dilation, desc->stride, desc->padding);
+}
+
+int conv_desc_check(const conv_desc_t *desc)
+{
+    if (!desc) {
+        return CONV_ERR_INVALID;
+    }
+    if (desc->batch <= 0 || desc->input_channel <= 0 || desc->output_channel <= 0 ||
+        desc->input_h <= 0 || desc->input_w <= 0 || desc->k_size <= 0) {
+        return CONV_ERR_INVALID;
+    }
+    if (desc->stride <= 0 || desc->dilation <= 0 || desc->padding < 0) {
+        return CONV_ERR_INVALID;
+    }
+    // 有效卷积核不能超过补零后的输入
+    int effective_kernel_size = (desc->k_size - 1) * desc->dilation + 1;
+    if (effective_kernel_size > desc->input_h + 2 * desc->padding ||
+        effective_kernel_size > desc->input_w + 2 * desc->padding) {
+        return CONV_ERR_INVALID;
+    }
+    if (desc->layout < CONV_LAYOUT_NCHW || desc->layout >= CONV_LAYOUT_COUNT) {
+        return CONV_ERR_INVALID;
+    }
+    if (desc->groups <= 0 || desc->input_channel % desc->groups != 0 || desc->output_channel % desc->groups != 0) {
+        return CONV_ERR_INVALID;
+    }
+    return conv_epilogue_check(&desc->epilogue);
+}
+
+void conv_interior_range(int input_size, int output_size, int k_size, int stride, int padding, int dilation,
+                         int *lo, int *hi)
+{
+    // 第一个抽头不越过左边界：o * stride >= padding
+    int first = (padding + stride - 1) / stride;
+    // 最后一个抽头不越过右边界：o * stride - padding + (k_size - 1) * dilation <= input_size - 1
+    int last = input_size - 1 + padding - (k_size - 1) * dilation;
+
+    *lo = first < output_size ? first : output_size;
+    *hi = last >= 0 ? last / stride + 1 : 0;
+    if (*hi > output_size) {
+        *hi = output_size;
+    }
+    if (*hi < *lo) {
+        *hi = *lo;
+    }
+}
+
+int conv_algo_supported(const conv_desc_t *desc, conv_algo_t algo)
+{
+    if (conv_desc_check(desc) != CONV_OK) {
+        return 0;
+    }
+    switch (algo) {
+    case CONV_ALGO_AUTO:
+        return 1;
+    case CONV_ALGO_DIRECT:
+        // 通道分块布局的直接卷积支持空洞（分组卷积逐组在NCHW下计算，不支持）
+        return desc->dilation == 1 ||
+               (desc->groups == 1 && (desc->layout == CONV_LAYOUT_NC4HW4 || desc->layout == CONV_LAYOUT_NC8HW8));
+    case CONV_ALGO_WINOGRAD_2X2:
+    case CONV_ALGO_WINOGRAD_4X4:
+        return desc->k_size == 3 && desc->stride == 1 && desc->dilation == 1;
+    case CONV_ALGO_IM2COL_SGEMM:
+    case CONV_ALGO_IMPLICIT_GEMM:
+    case CONV_ALGO_DILATED:
+        return 1;
+    case CONV_ALGO_DEPTHWISE:
+        return desc->groups == desc->input_channel;
+    default:
+        return 0;
+    }
+}
+
+// 输出按 m x m 分块后整个batch的tile数，即Winograd中矩阵乘法的N维
+static int winograd_tiles(const conv_desc_t *desc, int m)
+{
+    return desc->batch * ((conv_output_h(desc) + m - 1) / m) * ((conv_output_w(desc) + m - 1) / m);
+}
+
+// NCHW下的选择
+static conv_algo_t select_algo_nchw(const conv_desc_t *desc)
+{
+    // 3x3、stride=1（可带填充）且通道数足够：Winograd，tile数足够时优先乘法更少的 F(4x4,3x3)
+    if (conv_algo_supported(desc, CONV_ALGO_WINOGRAD_4X4) &&
+        desc->input_channel >= CONV_WINOGRAD_MIN_CHANNEL) {
+        if (winograd_tiles(desc, 4) >= CONV_WINOGRAD_MIN_TILES) {
+            return CONV_ALGO_WINOGRAD_4X4;
+        }
+        if (winograd_tiles(desc, 2) >= CONV_WINOGRAD_MIN_TILES) {
+            return CONV_ALGO_WINOGRAD_2X2;
+        }
+    }
+    // 逐点卷积不生成im2col矩阵，直接把输入交给SGEMM（1x1时空洞不起作用）
+    if (conv_pointwise(desc)) {
+        return CONV_ALGO_IM2COL_SGEMM;
+    }
+    if (desc->dilation != 1) {
+        // 空洞卷积：输出通道很少时逐平面的向量化内核更快，否则与普通卷积一样走空洞im2col + SGEMM
+        if (desc->output_channel <= CONV_DILATED_MAX_OUTPUT_CHANNEL) {
+            return CONV_ALGO_DILATED;
+        }
+    } else if (desc->k_size == 3 && desc->input_channel <= CONV_DIRECT_MAX_INPUT_CHANNEL) {
+        // 3x3且输入通道较少：直接卷积
+        return CONV_ALGO_DIRECT;
+    }
+    // 其余（大卷积核或通道数较多）：im2col + SGEMM；im2col矩阵按L2大小的列块流式生成，
+    // 临时内存与形状无关，大图像、大batch时也比逐元素收集窗口的隐式GEMM快
+    return CONV_ALGO_IM2COL_SGEMM;
+}
+
+void conv_group_desc(const conv_desc_t *desc, conv_desc_t *group)
+{
+    *group = *desc;
+    group->batch = 1;
+    group->input_channel = desc->input_channel / desc->groups;
+    group->output_channel = desc->output_channel / desc->groups;
+    group->layout = CONV_LAYOUT_NCHW;
+    group->groups = 1;
+}
+
+// 深度卷积用专用内核；其余分组卷积按单个分组的形状选择，逐组执行
+// 其他布局下优先使用该布局的专用内核，免去两次布局转换；Winograd的乘法次数少得多，仍然保留
+conv_algo_t conv_select_algo(const conv_desc_t *desc)
+{
+    if (desc->groups > 1) {
+        conv_desc_t group;
+        if (conv_algo_supported(desc, CONV_ALGO_DEPTHWISE)) {
+            return CONV_ALGO_DEPTHWISE;
+        }
+        conv_group_desc(desc, &group);
+        return select_algo_nchw(&group);
+    }
+
+    conv_algo_t algo = select_algo_nchw(desc);
+
+    if (algo == CONV_ALGO_WINOGRAD_2X2 || algo == CONV_ALGO_WINOGRAD_4X4 || desc->layout == CONV_LAYOUT_NCHW) {
+        return algo;
+    }
+    // 通道分块布局：小通道和空洞卷积用直接卷积
+    if ((desc->layout == CONV_LAYOUT_NC4HW4 || desc->layout == CONV_LAYOUT_NC8HW8) &&
+        (algo == CONV_ALGO_DIRECT || algo == CONV_ALGO_DILATED)) {
+        return CONV_ALGO_DIRECT;
+    }
+    // 其余用该布局的GEMM；im2row按行分块生成，内存有上界，两种GEMM算法在这些布局下相同
+    return conv_layout_native(desc, algo) ? algo : CONV_ALGO_IM2COL_SGEMM;
+}
+
+const char *conv_algo_name(conv_algo_t algo)
+{
+    switch (algo) {
+    case CONV_ALGO_AUTO:          return "auto";
+    case CONV_ALGO_DIRECT:        return "direct";
+    case CONV_ALGO_IM2COL_SGEMM:  return "im2col_sgemm";
+    case CONV_ALGO_IMPLICIT_GEMM: return "implicit_gemm";
+    case CONV_ALGO_WINOGRAD_2X2:  return "winograd_f2";
+    case CONV_ALGO_WINOGRAD_4X4:  return "winograd_f4";
+    case CONV_ALGO_DILATED:       return "dilated";
+    case CONV_ALGO_DEPTHWISE:     return "depthwise";
+    default:                      return "unknown";
+    }
+}
+
+void *conv_ws_alloc(conv_workspace_t *ws, size_t bytes)
+{
+    size_t size = conv_ws_bytes(bytes ? bytes : 1);
+    void *p;
+
+    if (!ws) {
+        return posix_memalign(&p, CONV_WORKSPACE_ALIGN, size) == 0 ? p : NULL;
+    }
+    if (size > ws->size - ws->used) {
+        return NULL;
+    }
+    p = ws->base + ws->used;
+    ws->used += size;
+    return p;
+}
+
+void conv_ws_free(conv_workspace_t *ws, void *p)
+{
+    if (!ws) {
+        free(p);
+        return;
+    }
+    if (p && (size_t)((char *)p - ws->base) < ws->used) {
+        ws->used = (size_t)((char *)p - ws->base);
+    }
+}
+
+// 分组卷积：每组的输入、输出通道在每张图像内连续，权重（OIHW）和偏置按组连续，
+// 逐个 (图像, 分组) 执行普通卷积（im2col 即每组一次 C_out/g x (C_in/g * k*k) 的GEMM）
+// (分组, 图像) 的个数不少于线程数时在它们之间并行：每个线程从工作区中分到一份单组所需的工作区，
+// 组内的算法在线程池中串行执行；否则逐组执行，由组内的算法使用所有线程
+static int grouped_concurrent(const conv_desc_t *desc)
+{
+    int threads = conv_parallel_threads();
+    return threads > 1 && desc->groups * desc->batch >= threads;
+}
+
+typedef struct {
+    const conv_desc_t *group;
+    conv_algo_t algo;
+    int groups;
+    const float *input, *weights, *packed_weights, *bias;
+    float *output;
+    size_t input_group, output_group, weights_group, packed_group;
+    char *workspace;
+    size_t workspace_stride;    // 每个线程一份，字节数
+    int ret;
+} grouped_task_t;
+
+static int grouped_run_one(const grouped_task_t *t, int image, conv_workspace_t *ws)
+{
+    int g = image % t->groups;
+
+    return conv_run(t->group, t->algo, t->input + image * t->input_group,
+                    t->weights ? t->weights + g * t->weights_group : NULL,
+                    t->packed_weights ? t->packed_weights + g * t->packed_group : NULL,
+                    t->bias ? t->bias + g * t->group->output_channel : NULL, t->output + image * t->output_group, ws);
+}
+
+static void grouped_task(void *ctx, int task, int thread_id)
+{
+    grouped_task_t *t = (grouped_task_t *)ctx;
+    conv_workspace_t ws;
+
+    ws.base = t->workspace ? t->workspace + (size_t)thread_id * t->workspace_stride : NULL;
+    ws.size = t->workspace_stride;
+    ws.used = 0;
+    int ret = grouped_run_one(t, task, &ws);
+    if (ret != CONV_OK) {
+        __atomic_store_n(&t->ret, ret, __ATOMIC_RELAXED);
+    }
+}
+
+static int run_grouped(const conv_desc_t *desc, conv_algo_t algo, const float *input, const float *weights,
+                       const float *packed_weights, const float *bias, float *output, conv_workspace_t *ws)
+{
+    conv_desc_t group;
+    grouped_task_t t;
+    int count = desc->groups * desc->batch;
+
+    conv_group_desc(desc, &group);
+    t.group = &group;
+    t.algo = algo;
+    t.groups = desc->groups;
+    t.input = input;
+    t.weights = weights;
+    t.packed_weights = packed_weights;
+    t.bias = bias;
+    t.output = output;
+    t.input_group = (size_t)group.input_channel * desc->input_h * desc->input_w;
+    t.output_group = (size_t)group.output_channel * conv_output_h(desc) * conv_output_w(desc);
+    t.weights_group = (size_t)group.output_channel * group.input_channel * desc->k_size * desc->k_size;
+    t.packed_group = packed_weights ? conv_packed_weights_size(&group, algo) : 0;
+    t.ret = CONV_OK;
+
+    // 第 image 个 (图像, 分组) 即NCHW中的第 image 段通道
+    if (!grouped_concurrent(desc)) {
+        for (int image = 0; image < count && t.ret == CONV_OK; image++) {
+            t.ret = grouped_run_one(&t, image, ws);
+        }
+        return t.ret;
+    }
+
+    t.workspace_stride = conv_ws_bytes(conv_run_workspace_size(&group, algo, packed_weights != NULL));
+    t.workspace = NULL;
+    if (t.workspace_stride > 0) {
+        t.workspace = (char *)conv_ws_alloc(ws, (size_t)conv_parallel_threads() * t.workspace_stride);
+        if (!t.workspace) {
+            return CONV_ERR_NOMEM;
+        }
+    }
+    conv_parallel_for(count, grouped_task, &t);
+    conv_ws_free(ws, t.workspace);
+    return t.ret;
+}
+
+int conv_run(const conv_desc_t *desc, conv_algo_t algo, const float *input, const float *weights,
+             const float *packed_weights, const float *bias, float *output, conv_workspace_t *ws)
+{
+    if (desc->layout != CONV_LAYOUT_NCHW) {
+        return conv_run_layout(desc, algo, input, weights, packed_weights, bias, output, ws);
+    }
+    if (desc->groups > 1 && algo != CONV_ALGO_DEPTHWISE) {
+        return run_grouped(desc, algo, input, weights, packed_weights, bias, output, ws);
+    }
+    switch (algo) {
+    case CONV_ALGO_DIRECT:
+        return conv_run_direct(desc, input, weights, packed_weights, bias, output, ws);
+    case CONV_ALGO_DILATED:
+        return conv_run_dilated(desc, input, weights, bias, output);
+    case CONV_ALGO_DEPTHWISE:
+        return conv_run_depthwise(desc, input, weights, bias, output);
+    case CONV_ALGO_IM2COL_SGEMM:
+        return packed_weights ? conv_run_im2col_sgemm_prepacked(desc, input, packed_weights, bias, output, ws)
+                              : conv_run_im2col_sgemm(desc, input, weights, bias, output, ws);
+    case CONV_ALGO_IMPLICIT_GEMM:
+        return packed_weights ? conv_run_implicit_gemm_prepacked(desc, input, packed_weights, bias, output, ws)
+                              : conv_run_implicit_gemm(desc, input, weights, bias, output, ws);
+    case CONV_ALGO_WINOGRAD_2X2:
+        return packed_weights ? conv_winograd_run(desc, 2, packed_weights, input, bias, output, ws)
+                              : conv_run_winograd(desc, 2, input, weights, bias, output, ws);
+    case CONV_ALGO_WINOGRAD_4X4:
+        return packed_weights ? conv_winograd_run(desc, 4, packed_weights, input, bias, output, ws)
+                              : conv_run_winograd(desc, 4, input, weights, bias, output, ws);
+    default:
+        return CONV_ERR_UNSUPPORTED;
+    }
+}
+
+// 与 conv_run 的分支一一对应；分组卷积逐组执行时各组依次复用同一段工作区，并行时每个线程一份
+size_t conv_run_workspace_size(const conv_desc_t *desc, conv_algo_t algo, int prepacked)
+{
+    if (desc->layout != CONV_LAYOUT_NCHW) {
+        return conv_layout_workspace_size(desc, algo, prepacked);
+    }
+    if (desc->groups > 1 && algo != CONV_ALGO_DEPTHWISE) {
+        conv_desc_t group;
+        conv_group_desc(desc, &group);
+        size_t size = conv_run_workspace_size(&group, algo, prepacked);
+        return grouped_concurrent(desc) ? (size_t)conv_parallel_threads() * conv_ws_bytes(size) : size;
+    }
+    switch (algo) {
+    case CONV_ALGO_DIRECT:
+        return conv_direct_workspace_size(desc, prepacked);
+    case CONV_ALGO_IM2COL_SGEMM:
+        return conv_im2col_sgemm_workspace_size(desc, prepacked);
+    case CONV_ALGO_IMPLICIT_GEMM:
+        return conv_implicit_gemm_workspace_size(desc, prepacked);
+    case CONV_ALGO_WINOGRAD_2X2:
+        return conv_winograd_workspace_size(desc, 2, prepacked);
+    case CONV_ALGO_WINOGRAD_4X4:
+        return conv_winograd_workspace_size(desc, 4, prepacked);
+    default:
+        // 空洞卷积和NCHW的深度卷积不需要临时内存
+        return 0;
+    }
+}
+
+// 检查参数，AUTO 换成调度器的选择
+static int conv2d_check(const conv_desc_t *desc, conv_algo_t *algo, const float *input, const float *weights,
+                        const float *output)
+{
+    int ret = conv_desc_check(desc);
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    if (!input || !weights || !output) {
+        return CONV_ERR_INVALID;
+    }
+    if (*algo == CONV_ALGO_AUTO) {
+        *algo = conv_select_algo(desc);
+    }
+    if (!conv_algo_supported(desc, *algo)) {
+        return CONV_ERR_UNSUPPORTED;
+    }
+    return CONV_OK;
+}
+
+size_t conv_workspace_size(const conv_desc_t *desc, conv_algo_t algo)
+{
+    if (conv_desc_check(desc) != CONV_OK) {
+        return 0;
+    }
+    if (algo == CONV_ALGO_AUTO) {
+        algo = conv_select_algo(desc);
+    }
+    if (!conv_algo_supported(desc, algo)) {
+        return 0;
+    }
+    return conv_run_workspace_size(desc, algo, 0);
+}
+
+int conv_workspace_init(conv_workspace_t *ws, void *workspace, size_t workspace_size, size_t required)
+{
+    if ((uintptr_t)workspace % CONV_WORKSPACE_ALIGN != 0 || (required > 0 && (!workspace || workspace_size < required))) {
+        return CONV_ERR_INVALID;
+    }
+    ws->base = (char *)workspace;
+    ws->size = workspace_size;
+    ws->used = 0;
+    return CONV_OK;
+}
+
+int conv2d_ws(const conv_desc_t *desc, conv_algo_t algo, const float *input, const float *weights,
+              const float *bias, float *output, void *workspace, size_t workspace_size)
+{
+    conv_workspace_t ws;
+    int ret = conv2d_check(desc, &algo, input, weights, output);
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    ret = conv_workspace_init(&ws, workspace, workspace_size, conv_run_workspace_size(desc, algo, 0));
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    return conv_run(desc, algo, input, weights, NULL, bias, output, &ws);
+}
+
+int conv2d(const conv_desc_t *desc, conv_algo_t algo,
+           const float *input, const float *weights, const float *bias, float *output)
+{
+    conv_workspace_t ws;
+    int ret = conv2d_check(desc, &algo, input, weights, output);
+    if (ret != CONV_OK) {
+        return ret;
+    }
+
+    // 整个调用只分配一次工作区
+    size_t size = conv_run_workspace_size(desc, algo, 0);
+    void *workspace = size ? conv_ws_alloc(NULL, size) : NULL;
+    if (size && !workspace) {
+        return CONV_ERR_NOMEM;
+    }
+    conv_workspace_init(&ws, workspace, size, size);
+    ret = conv_run(desc, algo, input, weights, NULL, bias, output, &ws);
+    conv_ws_free(NULL, workspace);
+    return ret;
+}
@@ -0,0 +1,294 @@
+#ifndef ARM64_CONV_H
+#define ARM64_CONV_H
+
+// 卷积库公共接口
+// 将 C_loop_Origin / set1 / set2 / set3 中的卷积实现整合为一个可链接的库，
+// 通过卷积描述符描述每一层的形状，由调度器为每种形状选择最快的实现。
+//
+// 数据布局约定（desc.layout 为默认的 CONV_LAYOUT_NCHW 时）：
+//   输入  input  : N x C_in  x H     x W      (NCHW)
+//   权重  weights: C_out x (C_in / groups) x k x k  (OIHW)
+//   偏置  bias   : C_out，可以为 NULL
+//   输出  output : N x C_out x out_h x out_w  (NCHW)
+// 输入、输出也可以按 NHWC 或通道分块的 NC4HW4 / NC8HW8 存放（见 conv_layout_t），权重始终为OIHW
+// 分组卷积：输入、输出通道各分成 groups 组，第g组输出只与第g组输入卷积；groups == C_in 为深度卷积
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 返回值
+#define CONV_OK                0
+#define CONV_ERR_INVALID      -1   // 描述符或参数非法
+#define CONV_ERR_NOMEM        -2   // 内存分配失败
+#define CONV_ERR_UNSUPPORTED  -3   // 所选算法不支持该形状
+
+// 激活函数
+typedef enum {
+    CONV_ACT_NONE = 0,
+    CONV_ACT_RELU,          // max(x, 0)
+    CONV_ACT_RELU6,         // min(max(x, 0), 6)
+    CONV_ACT_LEAKY_RELU,    // x > 0 ? x : alpha * x
+    CONV_ACT_SILU,          // x * sigmoid(x)
+    CONV_ACT_COUNT
+} conv_act_t;
+
+// 融合后处理：写回卷积结果时依次完成 加偏置 -> 激活 -> 截断，不再单独遍历整个输出
+// GEMM类算法在每个结果块写回后立即处理（结果块仍在L1中），直接卷积、Winograd、空洞卷积在每个输出行或平面写回时处理
+typedef struct {
+    conv_act_t activation;  // 默认 CONV_ACT_NONE
+    float alpha;            // LeakyReLU 负半轴的斜率
+    int clamp;              // 非0时在激活之后截断到 [clamp_min, clamp_max]
+    float clamp_min, clamp_max;
+} conv_epilogue_t;
+
+// 输入、输出特征图的数据布局
+// 通道分块布局把每 4 / 8 个通道的同一像素放在一起，按 N x ceil(C/4) x H x W x 4 存放，
+// 内核可以跨通道向量化；通道数不是4 / 8 的倍数时最后一块补零
+typedef enum {
+    CONV_LAYOUT_NCHW = 0,   // 默认
+    CONV_LAYOUT_NHWC,       // 通道连续，GEMM类算法的im2col只需按像素整段拷贝，1x1卷积直接作为GEMM的A矩阵
+    CONV_LAYOUT_NC4HW4,     // N x ceil(C/4) x H x W x 4
+    CONV_LAYOUT_NC8HW8,     // N x ceil(C/8) x H x W x 8
+    CONV_LAYOUT_COUNT
+} conv_layout_t;
+
+// 卷积描述符
+typedef struct {
+    int batch;           // N
+    int input_channel;   // C_in
+    int input_h;         // H
+    int input_w;         // W
+    int output_channel;  // C_out
+    int k_size;          // 卷积核尺寸 (k x k)
+    int stride;          // 步长
+    int padding;         // 四周补零的宽度
+    int dilation;        // 空洞率，普通卷积为1
+    conv_epilogue_t epilogue;   // 融合后处理，全为0（conv_desc_init 的默认值）时只加偏置
+    conv_layout_t layout;       // 输入和输出的数据布局，默认NCHW
+    int groups;                 // 分组数，C_in 和 C_out 都须是它的倍数，默认1
+} conv_desc_t;
+
+// 卷积算法
+typedef enum {
+    CONV_ALGO_AUTO = 0,         // 由调度器按形状自动选择
+    CONV_ALGO_DIRECT,           // 思路一：直接卷积 (set1)，不支持空洞
+    CONV_ALGO_IM2COL_SGEMM,     // 思路二：Im2col + SGEMM (set2)
+    CONV_ALGO_IMPLICIT_GEMM,    // 隐式GEMM：不生成im2col矩阵，打包时直接收集输入
+    CONV_ALGO_WINOGRAD_2X2,     // Winograd F(2x2,3x3)，仅 3x3、stride=1、dilation=1
+    CONV_ALGO_WINOGRAD_4X4,     // Winograd F(4x4,3x3)，仅 3x3、stride=1、dilation=1
+    CONV_ALGO_DILATED,          // 附加实验：空洞卷积 (set3)
+    CONV_ALGO_DEPTHWISE,        // 深度卷积，仅 groups == C_in（C_out 为 C_in 的倍数）
+    CONV_ALGO_COUNT
+} conv_algo_t;
+
+// Winograd 精度上界（与 C_loop_Origin.c 中的 convolution 比较，set1/C_Winograd_Kernel3x3.c 负责检查）
+// 输入、输出变换把整个tile的输入混在一起，舍入误差随tile内的输入幅度变化，而不只取决于该输出自己的抽头：
+// 补零边界上抽头大多落在补零中的输出，sum|w * x| 接近0，仍带有相邻输入的变换误差。因此对每个输出
+//   |y_winograd - y_ref| <= bound * sum_ic (sum_{kh,kw} |w[oc][ic]|) * max|x_ic|
+// max|x_ic| 为该输出所在tile读取的 (m+2) x (m+2) 输入窗口（含补零）中输入通道 ic 的最大绝对值，
+// tile 从输出的 (0, 0) 开始按 m x m 划分（F(2x2) 为 m = 2，F(4x4) 为 m = 4）
+// F(4x4,3x3) 的变换矩阵含 1/6、1/24 等系数和 8 倍放大，误差明显大于 F(2x2,3x3)
+#define CONV_WINOGRAD_2X2_ERROR_BOUND  1e-5f
+#define CONV_WINOGRAD_4X4_ERROR_BOUND  5e-5f
+
+// 用默认值（batch=1, stride=1, padding=0, dilation=1，无激活、不截断，NCHW，groups=1）初始化描述符
+void conv_desc_init(conv_desc_t *desc, int input_channel, int input_h, int input_w,
+                    int output_channel, int k_size);
+
+// 输出尺寸
+int conv_output_h(const conv_desc_t *desc);
+int conv_output_w(const conv_desc_t *desc);
+
+// 检查描述符是否合法，合法返回 CONV_OK
+// 后处理：激活函数须为已知值，LeakyReLU 的 alpha 须为有限值，截断时须 clamp_min <= clamp_max；布局须为已知值；
+// groups 须为正数且整除 C_in 和 C_out
+int conv_desc_check(const conv_desc_t *desc);
+
+// 判断某个算法能否处理该形状
+int conv_algo_supported(const conv_desc_t *desc, conv_algo_t algo);
+
+// 调度器：为该形状选择最快的算法（不会返回 CONV_ALGO_AUTO）
+conv_algo_t conv_select_algo(const conv_desc_t *desc);
+
+// 算法名称，用于打印
+const char *conv_algo_name(conv_algo_t algo);
+
+// 激活函数名称，用于打印
+const char *conv_act_name(conv_act_t activation);
+
+// 布局名称，用于打印
+const char *conv_layout_name(conv_layout_t layout);
+
+// 按 layout 存放 batch x channel x h x w 的特征图所需的float个数（含分块布局补齐的通道），layout 非法时返回0
+size_t conv_layout_size(conv_layout_t layout, int batch, int channel, int h, int w);
+
+// 布局转换：src 按 src_layout、dst 按 dst_layout 存放同一个 batch x channel x h x w 的特征图，两者不能重叠
+// 每次处理4个通道 x 4个像素，ARM64上用NEON转置（vtrn / vld4q / vst4q），按 (图像, 通道组) 并行；
+// 转换到分块布局时补齐的通道写0；参数非法时返回 CONV_ERR_INVALID。整个网络可以保持同一布局，只在输入和输出处各转换一次
+int conv_layout_transform(conv_layout_t src_layout, const float *src, conv_layout_t dst_layout, float *dst,
+                          int batch, int channel, int h, int w);
+
+// 线程数：默认为1；num_threads <= 0 时使用全部在线CPU核心
+// Im2col、SGEMM 和偏置都会按该线程数并行，不要在其他线程执行卷积的同时修改
+int conv_set_num_threads(int num_threads);
+int conv_get_num_threads(void);
+
+// CPU特性，conv_cpu_features 的返回值为以下各位的按位或
+#define CONV_CPU_NEON        (1u << 0)    // ARM64 Advanced SIMD
+#define CONV_CPU_DOTPROD     (1u << 1)    // ARMv8.2 SDOT/UDOT
+#define CONV_CPU_FP16        (1u << 2)    // ARMv8.2 半精度向量运算
+#define CONV_CPU_BF16        (1u << 3)    // ARMv8.6 BFDOT/BFMMLA
+#define CONV_CPU_I8MM        (1u << 4)    // ARMv8.6 SMMLA/UMMLA
+#define CONV_CPU_SVE         (1u << 5)
+#define CONV_CPU_SVE2        (1u << 6)
+#define CONV_CPU_FHM         (1u << 7)    // ARMv8.2 FMLAL/FMLSL（半精度乘积加宽到单精度累加）
+#define CONV_CPU_AVX2        (1u << 8)
+#define CONV_CPU_FMA         (1u << 9)
+#define CONV_CPU_F16C        (1u << 10)
+#define CONV_CPU_AVX512F     (1u << 11)
+#define CONV_CPU_AVX512BW    (1u << 12)
+#define CONV_CPU_AVX512VNNI  (1u << 13)
+#define CONV_CPU_AVX512BF16  (1u << 14)
+#define CONV_CPU_AVX512FP16  (1u << 15)
+#define CONV_CPU_AVXVNNI     (1u << 16)
+
+// 运行时检测到的CPU特性（操作系统不支持保存对应寄存器状态的特性不计入）
+// 第一次使用时检测一次，并据此为各算子填充内核调度表，同一个二进制在每台机器上选择最快的内核变体。
+// 环境变量 CONV_CPU_DISABLE 可以屏蔽部分特性（逗号分隔的特性名，如 "avx512f,avx2"），用于在同一台机器上比较各内核
+unsigned conv_cpu_features(void);
+
+// 单个特性的名称，如 "dotprod"、"avx512f"；不是单个已知特性时返回 "unknown"
+const char *conv_cpu_feature_name(unsigned feature);
+
+// 调度表的内容：检测到的特性和各算子选择的内核，如 "cpu=avx2,fma,avx512f sgemm=avx512_14x32 dilated=avx2"
+const char *conv_kernel_info(void);
+
+// 执行卷积，algo 为 CONV_ALGO_AUTO 时由调度器选择
+// 非NCHW布局的专用内核：NHWC 为 IM2COL_SGEMM / IMPLICIT_GEMM（像素为GEMM的行、输出通道为列，结果直接是NHWC），
+// NC4HW4 / NC8HW8 为 DIRECT（一次计算 4 / 8 个输出通道 x 多个像素，沿通道向量化）；
+// 其他算法先把输入转换为NCHW，计算后把输出转换回来。调度器在该布局下优先选择专用内核。
+// 深度卷积（groups == C_in）使用 DEPTHWISE：NCHW 沿宽度向量化，3x3 / 5x5、stride=1/2 有专用内核；
+// C_out == C_in 时 NHWC / NC4HW4 / NC8HW8 沿通道向量化。其余分组卷积逐组执行所选算法（im2col 即每组一次GEMM），
+// (图像, 分组) 的个数不少于线程数时在它们之间并行
+int conv2d(const conv_desc_t *desc, conv_algo_t algo,
+           const float *input, const float *weights, const float *bias, float *output);
+
+// 工作区
+// 卷积运行时的临时内存（im2col矩阵、SGEMM的打包缓冲区、Winograd的变换结果、布局转换的缓冲区等）
+// 可以由调用者提供：conv_workspace_size 返回所需的字节数，同样大小、按 CONV_WORKSPACE_ALIGN 字节对齐的
+// 缓冲区传给 conv2d_ws 后，运行过程中不再分配堆内存。conv2d 每次调用分配一次同样大小的工作区。
+// 同一个工作区可以在网络各层之间依次复用（取各层所需的最大值），但不能被并发的调用共用。
+// 所需大小与线程数有关，conv_set_num_threads 之后需要重新查询
+#define CONV_WORKSPACE_ALIGN 64
+
+// algo 为 CONV_ALGO_AUTO 时按调度器的选择计算；描述符非法或算法不支持时返回0
+size_t conv_workspace_size(const conv_desc_t *desc, conv_algo_t algo);
+
+// 与 conv2d 相同，临时内存全部取自 workspace；所需大小为0时 workspace 可以为NULL，
+// workspace 未按 CONV_WORKSPACE_ALIGN 对齐或 workspace_size 小于 conv_workspace_size 时返回 CONV_ERR_INVALID
+int conv2d_ws(const conv_desc_t *desc, conv_algo_t algo, const float *input, const float *weights,
+              const float *bias, float *output, void *workspace, size_t workspace_size);
+
+// 低精度卷积
+// 输入、权重、输出按16位存储（FP16 或 BF16），偏置仍为FP32；乘积在FP32中累加，只在写回输出时舍入一次。
+// 与FP32相比访存量和im2col矩阵减半，ARM64 上使用 FMLAL（FEAT_FHM）/ BFDOT，x86-64 上使用 F16C / AVX512_BF16。
+typedef enum {
+    CONV_DTYPE_FP32 = 0,
+    CONV_DTYPE_FP16,        // IEEE 754 半精度：10位尾数，范围 ±65504
+    CONV_DTYPE_BF16,        // bfloat16：FP32的高16位，7位尾数，范围与FP32相同
+    CONV_DTYPE_COUNT
+} conv_dtype_t;
+
+// 低精度精度上界（与FP32输入上的 convolution 比较，set2/asm_Sgemm_lowp.c 负责检查）
+// 对每个输出：|y_lowp - y_ref| <= bound * (|b| + sum_{ic,kh,kw} |w * x|)，且数值在FP16的范围内
+// 误差来自输入、权重舍入到16位（相对误差各 2^-11 / 2^-8）和输出的舍入，累加本身为FP32
+#define CONV_FP16_ERROR_BOUND  2e-3f
+#define CONV_BF16_ERROR_BOUND  1.6e-2f
+
+// 数据类型名称，用于打印
+const char *conv_dtype_name(conv_dtype_t dtype);
+
+// FP32 与16位格式之间的批量转换，舍入方式为就近舍入到偶数；dtype 为 CONV_DTYPE_FP32 时直接拷贝
+void conv_convert_from_fp32(conv_dtype_t dtype, const float *src, void *dst, size_t count);
+void conv_convert_to_fp32(conv_dtype_t dtype, const void *src, float *dst, size_t count);
+
+// 执行低精度卷积：input、weights、output 的元素类型为 dtype，bias 为FP32（可以为NULL）
+// 支持 CONV_ALGO_IM2COL_SGEMM（任意形状）和 CONV_ALGO_DIRECT（3x3、dilation=1），
+// CONV_ALGO_AUTO 在调度器选择直接卷积时使用直接卷积，否则使用 Im2col + GEMM；其他算法返回 CONV_ERR_UNSUPPORTED。
+// dtype 为 CONV_DTYPE_FP32 时与 conv2d 相同；其他类型只支持NCHW布局、groups=1
+int conv2d_lowp(const conv_desc_t *desc, conv_algo_t algo, conv_dtype_t dtype,
+                const void *input, const void *weights, const float *bias, void *output);
+
+// 与 conv_workspace_size / conv2d_ws 相同，临时内存（16位的im2col矩阵、HGEMM的打包缓冲区和FP32条带、
+// 直接卷积转换后的输入行）全部取自 workspace
+size_t conv_lowp_workspace_size(const conv_desc_t *desc, conv_algo_t algo, conv_dtype_t dtype);
+int conv2d_lowp_ws(const conv_desc_t *desc, conv_algo_t algo, conv_dtype_t dtype, const void *input,
+                   const void *weights, const float *bias, void *output, void *workspace, size_t workspace_size);
+
+// INT8量化卷积
+// 量化方式 real = scale * (q - zero_point)：输入、输出为每张量的比例和零点；权重为每个输出通道一个比例、零点为0（对称量化）；
+// 偏置为int32，比例为 input_scale * weight_scale[oc]、零点为0（与 TFLite / ONNX QLinearConv 的约定相同）
+typedef struct {
+    float input_scale;
+    int input_zero_point;           // [-128, 127]，补零部分按该值填充（表示实数0）
+    const float *weight_scale;      // output_channel 个
+    float output_scale;
+    int output_zero_point;          // [-128, 127]
+} conv_quant_t;
+
+// 执行INT8卷积：Im2col + INT8 GEMM（支持任意形状，包括步长、补零和空洞），int32 累加
+// 每个输出通道的重新量化 y = saturate(round((acc + bias) * input_scale * weight_scale[oc] / output_scale) + output_zero_point)
+// 在每个结果块写回时完成；ARM64 上使用 SMMLA（FEAT_I8MM）/ SDOT（FEAT_DotProd），x86-64 上使用 AVX512_VNNI / AVX_VNNI。
+// 后处理中的 ReLU / ReLU6 / 截断换算为量化值的饱和区间；LeakyReLU、SiLU 返回 CONV_ERR_UNSUPPORTED。
+// 只支持NCHW布局、groups=1；比例不是正的有限值或零点超出范围时返回 CONV_ERR_INVALID
+int conv2d_int8(const conv_desc_t *desc, const conv_quant_t *quant, const int8_t *input, const int8_t *weights,
+                const int32_t *bias, int8_t *output);
+
+// 与 conv_workspace_size / conv2d_ws 相同，临时内存（int8的im2col矩阵、重新量化比例、INT8 GEMM的打包缓冲区）
+// 全部取自 workspace；描述符非法或不支持时大小为0
+size_t conv_int8_workspace_size(const conv_desc_t *desc);
+int conv2d_int8_ws(const conv_desc_t *desc, const conv_quant_t *quant, const int8_t *input, const int8_t *weights,
+                   const int32_t *bias, int8_t *output, void *workspace, size_t workspace_size);
+
+// 预打包权重句柄
+// 推理时同一组权重会被反复使用：conv_prepare 只做一次权重整理（SGEMM类算法打包为微内核的A微面板，
+// Winograd 变换到 U = G g G^T 并打包），之后 conv2d_prepared 跳过全部权重重排。
+// 句柄持有权重和偏置的副本，调用者可以在 conv_prepare 返回后释放它们。
+typedef struct conv_handle conv_handle_t;
+
+// algo 为 CONV_ALGO_AUTO 时由调度器选择；成功时 *handle 指向新句柄
+int conv_prepare(const conv_desc_t *desc, conv_algo_t algo, const float *weights, const float *bias,
+                 conv_handle_t **handle);
+
+// 用句柄执行卷积，形状与 conv_prepare 时的描述符相同
+int conv2d_prepared(const conv_handle_t *handle, const float *input, float *output);
+
+// 句柄执行时的工作区大小（权重已整理，通常小于 conv_workspace_size），用法与 conv2d_ws 相同
+size_t conv_prepared_workspace_size(const conv_handle_t *handle);
+int conv2d_prepared_ws(const conv_handle_t *handle, const float *input, float *output, void *workspace,
+                       size_t workspace_size);
+
+// 低精度句柄：权重为 dtype 的16位元素，直接卷积在这里一次性转换为FP32并重排，Im2col + GEMM 保存16位权重的副本；
+// 句柄只能交给 conv2d_lowp_prepared（交给 conv2d_prepared 返回 CONV_ERR_INVALID），工作区大小同样由
+// conv_prepared_workspace_size 给出。dtype 为 CONV_DTYPE_FP32 时与 conv_prepare / conv2d_prepared 相同
+int conv_prepare_lowp(const conv_desc_t *desc, conv_algo_t algo, conv_dtype_t dtype, const void *weights,
+                      const float *bias, conv_handle_t **handle);
+int conv2d_lowp_prepared(const conv_handle_t *handle, const void *input, void *output);
+int conv2d_lowp_prepared_ws(const conv_handle_t *handle, const void *input, void *output, void *workspace,
+                            size_t workspace_size);
+
+// 句柄实际使用的算法
+conv_algo_t conv_handle_algo(const conv_handle_t *handle);
+
+// 释放句柄，handle 可以为NULL
+void conv_handle_destroy(conv_handle_t *handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ARM64_CONV_H
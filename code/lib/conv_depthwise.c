@@ -0,0 +1,521 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conv_internal.h"
+#include "thread_pool.h"
+
+#ifdef __aarch64__
+#include <arm_neon.h>
+#endif
+
+// 深度卷积：groups == C_in，每个输出通道只与一个输入通道（oc / (C_out / C_in)）卷积
+//
+// 每个输出只有 k*k 次乘加。用 im2col + SGEMM 时每个通道是一次 M=1 的矩阵乘法，打包开销远大于计算；
+// 直接卷积的多输出通道分块也无从复用。这里单独实现：
+//   NCHW：每个 (图像, 输出通道) 平面一个任务，沿宽度向量化。3x3 / 5x5、stride=1/2 时内部区域的卷积核
+//         读入寄存器，每次计算一行上相邻的8个输出（stride=2 用 vld2q 解交织读取），累加器从偏置开始，
+//         一行算完后立即做激活和截断；边界像素裁剪卷积核窗口。其余卷积核尺寸、步长和空洞用逐平面空洞卷积。
+//   NHWC / NC4HW4 / NC8HW8（C_out == C_in）：沿通道向量化，每次计算4个相邻像素的4个通道，
+//         权重整理为 [通道块][抽头][块内通道]，同一抽头的权重向量供4个像素复用。
+
+#ifdef __aarch64__
+typedef float32x4_t dw_vec_t;
+#else
+typedef float dw_vec_t __attribute__((vector_size(16)));
+#endif
+
+static inline dw_vec_t dw_load(const float *p)
+{
+#ifdef __aarch64__
+    return vld1q_f32(p);
+#else
+    dw_vec_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+#endif
+}
+
+// p[0], p[2], p[4], p[6]
+static inline dw_vec_t dw_load_even(const float *p)
+{
+#ifdef __aarch64__
+    return vld2q_f32(p).val[0];
+#else
+    dw_vec_t v = {p[0], p[2], p[4], p[6]};
+    return v;
+#endif
+}
+
+static inline void dw_store(float *p, dw_vec_t v)
+{
+#ifdef __aarch64__
+    vst1q_f32(p, v);
+#else
+    memcpy(p, &v, sizeof(v));
+#endif
+}
+
+static inline dw_vec_t dw_splat(float x)
+{
+#ifdef __aarch64__
+    return vdupq_n_f32(x);
+#else
+    dw_vec_t v = {x, x, x, x};
+    return v;
+#endif
+}
+
+// acc + x * w（w 广播）
+static inline dw_vec_t dw_fma_n(dw_vec_t acc, dw_vec_t x, float w)
+{
+#ifdef __aarch64__
+    return vfmaq_n_f32(acc, x, w);
+#else
+    return acc + x * dw_splat(w);
+#endif
+}
+
+// acc + x * w（逐元素）
+static inline dw_vec_t dw_fma(dw_vec_t acc, dw_vec_t x, dw_vec_t w)
+{
+#ifdef __aarch64__
+    return vfmaq_f32(acc, x, w);
+#else
+    return acc + x * w;
+#endif
+}
+
+// ---------------------------------------------------------------- NCHW
+
+// 内部列上 blocks 组、每组4个相邻输出，两组一起计算；卷积核只用 [0, rows) 行（上下边界行裁剪后的行数）
+// input 指向第一个输出的第一个有效抽头，kernel 指向对应的卷积核行；k_size、stride 由调用处以常量展开
+typedef void (*dw_row_fn)(const float *input, int input_w, const float *kernel, int rows, float bias, float *output,
+                          int blocks);
+
+static inline __attribute__((always_inline)) void dw_row_body(const float *input, int input_w, const float *kernel,
+                                                              const int rows, float bias, float *output, int blocks,
+                                                              const int k_size, const int stride)
+{
+    float w[25];
+    int b = 0;
+
+    // 卷积核只读一次，完整的卷积核展开后常驻寄存器
+    for (int i = 0; i < rows * k_size; i++) {
+        w[i] = kernel[i];
+    }
+    for (; b + 2 <= blocks; b += 2) {
+        const float *x = input + (size_t)b * 4 * stride;
+        dw_vec_t acc0 = dw_splat(bias);
+        dw_vec_t acc1 = acc0;
+        for (int kh = 0; kh < rows; kh++) {
+            const float *row = x + (size_t)kh * input_w;
+            for (int kw = 0; kw < k_size; kw++) {
+                dw_vec_t x0 = stride == 1 ? dw_load(row + kw) : dw_load_even(row + kw);
+                dw_vec_t x1 = stride == 1 ? dw_load(row + kw + 4) : dw_load_even(row + kw + 8);
+                acc0 = dw_fma_n(acc0, x0, w[kh * k_size + kw]);
+                acc1 = dw_fma_n(acc1, x1, w[kh * k_size + kw]);
+            }
+        }
+        dw_store(output + b * 4, acc0);
+        dw_store(output + b * 4 + 4, acc1);
+    }
+    for (; b < blocks; b++) {
+        const float *x = input + (size_t)b * 4 * stride;
+        dw_vec_t acc = dw_splat(bias);
+        for (int kh = 0; kh < rows; kh++) {
+            const float *row = x + (size_t)kh * input_w;
+            for (int kw = 0; kw < k_size; kw++) {
+                dw_vec_t x0 = stride == 1 ? dw_load(row + kw) : dw_load_even(row + kw);
+                acc = dw_fma_n(acc, x0, w[kh * k_size + kw]);
+            }
+        }
+        dw_store(output + b * 4, acc);
+    }
+}
+
+// 内部行的卷积核行数为常量，单独展开
+static inline __attribute__((always_inline)) void dw_row(const float *input, int input_w, const float *kernel,
+                                                         int rows, float bias, float *output, int blocks,
+                                                         const int k_size, const int stride)
+{
+    if (rows == k_size) {
+        dw_row_body(input, input_w, kernel, k_size, bias, output, blocks, k_size, stride);
+    } else {
+        dw_row_body(input, input_w, kernel, rows, bias, output, blocks, k_size, stride);
+    }
+}
+
+static void dw_row_3x3_s1(const float *input, int input_w, const float *kernel, int rows, float bias, float *output,
+                          int blocks)
+{
+    dw_row(input, input_w, kernel, rows, bias, output, blocks, 3, 1);
+}
+
+static void dw_row_3x3_s2(const float *input, int input_w, const float *kernel, int rows, float bias, float *output,
+                          int blocks)
+{
+    dw_row(input, input_w, kernel, rows, bias, output, blocks, 3, 2);
+}
+
+static void dw_row_5x5_s1(const float *input, int input_w, const float *kernel, int rows, float bias, float *output,
+                          int blocks)
+{
+    dw_row(input, input_w, kernel, rows, bias, output, blocks, 5, 1);
+}
+
+static void dw_row_5x5_s2(const float *input, int input_w, const float *kernel, int rows, float bias, float *output,
+                          int blocks)
+{
+    dw_row(input, input_w, kernel, rows, bias, output, blocks, 5, 2);
+}
+
+// 有专用内核的组合：3x3 / 5x5、stride=1/2、无空洞，否则返回NULL
+static dw_row_fn dw_row_kernel(const conv_desc_t *desc)
+{
+    if (desc->dilation != 1) {
+        return NULL;
+    }
+    if (desc->k_size == 3) {
+        return desc->stride == 1 ? dw_row_3x3_s1 : desc->stride == 2 ? dw_row_3x3_s2 : NULL;
+    }
+    if (desc->k_size == 5) {
+        return desc->stride == 1 ? dw_row_5x5_s1 : desc->stride == 2 ? dw_row_5x5_s2 : NULL;
+    }
+    return NULL;
+}
+
+typedef struct {
+    const conv_desc_t *desc;
+    const float *input;
+    const float *weights;
+    const float *bias;
+    float *output;
+    int output_h, output_w;
+    int multiplier;                 // C_out / C_in
+    dw_row_fn row_kernel;           // NULL 时用逐平面空洞卷积
+    int col_lo, col_hi;             // 所有抽头都在输入行内的列
+    int blocks;                     // 其中用 row_kernel 计算的4输出组数
+} dw_plane_task_t;
+
+// 一行上 [ow0, ow1) 列，卷积核行限于 [kh0, kh1)；clip 非0时裁剪越过左右边界的抽头
+// input_row 为第 kh0 个卷积核行对应的输入行，结果从偏置开始写入
+static void dw_cols(const dw_plane_task_t *t, const float *input_row, const float *kernel, int kh0, int kh1,
+                    float bias, float *output_row, int ow0, int ow1, int clip)
+{
+    const conv_desc_t *desc = t->desc;
+    int k_size = desc->k_size;
+
+    for (int ow = ow0; ow < ow1; ow++) {
+        int ix0 = ow * desc->stride - desc->padding;
+        int kw0 = 0, kw1 = k_size;
+        float sum = bias;
+        if (clip) {
+            kw0 = ix0 >= 0 ? 0 : (-ix0 + desc->dilation - 1) / desc->dilation;
+            kw1 = desc->input_w - ix0 > 0 ? (desc->input_w - ix0 + desc->dilation - 1) / desc->dilation : 0;
+            if (kw1 > k_size) {
+                kw1 = k_size;
+            }
+        }
+        for (int kh = kh0; kh < kh1; kh++) {
+            const float *row = input_row + (size_t)(kh - kh0) * desc->dilation * desc->input_w + ix0;
+            for (int kw = kw0; kw < kw1; kw++) {
+                sum += row[kw * desc->dilation] * kernel[kh * k_size + kw];
+            }
+        }
+        output_row[ow] = sum;
+    }
+}
+
+static void dw_plane_task(void *ctx, int task, int thread_id)
+{
+    const dw_plane_task_t *t = (const dw_plane_task_t *)ctx;
+    const conv_desc_t *desc = t->desc;
+    int n = task / desc->output_channel;
+    int oc = task % desc->output_channel;
+    int k_size = desc->k_size;
+    int output_w = t->output_w;
+    size_t input_plane = (size_t)desc->input_h * desc->input_w;
+    size_t output_plane = (size_t)t->output_h * output_w;
+    const float *input = t->input + ((size_t)n * desc->input_channel + oc / t->multiplier) * input_plane;
+    const float *kernel = t->weights + (size_t)oc * k_size * k_size;
+    float *output = t->output + (size_t)task * output_plane;
+    float bias = t->bias ? t->bias[oc] : 0.0f;
+    int epilogue = conv_epilogue_active(&desc->epilogue);
+
+    (void)thread_id;
+    if (!t->row_kernel) {
+        for (size_t i = 0; i < output_plane; i++) {
+            output[i] = bias;
+        }
+        dilated_convolution_2d_acc(input, desc->input_h, desc->input_w, kernel, k_size, k_size,
+                                   output, t->output_h, output_w, desc->dilation, desc->stride, desc->padding);
+        if (epilogue) {
+            conv_epilogue_apply(&desc->epilogue, 0.0f, output, output_plane);
+        }
+        return;
+    }
+
+    int fast_end = t->col_lo + 4 * t->blocks;
+    for (int oh = 0; oh < t->output_h; oh++) {
+        float *output_row = output + (size_t)oh * output_w;
+        // 落在输入内的卷积核行 [kh0, kh1)（专用内核无空洞），上下边界行同样向量化
+        int iy0 = oh * desc->stride - desc->padding;
+        int kh0 = iy0 >= 0 ? 0 : -iy0;
+        int kh1 = desc->input_h - iy0 < k_size ? desc->input_h - iy0 : k_size;
+        const float *input_row = input + (size_t)(iy0 + kh0) * desc->input_w;
+
+        dw_cols(t, input_row, kernel, kh0, kh1, bias, output_row, 0, t->col_lo, 1);
+        t->row_kernel(input_row + (t->col_lo * desc->stride - desc->padding), desc->input_w, kernel + kh0 * k_size,
+                      kh1 - kh0, bias, output_row + t->col_lo, t->blocks);
+        dw_cols(t, input_row, kernel, kh0, kh1, bias, output_row, fast_end, t->col_hi, 0);
+        dw_cols(t, input_row, kernel, kh0, kh1, bias, output_row, t->col_hi, output_w, 1);
+        if (epilogue) {
+            conv_epilogue_apply(&desc->epilogue, 0.0f, output_row, output_w);
+        }
+    }
+}
+
+int conv_run_depthwise(const conv_desc_t *desc, const float *input, const float *weights, const float *bias,
+                       float *output)
+{
+    dw_plane_task_t t;
+
+    t.desc = desc;
+    t.input = input;
+    t.weights = weights;
+    t.bias = bias;
+    t.output = output;
+    t.output_h = conv_output_h(desc);
+    t.output_w = conv_output_w(desc);
+    t.multiplier = desc->output_channel / desc->input_channel;
+    t.row_kernel = dw_row_kernel(desc);
+    conv_interior_range(desc->input_w, t.output_w, desc->k_size, desc->stride, desc->padding, desc->dilation,
+                        &t.col_lo, &t.col_hi);
+    t.blocks = (t.col_hi - t.col_lo) / 4;
+    // stride=2 时 vld2q 读取8个元素，最后一组的最后一个奇数位置可能越过输入行，需留出余量
+    if (desc->stride == 2 && t.blocks > 0 &&
+        (t.col_lo + 4 * t.blocks - 1) * 2 - desc->padding + desc->k_size >= desc->input_w) {
+        t.blocks--;
+    }
+    conv_parallel_for(desc->batch * desc->output_channel, dw_plane_task, &t);
+    return CONV_OK;
+}
+
+// ---------------------------------------------------------------- NHWC / NC4HW4 / NC8HW8
+
+size_t conv_depthwise_weights_size(const conv_desc_t *desc)
+{
+    int cb = conv_layout_channel_block(desc->layout, desc->output_channel);
+    size_t blocks = (desc->output_channel + cb - 1) / cb;
+    return blocks * cb * desc->k_size * desc->k_size;
+}
+
+// [C][k*k] -> [通道块][抽头][cb]，补齐的通道为0
+void conv_depthwise_pack_weights(const conv_desc_t *desc, const float *weights, float *packed_weights)
+{
+    int cb = conv_layout_channel_block(desc->layout, desc->output_channel);
+    int taps = desc->k_size * desc->k_size;
+
+    memset(packed_weights, 0, conv_depthwise_weights_size(desc) * sizeof(float));
+    for (int c = 0; c < desc->output_channel; c++) {
+        float *dst = packed_weights + (size_t)(c / cb) * taps * cb + c % cb;
+        for (int tap = 0; tap < taps; tap++) {
+            dst[(size_t)tap * cb] = weights[(size_t)c * taps + tap];
+        }
+    }
+}
+
+typedef struct {
+    const float *input;
+    const float *packed_weights;
+    const float *bias;              // 补齐到 blocks * cb 的偏置
+    float *output;
+    const conv_epilogue_t *epilogue;   // 不需要激活和截断时为NULL
+    int channel, cb, blocks;
+    int vecs;                       // 每块的完整向量数，NHWC 通道数不是4的倍数时剩余的通道逐个计算
+    int input_h, input_w, output_h, output_w;
+    int k_size, stride, padding, dilation;
+    int col_lo, col_hi;
+} dw_channels_task_t;
+
+// 内部区域一行上 [col, col + 4) 的4个像素，kh 限于 [kh0, kh1)
+static void dw_channels_quad(const dw_channels_task_t *t, const float *input, const float *weights, const float *bias,
+                             float *output_row, int row, int col, int kh0, int kh1)
+{
+    int cb = t->cb;
+    int k_size = t->k_size;
+    size_t pixel_step = (size_t)t->stride * cb;
+    int ix0 = col * t->stride - t->padding;
+
+    for (int j = 0; j < t->vecs; j++) {
+        dw_vec_t acc0 = dw_load(bias + j * 4);
+        dw_vec_t acc1 = acc0, acc2 = acc0, acc3 = acc0;
+        for (int kh = kh0; kh < kh1; kh++) {
+            int iy = row * t->stride - t->padding + kh * t->dilation;
+            const float *input_row = input + (size_t)iy * t->input_w * cb + j * 4;
+            const float *w = weights + (size_t)kh * k_size * cb + j * 4;
+            for (int kw = 0; kw < k_size; kw++) {
+                const float *x = input_row + (size_t)(ix0 + kw * t->dilation) * cb;
+                dw_vec_t wv = dw_load(w + kw * cb);
+                acc0 = dw_fma(acc0, dw_load(x), wv);
+                acc1 = dw_fma(acc1, dw_load(x + pixel_step), wv);
+                acc2 = dw_fma(acc2, dw_load(x + 2 * pixel_step), wv);
+                acc3 = dw_fma(acc3, dw_load(x + 3 * pixel_step), wv);
+            }
+        }
+        float *out = output_row + (size_t)col * cb + j * 4;
+        dw_store(out, acc0);
+        dw_store(out + cb, acc1);
+        dw_store(out + 2 * cb, acc2);
+        dw_store(out + 3 * cb, acc3);
+    }
+    // NHWC 剩余的通道
+    for (int c = t->vecs * 4; c < cb; c++) {
+        for (int p = 0; p < 4; p++) {
+            float sum = bias[c];
+            for (int kh = kh0; kh < kh1; kh++) {
+                int iy = row * t->stride - t->padding + kh * t->dilation;
+                for (int kw = 0; kw < k_size; kw++) {
+                    int ix = ix0 + p * t->stride + kw * t->dilation;
+                    sum += input[((size_t)iy * t->input_w + ix) * cb + c] * weights[(size_t)(kh * k_size + kw) * cb + c];
+                }
+            }
+            output_row[(size_t)(col + p) * cb + c] = sum;
+        }
+    }
+}
+
+// 单个像素，卷积核窗口裁剪到输入范围内
+static void dw_channels_pixel(const dw_channels_task_t *t, const float *input, const float *weights,
+                              const float *bias, float *output_row, int row, int col, int kh0, int kh1)
+{
+    int cb = t->cb;
+    int k_size = t->k_size;
+    float *out = output_row + (size_t)col * cb;
+
+    for (int j = 0; j < t->vecs; j++) {
+        dw_store(out + j * 4, dw_load(bias + j * 4));
+    }
+    for (int c = t->vecs * 4; c < cb; c++) {
+        out[c] = bias[c];
+    }
+    for (int kh = kh0; kh < kh1; kh++) {
+        int iy = row * t->stride - t->padding + kh * t->dilation;
+        for (int kw = 0; kw < k_size; kw++) {
+            int ix = col * t->stride - t->padding + kw * t->dilation;
+            if (ix < 0 || ix >= t->input_w) {
+                continue;
+            }
+            const float *x = input + ((size_t)iy * t->input_w + ix) * cb;
+            const float *w = weights + (size_t)(kh * k_size + kw) * cb;
+            for (int j = 0; j < t->vecs; j++) {
+                dw_store(out + j * 4, dw_fma(dw_load(out + j * 4), dw_load(x + j * 4), dw_load(w + j * 4)));
+            }
+            for (int c = t->vecs * 4; c < cb; c++) {
+                out[c] += x[c] * w[c];
+            }
+        }
+    }
+}
+
+// 一个任务计算一个 (图像, 通道块, 输出行)
+static void dw_channels_row_task(void *ctx, int task, int thread_id)
+{
+    const dw_channels_task_t *t = (const dw_channels_task_t *)ctx;
+    int cb = t->cb;
+    int row = task % t->output_h;
+    int block = task / t->output_h % t->blocks;
+    int image = task / t->output_h / t->blocks;
+    size_t image_block = (size_t)image * t->blocks + block;
+    const float *input = t->input + image_block * t->input_h * t->input_w * cb;
+    const float *weights = t->packed_weights + (size_t)block * t->k_size * t->k_size * cb;
+    const float *bias = t->bias + (size_t)block * cb;
+    float *output_row = t->output + (image_block * t->output_h + row) * t->output_w * cb;
+
+    (void)thread_id;
+    // 落在输入行内的卷积核行 [kh0, kh1)
+    int iy0 = row * t->stride - t->padding;
+    int kh0 = iy0 >= 0 ? 0 : (-iy0 + t->dilation - 1) / t->dilation;
+    int kh1 = t->input_h - iy0 > 0 ? (t->input_h - iy0 + t->dilation - 1) / t->dilation : 0;
+    if (kh1 > t->k_size) {
+        kh1 = t->k_size;
+    }
+    if (kh1 < kh0) {
+        kh1 = kh0;
+    }
+
+    int col = 0;
+    for (; col < t->col_lo; col++) {
+        dw_channels_pixel(t, input, weights, bias, output_row, row, col, kh0, kh1);
+    }
+    for (; col + 4 <= t->col_hi; col += 4) {
+        dw_channels_quad(t, input, weights, bias, output_row, row, col, kh0, kh1);
+    }
+    for (; col < t->output_w; col++) {
+        dw_channels_pixel(t, input, weights, bias, output_row, row, col, kh0, kh1);
+    }
+
+    if (t->epilogue) {
+        conv_epilogue_apply(t->epilogue, 0.0f, output_row, (size_t)t->output_w * cb);
+        // 截断可能把补齐的通道变为非0，恢复为0
+        int valid = t->channel - block * cb;
+        if (t->epilogue->clamp && valid < cb) {
+            for (int c = 0; c < t->output_w; c++) {
+                memset(output_row + (size_t)c * cb + valid, 0, (cb - valid) * sizeof(float));
+            }
+        }
+    }
+}
+
+// 偏置补齐到整数个通道块
+static size_t dw_channels_bias_size(const conv_desc_t *desc)
+{
+    int cb = conv_layout_channel_block(desc->layout, desc->output_channel);
+    return (size_t)(desc->output_channel + cb - 1) / cb * cb * sizeof(float);
+}
+
+size_t conv_depthwise_channels_workspace_size(const conv_desc_t *desc)
+{
+    return conv_ws_bytes(dw_channels_bias_size(desc));
+}
+
+int conv_run_depthwise_channels(const conv_desc_t *desc, const float *input, const float *packed_weights,
+                                const float *bias, float *output, conv_workspace_t *ws)
+{
+    dw_channels_task_t t;
+
+    t.cb = conv_layout_channel_block(desc->layout, desc->output_channel);
+    t.blocks = (desc->output_channel + t.cb - 1) / t.cb;
+    // 补齐的通道为0
+    float *bias_padded = (float *)conv_ws_alloc(ws, dw_channels_bias_size(desc));
+    if (!bias_padded) {
+        return CONV_ERR_NOMEM;
+    }
+    memset(bias_padded, 0, dw_channels_bias_size(desc));
+    if (bias) {
+        memcpy(bias_padded, bias, desc->output_channel * sizeof(float));
+    }
+
+    t.input = input;
+    t.packed_weights = packed_weights;
+    t.bias = bias_padded;
+    t.output = output;
+    t.epilogue = conv_epilogue_active(&desc->epilogue) ? &desc->epilogue : NULL;
+    t.channel = desc->output_channel;
+    t.vecs = t.cb / 4;
+    t.input_h = desc->input_h;
+    t.input_w = desc->input_w;
+    t.output_h = conv_output_h(desc);
+    t.output_w = conv_output_w(desc);
+    t.k_size = desc->k_size;
+    t.stride = desc->stride;
+    t.padding = desc->padding;
+    t.dilation = desc->dilation;
+    conv_interior_range(desc->input_w, t.output_w, desc->k_size, desc->stride, desc->padding, desc->dilation,
+                        &t.col_lo, &t.col_hi);
+
+    conv_parallel_for(desc->batch * t.blocks * t.output_h, dw_channels_row_task, &t);
+    conv_ws_free(ws, bias_padded);
+    return CONV_OK;
+}
@@ -0,0 +1,348 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conv_internal.h"
+#include "cpu_dispatch.h"
+#include "thread_pool.h"
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#elif CONV_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+// 附加实验：空洞卷积 (移植自 set3)
+//
+// set3 的 dilated_convolution_2d_asm 每个输出像素一个asm块：每个抽头4次比较、2次分支、一次整数乘法算地址，
+// 并且每个像素都重新加载9个卷积核值。这里按内部/边界拆分输出平面：
+//   内部区域：所有抽头都在输入内，无需检查，一次计算多个相邻输出
+//     - ARM64、3x3、stride=1：整个内部区域在一个asm块内完成，卷积核常驻 v0-v2，每次迭代8个输出
+//     - ARM64、stride=1/2：NEON按4个输出一组计算，stride=2 用 vld2q 解交织读取
+//     - x86-64、stride=1：运行时检测到AVX2和FMA时按8个输出一组计算（见 cpu_dispatch.h）
+//     - 其余：逐点计算，无越界检查
+//   边界带：每个像素先把卷积核窗口裁剪到输入范围内，再按普通循环累加
+
+typedef struct {
+    const float *input;
+    int input_h, input_w;
+    const float *kernel;
+    int kernel_h, kernel_w;
+    float *output;
+    int output_h, output_w;
+    int dilation, stride, padding;
+} dilated_plane_t;
+
+// 抽头下标 k 满足 0 <= start + k * dilation < size 的范围 [k0, k1)
+static void clip_taps(int start, int size, int k_size, int dilation, int *k0, int *k1)
+{
+    *k0 = start < 0 ? (-start + dilation - 1) / dilation : 0;
+    *k1 = size - start > 0 ? (size - start + dilation - 1) / dilation : 0;
+    if (*k1 > k_size) {
+        *k1 = k_size;
+    }
+}
+
+// 边界像素：第 oh 行的 [ow0, ow1) 列
+static void dilated_border(const dilated_plane_t *p, int oh, int ow0, int ow1)
+{
+    int d = p->dilation;
+    int ih_start = oh * p->stride - p->padding;
+    int kh0, kh1;
+
+    clip_taps(ih_start, p->input_h, p->kernel_h, d, &kh0, &kh1);
+    for (int ow = ow0; ow < ow1; ow++) {
+        int iw_start = ow * p->stride - p->padding;
+        int kw0, kw1;
+        float sum = 0.0f;
+
+        clip_taps(iw_start, p->input_w, p->kernel_w, d, &kw0, &kw1);
+        for (int kh = kh0; kh < kh1; kh++) {
+            const float *input_row = p->input + (size_t)(ih_start + kh * d) * p->input_w + iw_start;
+            for (int kw = kw0; kw < kw1; kw++) {
+                sum += input_row[kw * d] * p->kernel[kh * p->kernel_w + kw];
+            }
+        }
+        p->output[(size_t)oh * p->output_w + ow] += sum;
+    }
+}
+
+// 内部像素逐点计算：第 oh 行的 [ow0, ow1) 列
+static void dilated_interior_scalar(const dilated_plane_t *p, int oh, int ow0, int ow1)
+{
+    int d = p->dilation;
+    const float *input_base = p->input + (size_t)(oh * p->stride - p->padding) * p->input_w - p->padding;
+
+    for (int ow = ow0; ow < ow1; ow++) {
+        const float *input_ptr = input_base + ow * p->stride;
+        float sum = 0.0f;
+        for (int kh = 0; kh < p->kernel_h; kh++) {
+            for (int kw = 0; kw < p->kernel_w; kw++) {
+                sum += input_ptr[(size_t)kh * d * p->input_w + kw * d] * p->kernel[kh * p->kernel_w + kw];
+            }
+        }
+        p->output[(size_t)oh * p->output_w + ow] += sum;
+    }
+}
+
+#if defined(__aarch64__)
+// 3x3、stride=1 的内部区域：rows 行，每行 blocks 组8个输出
+// input 指向第一个输出的左上角抽头，output 指向第一个输出
+static void dilated_interior_3x3_s1(const dilated_plane_t *p, const float *input, float *output,
+                                    long rows, long blocks)
+{
+    long input_row = (long)p->input_w * sizeof(float);
+    long output_row = (long)p->output_w * sizeof(float);
+    long tap = (long)p->dilation * sizeof(float);
+    long tap_row = (long)p->dilation * input_row;
+
+    __asm__ __volatile__(
+        // 卷积核常驻：v0 = k0..k3, v1 = k4..k7, v2.s[0] = k8
+        "ld1 {v0.4s, v1.4s}, [%[kernel]]           \n\t"
+        "ldr s2, [%[kernel], #32]                  \n\t"
+        "1:                                        \n\t"    // 行循环
+        "mov x9, %[input]                          \n\t"
+        "mov x10, %[output]                        \n\t"
+        "mov x11, %[blocks]                        \n\t"
+        "2:                                        \n\t"    // 每次8个输出
+        "ld1 {v16.4s, v17.4s}, [x10]               \n\t"    // 累加到已有输出上
+        "add x13, x9, %[tap]                       \n\t"
+        "add x14, x13, %[tap]                      \n\t"
+        "ld1 {v18.4s, v19.4s}, [x9]                \n\t"    // 第0行的3个抽头
+        "ld1 {v20.4s, v21.4s}, [x13]               \n\t"
+        "ld1 {v22.4s, v23.4s}, [x14]               \n\t"
+        "fmla v16.4s, v18.4s, v0.s[0]              \n\t"
+        "fmla v17.4s, v19.4s, v0.s[0]              \n\t"
+        "fmla v16.4s, v20.4s, v0.s[1]              \n\t"
+        "fmla v17.4s, v21.4s, v0.s[1]              \n\t"
+        "fmla v16.4s, v22.4s, v0.s[2]              \n\t"
+        "fmla v17.4s, v23.4s, v0.s[2]              \n\t"
+        "add x12, x9, %[tap_row]                   \n\t"    // 第1行
+        "add x13, x12, %[tap]                      \n\t"
+        "add x14, x13, %[tap]                      \n\t"
+        "ld1 {v24.4s, v25.4s}, [x12]               \n\t"
+        "ld1 {v26.4s, v27.4s}, [x13]               \n\t"
+        "ld1 {v28.4s, v29.4s}, [x14]               \n\t"
+        "fmla v16.4s, v24.4s, v0.s[3]              \n\t"
+        "fmla v17.4s, v25.4s, v0.s[3]              \n\t"
+        "fmla v16.4s, v26.4s, v1.s[0]              \n\t"
+        "fmla v17.4s, v27.4s, v1.s[0]              \n\t"
+        "fmla v16.4s, v28.4s, v1.s[1]              \n\t"
+        "fmla v17.4s, v29.4s, v1.s[1]              \n\t"
+        "add x12, x12, %[tap_row]                  \n\t"    // 第2行
+        "add x13, x12, %[tap]                      \n\t"
+        "add x14, x13, %[tap]                      \n\t"
+        "ld1 {v18.4s, v19.4s}, [x12]               \n\t"
+        "ld1 {v20.4s, v21.4s}, [x13]               \n\t"
+        "ld1 {v22.4s, v23.4s}, [x14]               \n\t"
+        "fmla v16.4s, v18.4s, v1.s[2]              \n\t"
+        "fmla v17.4s, v19.4s, v1.s[2]              \n\t"
+        "fmla v16.4s, v20.4s, v1.s[3]              \n\t"
+        "fmla v17.4s, v21.4s, v1.s[3]              \n\t"
+        "fmla v16.4s, v22.4s, v2.s[0]              \n\t"
+        "fmla v17.4s, v23.4s, v2.s[0]              \n\t"
+        "st1 {v16.4s, v17.4s}, [x10], #32          \n\t"
+        "add x9, x9, #32                           \n\t"
+        "subs x11, x11, #1                         \n\t"
+        "b.ne 2b                                   \n\t"
+        "add %[input], %[input], %[input_row]      \n\t"    // 下一行
+        "add %[output], %[output], %[output_row]   \n\t"
+        "subs %[rows], %[rows], #1                 \n\t"
+        "b.ne 1b                                   \n\t"
+        : [input] "+r"(input),
+          [output] "+r"(output),
+          [rows] "+r"(rows)
+        : [blocks] "r"(blocks),
+          [kernel] "r"(p->kernel),
+          [tap] "r"(tap),
+          [tap_row] "r"(tap_row),
+          [input_row] "r"(input_row),
+          [output_row] "r"(output_row)
+        : "cc", "memory", "x9", "x10", "x11", "x12", "x13", "x14",
+          "v0", "v1", "v2", "v16", "v17", "v18", "v19", "v20", "v21", "v22", "v23",
+          "v24", "v25", "v26", "v27", "v28", "v29"
+    );
+}
+
+// stride=1/2、任意卷积核的内部像素：第 oh 行从 ow0 开始的 blocks 组4个输出
+// stride=2 时用 vld2q 解交织，偶数位置恰好是相邻4个输出对应的输入
+static void dilated_interior_neon(const dilated_plane_t *p, int oh, int ow0, int blocks)
+{
+    int d = p->dilation;
+    const float *input_base = p->input + (size_t)(oh * p->stride - p->padding) * p->input_w - p->padding;
+    float *output_ptr = p->output + (size_t)oh * p->output_w + ow0;
+
+    for (int b = 0; b < blocks; b++) {
+        const float *input_ptr = input_base + (size_t)(ow0 + 4 * b) * p->stride;
+        float32x4_t acc = vld1q_f32(output_ptr + 4 * b);
+        for (int kh = 0; kh < p->kernel_h; kh++) {
+            const float *input_row = input_ptr + (size_t)kh * d * p->input_w;
+            const float *kernel_row = p->kernel + kh * p->kernel_w;
+            for (int kw = 0; kw < p->kernel_w; kw++) {
+                float32x4_t x = p->stride == 1 ? vld1q_f32(input_row + kw * d) : vld2q_f32(input_row + kw * d).val[0];
+                acc = vfmaq_n_f32(acc, x, kernel_row[kw]);
+            }
+        }
+        vst1q_f32(output_ptr + 4 * b, acc);
+    }
+}
+#endif
+
+#if defined(__aarch64__)
+const dilated_s1_kernel_t dilated_s1_default = { "neon", 0, NULL };
+#else
+const dilated_s1_kernel_t dilated_s1_default = { "c", 0, NULL };
+#endif
+
+#if CONV_X86_DISPATCH
+// stride=1、任意卷积核的内部像素：blocks 组8个输出
+__attribute__((target("avx2,fma")))
+static void dilated_s1_avx2_run(const float *input, int input_w, const float *kernel, int kernel_h, int kernel_w,
+                                int dilation, float *output, int blocks)
+{
+    for (int b = 0; b < blocks; b++) {
+        const float *input_ptr = input + 8 * b;
+        __m256 acc = _mm256_loadu_ps(output + 8 * b);
+        for (int kh = 0; kh < kernel_h; kh++) {
+            const float *input_row = input_ptr + (size_t)kh * dilation * input_w;
+            const float *kernel_row = kernel + kh * kernel_w;
+            for (int kw = 0; kw < kernel_w; kw++) {
+                acc = _mm256_fmadd_ps(_mm256_loadu_ps(input_row + kw * dilation), _mm256_broadcast_ss(kernel_row + kw), acc);
+            }
+        }
+        _mm256_storeu_ps(output + 8 * b, acc);
+    }
+}
+
+const dilated_s1_kernel_t dilated_s1_avx2 = { "avx2", 8, dilated_s1_avx2_run };
+#endif
+
+// 单平面空洞卷积，结果累加到 output 上（多通道时逐个输入通道累加）
+void dilated_convolution_2d_acc(const float *input, int input_h, int input_w,
+                                const float *kernel, int kernel_h, int kernel_w,
+                                float *output, int output_h, int output_w,
+                                int dilation, int stride, int padding)
+{
+    dilated_plane_t p;
+    int oh_lo, oh_hi, ow_lo, ow_hi;
+
+    p.input = input;
+    p.input_h = input_h;
+    p.input_w = input_w;
+    p.kernel = kernel;
+    p.kernel_h = kernel_h;
+    p.kernel_w = kernel_w;
+    p.output = output;
+    p.output_h = output_h;
+    p.output_w = output_w;
+    p.dilation = dilation;
+    p.stride = stride;
+    p.padding = padding;
+
+    conv_interior_range(input_h, output_h, kernel_h, stride, padding, dilation, &oh_lo, &oh_hi);
+    conv_interior_range(input_w, output_w, kernel_w, stride, padding, dilation, &ow_lo, &ow_hi);
+
+    // 上下边界带
+    for (int oh = 0; oh < oh_lo; oh++) {
+        dilated_border(&p, oh, 0, output_w);
+    }
+    for (int oh = oh_hi; oh < output_h; oh++) {
+        dilated_border(&p, oh, 0, output_w);
+    }
+
+    // 内部区域的快速路径覆盖 [ow_lo, ow_fast)，剩余的列逐点计算
+    // 调度表中有运行时选择的内核时优先使用，否则使用编译期选择的实现
+    const dilated_s1_kernel_t *fast = conv_dispatch()->dilated;
+    int ow_fast = ow_lo;
+    if (fast->run && stride == 1) {
+        int blocks = (ow_hi - ow_lo) / fast->width;
+        for (int oh = oh_lo; oh < oh_hi && blocks > 0; oh++) {
+            fast->run(input + (size_t)(oh - padding) * input_w + (ow_lo - padding), input_w, kernel, kernel_h, kernel_w,
+                      dilation, output + (size_t)oh * output_w + ow_lo, blocks);
+        }
+        ow_fast = ow_lo + fast->width * blocks;
+    }
+#if defined(__aarch64__)
+    else if (kernel_h == 3 && kernel_w == 3 && stride == 1) {
+        long blocks = (ow_hi - ow_lo) / 8;
+        if (blocks > 0 && oh_hi > oh_lo) {
+            dilated_interior_3x3_s1(&p, input + (size_t)(oh_lo - padding) * input_w + (ow_lo - padding),
+                                    output + (size_t)oh_lo * output_w + ow_lo, oh_hi - oh_lo, blocks);
+            ow_fast = ow_lo + 8 * (int)blocks;
+        }
+    } else if (stride <= 2) {
+        int blocks = (ow_hi - ow_lo) / 4;
+        // stride=2 时 vld2q 读取8个元素，最后一组的奇数位置可能越过内部区域，需留出余量
+        if (stride == 2 && blocks > 0 && (ow_lo + 4 * blocks - 1) * 2 - padding + (kernel_w - 1) * dilation + 1 >= input_w) {
+            blocks--;
+        }
+        for (int oh = oh_lo; oh < oh_hi && blocks > 0; oh++) {
+            dilated_interior_neon(&p, oh, ow_lo, blocks);
+        }
+        ow_fast = ow_lo + 4 * (blocks > 0 ? blocks : 0);
+    }
+#endif
+
+    // 内部行：左右边界带和快速路径剩下的列
+    for (int oh = oh_lo; oh < oh_hi; oh++) {
+        dilated_border(&p, oh, 0, ow_lo);
+        dilated_interior_scalar(&p, oh, ow_fast, ow_hi);
+        dilated_border(&p, oh, ow_hi, output_w);
+    }
+}
+
+// 多通道：output[n][oc] = bias[oc] + sum_ic conv(input[n][ic], weights[oc][ic])
+// 每个 (图像, 输出通道) 一个任务，输出平面互不重叠，按任务并行；平面算完后在同一任务内做激活和截断
+typedef struct {
+    const conv_desc_t *desc;
+    const float *input;
+    const float *weights;
+    const float *bias;
+    float *output;
+    int output_h, output_w;
+} dilated_task_t;
+
+static void dilated_channel_task(void *ctx, int task, int thread_id)
+{
+    const dilated_task_t *t = (const dilated_task_t *)ctx;
+    const conv_desc_t *desc = t->desc;
+    int n = task / desc->output_channel;
+    int oc = task % desc->output_channel;
+    int k_size = desc->k_size;
+    size_t input_plane = (size_t)desc->input_h * desc->input_w;
+    size_t output_plane = (size_t)t->output_h * t->output_w;
+    const float *input_n = t->input + (size_t)n * desc->input_channel * input_plane;
+    float *output_ptr = t->output + (size_t)task * output_plane;
+    float b = t->bias ? t->bias[oc] : 0.0f;
+
+    (void)thread_id;
+    for (size_t i = 0; i < output_plane; i++) {
+        output_ptr[i] = b;
+    }
+    for (int ic = 0; ic < desc->input_channel; ic++) {
+        dilated_convolution_2d_acc(input_n + ic * input_plane, desc->input_h, desc->input_w,
+                                   t->weights + ((size_t)oc * desc->input_channel + ic) * k_size * k_size,
+                                   k_size, k_size,
+                                   output_ptr, t->output_h, t->output_w,
+                                   desc->dilation, desc->stride, desc->padding);
+    }
+    if (conv_epilogue_active(&desc->epilogue)) {
+        conv_epilogue_apply(&desc->epilogue, 0.0f, output_ptr, output_plane);
+    }
+}
+
+int conv_run_dilated(const conv_desc_t *desc, const float *input, const float *weights,
+                     const float *bias, float *output)
+{
+    dilated_task_t t;
+
+    t.desc = desc;
+    t.input = input;
+    t.weights = weights;
+    t.bias = bias;
+    t.output = output;
+    t.output_h = conv_output_h(desc);
+    t.output_w = conv_output_w(desc);
+    conv_parallel_for(desc->batch * desc->output_channel, dilated_channel_task, &t);
+    return CONV_OK;
+}
@@ -0,0 +1,690 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conv_internal.h"
+#include "cpu_dispatch.h"
+#include "thread_pool.h"
+
+#ifdef __aarch64__
+#include <arm_neon.h>
+#endif
+
+// 思路一：直接卷积 (移植自 set1)
+
+// 卷积形状，供边界像素计算使用
+typedef struct {
+    int output_channel, input_channel;
+    int k_size;
+    int output_h, output_w;
+    int input_h, input_w;
+    int stride, padding;
+    const float *packed_weights;   // 重排的权重：SVE内核见 direct_3x3_pack_weights，寄存器分块见 direct_tile_pack_weights
+    const conv_epilogue_t *epilogue;   // 偏置之后的激活和截断，不需要时为NULL
+} direct_shape_t;
+
+// 边界像素 [col0, col1)：先把卷积核窗口裁剪到输入范围内再累加，不做逐抽头的越界检查
+// 补零的部分对结果没有贡献，直接跳过
+static void direct_border_pixels(const direct_shape_t *s, const float *input_feature, const float *weights,
+                                 const float *bias, float *output_feature, int row, int col0, int col1)
+{
+    int k_size = s->k_size;
+    int iy0 = row * s->stride - s->padding;
+    int kr0 = iy0 < 0 ? -iy0 : 0;
+    int kr1 = s->input_h - iy0 < k_size ? s->input_h - iy0 : k_size;
+
+    for (int col = col0; col < col1; col++) {
+        int ix0 = col * s->stride - s->padding;
+        int kc0 = ix0 < 0 ? -ix0 : 0;
+        int kc1 = s->input_w - ix0 < k_size ? s->input_w - ix0 : k_size;
+
+        for (int output_filter = 0; output_filter < s->output_channel; output_filter++) {
+            float temp = 0.0f;
+            for (int input_filter = 0; input_filter < s->input_channel; input_filter++) {
+                const float *input_ptr = input_feature + (size_t)input_filter * s->input_h * s->input_w;
+                const float *weight_ptr = weights + ((size_t)output_filter * s->input_channel + input_filter) * k_size * k_size;
+                for (int kernel_row = kr0; kernel_row < kr1; kernel_row++) {
+                    for (int kernel_col = kc0; kernel_col < kc1; kernel_col++) {
+                        temp += input_ptr[(iy0 + kernel_row) * s->input_w + (ix0 + kernel_col)] *
+                                weight_ptr[kernel_row * k_size + kernel_col];
+                    }
+                }
+            }
+            output_feature[(size_t)output_filter * s->output_h * s->output_w + row * s->output_w + col] =
+                temp + (bias ? bias[output_filter] : 0.0f);
+        }
+    }
+}
+
+// 输出的一行：整行都在边界带内时全部走边界路径，否则左右两端走边界路径，
+// 中间的内部区域 [col_lo, col_hi) 交给 interior 计算（所有抽头都在输入内，无需检查）；
+// 该行的所有输出通道算完后，趁这些行还在缓存中做激活和截断（偏置已在计算时加上）
+typedef void (*direct_interior_fn)(const direct_shape_t *s, const float *input_feature, const float *weights,
+                                   const float *bias, float *output_feature, int row, int col0, int col1);
+
+static void direct_run_row(const direct_shape_t *s, const float *input_feature, const float *weights,
+                           const float *bias, float *output_feature, direct_interior_fn interior, int row)
+{
+    int row_lo, row_hi, col_lo, col_hi;
+
+    conv_interior_range(s->input_h, s->output_h, s->k_size, s->stride, s->padding, 1, &row_lo, &row_hi);
+    conv_interior_range(s->input_w, s->output_w, s->k_size, s->stride, s->padding, 1, &col_lo, &col_hi);
+
+    if (row < row_lo || row >= row_hi) {
+        direct_border_pixels(s, input_feature, weights, bias, output_feature, row, 0, s->output_w);
+    } else {
+        direct_border_pixels(s, input_feature, weights, bias, output_feature, row, 0, col_lo);
+        interior(s, input_feature, weights, bias, output_feature, row, col_lo, col_hi);
+        direct_border_pixels(s, input_feature, weights, bias, output_feature, row, col_hi, s->output_w);
+    }
+    if (s->epilogue) {
+        for (int oc = 0; oc < s->output_channel; oc++) {
+            conv_epilogue_apply(s->epilogue, 0.0f, output_feature + ((size_t)oc * s->output_h + row) * s->output_w,
+                                s->output_w);
+        }
+    }
+}
+
+#if defined(__aarch64__)
+const direct_3x3_kernel_t direct_3x3_default = { "neon", NULL };
+#else
+const direct_3x3_kernel_t direct_3x3_default = { "c", NULL };
+#endif
+
+#if CONV_SVE_DISPATCH
+// SVE：一次计算 4个输出通道 x VL列，列的尾部用 whilelt 谓词处理，不需要标量的剩余循环
+// z16-z24: 9个抽头的输入向量，z0-z7: 每个抽头4个输出通道的权重（ld1rqw 复制到每个128位段，按下标 fmla；
+// 按下标的 fmla 只能使用 z0-z7，第9个抽头复用 z0），z28-z31: 累加器
+static void direct_3x3_sve_row(const float *input, long input_w, long input_plane, const float *packed_weights,
+                               long input_channel, const float *bias4, float *output, long output_plane,
+                               long oc_count, long cols)
+{
+    __asm__ __volatile__(
+        ".arch_extension sve                         \n\t"
+        "ptrue p1.s                                  \n\t"
+        "mov x10, #1                                 \n\t"    // x10 / x11: 第1、2列抽头的元素偏移
+        "mov x11, #2                                 \n\t"
+        "lsl x12, %[input_w], #2                     \n\t"    // x12: 输入行步长（字节）
+        "lsl x13, %[input_plane], #2                 \n\t"    // x13: 输入通道步长（字节）
+        "lsl x14, %[output_plane], #2                \n\t"    // x14: 输出通道步长（字节）
+        "mov x15, %[input]                           \n\t"    // x15 / x3: 当前列块的输入、输出
+        "mov x3, %[output]                           \n\t"
+        "mov x2, #0                                  \n\t"    // x2: 列号
+        "1:                                          \n\t"    // 列循环，每次VL列
+        "whilelt p0.s, x2, %[cols]                   \n\t"    // p0: 本次的有效列
+        "b.none 4f                                   \n\t"
+        "ld1rw {z28.s}, p1/z, [%[bias]]              \n\t"    // z28-z31: 4个输出通道的累加器，初值为偏置
+        "ld1rw {z29.s}, p1/z, [%[bias], #4]          \n\t"
+        "ld1rw {z30.s}, p1/z, [%[bias], #8]          \n\t"
+        "ld1rw {z31.s}, p1/z, [%[bias], #12]         \n\t"
+        "mov x4, x15                                 \n\t"
+        "mov x5, %[weights]                          \n\t"
+        "mov x6, %[input_channel]                    \n\t"
+        "2:                                          \n\t"    // 输入通道循环
+        "add x8, x4, x12                             \n\t"
+        "add x9, x8, x12                             \n\t"
+        "ld1w {z16.s}, p0/z, [x4]                    \n\t"    // 第0行的3个抽头
+        "ld1w {z17.s}, p0/z, [x4, x10, lsl #2]       \n\t"
+        "ld1w {z18.s}, p0/z, [x4, x11, lsl #2]       \n\t"
+        "ld1w {z19.s}, p0/z, [x8]                    \n\t"    // 第1行的3个抽头
+        "ld1w {z20.s}, p0/z, [x8, x10, lsl #2]       \n\t"
+        "ld1w {z21.s}, p0/z, [x8, x11, lsl #2]       \n\t"
+        "ld1w {z22.s}, p0/z, [x9]                    \n\t"    // 第2行的3个抽头
+        "ld1w {z23.s}, p0/z, [x9, x10, lsl #2]       \n\t"
+        "ld1w {z24.s}, p0/z, [x9, x11, lsl #2]       \n\t"
+        "ld1rqw {z0.s}, p1/z, [x5]                   \n\t"    // 抽头0-7各4个输出通道的权重
+        "ld1rqw {z1.s}, p1/z, [x5, #16]              \n\t"
+        "ld1rqw {z2.s}, p1/z, [x5, #32]              \n\t"
+        "ld1rqw {z3.s}, p1/z, [x5, #48]              \n\t"
+        "ld1rqw {z4.s}, p1/z, [x5, #64]              \n\t"
+        "ld1rqw {z5.s}, p1/z, [x5, #80]              \n\t"
+        "ld1rqw {z6.s}, p1/z, [x5, #96]              \n\t"
+        "ld1rqw {z7.s}, p1/z, [x5, #112]             \n\t"
+        "fmla z28.s, z16.s, z0.s[0]                  \n\t"    // 抽头0
+        "fmla z29.s, z16.s, z0.s[1]                  \n\t"
+        "fmla z30.s, z16.s, z0.s[2]                  \n\t"
+        "fmla z31.s, z16.s, z0.s[3]                  \n\t"
+        "fmla z28.s, z17.s, z1.s[0]                  \n\t"    // 抽头1
+        "fmla z29.s, z17.s, z1.s[1]                  \n\t"
+        "fmla z30.s, z17.s, z1.s[2]                  \n\t"
+        "fmla z31.s, z17.s, z1.s[3]                  \n\t"
+        "fmla z28.s, z18.s, z2.s[0]                  \n\t"    // 抽头2
+        "fmla z29.s, z18.s, z2.s[1]                  \n\t"
+        "fmla z30.s, z18.s, z2.s[2]                  \n\t"
+        "fmla z31.s, z18.s, z2.s[3]                  \n\t"
+        "fmla z28.s, z19.s, z3.s[0]                  \n\t"    // 抽头3
+        "fmla z29.s, z19.s, z3.s[1]                  \n\t"
+        "fmla z30.s, z19.s, z3.s[2]                  \n\t"
+        "fmla z31.s, z19.s, z3.s[3]                  \n\t"
+        "fmla z28.s, z20.s, z4.s[0]                  \n\t"    // 抽头4
+        "fmla z29.s, z20.s, z4.s[1]                  \n\t"
+        "fmla z30.s, z20.s, z4.s[2]                  \n\t"
+        "fmla z31.s, z20.s, z4.s[3]                  \n\t"
+        "fmla z28.s, z21.s, z5.s[0]                  \n\t"    // 抽头5
+        "fmla z29.s, z21.s, z5.s[1]                  \n\t"
+        "fmla z30.s, z21.s, z5.s[2]                  \n\t"
+        "fmla z31.s, z21.s, z5.s[3]                  \n\t"
+        "fmla z28.s, z22.s, z6.s[0]                  \n\t"    // 抽头6
+        "fmla z29.s, z22.s, z6.s[1]                  \n\t"
+        "fmla z30.s, z22.s, z6.s[2]                  \n\t"
+        "fmla z31.s, z22.s, z6.s[3]                  \n\t"
+        "fmla z28.s, z23.s, z7.s[0]                  \n\t"    // 抽头7
+        "fmla z29.s, z23.s, z7.s[1]                  \n\t"
+        "fmla z30.s, z23.s, z7.s[2]                  \n\t"
+        "fmla z31.s, z23.s, z7.s[3]                  \n\t"
+        "add x5, x5, #128                            \n\t"
+        "ld1rqw {z0.s}, p1/z, [x5]                   \n\t"    // 抽头8的权重，z0 已用完
+        "add x5, x5, #16                             \n\t"
+        "fmla z28.s, z24.s, z0.s[0]                  \n\t"    // 抽头8
+        "fmla z29.s, z24.s, z0.s[1]                  \n\t"
+        "fmla z30.s, z24.s, z0.s[2]                  \n\t"
+        "fmla z31.s, z24.s, z0.s[3]                  \n\t"
+        "add x4, x4, x13                             \n\t"
+        "subs x6, x6, #1                             \n\t"
+        "b.ne 2b                                     \n\t"
+        "st1w {z28.s}, p0, [x3]                      \n\t"    // 只写回前 oc_count 个输出通道
+        "cmp %[oc_count], #1                         \n\t"
+        "b.le 3f                                     \n\t"
+        "add x7, x3, x14                             \n\t"
+        "st1w {z29.s}, p0, [x7]                      \n\t"
+        "cmp %[oc_count], #2                         \n\t"
+        "b.le 3f                                     \n\t"
+        "add x7, x7, x14                             \n\t"
+        "st1w {z30.s}, p0, [x7]                      \n\t"
+        "cmp %[oc_count], #3                         \n\t"
+        "b.le 3f                                     \n\t"
+        "add x7, x7, x14                             \n\t"
+        "st1w {z31.s}, p0, [x7]                      \n\t"
+        "3:                                          \n\t"
+        "incw x2                                     \n\t"
+        "addvl x15, x15, #1                          \n\t"
+        "addvl x3, x3, #1                            \n\t"
+        "b 1b                                        \n\t"
+        "4:                                          \n\t"
+
+        :
+        : [input] "r"(input),
+          [input_w] "r"(input_w),
+          [input_plane] "r"(input_plane),
+          [weights] "r"(packed_weights),
+          [input_channel] "r"(input_channel),
+          [bias] "r"(bias4),
+          [output] "r"(output),
+          [output_plane] "r"(output_plane),
+          [oc_count] "r"(oc_count),
+          [cols] "r"(cols)
+        : "cc", "memory", "x2", "x3", "x4", "x5", "x6", "x7", "x8", "x9", "x10", "x11", "x12", "x13", "x14", "x15",
+          "p0", "p1",
+          "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7", "v16", "v17", "v18", "v19", "v20", "v21", "v22",
+          "v23", "v24", "v28", "v29", "v30", "v31"
+    );
+}
+
+const direct_3x3_kernel_t direct_3x3_sve = { "sve", direct_3x3_sve_row };
+#endif
+
+// 向量内核的权重：每4个输出通道一组，组内按 [输入通道][抽头][4] 排列，不足4个通道时补零；
+// 预打包句柄在 conv_prepare 时重排一次（见 conv_direct_prepack_weights）
+static size_t direct_3x3_packed_size(int output_channel, int input_channel)
+{
+    return (size_t)(output_channel + 3) / 4 * input_channel * 36;
+}
+
+static void direct_3x3_pack_weights(const float *weights, int output_channel, int input_channel, float *packed)
+{
+    memset(packed, 0, direct_3x3_packed_size(output_channel, input_channel) * sizeof(float));
+    for (int oc = 0; oc < output_channel; oc++) {
+        float *group = packed + (size_t)(oc / 4) * input_channel * 36;
+        for (int ic = 0; ic < input_channel; ic++) {
+            for (int tap = 0; tap < 9; tap++) {
+                group[(ic * 9 + tap) * 4 + oc % 4] = weights[((size_t)oc * input_channel + ic) * 9 + tap];
+            }
+        }
+    }
+}
+
+// stride=1 的内部像素交给调度表中的向量内核，每次4个输出通道
+static void direct_3x3_interior_vector(const direct_shape_t *s, const float *input_feature, const float *weights,
+                                       const float *bias, float *output_feature, int row, int col0, int col1)
+{
+    direct_3x3_row_fn run = conv_dispatch()->direct_3x3->run;
+    long output_plane = (long)s->output_h * s->output_w;
+    const float *input_ptr = input_feature + (size_t)(row - s->padding) * s->input_w + (col0 - s->padding);
+
+    (void)weights;
+    if (col1 <= col0) {
+        return;
+    }
+    for (int oc = 0; oc < s->output_channel; oc += 4) {
+        int oc_count = s->output_channel - oc < 4 ? s->output_channel - oc : 4;
+        float bias4[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (int i = 0; i < oc_count && bias; i++) {
+            bias4[i] = bias[oc + i];
+        }
+        run(input_ptr, s->input_w, (long)s->input_h * s->input_w, s->packed_weights + (size_t)oc / 4 * s->input_channel * 36,
+            s->input_channel, bias4, output_feature + (size_t)oc * output_plane + (size_t)row * s->output_w + col0,
+            output_plane, oc_count, col1 - col0);
+    }
+}
+
+// 寄存器分块的直接卷积（任意卷积核尺寸和步长），只处理内部像素
+//
+// 一个寄存器块为同一输出行上 DIRECT_TILE_OC 个输出通道 x DIRECT_TILE_PX 个像素，
+// 8 x 8 的累加器常驻16个向量寄存器：每个抽头读入8个像素的输入（2个向量）和8个输出通道的权重（2个向量），
+// 用 FMLA（按元素）做 8 x 2 次向量乘加，输入行在一个寄存器块内只读一遍，累加器直到写回都不离开寄存器，
+// 没有水平归约。抽头逐个展开，卷积核尺寸不必是4的倍数。
+// 权重整理为 [oc块][输入通道][kh][kw][8]，不足8个的输出通道补零，只写回有效的通道。
+// 行尾不足8个像素时先按4个像素一块，最后逐像素以输出通道为向量计算。
+#ifdef __aarch64__
+typedef float32x4_t direct_vec_t;
+#else
+typedef float direct_vec_t __attribute__((vector_size(16)));
+#endif
+
+#define DIRECT_TILE_OC 8   // 寄存器块的输出通道数
+#define DIRECT_TILE_PX 8   // 寄存器块的像素数
+
+static inline direct_vec_t direct_load(const float *p)
+{
+#ifdef __aarch64__
+    return vld1q_f32(p);
+#else
+    direct_vec_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+#endif
+}
+
+static inline void direct_store(float *p, direct_vec_t v)
+{
+#ifdef __aarch64__
+    vst1q_f32(p, v);
+#else
+    memcpy(p, &v, sizeof(v));
+#endif
+}
+
+static inline direct_vec_t direct_splat(float x)
+{
+#ifdef __aarch64__
+    return vdupq_n_f32(x);
+#else
+    direct_vec_t v = {x, x, x, x};
+    return v;
+#endif
+}
+
+// acc + x * w（逐元素）
+static inline direct_vec_t direct_fma(direct_vec_t acc, direct_vec_t x, direct_vec_t w)
+{
+#ifdef __aarch64__
+    return vfmaq_f32(acc, x, w);
+#else
+    return acc + x * w;
+#endif
+}
+
+// 间隔为 stride 的4个像素。mode 为读取方式，由调用处以常量展开：
+// 1 为 stride=1 的连续读取，2 为 stride=2 时用 LD2 取偶数元素（多读一个元素，调用处保证不越界），0 为逐元素读取
+static inline direct_vec_t direct_load_pixels(const float *p, int stride, const int mode)
+{
+    if (mode == 1) {
+        return direct_load(p);
+    }
+#ifdef __aarch64__
+    if (mode == 2) {
+        return vld2q_f32(p).val[0];
+    }
+#endif
+    direct_vec_t v = {p[0], p[stride], p[2 * stride], p[3 * stride]};
+    return v;
+}
+
+// acc + x * w[lane]，ARM64 上为 FMLA（按元素），lane 必须是常量
+#ifdef __aarch64__
+#define direct_fma_lane(acc, x, w, lane) vfmaq_laneq_f32(acc, x, w, lane)
+#else
+#define direct_fma_lane(acc, x, w, lane) ((acc) + (x) * (w)[lane])
+#endif
+
+// 8个输出通道的权重，每组 DIRECT_TILE_OC 个通道按 [输入通道][抽头][8] 排列，不足8个通道时补零
+static size_t direct_tile_packed_size(int output_channel, int input_channel, int k_size)
+{
+    return (size_t)(output_channel + DIRECT_TILE_OC - 1) / DIRECT_TILE_OC * input_channel * k_size * k_size *
+           DIRECT_TILE_OC;
+}
+
+static void direct_tile_pack_weights(const float *weights, int output_channel, int input_channel, int k_size,
+                                     float *packed)
+{
+    int taps = k_size * k_size;
+
+    memset(packed, 0, direct_tile_packed_size(output_channel, input_channel, k_size) * sizeof(float));
+    for (int oc = 0; oc < output_channel; oc++) {
+        float *group = packed + (size_t)(oc / DIRECT_TILE_OC) * input_channel * taps * DIRECT_TILE_OC;
+        for (int ic = 0; ic < input_channel; ic++) {
+            for (int tap = 0; tap < taps; tap++) {
+                group[((size_t)ic * taps + tap) * DIRECT_TILE_OC + oc % DIRECT_TILE_OC] =
+                    weights[((size_t)oc * input_channel + ic) * taps + tap];
+            }
+        }
+    }
+}
+
+// 一个寄存器块：input 指向第0个输入通道中第一个像素的左上角抽头，weights 为该组8个输出通道的权重，
+// output 指向第一个输出通道的第一个像素；vecs 为每个输出通道的像素向量数（2：8个像素，1：4个像素），
+// mode 见 direct_load_pixels
+static inline __attribute__((always_inline)) void direct_tile(const direct_shape_t *s, const float *input,
+                                                              const float *weights, const float *bias8,
+                                                              float *output, size_t output_plane, int oc_count,
+                                                              const int vecs, const int mode)
+{
+    int k_size = s->k_size;
+    int stride = mode ? mode : s->stride;
+    size_t input_plane = (size_t)s->input_h * s->input_w;
+    direct_vec_t acc[DIRECT_TILE_OC][2];
+
+    for (int o = 0; o < DIRECT_TILE_OC; o++) {
+        for (int v = 0; v < vecs; v++) {
+            acc[o][v] = direct_splat(bias8[o]);
+        }
+    }
+    for (int ic = 0; ic < s->input_channel; ic++) {
+        const float *input_ptr = input + ic * input_plane;
+        for (int kh = 0; kh < k_size; kh++) {
+            const float *row = input_ptr + (size_t)kh * s->input_w;
+            for (int kw = 0; kw < k_size; kw++, weights += DIRECT_TILE_OC) {
+                direct_vec_t w0 = direct_load(weights);
+                direct_vec_t w1 = direct_load(weights + 4);
+                for (int v = 0; v < vecs; v++) {
+                    direct_vec_t x = direct_load_pixels(row + kw + v * 4 * stride, stride, mode);
+                    acc[0][v] = direct_fma_lane(acc[0][v], x, w0, 0);
+                    acc[1][v] = direct_fma_lane(acc[1][v], x, w0, 1);
+                    acc[2][v] = direct_fma_lane(acc[2][v], x, w0, 2);
+                    acc[3][v] = direct_fma_lane(acc[3][v], x, w0, 3);
+                    acc[4][v] = direct_fma_lane(acc[4][v], x, w1, 0);
+                    acc[5][v] = direct_fma_lane(acc[5][v], x, w1, 1);
+                    acc[6][v] = direct_fma_lane(acc[6][v], x, w1, 2);
+                    acc[7][v] = direct_fma_lane(acc[7][v], x, w1, 3);
+                }
+            }
+        }
+    }
+    for (int o = 0; o < oc_count; o++) {
+        for (int v = 0; v < vecs; v++) {
+            direct_store(output + o * output_plane + v * 4, acc[o][v]);
+        }
+    }
+}
+
+// 单个像素：8个输出通道为一个向量对，输入标量广播
+static void direct_tile_pixel(const direct_shape_t *s, const float *input, const float *weights,
+                              const float *bias8, float *output, size_t output_plane, int oc_count)
+{
+    int taps = s->k_size * s->k_size;
+    size_t input_plane = (size_t)s->input_h * s->input_w;
+    direct_vec_t acc0 = direct_load(bias8);
+    direct_vec_t acc1 = direct_load(bias8 + 4);
+    float result[DIRECT_TILE_OC];
+
+    for (int ic = 0; ic < s->input_channel; ic++) {
+        const float *input_ptr = input + ic * input_plane;
+        for (int tap = 0; tap < taps; tap++, weights += DIRECT_TILE_OC) {
+            direct_vec_t x = direct_splat(input_ptr[tap / s->k_size * s->input_w + tap % s->k_size]);
+            acc0 = direct_fma(acc0, x, direct_load(weights));
+            acc1 = direct_fma(acc1, x, direct_load(weights + 4));
+        }
+    }
+    direct_store(result, acc0);
+    direct_store(result + 4, acc1);
+    for (int o = 0; o < oc_count; o++) {
+        output[o * output_plane] = result[o];
+    }
+}
+
+// 内部像素 [col0, col1)：每8个输出通道一组，沿行依次计算 8 / 4 / 1 个像素的块
+// stride=2 的 LD2 比所需多读一个元素，块的最后一个抽头在行尾时改用逐元素读取
+static inline __attribute__((always_inline)) void direct_tile_row(const direct_shape_t *s,
+                                                                  const float *input_feature, const float *bias,
+                                                                  float *output_feature, int row, int col0,
+                                                                  int col1, const int mode)
+{
+    int k_size = s->k_size;
+    size_t output_plane = (size_t)s->output_h * s->output_w;
+    size_t group_size = (size_t)s->input_channel * k_size * k_size * DIRECT_TILE_OC;
+    const float *input_row = input_feature + (size_t)(row * s->stride - s->padding) * s->input_w - s->padding;
+    // 块的输入起点 x0 满足 x0 + 2 * 像素数 <= ld2_end 时，LD2 读到的最后一个元素仍在输入行内
+    int ld2_end = s->input_w - k_size;
+
+    for (int oc = 0; oc < s->output_channel; oc += DIRECT_TILE_OC) {
+        int oc_count = s->output_channel - oc < DIRECT_TILE_OC ? s->output_channel - oc : DIRECT_TILE_OC;
+        const float *weights = s->packed_weights + (size_t)oc / DIRECT_TILE_OC * group_size;
+        float *output = output_feature + (size_t)oc * output_plane + (size_t)row * s->output_w;
+        float bias8[DIRECT_TILE_OC] = { 0.0f };
+        int col = col0;
+
+        for (int i = 0; i < oc_count && bias; i++) {
+            bias8[i] = bias[oc + i];
+        }
+        for (; col + DIRECT_TILE_PX <= col1; col += DIRECT_TILE_PX) {
+            const float *x = input_row + col * s->stride;
+            if (mode == 2 && (col + DIRECT_TILE_PX) * 2 - s->padding > ld2_end) {
+                direct_tile(s, x, weights, bias8, output + col, output_plane, oc_count, 2, 0);
+            } else {
+                direct_tile(s, x, weights, bias8, output + col, output_plane, oc_count, 2, mode);
+            }
+        }
+        for (; col + 4 <= col1; col += 4) {
+            const float *x = input_row + col * s->stride;
+            if (mode == 2 && (col + 4) * 2 - s->padding > ld2_end) {
+                direct_tile(s, x, weights, bias8, output + col, output_plane, oc_count, 1, 0);
+            } else {
+                direct_tile(s, x, weights, bias8, output + col, output_plane, oc_count, 1, mode);
+            }
+        }
+        for (; col < col1; col++) {
+            direct_tile_pixel(s, input_row + col * s->stride, weights, bias8, output + col, output_plane, oc_count);
+        }
+    }
+}
+
+static void direct_tile_interior(const direct_shape_t *s, const float *input_feature, const float *weights,
+                                 const float *bias, float *output_feature, int row, int col0, int col1)
+{
+    (void)weights;
+    switch (s->stride) {
+    case 1:
+        direct_tile_row(s, input_feature, bias, output_feature, row, col0, col1, 1);
+        break;
+    case 2:
+        direct_tile_row(s, input_feature, bias, output_feature, row, col0, col1, 2);
+        break;
+    default:
+        direct_tile_row(s, input_feature, bias, output_feature, row, col0, col1, 0);
+        break;
+    }
+}
+
+static void direct_shape_init(direct_shape_t *s, const conv_epilogue_t *epilogue, int output_channel,
+                              int input_channel, int k_size, int output_h, int output_w, int input_h, int input_w,
+                              int stride, int padding)
+{
+    s->output_channel = output_channel;
+    s->input_channel = input_channel;
+    s->k_size = k_size;
+    s->output_h = output_h;
+    s->output_w = output_w;
+    s->input_h = input_h;
+    s->input_w = input_w;
+    s->stride = stride;
+    s->padding = padding;
+    s->packed_weights = NULL;
+    s->epilogue = epilogue && conv_epilogue_active(epilogue) ? epilogue : NULL;
+}
+
+// 3x3、stride=1 且调度表中有向量内核时，内部区域交给它（权重按 direct_3x3_pack_weights 重排），
+// 否则各种尺寸的卷积核都走寄存器分块
+static int direct_use_3x3_kernel(const conv_desc_t *desc)
+{
+    return desc->k_size == 3 && desc->stride == 1 && conv_dispatch()->direct_3x3->run;
+}
+
+size_t conv_direct_packed_size(const conv_desc_t *desc)
+{
+    return direct_use_3x3_kernel(desc) ? direct_3x3_packed_size(desc->output_channel, desc->input_channel)
+                                       : direct_tile_packed_size(desc->output_channel, desc->input_channel,
+                                                                 desc->k_size);
+}
+
+void conv_direct_pack_weights(const conv_desc_t *desc, const float *weights, float *packed)
+{
+    if (direct_use_3x3_kernel(desc)) {
+        direct_3x3_pack_weights(weights, desc->output_channel, desc->input_channel, packed);
+    } else {
+        direct_tile_pack_weights(weights, desc->output_channel, desc->input_channel, desc->k_size, packed);
+    }
+}
+
+// 句柄保存的权重已经重排，内部区域的内核直接使用，否则在工作区中临时重排
+size_t conv_direct_workspace_size(const conv_desc_t *desc, int prepacked)
+{
+    return prepacked ? 0 : conv_ws_bytes(conv_direct_packed_size(desc) * sizeof(float));
+}
+
+size_t conv_direct_prepacked_size(const conv_desc_t *desc)
+{
+    return (size_t)desc->output_channel * desc->input_channel * desc->k_size * desc->k_size +
+           conv_direct_packed_size(desc);
+}
+
+void conv_direct_prepack_weights(const conv_desc_t *desc, const float *weights, float *prepacked)
+{
+    size_t raw = (size_t)desc->output_channel * desc->input_channel * desc->k_size * desc->k_size;
+
+    memcpy(prepacked, weights, raw * sizeof(float));
+    conv_direct_pack_weights(desc, weights, prepacked + raw);
+}
+
+// 低精度：每个输出行先把所需的3行输入（所有输入通道）转换为FP32并在左右补零，
+// 之后整行都没有越界的抽头，不需要边界路径，内部区域的内核直接处理整行
+size_t conv_direct_lowp_rows_size(const conv_desc_t *desc)
+{
+    return (size_t)desc->input_channel * 3 * (desc->input_w + 2 * desc->padding) +
+           (size_t)desc->output_channel * conv_output_w(desc);
+}
+
+void conv_direct_3x3_lowp_row(const conv_desc_t *desc, conv_dtype_t dtype, const uint16_t *input_feature,
+                              const float *packed_weights, const float *bias, uint16_t *output_feature, int row,
+                              float *rows)
+{
+    int input_channel = desc->input_channel;
+    int output_h = conv_output_h(desc);
+    int output_w = conv_output_w(desc);
+    int padding = desc->padding;
+    int row_w = desc->input_w + 2 * padding;
+    // rows: [输入通道][3][row_w]，之后是所有输出通道的一行FP32结果
+    float *out_rows = rows + (size_t)input_channel * 3 * row_w;
+
+    for (int ic = 0; ic < input_channel; ic++) {
+        for (int r = 0; r < 3; r++) {
+            int iy = row * desc->stride - padding + r;
+            float *dst = rows + ((size_t)ic * 3 + r) * row_w;
+            if (iy < 0 || iy >= desc->input_h) {
+                memset(dst, 0, row_w * sizeof(float));
+                continue;
+            }
+            memset(dst, 0, padding * sizeof(float));
+            conv_convert_to_fp32(dtype, input_feature + ((size_t)ic * desc->input_h + iy) * desc->input_w,
+                                 dst + padding, desc->input_w);
+            memset(dst + padding + desc->input_w, 0, padding * sizeof(float));
+        }
+    }
+
+    if (direct_use_3x3_kernel(desc)) {
+        // 与FP32相同的向量行内核，每次4个输出通道
+        direct_3x3_row_fn run = conv_dispatch()->direct_3x3->run;
+        for (int oc = 0; oc < desc->output_channel; oc += 4) {
+            int oc_count = desc->output_channel - oc < 4 ? desc->output_channel - oc : 4;
+            float bias4[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for (int i = 0; i < oc_count && bias; i++) {
+                bias4[i] = bias[oc + i];
+            }
+            run(rows, row_w, 3L * row_w, packed_weights + (size_t)oc / 4 * input_channel * 36, input_channel, bias4,
+                out_rows + (size_t)oc * output_w, output_w, oc_count, output_w);
+        }
+    } else {
+        // 寄存器分块：补零后的3行看作高3、宽 row_w、无补零的输入，计算其唯一的输出行
+        direct_shape_t s;
+        direct_shape_init(&s, NULL, desc->output_channel, input_channel, 3, 1, output_w, 3, row_w, desc->stride, 0);
+        s.packed_weights = packed_weights;
+        direct_tile_interior(&s, rows, NULL, bias, out_rows, 0, 0, output_w);
+    }
+
+    // 偏置已在计算时加上，激活和截断之后舍入为16位写回
+    for (int oc = 0; oc < desc->output_channel; oc++) {
+        float *out = out_rows + (size_t)oc * output_w;
+        if (conv_epilogue_active(&desc->epilogue)) {
+            conv_epilogue_apply(&desc->epilogue, 0.0f, out, output_w);
+        }
+        conv_convert_from_fp32(dtype, out, output_feature + ((size_t)oc * output_h + row) * output_w, output_w);
+    }
+}
+
+// 按 (图像, 输出行) 并行，batch=1 时也能分给所有线程；各行共用同一份重排的权重
+typedef struct {
+    const direct_shape_t *shape;
+    direct_interior_fn interior;
+    const float *input;
+    const float *weights;
+    const float *bias;
+    float *output;
+    size_t input_size, output_size;
+} direct_row_task_t;
+
+static void direct_row_task(void *ctx, int task, int thread_id)
+{
+    direct_row_task_t *t = (direct_row_task_t *)ctx;
+    int image = task / t->shape->output_h;
+
+    (void)thread_id;
+    direct_run_row(t->shape, t->input + image * t->input_size, t->weights, t->bias,
+                   t->output + image * t->output_size, t->interior, task % t->shape->output_h);
+}
+
+int conv_run_direct(const conv_desc_t *desc, const float *input, const float *weights,
+                    const float *prepacked_weights, const float *bias, float *output, conv_workspace_t *ws)
+{
+    direct_shape_t s;
+    direct_row_task_t t;
+    int output_h = conv_output_h(desc);
+    int output_w = conv_output_w(desc);
+    int use_3x3 = direct_use_3x3_kernel(desc);
+    float *packed = NULL;
+
+    direct_shape_init(&s, &desc->epilogue, desc->output_channel, desc->input_channel, desc->k_size, output_h,
+                      output_w, desc->input_h, desc->input_w, desc->stride, desc->padding);
+    if (prepacked_weights) {
+        weights = prepacked_weights;
+        s.packed_weights = prepacked_weights + (size_t)desc->output_channel * desc->input_channel * desc->k_size *
+                                                   desc->k_size;
+    } else {
+        packed = (float *)conv_ws_alloc(ws, conv_direct_workspace_size(desc, 0));
+        if (!packed) {
+            return CONV_ERR_NOMEM;
+        }
+        conv_direct_pack_weights(desc, weights, packed);
+        s.packed_weights = packed;
+    }
+
+    t.shape = &s;
+    t.interior = use_3x3 ? direct_3x3_interior_vector : direct_tile_interior;
+    t.input = input;
+    t.weights = weights;
+    t.bias = bias;
+    t.output = output;
+    t.input_size = (size_t)desc->input_channel * desc->input_h * desc->input_w;
+    t.output_size = (size_t)desc->output_channel * output_h * output_w;
+    conv_parallel_for(desc->batch * output_h, direct_row_task, &t);
+    conv_ws_free(ws, packed);
+    return CONV_OK;
+}
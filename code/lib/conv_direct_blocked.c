@@ -0,0 +1,290 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conv_internal.h"
+#include "thread_pool.h"
+
+#ifdef __aarch64__
+#include <arm_neon.h>
+#endif
+
+// NC4HW4 / NC8HW8 的直接卷积
+//
+// 输入、输出按 N x ceil(C/cb) x H x W x cb 存放（cb 为4或8），同一像素的 cb 个通道相邻。
+// 权重整理为 [oc块][ic块][kh][kw][ic (cb)][oc (cb)]，补齐的通道为0，因此一个输入标量乘以一行权重
+// 就是对 cb 个输出通道的向量更新：
+//   acc[像素][oc块内 cb 个通道] += x[像素][ic] * w[ic][cb 个输出通道]
+// 每次计算一个输出行上的 8 个像素（NC4HW4，8个向量累加器）或 4 个像素（NC8HW8，每像素2个向量），
+// 每个抽头的权重读入寄存器后供这些像素复用，输入按向量读取后用 FMLA（按元素）乘加，累加器常驻寄存器。
+// 通道较多时非NCHW布局的GEMM（见 conv_sgemm.c）更快，这里主要用于3x3等小通道卷积和空洞卷积。
+// 输出行两端窗口越界的像素单独裁剪卷积核窗口；支持步长、补零和空洞。
+
+#ifdef __aarch64__
+typedef float32x4_t blocked_vec_t;
+#else
+typedef float blocked_vec_t __attribute__((vector_size(16)));
+#endif
+
+#define BLOCKED_ACC 8            // 累加器向量数
+#define BLOCKED_WEIGHT_VECS 16   // 一个抽头的权重向量数上限（NC8HW8: 8 x 2）
+
+static inline blocked_vec_t blocked_load(const float *p)
+{
+#ifdef __aarch64__
+    return vld1q_f32(p);
+#else
+    blocked_vec_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+#endif
+}
+
+static inline void blocked_store(float *p, blocked_vec_t v)
+{
+#ifdef __aarch64__
+    vst1q_f32(p, v);
+#else
+    memcpy(p, &v, sizeof(v));
+#endif
+}
+
+// acc + w * x（x 广播到4个通道）
+static inline blocked_vec_t blocked_fma(blocked_vec_t acc, blocked_vec_t w, float x)
+{
+#ifdef __aarch64__
+    return vfmaq_n_f32(acc, w, x);
+#else
+    blocked_vec_t xv = {x, x, x, x};
+    return acc + w * xv;
+#endif
+}
+
+// acc + w * x[lane]，ARM64 上为 FMLA（按元素），lane 必须是常量
+#ifdef __aarch64__
+#define blocked_fma_lane(acc, w, x, lane) vfmaq_laneq_f32(acc, w, x, lane)
+#else
+#define blocked_fma_lane(acc, w, x, lane) ((acc) + (w) * (x)[lane])
+#endif
+
+typedef struct {
+    const float *input;
+    const float *packed_weights;
+    const float *bias;
+    float *output;
+    const conv_epilogue_t *epilogue;   // 不需要激活和截断时为NULL
+    int cb;
+    int input_blocks, output_blocks;
+    int output_channel;
+    int input_h, input_w, output_h, output_w;
+    int k_size, stride, padding, dilation;
+    int col_lo, col_hi;                // 输出行内所有抽头都在输入内的列范围
+} blocked_task_t;
+
+size_t conv_direct_blocked_weights_size(const conv_desc_t *desc)
+{
+    int cb = conv_layout_channel_block(desc->layout, desc->output_channel);
+    size_t input_blocks = (desc->input_channel + cb - 1) / cb;
+    size_t output_blocks = (desc->output_channel + cb - 1) / cb;
+    return output_blocks * input_blocks * desc->k_size * desc->k_size * cb * cb;
+}
+
+void conv_direct_blocked_pack_weights(const conv_desc_t *desc, const float *weights, float *packed_weights)
+{
+    int cb = conv_layout_channel_block(desc->layout, desc->output_channel);
+    int taps = desc->k_size * desc->k_size;
+    int input_blocks = (desc->input_channel + cb - 1) / cb;
+
+    memset(packed_weights, 0, conv_direct_blocked_weights_size(desc) * sizeof(float));
+    for (int oc = 0; oc < desc->output_channel; oc++) {
+        for (int ic = 0; ic < desc->input_channel; ic++) {
+            const float *src = weights + ((size_t)oc * desc->input_channel + ic) * taps;
+            float *dst = packed_weights + ((size_t)(oc / cb) * input_blocks + ic / cb) * taps * cb * cb +
+                         (ic % cb) * cb + oc % cb;
+            for (int tap = 0; tap < taps; tap++) {
+                dst[(size_t)tap * cb * cb] = src[tap];
+            }
+        }
+    }
+}
+
+// 输出行 [col0, col0 + pixels) 上的 pixels 个像素（所有抽头都在输入行内），kh 限于 [kh0, kh1)
+// vecs 为每个像素的向量数（cb / 4），pixels * vecs <= BLOCKED_ACC；由调用处以常量展开
+static inline __attribute__((always_inline)) void blocked_strip(const blocked_task_t *t, const float *input,
+                                                                const float *weights, const float *bias,
+                                                                float *output_row, int row, int col0, int kh0,
+                                                                int kh1, const int vecs, const int pixels)
+{
+    const int cb = vecs * 4;
+    int k_size = t->k_size;
+    int stride = t->stride;
+    size_t pixel_step = (size_t)stride * cb;
+    blocked_vec_t acc[BLOCKED_ACC];
+
+    for (int px = 0; px < pixels; px++) {
+        for (int v = 0; v < vecs; v++) {
+            acc[px * vecs + v] = blocked_load(bias + v * 4);
+        }
+    }
+    for (int ib = 0; ib < t->input_blocks; ib++) {
+        const float *input_block = input + (size_t)ib * t->input_h * t->input_w * cb;
+        const float *weight_block = weights + (size_t)ib * k_size * k_size * cb * cb;
+        for (int kh = kh0; kh < kh1; kh++) {
+            int iy = row * stride - t->padding + kh * t->dilation;
+            const float *input_row = input_block + (size_t)iy * t->input_w * cb;
+            for (int kw = 0; kw < k_size; kw++) {
+                const float *x = input_row + (size_t)(col0 * stride - t->padding + kw * t->dilation) * cb;
+                const float *w = weight_block + (size_t)(kh * k_size + kw) * cb * cb;
+                // 该抽头的 cb x cb 权重（NC4HW4 4个、NC8HW8 16个向量）读入寄存器，供所有像素复用
+                blocked_vec_t wv[BLOCKED_WEIGHT_VECS];
+                for (int i = 0; i < cb * vecs; i++) {
+                    wv[i] = blocked_load(w + i * 4);
+                }
+                // 每个像素按向量读入 cb 个输入通道，逐个元素与对应的权重行乘加
+                for (int px = 0; px < pixels; px++) {
+                    for (int g = 0; g < vecs; g++) {
+                        blocked_vec_t xv = blocked_load(x + px * pixel_step + g * 4);
+                        const blocked_vec_t *wg = wv + g * 4 * vecs;
+                        for (int v = 0; v < vecs; v++) {
+                            blocked_vec_t a = acc[px * vecs + v];
+                            a = blocked_fma_lane(a, wg[0 * vecs + v], xv, 0);
+                            a = blocked_fma_lane(a, wg[1 * vecs + v], xv, 1);
+                            a = blocked_fma_lane(a, wg[2 * vecs + v], xv, 2);
+                            a = blocked_fma_lane(a, wg[3 * vecs + v], xv, 3);
+                            acc[px * vecs + v] = a;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    for (int px = 0; px < pixels; px++) {
+        for (int v = 0; v < vecs; v++) {
+            blocked_store(output_row + (size_t)(col0 + px) * cb + v * 4, acc[px * vecs + v]);
+        }
+    }
+}
+
+// 单个像素，卷积核窗口裁剪到输入范围内（行两端的边界像素、以及内部区域末尾不足一组的像素）
+static void blocked_pixel(const blocked_task_t *t, const float *input, const float *weights, const float *bias,
+                          float *output_row, int row, int col, int kh0, int kh1)
+{
+    int cb = t->cb;
+    int vecs = cb / 4;
+    int k_size = t->k_size;
+    blocked_vec_t acc[2];
+
+    for (int v = 0; v < vecs; v++) {
+        acc[v] = blocked_load(bias + v * 4);
+    }
+    for (int ib = 0; ib < t->input_blocks; ib++) {
+        const float *input_block = input + (size_t)ib * t->input_h * t->input_w * cb;
+        const float *weight_block = weights + (size_t)ib * k_size * k_size * cb * cb;
+        for (int kh = kh0; kh < kh1; kh++) {
+            int iy = row * t->stride - t->padding + kh * t->dilation;
+            for (int kw = 0; kw < k_size; kw++) {
+                int ix = col * t->stride - t->padding + kw * t->dilation;
+                if (ix < 0 || ix >= t->input_w) {
+                    continue;
+                }
+                const float *x = input_block + ((size_t)iy * t->input_w + ix) * cb;
+                const float *w = weight_block + (size_t)(kh * k_size + kw) * cb * cb;
+                for (int i = 0; i < cb; i++) {
+                    for (int v = 0; v < vecs; v++) {
+                        acc[v] = blocked_fma(acc[v], blocked_load(w + i * cb + v * 4), x[i]);
+                    }
+                }
+            }
+        }
+    }
+    for (int v = 0; v < vecs; v++) {
+        blocked_store(output_row + (size_t)col * cb + v * 4, acc[v]);
+    }
+}
+
+// 一个任务计算一个 (图像, 输出通道块, 输出行)
+static void blocked_row_task(void *ctx, int task, int thread_id)
+{
+    blocked_task_t *t = (blocked_task_t *)ctx;
+    int cb = t->cb;
+    int row = task % t->output_h;
+    int ob = task / t->output_h % t->output_blocks;
+    int image = task / t->output_h / t->output_blocks;
+    const float *input = t->input + (size_t)image * t->input_blocks * t->input_h * t->input_w * cb;
+    const float *weights = t->packed_weights + (size_t)ob * t->input_blocks * t->k_size * t->k_size * cb * cb;
+    float *output_row = t->output + (((size_t)image * t->output_blocks + ob) * t->output_h + row) * t->output_w * cb;
+    float bias[8] = {0.0f};
+
+    (void)thread_id;
+    for (int i = 0; i < cb && ob * cb + i < t->output_channel; i++) {
+        bias[i] = t->bias ? t->bias[ob * cb + i] : 0.0f;
+    }
+
+    // 落在输入行内的卷积核行 [kh0, kh1)
+    int iy0 = row * t->stride - t->padding;
+    int kh0 = iy0 >= 0 ? 0 : (-iy0 + t->dilation - 1) / t->dilation;
+    int kh1 = t->input_h - iy0 > 0 ? (t->input_h - iy0 + t->dilation - 1) / t->dilation : 0;
+    if (kh1 > t->k_size) {
+        kh1 = t->k_size;
+    }
+    if (kh1 < kh0) {
+        kh1 = kh0;
+    }
+
+    int col = 0;
+    for (; col < t->col_lo; col++) {
+        blocked_pixel(t, input, weights, bias, output_row, row, col, kh0, kh1);
+    }
+    if (cb == 4) {
+        for (; col + 8 <= t->col_hi; col += 8) {
+            blocked_strip(t, input, weights, bias, output_row, row, col, kh0, kh1, 1, 8);
+        }
+    } else {
+        for (; col + 4 <= t->col_hi; col += 4) {
+            blocked_strip(t, input, weights, bias, output_row, row, col, kh0, kh1, 2, 4);
+        }
+    }
+    for (; col < t->output_w; col++) {
+        blocked_pixel(t, input, weights, bias, output_row, row, col, kh0, kh1);
+    }
+
+    if (t->epilogue) {
+        conv_epilogue_apply(t->epilogue, 0.0f, output_row, (size_t)t->output_w * cb);
+        // 截断可能把补齐的通道变为非0，恢复为0
+        int valid = t->output_channel - ob * cb;
+        if (t->epilogue->clamp && valid < cb) {
+            for (int col = 0; col < t->output_w; col++) {
+                memset(output_row + (size_t)col * cb + valid, 0, (cb - valid) * sizeof(float));
+            }
+        }
+    }
+}
+
+int conv_run_direct_blocked(const conv_desc_t *desc, const float *input, const float *packed_weights,
+                            const float *bias, float *output)
+{
+    blocked_task_t t;
+
+    t.input = input;
+    t.packed_weights = packed_weights;
+    t.bias = bias;
+    t.output = output;
+    t.epilogue = conv_epilogue_active(&desc->epilogue) ? &desc->epilogue : NULL;
+    t.cb = conv_layout_channel_block(desc->layout, desc->output_channel);
+    t.input_blocks = (desc->input_channel + t.cb - 1) / t.cb;
+    t.output_blocks = (desc->output_channel + t.cb - 1) / t.cb;
+    t.output_channel = desc->output_channel;
+    t.input_h = desc->input_h;
+    t.input_w = desc->input_w;
+    t.output_h = conv_output_h(desc);
+    t.output_w = conv_output_w(desc);
+    t.k_size = desc->k_size;
+    t.stride = desc->stride;
+    t.padding = desc->padding;
+    t.dilation = desc->dilation;
+    conv_interior_range(desc->input_w, t.output_w, desc->k_size, desc->stride, desc->padding, desc->dilation,
+                        &t.col_lo, &t.col_hi);
+
+    conv_parallel_for(desc->batch * t.output_blocks * t.output_h, blocked_row_task, &t);
+    return CONV_OK;
+}
@@ -0,0 +1,171 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "conv_internal.h"
+
+// 融合后处理：加偏置 -> 激活 -> 截断，由各算法在写回结果块或输出行时调用
+
+const char *conv_act_name(conv_act_t activation)
+{
+    switch (activation) {
+    case CONV_ACT_NONE:       return "none";
+    case CONV_ACT_RELU:       return "relu";
+    case CONV_ACT_RELU6:      return "relu6";
+    case CONV_ACT_LEAKY_RELU: return "leaky_relu";
+    case CONV_ACT_SILU:       return "silu";
+    default:                  return "unknown";
+    }
+}
+
+int conv_epilogue_check(const conv_epilogue_t *epilogue)
+{
+    if (epilogue->activation < CONV_ACT_NONE || epilogue->activation >= CONV_ACT_COUNT) {
+        return CONV_ERR_INVALID;
+    }
+    if (epilogue->activation == CONV_ACT_LEAKY_RELU && !isfinite(epilogue->alpha)) {
+        return CONV_ERR_INVALID;
+    }
+    // 写成取反的形式，NaN 也不合法
+    if (epilogue->clamp && !(epilogue->clamp_min <= epilogue->clamp_max)) {
+        return CONV_ERR_INVALID;
+    }
+    return CONV_OK;
+}
+
+void conv_epilogue_bounds(const conv_epilogue_t *epilogue, float *lo, float *hi)
+{
+    *lo = epilogue->clamp ? epilogue->clamp_min : -INFINITY;
+    *hi = epilogue->clamp ? epilogue->clamp_max : INFINITY;
+    if (epilogue->activation == CONV_ACT_RELU || epilogue->activation == CONV_ACT_RELU6) {
+        *lo = *lo > 0.0f ? *lo : 0.0f;
+    }
+    if (epilogue->activation == CONV_ACT_RELU6) {
+        *hi = *hi < 6.0f ? *hi : 6.0f;
+    }
+}
+
+// GCC / Clang 的通用向量，ARM64 上编译为NEON，x86-64 上为SSE
+typedef float epilogue_vec_t __attribute__((vector_size(16)));
+typedef int32_t epilogue_ivec_t __attribute__((vector_size(16)));
+
+// 按掩码逐元素选择 mask ? a : b（C语言的 ?: 不接受向量）
+static inline epilogue_vec_t epilogue_select(epilogue_ivec_t mask, epilogue_vec_t a, epilogue_vec_t b)
+{
+    return (epilogue_vec_t)((mask & (epilogue_ivec_t)a) | (~mask & (epilogue_ivec_t)b));
+}
+
+// exp(x)：x = n * ln2 + r（|r| <= ln2 / 2），exp(r) 用 Cephes expf 的多项式，2^n 直接写入指数位，相对误差约 2e-7。
+// x 先截断到 [-87, 88]，n 在 [-125, 127] 内，结果不会溢出或成为非规格化数；NaN 保持为 NaN
+static inline epilogue_vec_t epilogue_exp(epilogue_vec_t x)
+{
+    x = epilogue_select(x < -87.0f, (epilogue_vec_t){} - 87.0f, x);
+    x = epilogue_select(x > 88.0f, (epilogue_vec_t){} + 88.0f, x);
+
+    // n = floor(x * log2(e) + 0.5)：先向零取整，正数以外多减的1再补回
+    epilogue_vec_t t = x * 1.44269504088896341f + 0.5f;
+    epilogue_ivec_t n = __builtin_convertvector(t, epilogue_ivec_t);
+    n += __builtin_convertvector(n, epilogue_vec_t) > t;
+    epilogue_vec_t fn = __builtin_convertvector(n, epilogue_vec_t);
+
+    // ln2 拆成高低两部分，r 的舍入误差不被 n 放大
+    epilogue_vec_t r = x - fn * 0.693359375f;
+    r = r + fn * 2.12194440e-4f;
+    epilogue_vec_t y = r * 1.9875691500e-4f + 1.3981999507e-3f;
+    y = y * r + 8.3334519073e-3f;
+    y = y * r + 4.1665795894e-2f;
+    y = y * r + 1.6666665459e-1f;
+    y = y * r + 5.0000001201e-1f;
+    y = y * (r * r) + r + 1.0f;
+
+    epilogue_ivec_t pow2n = (n + 127) << 23;
+    return y * (epilogue_vec_t)pow2n;
+}
+
+void conv_silu(float bias, float *data, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        epilogue_vec_t v;
+        memcpy(&v, data + i, sizeof(v));
+        v += bias;
+        v = v / (1.0f + epilogue_exp(-v));
+        memcpy(data + i, &v, sizeof(v));
+    }
+    for (; i < count; i++) {
+        float v = data[i] + bias;
+        data[i] = v / (1.0f + expf(-v));
+    }
+}
+
+// LeakyReLU（v > 0 ? v : v * alpha），clamp 非0时再截断到 [lo, hi]，一遍完成。
+// 标量循环中 ?: 选择乘积的写法在默认的 -ftrapping-math 下不会被编译器向量化，这里用向量比较和按位选择
+static void epilogue_leaky(float bias, float alpha, int clamp, float lo, float hi, float *data, size_t count)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        epilogue_vec_t v;
+        memcpy(&v, data + i, sizeof(v));
+        v += bias;
+        v = epilogue_select(v > 0.0f, v, v * alpha);
+        if (clamp) {
+            v = epilogue_select(v > lo, v, (epilogue_vec_t){} + lo);
+            v = epilogue_select(v < hi, v, (epilogue_vec_t){} + hi);
+        }
+        memcpy(data + i, &v, sizeof(v));
+    }
+    for (; i < count; i++) {
+        float v = data[i] + bias;
+        v = v > 0.0f ? v : v * alpha;
+        if (clamp) {
+            v = v > lo ? v : lo;
+            v = v < hi ? v : hi;
+        }
+        data[i] = v;
+    }
+}
+
+// 截断和只加偏置的循环不含分支（比较写成 v > lo ? v : lo 的形式，编译为 max / min），编译器可以向量化；
+// LeakyReLU 见 epilogue_leaky，SiLU 见 conv_silu
+void conv_epilogue_apply(const conv_epilogue_t *epilogue, float bias, float *data, size_t count)
+{
+    conv_act_t activation = epilogue->activation;
+    int clamp = epilogue->clamp || activation == CONV_ACT_RELU || activation == CONV_ACT_RELU6;
+    float lo, hi;
+
+    if (activation == CONV_ACT_LEAKY_RELU) {
+        // 截断在同一遍中完成
+        conv_epilogue_bounds(epilogue, &lo, &hi);
+        epilogue_leaky(bias, epilogue->alpha, clamp, lo, hi, data, count);
+        return;
+    } else if (activation == CONV_ACT_SILU) {
+        conv_silu(bias, data, count);
+        bias = 0.0f;
+    }
+
+    // ReLU / ReLU6 本身就是截断，与截断区间合并为一次 max / min
+    if (clamp) {
+        conv_epilogue_bounds(epilogue, &lo, &hi);
+        for (size_t i = 0; i < count; i++) {
+            float v = data[i] + bias;
+            v = v > lo ? v : lo;
+            data[i] = v < hi ? v : hi;
+        }
+    } else if (bias != 0.0f) {
+        for (size_t i = 0; i < count; i++) {
+            data[i] += bias;
+        }
+    }
+}
+
+void conv_epilogue_apply_channels(const conv_epilogue_t *epilogue, const float *bias, float *data, size_t count)
+{
+    if (bias) {
+        for (size_t i = 0; i < count; i++) {
+            data[i] += bias[i];
+        }
+    }
+    conv_epilogue_apply(epilogue, 0.0f, data, count);
+}
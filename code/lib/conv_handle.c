@@ -0,0 +1,280 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conv_internal.h"
+#include "sgemm.h"
+
+// 预打包权重句柄
+//   IM2COL_SGEMM / IMPLICIT_GEMM: 权重即 C_out x (C_in*k*k) 的A矩阵，按 sgemm_prepack_a 打包
+//   WINOGRAD_*:                   变换后的 alpha^2 个 C_out x C_in 矩阵，各自打包
+//   DIRECT:                       原始权重（边界像素使用）之后接内部区域内核的重排权重，见 conv_direct_prepack_weights
+//   DILATED / DEPTHWISE:          内核按OIHW顺序读取权重，保存原始权重的副本
+//   分组卷积：                     每组按单个分组的形状整理，依次存放
+//   非NCHW布局的专用内核：         GEMM为 K x C_out 矩阵（NHWC即HWIO），NC4HW4 / NC8HW8 的直接卷积为分块重排的权重
+//   低精度（conv_prepare_lowp）：   见 conv_lowp_prepare_weights，保存在 lowp_weights 中
+struct conv_handle {
+    conv_desc_t desc;
+    conv_algo_t algo;
+    conv_dtype_t dtype;
+    float *weights;       // 按算法整理后的权重
+    void *lowp_weights;   // 低精度句柄的权重，FP32句柄为NULL
+    float *bias;          // 偏置副本，无偏置时为NULL
+};
+
+size_t conv_packed_weights_size(const conv_desc_t *desc, conv_algo_t algo)
+{
+    int m = desc->output_channel;
+    int k = desc->input_channel / desc->groups * desc->k_size * desc->k_size;
+
+    switch (algo) {
+    case CONV_ALGO_IM2COL_SGEMM:
+    case CONV_ALGO_IMPLICIT_GEMM:
+        return sgemm_packed_a_size(m, k);
+    case CONV_ALGO_WINOGRAD_2X2:
+        return conv_winograd_filter_size(2, m, desc->input_channel);
+    case CONV_ALGO_WINOGRAD_4X4:
+        return conv_winograd_filter_size(4, m, desc->input_channel);
+    case CONV_ALGO_DIRECT:
+        return conv_direct_prepacked_size(desc);
+    default:
+        return (size_t)m * k;
+    }
+}
+
+// 按NCHW算法整理一个普通卷积（或深度卷积）的权重
+static int pack_weights(const conv_desc_t *desc, conv_algo_t algo, const float *weights, float *packed_weights)
+{
+    int m = desc->output_channel;
+    int k = desc->input_channel * desc->k_size * desc->k_size;
+
+    switch (algo) {
+    case CONV_ALGO_IM2COL_SGEMM:
+    case CONV_ALGO_IMPLICIT_GEMM:
+        sgemm_prepack_a(m, k, weights, k, packed_weights);
+        return CONV_OK;
+    case CONV_ALGO_WINOGRAD_2X2:
+        return conv_winograd_transform_filter(2, weights, m, desc->input_channel, packed_weights, NULL);
+    case CONV_ALGO_WINOGRAD_4X4:
+        return conv_winograd_transform_filter(4, weights, m, desc->input_channel, packed_weights, NULL);
+    case CONV_ALGO_DIRECT:
+        conv_direct_prepack_weights(desc, weights, packed_weights);
+        return CONV_OK;
+    default:
+        memcpy(packed_weights, weights, conv_packed_weights_size(desc, algo) * sizeof(float));
+        return CONV_OK;
+    }
+}
+
+int conv_prepare(const conv_desc_t *desc, conv_algo_t algo, const float *weights, const float *bias,
+                 conv_handle_t **handle)
+{
+    int ret = conv_desc_check(desc);
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    if (!weights || !handle) {
+        return CONV_ERR_INVALID;
+    }
+    if (algo == CONV_ALGO_AUTO) {
+        algo = conv_select_algo(desc);
+    }
+    if (!conv_algo_supported(desc, algo)) {
+        return CONV_ERR_UNSUPPORTED;
+    }
+
+    conv_handle_t *h = (conv_handle_t *)calloc(1, sizeof(conv_handle_t));
+    if (!h) {
+        return CONV_ERR_NOMEM;
+    }
+    h->desc = *desc;
+    h->algo = algo;
+
+    // 分组卷积（深度卷积除外）逐组整理
+    int m = desc->output_channel;
+    int native = conv_layout_native(desc, algo);
+    int groups = native || algo == CONV_ALGO_DEPTHWISE ? 1 : desc->groups;
+    conv_desc_t group = *desc;
+    if (groups > 1) {
+        conv_group_desc(desc, &group);
+    }
+    size_t group_size = native ? conv_layout_weights_size(desc, algo) : conv_packed_weights_size(&group, algo);
+    size_t group_weights = (size_t)group.output_channel * (group.input_channel / group.groups) * desc->k_size *
+                           desc->k_size;
+
+    // 打包后的权重按64字节（缓存行）对齐
+    if (posix_memalign((void **)&h->weights, 64, group_size * groups * sizeof(float)) != 0) {
+        h->weights = NULL;
+        conv_handle_destroy(h);
+        return CONV_ERR_NOMEM;
+    }
+    if (bias) {
+        h->bias = (float *)malloc(m * sizeof(float));
+        if (!h->bias) {
+            conv_handle_destroy(h);
+            return CONV_ERR_NOMEM;
+        }
+        memcpy(h->bias, bias, m * sizeof(float));
+    }
+
+    if (native) {
+        conv_layout_pack_weights(desc, algo, weights, h->weights);
+    } else {
+        for (int g = 0; g < groups && ret == CONV_OK; g++) {
+            ret = pack_weights(&group, algo, weights + g * group_weights, h->weights + g * group_size);
+        }
+    }
+    if (ret != CONV_OK) {
+        conv_handle_destroy(h);
+        return ret;
+    }
+
+    *handle = h;
+    return CONV_OK;
+}
+
+// 空洞卷积和深度卷积的句柄保存的是原始权重（非NCHW布局的专用内核除外），其余为打包后的权重
+static int handle_raw_weights(const conv_handle_t *handle)
+{
+    return (handle->algo == CONV_ALGO_DILATED || handle->algo == CONV_ALGO_DEPTHWISE) &&
+           !conv_layout_native(&handle->desc, handle->algo);
+}
+
+size_t conv_prepared_workspace_size(const conv_handle_t *handle)
+{
+    if (!handle) {
+        return 0;
+    }
+    if (handle->dtype != CONV_DTYPE_FP32) {
+        return conv_run_lowp_workspace_size(&handle->desc, handle->algo, handle->dtype, 1);
+    }
+    return conv_run_workspace_size(&handle->desc, handle->algo, !handle_raw_weights(handle));
+}
+
+int conv2d_prepared_ws(const conv_handle_t *handle, const float *input, float *output, void *workspace,
+                       size_t workspace_size)
+{
+    conv_workspace_t ws;
+
+    if (!handle || handle->dtype != CONV_DTYPE_FP32 || !input || !output) {
+        return CONV_ERR_INVALID;
+    }
+    int ret = conv_workspace_init(&ws, workspace, workspace_size, conv_prepared_workspace_size(handle));
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    if (handle_raw_weights(handle)) {
+        return conv_run(&handle->desc, handle->algo, input, handle->weights, NULL, handle->bias, output, &ws);
+    }
+    return conv_run(&handle->desc, handle->algo, input, NULL, handle->weights, handle->bias, output, &ws);
+}
+
+int conv2d_prepared(const conv_handle_t *handle, const float *input, float *output)
+{
+    if (!handle || handle->dtype != CONV_DTYPE_FP32 || !input || !output) {
+        return CONV_ERR_INVALID;
+    }
+
+    size_t size = conv_prepared_workspace_size(handle);
+    void *workspace = size ? conv_ws_alloc(NULL, size) : NULL;
+    if (size && !workspace) {
+        return CONV_ERR_NOMEM;
+    }
+    int ret = conv2d_prepared_ws(handle, input, output, workspace, size);
+    conv_ws_free(NULL, workspace);
+    return ret;
+}
+
+int conv_prepare_lowp(const conv_desc_t *desc, conv_algo_t algo, conv_dtype_t dtype, const void *weights,
+                      const float *bias, conv_handle_t **handle)
+{
+    if (dtype == CONV_DTYPE_FP32) {
+        return conv_prepare(desc, algo, (const float *)weights, bias, handle);
+    }
+    int ret = conv_lowp_check(desc, dtype, &algo);
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    if (!weights || !handle) {
+        return CONV_ERR_INVALID;
+    }
+
+    conv_handle_t *h = (conv_handle_t *)calloc(1, sizeof(conv_handle_t));
+    if (!h) {
+        return CONV_ERR_NOMEM;
+    }
+    h->desc = *desc;
+    h->algo = algo;
+    h->dtype = dtype;
+    h->lowp_weights = conv_lowp_prepare_weights(desc, algo, dtype, weights);
+    if (!h->lowp_weights) {
+        conv_handle_destroy(h);
+        return CONV_ERR_NOMEM;
+    }
+    if (bias) {
+        h->bias = (float *)malloc(desc->output_channel * sizeof(float));
+        if (!h->bias) {
+            conv_handle_destroy(h);
+            return CONV_ERR_NOMEM;
+        }
+        memcpy(h->bias, bias, desc->output_channel * sizeof(float));
+    }
+
+    *handle = h;
+    return CONV_OK;
+}
+
+int conv2d_lowp_prepared_ws(const conv_handle_t *handle, const void *input, void *output, void *workspace,
+                            size_t workspace_size)
+{
+    conv_workspace_t ws;
+
+    if (handle && handle->dtype == CONV_DTYPE_FP32) {
+        return conv2d_prepared_ws(handle, (const float *)input, (float *)output, workspace, workspace_size);
+    }
+    if (!handle || !input || !output) {
+        return CONV_ERR_INVALID;
+    }
+    int ret = conv_workspace_init(&ws, workspace, workspace_size, conv_prepared_workspace_size(handle));
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    if (handle->algo == CONV_ALGO_DIRECT) {
+        return conv_run_lowp(&handle->desc, handle->algo, handle->dtype, input, NULL,
+                             (const float *)handle->lowp_weights, handle->bias, output, &ws);
+    }
+    return conv_run_lowp(&handle->desc, handle->algo, handle->dtype, input, handle->lowp_weights, NULL,
+                         handle->bias, output, &ws);
+}
+
+int conv2d_lowp_prepared(const conv_handle_t *handle, const void *input, void *output)
+{
+    if (!handle || !input || !output) {
+        return CONV_ERR_INVALID;
+    }
+
+    size_t size = conv_prepared_workspace_size(handle);
+    void *workspace = size ? conv_ws_alloc(NULL, size) : NULL;
+    if (size && !workspace) {
+        return CONV_ERR_NOMEM;
+    }
+    int ret = conv2d_lowp_prepared_ws(handle, input, output, workspace, size);
+    conv_ws_free(NULL, workspace);
+    return ret;
+}
+
+conv_algo_t conv_handle_algo(const conv_handle_t *handle)
+{
+    return handle ? handle->algo : CONV_ALGO_AUTO;
+}
+
+void conv_handle_destroy(conv_handle_t *handle)
+{
+    if (!handle) {
+        return;
+    }
+    free(handle->weights);
+    free(handle->lowp_weights);
+    free(handle->bias);
+    free(handle);
+}
@@ -0,0 +1,167 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conv_internal.h"
+#include "qgemm.h"
+
+// INT8量化卷积：Im2col + INT8 GEMM，重新量化在GEMM写回结果块时完成
+
+static int scale_valid(float scale)
+{
+    return scale > 0.0f && isfinite(scale);
+}
+
+static int zero_point_valid(int zero_point)
+{
+    return zero_point >= -128 && zero_point <= 127;
+}
+
+static int quant_check(const conv_quant_t *quant, int output_channel)
+{
+    if (!quant || !quant->weight_scale || !scale_valid(quant->input_scale) || !scale_valid(quant->output_scale) ||
+        !zero_point_valid(quant->input_zero_point) || !zero_point_valid(quant->output_zero_point)) {
+        return CONV_ERR_INVALID;
+    }
+    for (int oc = 0; oc < output_channel; oc++) {
+        if (!scale_valid(quant->weight_scale[oc])) {
+            return CONV_ERR_INVALID;
+        }
+    }
+    return CONV_OK;
+}
+
+// 实数 real 对应的量化输出 zero_point + round(real / output_scale)，饱和到 [-128, 127]；real 可以为无穷大
+static int quant_bound(const conv_quant_t *quant, float real)
+{
+    double q = quant->output_zero_point + floor((double)real / quant->output_scale + 0.5);
+    return q < -128.0 ? -128 : (q > 127.0 ? 127 : (int)q);
+}
+
+// 与量化参数无关的检查
+static int int8_check(const conv_desc_t *desc)
+{
+    int ret = conv_desc_check(desc);
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    // 后处理只支持单调的截断类激活：它们与量化可交换，换算为量化值的饱和区间
+    if (desc->layout != CONV_LAYOUT_NCHW || desc->groups != 1 || desc->epilogue.activation == CONV_ACT_LEAKY_RELU ||
+        desc->epilogue.activation == CONV_ACT_SILU) {
+        return CONV_ERR_UNSUPPORTED;
+    }
+    return CONV_OK;
+}
+
+// 工作区依次为im2col矩阵、每个输出通道的重新量化比例和 qgemm_blocked 的缓冲区
+static size_t int8_workspace_size(const conv_desc_t *desc)
+{
+    int m = desc->output_channel;
+    int k = desc->input_channel * desc->k_size * desc->k_size;
+    size_t n = (size_t)desc->batch * conv_output_h(desc) * conv_output_w(desc);
+
+    return conv_ws_bytes(k * n) + conv_ws_bytes((size_t)m * sizeof(float)) + conv_ws_bytes(qgemm_workspace_size(m, k));
+}
+
+static int int8_run(const conv_desc_t *desc, const conv_quant_t *quant, const int8_t *input, const int8_t *weights,
+                    const int32_t *bias, int8_t *output, conv_workspace_t *ws)
+{
+    int output_h = conv_output_h(desc);
+    int output_w = conv_output_w(desc);
+    int k_size = desc->k_size;
+    int m = desc->output_channel;
+    int k = desc->input_channel * k_size * k_size;
+    int plane = output_h * output_w;
+    int n = desc->batch * plane;
+
+    // 1. Im2col转换：int8矩阵只有FP32的四分之一大，补零部分填输入零点
+    int8_t *im2col_feature = (int8_t *)conv_im2col(ws, input, sizeof(int8_t), quant->input_zero_point, desc->batch,
+                                                   desc->input_channel, desc->input_h, desc->input_w, k_size,
+                                                   desc->stride, desc->padding, desc->dilation, output_h, output_w);
+    // 每个输出通道的重新量化比例
+    float *scale = (float *)conv_ws_alloc(ws, (size_t)m * sizeof(float));
+    void *workspace = conv_ws_alloc(ws, qgemm_workspace_size(m, k));
+    if (!im2col_feature || !scale || !workspace) {
+        conv_ws_free(ws, workspace);
+        conv_ws_free(ws, scale);
+        conv_ws_free(ws, im2col_feature);
+        return CONV_ERR_NOMEM;
+    }
+    for (int oc = 0; oc < m; oc++) {
+        scale[oc] = quant->input_scale * quant->weight_scale[oc] / quant->output_scale;
+    }
+
+    // 2. 矩阵乘法 + 重新量化，输出的每 plane 列属于一张图像，直接按NCHW写回
+    qgemm_requant_t rq;
+    float lo, hi;
+    rq.bias = bias;
+    rq.scale = scale;
+    rq.b_zero_point = quant->input_zero_point;
+    rq.zero_point = quant->output_zero_point;
+    conv_epilogue_bounds(&desc->epilogue, &lo, &hi);
+    rq.min = quant_bound(quant, lo);
+    rq.max = quant_bound(quant, hi);
+    int ret = qgemm_blocked(m, n, k, weights, k, im2col_feature, n, &rq, output, plane, plane, (size_t)m * plane,
+                            workspace);
+
+    conv_ws_free(ws, workspace);
+    conv_ws_free(ws, scale);
+    conv_ws_free(ws, im2col_feature);
+    return ret;
+}
+
+size_t conv_int8_workspace_size(const conv_desc_t *desc)
+{
+    return int8_check(desc) == CONV_OK ? int8_workspace_size(desc) : 0;
+}
+
+int conv2d_int8_ws(const conv_desc_t *desc, const conv_quant_t *quant, const int8_t *input, const int8_t *weights,
+                   const int32_t *bias, int8_t *output, void *workspace, size_t workspace_size)
+{
+    conv_workspace_t ws;
+    int ret = int8_check(desc);
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    if (!input || !weights || !output) {
+        return CONV_ERR_INVALID;
+    }
+    ret = quant_check(quant, desc->output_channel);
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    ret = conv_workspace_init(&ws, workspace, workspace_size, int8_workspace_size(desc));
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    return int8_run(desc, quant, input, weights, bias, output, &ws);
+}
+
+int conv2d_int8(const conv_desc_t *desc, const conv_quant_t *quant, const int8_t *input, const int8_t *weights,
+                const int32_t *bias, int8_t *output)
+{
+    conv_workspace_t ws;
+    int ret = int8_check(desc);
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    if (!input || !weights || !output) {
+        return CONV_ERR_INVALID;
+    }
+    ret = quant_check(quant, desc->output_channel);
+    if (ret != CONV_OK) {
+        return ret;
+    }
+
+    // 整个调用只分配一次工作区
+    size_t size = int8_workspace_size(desc);
+    void *workspace = conv_ws_alloc(NULL, size);
+    if (!workspace) {
+        return CONV_ERR_NOMEM;
+    }
+    conv_workspace_init(&ws, workspace, size, size);
+    ret = int8_run(desc, quant, input, weights, bias, output, &ws);
+    conv_ws_free(NULL, workspace);
+    return ret;
+}
@@ -0,0 +1,300 @@
+#ifndef ARM64_CONV_INTERNAL_H
+#define ARM64_CONV_INTERNAL_H
+
+// 卷积库内部接口，不对外暴露
+
+#include <stdint.h>
+#include <string.h>
+
+#include "conv.h"
+
+// 调度阈值
+// 3x3卷积在输入通道较少时直接卷积更快，通道数较多时im2col+SGEMM的数据重用占优
+#define CONV_DIRECT_MAX_INPUT_CHANNEL  16
+// 3x3、stride=1：输入通道和tile数足够多时使用Winograd，否则变换开销和小矩阵乘法占主导
+#define CONV_WINOGRAD_MIN_CHANNEL      8
+#define CONV_WINOGRAD_MIN_TILES        64
+// Winograd按组处理batch，每组的tile数（GEMM的N维）约为该值
+#define CONV_WINOGRAD_BATCH_TILES      512
+// 空洞卷积的逐平面内核每个输出通道都要重新读一遍输入，输出通道超过该值时空洞im2col + SGEMM更快
+#define CONV_DILATED_MAX_OUTPUT_CHANNEL 2
+// 非NCHW布局GEMM的im2row矩阵每块不超过该大小
+#define CONV_IM2ROW_MAX_BYTES          (16 << 20)
+// Im2col + SGEMM 按列块流式生成im2col矩阵，每块约为L2的一半（留出打包的A、B所需的空间），
+// 生成后立即交给GEMM打包，仍在L2中，不再写回内存
+#define CONV_IM2COL_BLOCK_BYTES        (256 << 10)
+// 每块至少该列数（k*k*C_in 很大时块会超过L2）：每个块都要把整个A（权重）读一遍，列数太少时A的读取占主导
+#define CONV_IM2COL_MIN_BLOCK_COLS     384
+// 非NCHW布局GEMM的im2row按行分块生成，每块至少该行数，B（权重）在每块中重新打包一次
+#define CONV_IM2ROW_MIN_CHUNK_ROWS     256
+
+// 工作区：调用者提供的一段64字节对齐的内存（见 conv.h 中的 conv2d_ws），运行时的临时缓冲区按顺序从中切分
+typedef struct {
+    char *base;
+    size_t size;
+    size_t used;
+} conv_workspace_t;
+
+// bytes 向上对齐到 CONV_WORKSPACE_ALIGN，各算法的工作区大小按它累加
+static inline size_t conv_ws_bytes(size_t bytes)
+{
+    return (bytes + CONV_WORKSPACE_ALIGN - 1) / CONV_WORKSPACE_ALIGN * CONV_WORKSPACE_ALIGN;
+}
+// 从工作区取 bytes 字节（64字节对齐），空间不足返回NULL；ws 为NULL时改为堆分配（conv_prepare 等不在推理路径上的调用）
+void *conv_ws_alloc(conv_workspace_t *ws, size_t bytes);
+// 归还 conv_ws_alloc 的结果，p 之后从工作区取的部分一并收回（调用处按分配的逆序或一起归还）；ws 为NULL时 free
+void conv_ws_free(conv_workspace_t *ws, void *p);
+// 用调用者的内存初始化 ws：要求 workspace 按 CONV_WORKSPACE_ALIGN 对齐且不小于 required 字节，否则 CONV_ERR_INVALID
+int conv_workspace_init(conv_workspace_t *ws, void *workspace, size_t workspace_size, size_t required);
+
+// 按算法执行整个batch；packed_weights 非NULL时为 conv_prepare 整理后的权重，此时忽略 weights
+// 假定描述符已通过 conv_desc_check 和 conv_algo_supported，ws 至少有 conv_run_workspace_size 字节
+// 分组卷积（DEPTHWISE 除外）逐个 (分组, 图像) 执行 conv_group_desc 描述的普通卷积，预打包权重按组依次存放
+int conv_run(const conv_desc_t *desc, conv_algo_t algo, const float *input, const float *weights,
+             const float *packed_weights, const float *bias, float *output, conv_workspace_t *ws);
+// conv_run 所需的工作区字节数，prepacked 非0时为使用预打包权重的情况；与当前线程数有关
+size_t conv_run_workspace_size(const conv_desc_t *desc, conv_algo_t algo, int prepacked);
+
+// 低精度卷积（见 conv_lowp.c）：检查 dtype（FP16 / BF16）与描述符，把 CONV_ALGO_AUTO 解析为具体算法
+int conv_lowp_check(const conv_desc_t *desc, conv_dtype_t dtype, conv_algo_t *algo);
+// 与 conv_run 相同，按已解析的算法执行整个batch；packed_weights 非NULL时为 conv_lowp_prepare_weights 的结果，
+// 此时忽略 weights（只有直接卷积会重排权重，Im2col + GEMM 直接使用16位权重）
+int conv_run_lowp(const conv_desc_t *desc, conv_algo_t algo, conv_dtype_t dtype, const void *input,
+                  const void *weights, const float *packed_weights, const float *bias, void *output,
+                  conv_workspace_t *ws);
+size_t conv_run_lowp_workspace_size(const conv_desc_t *desc, conv_algo_t algo, conv_dtype_t dtype, int prepacked);
+// 句柄保存的权重：直接卷积为转换到FP32并重排的权重，Im2col + GEMM 为16位权重的副本；分配失败返回NULL，用 free 释放
+void *conv_lowp_prepare_weights(const conv_desc_t *desc, conv_algo_t algo, conv_dtype_t dtype, const void *weights);
+
+// 分组卷积中单个分组、单张图像的描述符：C_in / groups、C_out / groups，batch = groups = 1
+void conv_group_desc(const conv_desc_t *desc, conv_desc_t *group);
+
+// NCHW下算法整理后的权重（float个数），desc 为普通卷积（groups = 1）或深度卷积；实现见 conv_handle.c
+size_t conv_packed_weights_size(const conv_desc_t *desc, conv_algo_t algo);
+
+// 直接卷积按 (图像, 输出行) 并行，空洞卷积按 (图像, 输出通道) 并行；其余 conv_run_* 处理整个batch，batch折叠进GEMM的N维
+// 所有 conv_run_* 均假定描述符已通过 conv_desc_check 和 conv_algo_supported；
+// 带 ws 的函数从工作区取临时缓冲区，所需字节数由对应的 *_workspace_size 给出
+// prepacked_weights 非NULL时为 conv_direct_prepack_weights 的结果，此时忽略 weights
+int conv_run_direct(const conv_desc_t *desc, const float *input, const float *weights,
+                    const float *prepacked_weights, const float *bias, float *output, conv_workspace_t *ws);
+size_t conv_direct_workspace_size(const conv_desc_t *desc, int prepacked);
+int conv_run_im2col_sgemm(const conv_desc_t *desc, const float *input, const float *weights,
+                          const float *bias, float *output, conv_workspace_t *ws);
+int conv_run_implicit_gemm(const conv_desc_t *desc, const float *input, const float *weights,
+                           const float *bias, float *output, conv_workspace_t *ws);
+int conv_run_winograd(const conv_desc_t *desc, int m, const float *input, const float *weights,
+                      const float *bias, float *output, conv_workspace_t *ws);
+// 权重已由 conv_prepare 按 sgemm_prepack_a 打包
+int conv_run_im2col_sgemm_prepacked(const conv_desc_t *desc, const float *input, const float *packed_weights,
+                                    const float *bias, float *output, conv_workspace_t *ws);
+int conv_run_implicit_gemm_prepacked(const conv_desc_t *desc, const float *input, const float *packed_weights,
+                                     const float *bias, float *output, conv_workspace_t *ws);
+size_t conv_im2col_sgemm_workspace_size(const conv_desc_t *desc, int prepacked);
+size_t conv_implicit_gemm_workspace_size(const conv_desc_t *desc, int prepacked);
+// 逐点卷积（1x1、无补零，stride任意）：输入按stride取样后本身就是GEMM的B矩阵，
+// IM2COL_SGEMM / IMPLICIT_GEMM 打包B时直接从输入读取，不生成im2col矩阵
+static inline int conv_pointwise(const conv_desc_t *desc)
+{
+    return desc->k_size == 1 && desc->padding == 0;
+}
+int conv_run_dilated(const conv_desc_t *desc, const float *input, const float *weights,
+                     const float *bias, float *output);
+// 深度卷积（NCHW），按 (图像, 输出通道) 并行，实现见 conv_depthwise.c
+int conv_run_depthwise(const conv_desc_t *desc, const float *input, const float *weights,
+                       const float *bias, float *output);
+
+// 内部/边界拆分：一维上所有卷积核抽头都落在输入内的输出范围 [lo, hi)
+// 该范围内的输出走无越界检查的快速路径，两侧的窄边界带单独处理（lo == hi 时没有内部区域）
+void conv_interior_range(int input_size, int output_size, int k_size, int stride, int padding, int dilation,
+                         int *lo, int *hi);
+
+// 思路一：直接卷积核 (set1)，支持步长和补零，见 conv_run_direct
+// 内部区域按重排的权重计算（3x3 stride=1 且调度表有SVE内核时交给它，否则为 8输出通道 x 8像素 的寄存器分块），
+// 重排的权重整个batch共用：预打包句柄在 conv_prepare 时重排，否则在工作区中临时重排
+// 重排后的权重（float个数）及重排，格式取决于内部区域使用的内核；低精度直接卷积转换为FP32后使用同样的格式
+size_t conv_direct_packed_size(const conv_desc_t *desc);
+void conv_direct_pack_weights(const conv_desc_t *desc, const float *weights, float *packed);
+// conv_prepare 保存的权重（float个数）及整理：边界像素按OIHW读取的原始权重，之后是内部区域内核的重排权重
+size_t conv_direct_prepacked_size(const conv_desc_t *desc);
+void conv_direct_prepack_weights(const conv_desc_t *desc, const float *weights, float *prepacked);
+// 低精度3x3直接卷积（dilation=1）的一个输出行：输入、输出为 dtype 的16位元素，在FP32中累加；
+// packed_weights 为 conv_direct_pack_weights 重排的FP32权重，rows 为 conv_direct_lowp_rows_size 个float的临时缓冲区
+size_t conv_direct_lowp_rows_size(const conv_desc_t *desc);
+void conv_direct_3x3_lowp_row(const conv_desc_t *desc, conv_dtype_t dtype, const uint16_t *input_feature,
+                              const float *packed_weights, const float *bias, uint16_t *output_feature, int row,
+                              float *rows);
+
+// 思路二：Im2col (set2)，支持步长、补零和空洞，矩阵乘法见 sgemm.h
+float *src_im2col(const float *input_feature, int batch, int input_channel, int input_h, int input_w,
+                  int k_size, int stride, int padding, int dilation, int output_h, int output_w);
+// 元素为 elem_size 字节的im2col（FP32为4，FP16/BF16为2，INT8为1），只搬移数据；
+// 补零部分的每个字节填充 pad_byte：浮点类型为0，INT8为输入的零点（表示实数0）
+// 矩阵从 ws 中分配（ws 为NULL时堆分配），用 conv_ws_free 归还
+void *conv_im2col(conv_workspace_t *ws, const void *input_feature, size_t elem_size, int pad_byte, int batch,
+                  int input_channel, int input_h, int input_w, int k_size, int stride, int padding, int dilation,
+                  int output_h, int output_w);
+
+// 融合后处理（见 conv.h 中的 conv_epilogue_t），实现见 conv_epilogue.c
+// 检查后处理参数，合法返回 CONV_OK
+int conv_epilogue_check(const conv_epilogue_t *epilogue);
+// 激活之后的截断区间：合并了截断区间和 ReLU / ReLU6，不截断的一侧为无穷大
+void conv_epilogue_bounds(const conv_epilogue_t *epilogue, float *lo, float *hi);
+// 对 count 个连续元素加 bias，再按 epilogue 做激活和截断；由写回结果的代码在数据仍在缓存中时调用
+void conv_epilogue_apply(const conv_epilogue_t *epilogue, float bias, float *data, size_t count);
+// 同上，第i个元素加 bias[i]（bias 可以为NULL）；用于通道在最内层的NHWC结果
+void conv_epilogue_apply_channels(const conv_epilogue_t *epilogue, const float *bias, float *data, size_t count);
+// SiLU：data[i] = v / (1 + exp(-v))，v = data[i] + bias；exp 按4个元素一组向量化计算
+void conv_silu(float bias, float *data, size_t count);
+
+// 除偏置之外是否还需要激活或截断
+static inline int conv_epilogue_active(const conv_epilogue_t *epilogue)
+{
+    return epilogue->activation != CONV_ACT_NONE || epilogue->clamp;
+}
+
+// 非NCHW布局（见 conv.h 中的 conv_layout_t），实现见 conv_layout.c
+// 一个通道块的通道数：NCHW为1，NHWC为全部通道，NC4HW4 / NC8HW8 为4 / 8
+int conv_layout_channel_block(conv_layout_t layout, int channel);
+// 该布局下算法是否有专用内核：各布局的 IM2COL_SGEMM / IMPLICIT_GEMM，NC4HW4 / NC8HW8 的 DIRECT（均限 groups = 1），
+// C_out == C_in 的 DEPTHWISE
+int conv_layout_native(const conv_desc_t *desc, conv_algo_t algo);
+// 专用内核整理后的权重（float个数）和整理函数，conv_prepare 调用；只用于 conv_layout_native 的组合
+size_t conv_layout_weights_size(const conv_desc_t *desc, conv_algo_t algo);
+void conv_layout_pack_weights(const conv_desc_t *desc, conv_algo_t algo, const float *weights, float *packed_weights);
+// 非NCHW布局的卷积：有专用内核时直接计算（packed_weights 为NULL时临时整理 weights），
+// 否则把输入转换为NCHW，按 algo 计算后再把输出转换回来；packed_weights 此时为NCHW算法的预打包权重
+int conv_run_layout(const conv_desc_t *desc, conv_algo_t algo, const float *input, const float *weights,
+                    const float *packed_weights, const float *bias, float *output, conv_workspace_t *ws);
+size_t conv_layout_workspace_size(const conv_desc_t *desc, conv_algo_t algo, int prepacked);
+
+// 非NCHW布局的GEMM：像素为行、输出通道为列，C = im2row(input) * W，结果按输出通道块直接写回该布局
+// 权重为 K x C_out 矩阵，K 按 (输入通道块, kh, kw, 块内通道) 排列（NHWC 即HWIO）；
+// 1x1、stride=1、无补零且只有一个输入通道块时输入直接作为A矩阵，实现见 conv_sgemm.c
+size_t conv_layout_gemm_weights_size(const conv_desc_t *desc);
+void conv_layout_gemm_pack_weights(const conv_desc_t *desc, const float *weights, float *packed_weights);
+int conv_run_layout_gemm(const conv_desc_t *desc, const float *input, const float *packed_weights,
+                         const float *bias, float *output, conv_workspace_t *ws);
+size_t conv_layout_gemm_workspace_size(const conv_desc_t *desc);
+
+// NHWC / NC4HW4 / NC8HW8 的深度卷积（C_out == C_in），沿通道向量化，权重为 [通道块][抽头][块内通道]
+size_t conv_depthwise_weights_size(const conv_desc_t *desc);
+void conv_depthwise_pack_weights(const conv_desc_t *desc, const float *weights, float *packed_weights);
+// 偏置补齐到整数个通道块后放在工作区中
+int conv_run_depthwise_channels(const conv_desc_t *desc, const float *input, const float *packed_weights,
+                                const float *bias, float *output, conv_workspace_t *ws);
+size_t conv_depthwise_channels_workspace_size(const conv_desc_t *desc);
+
+// NC4HW4 / NC8HW8 的直接卷积，处理整个batch，实现见 conv_direct_blocked.c
+size_t conv_direct_blocked_weights_size(const conv_desc_t *desc);
+void conv_direct_blocked_pack_weights(const conv_desc_t *desc, const float *weights, float *packed_weights);
+int conv_run_direct_blocked(const conv_desc_t *desc, const float *input, const float *packed_weights,
+                            const float *bias, float *output);
+
+// Winograd F(m x m, 3x3)，m 为2或4
+// 变换后的卷积核为 (m+2)^2 个 C_out x C_in 矩阵，每个按 sgemm_prepack_a 打包
+size_t conv_winograd_filter_size(int m, int output_channel, int input_channel);   // float个数
+// 变换的中间结果从 ws 中分配（conv_prepare 时为NULL，堆分配）
+int conv_winograd_transform_filter(int m, const float *weights, int output_channel, int input_channel,
+                                   float *transformed, conv_workspace_t *ws);
+int conv_winograd_run(const conv_desc_t *desc, int m, const float *transformed_filter,
+                      const float *input, const float *bias, float *output, conv_workspace_t *ws);
+size_t conv_winograd_workspace_size(const conv_desc_t *desc, int m, int prepacked);
+
+// 附加实验：单平面空洞卷积 (set3)，结果累加到 output 上
+void dilated_convolution_2d_acc(const float *input, int input_h, int input_w,
+                                const float *kernel, int kernel_h, int kernel_w,
+                                float *output, int output_h, int output_w,
+                                int dilation, int stride, int padding);
+
+// 单个元素的 FP16 / BF16 <-> FP32 转换，就近舍入到偶数
+// ARM64 上 __fp16 的转换编译为 FCVT（ARMv8 基础指令集），其他架构按位操作
+static inline float conv_fp16_to_fp32(uint16_t h)
+{
+#if defined(__aarch64__)
+    __fp16 v;
+    memcpy(&v, &h, sizeof(v));
+    return (float)v;
+#else
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1f;
+    uint32_t mantissa = h & 0x3ff;
+    uint32_t bits;
+    float f;
+
+    if (exponent == 0x1f) {
+        bits = sign | 0x7f800000 | (mantissa << 13);           // 无穷大、NaN
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else {
+        f = (float)mantissa * (1.0f / 16777216.0f);             // 非规格化数：mantissa * 2^-24
+        return sign ? -f : f;
+    }
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+#endif
+}
+
+static inline uint16_t conv_fp32_to_fp16(float f)
+{
+#if defined(__aarch64__)
+    __fp16 v = (__fp16)f;
+    uint16_t h;
+    memcpy(&h, &v, sizeof(h));
+    return h;
+#else
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    uint32_t abs_bits = bits & 0x7fffffff;
+
+    if (abs_bits >= 0x7f800000) {
+        return sign | 0x7c00 | (abs_bits > 0x7f800000 ? 0x200 : 0);   // 无穷大、NaN
+    }
+    if (abs_bits >= 0x477ff000) {
+        return sign | 0x7c00;                                           // 不小于65520，舍入为无穷大
+    }
+    if (abs_bits < 0x38800000) {
+        // 结果为非规格化数：加0.5后尾数的低位正好是以 2^-24 为单位的值，由浮点加法完成舍入
+        float v;
+        memcpy(&v, &abs_bits, sizeof(v));
+        v += 0.5f;
+        memcpy(&abs_bits, &v, sizeof(v));
+        return sign | (uint16_t)(abs_bits - 0x3f000000);
+    }
+    // 指数偏置从127改为15，低13位就近舍入到偶数
+    abs_bits += 0xc8000fff + ((abs_bits >> 13) & 1);
+    return sign | (uint16_t)(abs_bits >> 13);
+#endif
+}
+
+static inline float conv_bf16_to_fp32(uint16_t h)
+{
+    uint32_t bits = (uint32_t)h << 16;
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static inline uint16_t conv_fp32_to_bf16(float f)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    if ((bits & 0x7fffffff) > 0x7f800000) {
+        return (uint16_t)((bits >> 16) | 0x40);   // NaN 保持为静默NaN
+    }
+    bits += 0x7fff + ((bits >> 16) & 1);
+    return (uint16_t)(bits >> 16);
+}
+
+static inline float conv_lowp_to_fp32(conv_dtype_t dtype, uint16_t h)
+{
+    return dtype == CONV_DTYPE_BF16 ? conv_bf16_to_fp32(h) : conv_fp16_to_fp32(h);
+}
+
+static inline uint16_t conv_fp32_to_lowp(conv_dtype_t dtype, float f)
+{
+    return dtype == CONV_DTYPE_BF16 ? conv_fp32_to_bf16(f) : conv_fp32_to_fp16(f);
+}
+
+#endif // ARM64_CONV_INTERNAL_H
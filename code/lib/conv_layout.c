@@ -0,0 +1,347 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conv_internal.h"
+#include "thread_pool.h"
+
+#ifdef __aarch64__
+#include <arm_neon.h>
+#endif
+
+// 特征图布局与布局转换
+//
+// 四种布局都可以看成通道按 cb 个一块：一张图像中通道 c、像素 p 的位置为
+//   (c / cb) * (H*W*cb) + p * cb + c % cb
+// NCHW 为 cb = 1，NHWC 为 cb = C（只有一块），NC4HW4 / NC8HW8 为 cb = 4 / 8（通道数补齐到cb的倍数）。
+// 转换按4个对齐的通道一组：cb >= 4 时这4个通道在每个像素上连续，cb = 1 时是4个平面，
+// 只有一侧为平面时需要 4x4 转置。
+
+const char *conv_layout_name(conv_layout_t layout)
+{
+    switch (layout) {
+    case CONV_LAYOUT_NCHW:   return "nchw";
+    case CONV_LAYOUT_NHWC:   return "nhwc";
+    case CONV_LAYOUT_NC4HW4: return "nc4hw4";
+    case CONV_LAYOUT_NC8HW8: return "nc8hw8";
+    default:                 return "unknown";
+    }
+}
+
+int conv_layout_channel_block(conv_layout_t layout, int channel)
+{
+    switch (layout) {
+    case CONV_LAYOUT_NHWC:   return channel;
+    case CONV_LAYOUT_NC4HW4: return 4;
+    case CONV_LAYOUT_NC8HW8: return 8;
+    default:                 return 1;
+    }
+}
+
+// 补齐到通道块整数倍后的通道数
+static int padded_channels(conv_layout_t layout, int channel)
+{
+    int cb = conv_layout_channel_block(layout, channel);
+    return (channel + cb - 1) / cb * cb;
+}
+
+size_t conv_layout_size(conv_layout_t layout, int batch, int channel, int h, int w)
+{
+    if (layout < CONV_LAYOUT_NCHW || layout >= CONV_LAYOUT_COUNT || batch <= 0 || channel <= 0 || h <= 0 || w <= 0) {
+        return 0;
+    }
+    return (size_t)batch * padded_channels(layout, channel) * h * w;
+}
+
+// 4x4转置：src 的第i行（行距 src_stride）写到 dst 的第i列（行距 dst_stride）
+static inline void transpose_4x4(const float *src, size_t src_stride, float *dst, size_t dst_stride)
+{
+#ifdef __aarch64__
+    float32x4x2_t t01 = vtrnq_f32(vld1q_f32(src), vld1q_f32(src + src_stride));
+    float32x4x2_t t23 = vtrnq_f32(vld1q_f32(src + 2 * src_stride), vld1q_f32(src + 3 * src_stride));
+    vst1q_f32(dst, vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0])));
+    vst1q_f32(dst + dst_stride, vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1])));
+    vst1q_f32(dst + 2 * dst_stride, vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0])));
+    vst1q_f32(dst + 3 * dst_stride, vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1])));
+#else
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            dst[j * dst_stride + i] = src[i * src_stride + j];
+        }
+    }
+#endif
+}
+
+typedef struct {
+    const float *src;
+    float *dst;
+    conv_layout_t src_layout, dst_layout;
+    int channel, plane;
+    int groups;                    // 每张图像的通道组数（4个通道一组，按目标布局补齐的通道计）
+} layout_task_t;
+
+// 一张图像中通道 c 的第一个像素的位置，相邻像素相距 cb
+static inline size_t channel_offset(int cb, int plane, int c)
+{
+    return (size_t)(c / cb) * plane * cb + c % cb;
+}
+
+// 一个任务转换一张图像中的一组（4个）通道
+static void layout_task(void *ctx, int task, int thread_id)
+{
+    layout_task_t *t = (layout_task_t *)ctx;
+    int image = task / t->groups;
+    int c0 = task % t->groups * 4;
+    int plane = t->plane;
+    int src_cb = conv_layout_channel_block(t->src_layout, t->channel);
+    int dst_cb = conv_layout_channel_block(t->dst_layout, t->channel);
+    const float *src = t->src + (size_t)image * padded_channels(t->src_layout, t->channel) * plane;
+    float *dst = t->dst + (size_t)image * padded_channels(t->dst_layout, t->channel) * plane;
+
+    (void)thread_id;
+    if (c0 + 4 > t->channel) {
+        // 最后不足4个的通道逐个拷贝；超出 channel 的为目标分块布局补齐的通道，写0
+        for (int c = c0; c < c0 + 4; c++) {
+            if (c >= padded_channels(t->dst_layout, t->channel)) {
+                break;
+            }
+            float *d = dst + channel_offset(dst_cb, plane, c);
+            if (c >= t->channel) {
+                for (int p = 0; p < plane; p++) {
+                    d[(size_t)p * dst_cb] = 0.0f;
+                }
+                continue;
+            }
+            const float *s = src + channel_offset(src_cb, plane, c);
+            for (int p = 0; p < plane; p++) {
+                d[(size_t)p * dst_cb] = s[(size_t)p * src_cb];
+            }
+        }
+        return;
+    }
+
+    int p = 0;
+    if (src_cb == 1 && dst_cb == 1) {
+        // NCHW <-> 单通道的NHWC：平面整段拷贝
+        for (int c = c0; c < c0 + 4; c++) {
+            memcpy(dst + (size_t)c * plane, src + (size_t)c * plane, plane * sizeof(float));
+        }
+        return;
+    }
+    if (src_cb == 1) {
+        // 4个平面 -> 每个像素4个连续通道：每次读4个平面的各4个像素，转置后按像素写回
+        const float *s = src + (size_t)c0 * plane;
+        float *d = dst + channel_offset(dst_cb, plane, c0);
+        for (; p + 4 <= plane; p += 4) {
+#ifdef __aarch64__
+            if (dst_cb == 4) {
+                float32x4x4_t v;
+                v.val[0] = vld1q_f32(s + p);
+                v.val[1] = vld1q_f32(s + plane + p);
+                v.val[2] = vld1q_f32(s + 2 * plane + p);
+                v.val[3] = vld1q_f32(s + 3 * plane + p);
+                vst4q_f32(d + (size_t)p * 4, v);
+                continue;
+            }
+#endif
+            transpose_4x4(s + p, plane, d + (size_t)p * dst_cb, dst_cb);
+        }
+        for (; p < plane; p++) {
+            for (int j = 0; j < 4; j++) {
+                d[(size_t)p * dst_cb + j] = s[(size_t)j * plane + p];
+            }
+        }
+    } else if (dst_cb == 1) {
+        // 每个像素4个连续通道 -> 4个平面
+        const float *s = src + channel_offset(src_cb, plane, c0);
+        float *d = dst + (size_t)c0 * plane;
+        for (; p + 4 <= plane; p += 4) {
+#ifdef __aarch64__
+            if (src_cb == 4) {
+                float32x4x4_t v = vld4q_f32(s + (size_t)p * 4);
+                vst1q_f32(d + p, v.val[0]);
+                vst1q_f32(d + plane + p, v.val[1]);
+                vst1q_f32(d + 2 * plane + p, v.val[2]);
+                vst1q_f32(d + 3 * plane + p, v.val[3]);
+                continue;
+            }
+#endif
+            transpose_4x4(s + (size_t)p * src_cb, src_cb, d + p, plane);
+        }
+        for (; p < plane; p++) {
+            for (int j = 0; j < 4; j++) {
+                d[(size_t)j * plane + p] = s[(size_t)p * src_cb + j];
+            }
+        }
+    } else {
+        // 两侧每个像素的4个通道都连续：逐像素拷贝一个向量
+        const float *s = src + channel_offset(src_cb, plane, c0);
+        float *d = dst + channel_offset(dst_cb, plane, c0);
+        for (; p < plane; p++) {
+#ifdef __aarch64__
+            vst1q_f32(d + (size_t)p * dst_cb, vld1q_f32(s + (size_t)p * src_cb));
+#else
+            memcpy(d + (size_t)p * dst_cb, s + (size_t)p * src_cb, 4 * sizeof(float));
+#endif
+        }
+    }
+}
+
+int conv_layout_transform(conv_layout_t src_layout, const float *src, conv_layout_t dst_layout, float *dst,
+                          int batch, int channel, int h, int w)
+{
+    size_t size = conv_layout_size(src_layout, batch, channel, h, w);
+    if (!src || !dst || size == 0 || conv_layout_size(dst_layout, batch, channel, h, w) == 0) {
+        return CONV_ERR_INVALID;
+    }
+    if (src_layout == dst_layout) {
+        memcpy(dst, src, size * sizeof(float));
+        return CONV_OK;
+    }
+
+    layout_task_t t;
+    t.src = src;
+    t.dst = dst;
+    t.src_layout = src_layout;
+    t.dst_layout = dst_layout;
+    t.channel = channel;
+    t.plane = h * w;
+    t.groups = (padded_channels(dst_layout, channel) + 3) / 4;
+    conv_parallel_for(batch * t.groups, layout_task, &t);
+    return CONV_OK;
+}
+
+int conv_layout_native(const conv_desc_t *desc, conv_algo_t algo)
+{
+    if (algo == CONV_ALGO_DEPTHWISE) {
+        return desc->layout != CONV_LAYOUT_NCHW && desc->output_channel == desc->input_channel;
+    }
+    if (desc->groups != 1) {
+        return 0;
+    }
+    switch (desc->layout) {
+    case CONV_LAYOUT_NHWC:
+        return algo == CONV_ALGO_IM2COL_SGEMM || algo == CONV_ALGO_IMPLICIT_GEMM;
+    case CONV_LAYOUT_NC4HW4:
+    case CONV_LAYOUT_NC8HW8:
+        return algo == CONV_ALGO_DIRECT || algo == CONV_ALGO_IM2COL_SGEMM || algo == CONV_ALGO_IMPLICIT_GEMM;
+    default:
+        return 0;
+    }
+}
+
+size_t conv_layout_weights_size(const conv_desc_t *desc, conv_algo_t algo)
+{
+    if (algo == CONV_ALGO_DEPTHWISE) {
+        return conv_depthwise_weights_size(desc);
+    }
+    if (algo == CONV_ALGO_DIRECT) {
+        return conv_direct_blocked_weights_size(desc);
+    }
+    return conv_layout_gemm_weights_size(desc);
+}
+
+void conv_layout_pack_weights(const conv_desc_t *desc, conv_algo_t algo, const float *weights, float *packed_weights)
+{
+    if (algo == CONV_ALGO_DEPTHWISE) {
+        conv_depthwise_pack_weights(desc, weights, packed_weights);
+    } else if (algo == CONV_ALGO_DIRECT) {
+        conv_direct_blocked_pack_weights(desc, weights, packed_weights);
+    } else {
+        conv_layout_gemm_pack_weights(desc, weights, packed_weights);
+    }
+}
+
+// 没有专用内核的算法：输入转换为NCHW，计算后输出转换回来
+// 两份NCHW张量在前，NCHW算法的工作区接在其后
+static void via_nchw_sizes(const conv_desc_t *desc, size_t *input_size, size_t *output_size)
+{
+    *input_size = conv_layout_size(CONV_LAYOUT_NCHW, desc->batch, desc->input_channel, desc->input_h,
+                                   desc->input_w) * sizeof(float);
+    *output_size = conv_layout_size(CONV_LAYOUT_NCHW, desc->batch, desc->output_channel, conv_output_h(desc),
+                                    conv_output_w(desc)) * sizeof(float);
+}
+
+static int run_via_nchw(const conv_desc_t *desc, conv_algo_t algo, const float *input, const float *weights,
+                        const float *packed_weights, const float *bias, float *output, conv_workspace_t *ws)
+{
+    conv_desc_t nchw = *desc;
+    int output_h = conv_output_h(desc);
+    int output_w = conv_output_w(desc);
+    size_t input_size, output_size;
+
+    via_nchw_sizes(desc, &input_size, &output_size);
+    float *input_nchw = (float *)conv_ws_alloc(ws, input_size);
+    float *output_nchw = (float *)conv_ws_alloc(ws, output_size);
+    int ret = CONV_ERR_NOMEM;
+
+    nchw.layout = CONV_LAYOUT_NCHW;
+    if (input_nchw && output_nchw) {
+        conv_layout_transform(desc->layout, input, CONV_LAYOUT_NCHW, input_nchw, desc->batch, desc->input_channel,
+                              desc->input_h, desc->input_w);
+        ret = conv_run(&nchw, algo, input_nchw, weights, packed_weights, bias, output_nchw, ws);
+        if (ret == CONV_OK) {
+            conv_layout_transform(CONV_LAYOUT_NCHW, output_nchw, desc->layout, output, desc->batch,
+                                  desc->output_channel, output_h, output_w);
+        }
+    }
+    conv_ws_free(ws, output_nchw);
+    conv_ws_free(ws, input_nchw);
+    return ret;
+}
+
+size_t conv_layout_workspace_size(const conv_desc_t *desc, conv_algo_t algo, int prepacked)
+{
+    if (!conv_layout_native(desc, algo)) {
+        conv_desc_t nchw = *desc;
+        size_t input_size, output_size;
+
+        via_nchw_sizes(desc, &input_size, &output_size);
+        nchw.layout = CONV_LAYOUT_NCHW;
+        return conv_ws_bytes(input_size) + conv_ws_bytes(output_size) + conv_run_workspace_size(&nchw, algo, prepacked);
+    }
+
+    size_t size = prepacked ? 0 : conv_ws_bytes(conv_layout_weights_size(desc, algo) * sizeof(float));
+    switch (algo) {
+    case CONV_ALGO_DEPTHWISE:
+        return size + conv_depthwise_channels_workspace_size(desc);
+    case CONV_ALGO_DIRECT:
+        return size;
+    default:
+        return size + conv_layout_gemm_workspace_size(desc);
+    }
+}
+
+int conv_run_layout(const conv_desc_t *desc, conv_algo_t algo, const float *input, const float *weights,
+                    const float *packed_weights, const float *bias, float *output, conv_workspace_t *ws)
+{
+    if (!conv_layout_native(desc, algo)) {
+        return run_via_nchw(desc, algo, input, weights, packed_weights, bias, output, ws);
+    }
+
+    // 专用内核：没有预打包的权重时临时整理
+    float *temp = NULL;
+    if (!packed_weights) {
+        temp = (float *)conv_ws_alloc(ws, conv_layout_weights_size(desc, algo) * sizeof(float));
+        if (!temp) {
+            return CONV_ERR_NOMEM;
+        }
+        conv_layout_pack_weights(desc, algo, weights, temp);
+        packed_weights = temp;
+    }
+
+    int ret;
+    switch (algo) {
+    case CONV_ALGO_DEPTHWISE:
+        ret = conv_run_depthwise_channels(desc, input, packed_weights, bias, output, ws);
+        break;
+    case CONV_ALGO_DIRECT:
+        ret = conv_run_direct_blocked(desc, input, packed_weights, bias, output);
+        break;
+    default:
+        ret = conv_run_layout_gemm(desc, input, packed_weights, bias, output, ws);
+        break;
+    }
+    conv_ws_free(ws, temp);
+    return ret;
+}
@@ -0,0 +1,335 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conv_internal.h"
+#include "cpu_dispatch.h"
+#include "hgemm.h"
+#include "thread_pool.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define CONV_LOWP_F16C 1
+#endif
+
+// 低精度卷积：16位存储（FP16 / BF16），FP32累加
+
+const char *conv_dtype_name(conv_dtype_t dtype)
+{
+    switch (dtype) {
+    case CONV_DTYPE_FP32: return "fp32";
+    case CONV_DTYPE_FP16: return "fp16";
+    case CONV_DTYPE_BF16: return "bf16";
+    default:              return "unknown";
+    }
+}
+
+#ifdef CONV_LOWP_F16C
+// F16C 每条指令转换8个元素，舍入方式与标量转换相同（就近舍入到偶数）
+__attribute__((target("avx,f16c")))
+static size_t fp16_from_fp32_f16c(const float *src, uint16_t *dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i *)(dst + i), h);
+    }
+    return i;
+}
+
+__attribute__((target("avx,f16c")))
+static size_t fp16_to_fp32_f16c(const uint16_t *src, float *dst, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(src + i))));
+    }
+    return i;
+}
+#endif
+
+void conv_convert_from_fp32(conv_dtype_t dtype, const float *src, void *dst, size_t count)
+{
+    uint16_t *h = (uint16_t *)dst;
+    size_t i = 0;
+
+    if (dtype == CONV_DTYPE_FP32) {
+        memcpy(dst, src, count * sizeof(float));
+        return;
+    }
+#ifdef CONV_LOWP_F16C
+    if (dtype == CONV_DTYPE_FP16 && (conv_cpu_features() & CONV_CPU_F16C)) {
+        i = fp16_from_fp32_f16c(src, h, count);
+    }
+#endif
+    // ARM64 上 conv_fp32_to_fp16 即 FCVT，编译器会把循环向量化为 FCVTN
+    for (; i < count; i++) {
+        h[i] = conv_fp32_to_lowp(dtype, src[i]);
+    }
+}
+
+void conv_convert_to_fp32(conv_dtype_t dtype, const void *src, float *dst, size_t count)
+{
+    const uint16_t *h = (const uint16_t *)src;
+    size_t i = 0;
+
+    if (dtype == CONV_DTYPE_FP32) {
+        memcpy(dst, src, count * sizeof(float));
+        return;
+    }
+#ifdef CONV_LOWP_F16C
+    if (dtype == CONV_DTYPE_FP16 && (conv_cpu_features() & CONV_CPU_F16C)) {
+        i = fp16_to_fp32_f16c(h, dst, count);
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = conv_lowp_to_fp32(dtype, h[i]);
+    }
+}
+
+// Im2col + HGEMM：im2col矩阵保持16位（大小是FP32的一半），HGEMM在每个线程的FP32条带中累加，
+// 逐块加偏置、做激活和截断后只舍入一次，直接按NCHW写回各图像；batch与FP32路径相同折叠进N维
+static size_t im2col_hgemm_workspace_size(const conv_desc_t *desc, conv_dtype_t dtype)
+{
+    int m = desc->output_channel;
+    size_t k = (size_t)desc->input_channel * desc->k_size * desc->k_size;
+    int n = desc->batch * conv_output_h(desc) * conv_output_w(desc);
+
+    return conv_ws_bytes(k * n * sizeof(uint16_t)) + conv_ws_bytes(hgemm_workspace_size(dtype, m, n));
+}
+
+static int im2col_hgemm(const conv_desc_t *desc, conv_dtype_t dtype, const uint16_t *input,
+                        const uint16_t *weights, const float *bias, uint16_t *output, conv_workspace_t *ws)
+{
+    int output_h = conv_output_h(desc);
+    int output_w = conv_output_w(desc);
+    int k_size = desc->k_size;
+    int m = desc->output_channel;
+    int k = desc->input_channel * k_size * k_size;
+    int plane = output_h * output_w;
+    int n = desc->batch * plane;
+
+    uint16_t *im2col_feature = (uint16_t *)conv_im2col(ws, input, sizeof(uint16_t), 0, desc->batch,
+                                                       desc->input_channel, desc->input_h, desc->input_w, k_size,
+                                                       desc->stride, desc->padding, desc->dilation, output_h, output_w);
+    if (!im2col_feature) {
+        return CONV_ERR_NOMEM;
+    }
+    void *workspace = conv_ws_alloc(ws, hgemm_workspace_size(dtype, m, n));
+    if (!workspace) {
+        conv_ws_free(ws, im2col_feature);
+        return CONV_ERR_NOMEM;
+    }
+
+    int ret = hgemm_blocked(dtype, m, n, k, weights, k, im2col_feature, n, output, plane, plane, (size_t)m * plane,
+                            bias, &desc->epilogue, workspace);
+    conv_ws_free(ws, workspace);
+    conv_ws_free(ws, im2col_feature);
+    return ret;
+}
+
+// 直接卷积按 (图像, 输出行) 并行，每个线程一份转换后的输入行缓冲区
+typedef struct {
+    const conv_desc_t *desc;
+    conv_dtype_t dtype;
+    const uint16_t *input;
+    const float *packed_weights;
+    const float *bias;
+    uint16_t *output;
+    float *rows;
+    size_t rows_stride;          // 相邻线程的缓冲区间距（float个数）
+    size_t input_size, output_size;
+    int output_h;
+} lowp_row_task_t;
+
+static void lowp_row_task(void *ctx, int task, int thread_id)
+{
+    lowp_row_task_t *t = (lowp_row_task_t *)ctx;
+    int image = task / t->output_h;
+
+    conv_direct_3x3_lowp_row(t->desc, t->dtype, t->input + image * t->input_size, t->packed_weights, t->bias,
+                             t->output + image * t->output_size, task % t->output_h,
+                             t->rows + (size_t)thread_id * t->rows_stride);
+}
+
+// 未预打包时先取重排权重的空间，FP32权重的临时副本用完归还后，其位置再分给各线程的行缓冲区
+static size_t direct_lowp_workspace_size(const conv_desc_t *desc, int prepacked)
+{
+    size_t rows = (size_t)conv_parallel_threads() * conv_ws_bytes(conv_direct_lowp_rows_size(desc) * sizeof(float));
+    size_t weights = conv_ws_bytes((size_t)desc->output_channel * desc->input_channel * 9 * sizeof(float));
+
+    if (prepacked) {
+        return rows;
+    }
+    return conv_direct_workspace_size(desc, 0) + (weights > rows ? weights : rows);
+}
+
+static int direct_lowp(const conv_desc_t *desc, conv_dtype_t dtype, const uint16_t *input, const uint16_t *weights,
+                       const float *packed_weights, const float *bias, uint16_t *output, conv_workspace_t *ws)
+{
+    lowp_row_task_t t;
+    float *packed = NULL;
+
+    if (!packed_weights) {
+        size_t count = (size_t)desc->output_channel * desc->input_channel * 9;
+        packed = (float *)conv_ws_alloc(ws, conv_direct_workspace_size(desc, 0));
+        float *weights_fp32 = (float *)conv_ws_alloc(ws, count * sizeof(float));
+        if (!packed || !weights_fp32) {
+            conv_ws_free(ws, weights_fp32);
+            conv_ws_free(ws, packed);
+            return CONV_ERR_NOMEM;
+        }
+        conv_convert_to_fp32(dtype, weights, weights_fp32, count);
+        conv_direct_pack_weights(desc, weights_fp32, packed);
+        conv_ws_free(ws, weights_fp32);
+        packed_weights = packed;
+    }
+
+    t.rows_stride = conv_ws_bytes(conv_direct_lowp_rows_size(desc) * sizeof(float)) / sizeof(float);
+    t.rows = (float *)conv_ws_alloc(ws, (size_t)conv_parallel_threads() * t.rows_stride * sizeof(float));
+    if (!t.rows) {
+        conv_ws_free(ws, packed);
+        return CONV_ERR_NOMEM;
+    }
+    t.desc = desc;
+    t.dtype = dtype;
+    t.input = input;
+    t.packed_weights = packed_weights;
+    t.bias = bias;
+    t.output = output;
+    t.output_h = conv_output_h(desc);
+    t.input_size = (size_t)desc->input_channel * desc->input_h * desc->input_w;
+    t.output_size = (size_t)desc->output_channel * t.output_h * conv_output_w(desc);
+    conv_parallel_for(desc->batch * t.output_h, lowp_row_task, &t);
+
+    conv_ws_free(ws, t.rows);
+    conv_ws_free(ws, packed);
+    return CONV_OK;
+}
+
+int conv_lowp_check(const conv_desc_t *desc, conv_dtype_t dtype, conv_algo_t *algo)
+{
+    if (dtype != CONV_DTYPE_FP16 && dtype != CONV_DTYPE_BF16) {
+        return CONV_ERR_INVALID;
+    }
+    int ret = conv_desc_check(desc);
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    if (desc->layout != CONV_LAYOUT_NCHW || desc->groups != 1) {
+        return CONV_ERR_UNSUPPORTED;
+    }
+
+    int direct_ok = desc->k_size == 3 && desc->dilation == 1;
+    if (*algo == CONV_ALGO_AUTO) {
+        *algo = direct_ok && conv_select_algo(desc) == CONV_ALGO_DIRECT ? CONV_ALGO_DIRECT : CONV_ALGO_IM2COL_SGEMM;
+    }
+    if (*algo != CONV_ALGO_IM2COL_SGEMM && (*algo != CONV_ALGO_DIRECT || !direct_ok)) {
+        return CONV_ERR_UNSUPPORTED;
+    }
+    return CONV_OK;
+}
+
+size_t conv_run_lowp_workspace_size(const conv_desc_t *desc, conv_algo_t algo, conv_dtype_t dtype, int prepacked)
+{
+    return algo == CONV_ALGO_DIRECT ? direct_lowp_workspace_size(desc, prepacked)
+                                    : im2col_hgemm_workspace_size(desc, dtype);
+}
+
+int conv_run_lowp(const conv_desc_t *desc, conv_algo_t algo, conv_dtype_t dtype, const void *input,
+                  const void *weights, const float *packed_weights, const float *bias, void *output,
+                  conv_workspace_t *ws)
+{
+    if (algo == CONV_ALGO_DIRECT) {
+        return direct_lowp(desc, dtype, (const uint16_t *)input, (const uint16_t *)weights, packed_weights, bias,
+                           (uint16_t *)output, ws);
+    }
+    return im2col_hgemm(desc, dtype, (const uint16_t *)input, (const uint16_t *)weights, bias, (uint16_t *)output,
+                        ws);
+}
+
+size_t conv_lowp_workspace_size(const conv_desc_t *desc, conv_algo_t algo, conv_dtype_t dtype)
+{
+    if (dtype == CONV_DTYPE_FP32) {
+        return conv_workspace_size(desc, algo);
+    }
+    if (conv_lowp_check(desc, dtype, &algo) != CONV_OK) {
+        return 0;
+    }
+    return conv_run_lowp_workspace_size(desc, algo, dtype, 0);
+}
+
+int conv2d_lowp_ws(const conv_desc_t *desc, conv_algo_t algo, conv_dtype_t dtype, const void *input,
+                   const void *weights, const float *bias, void *output, void *workspace, size_t workspace_size)
+{
+    conv_workspace_t ws;
+
+    if (dtype == CONV_DTYPE_FP32) {
+        return conv2d_ws(desc, algo, (const float *)input, (const float *)weights, bias, (float *)output, workspace,
+                         workspace_size);
+    }
+    int ret = conv_lowp_check(desc, dtype, &algo);
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    if (!input || !weights || !output) {
+        return CONV_ERR_INVALID;
+    }
+    ret = conv_workspace_init(&ws, workspace, workspace_size, conv_run_lowp_workspace_size(desc, algo, dtype, 0));
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    return conv_run_lowp(desc, algo, dtype, input, weights, NULL, bias, output, &ws);
+}
+
+int conv2d_lowp(const conv_desc_t *desc, conv_algo_t algo, conv_dtype_t dtype,
+                const void *input, const void *weights, const float *bias, void *output)
+{
+    conv_workspace_t ws;
+
+    if (dtype == CONV_DTYPE_FP32) {
+        return conv2d(desc, algo, (const float *)input, (const float *)weights, bias, (float *)output);
+    }
+    int ret = conv_lowp_check(desc, dtype, &algo);
+    if (ret != CONV_OK) {
+        return ret;
+    }
+    if (!input || !weights || !output) {
+        return CONV_ERR_INVALID;
+    }
+
+    // 整个调用只分配一次工作区
+    size_t size = conv_run_lowp_workspace_size(desc, algo, dtype, 0);
+    void *workspace = conv_ws_alloc(NULL, size);
+    if (!workspace) {
+        return CONV_ERR_NOMEM;
+    }
+    conv_workspace_init(&ws, workspace, size, size);
+    ret = conv_run_lowp(desc, algo, dtype, input, weights, NULL, bias, output, &ws);
+    conv_ws_free(NULL, workspace);
+    return ret;
+}
+
+void *conv_lowp_prepare_weights(const conv_desc_t *desc, conv_algo_t algo, conv_dtype_t dtype, const void *weights)
+{
+    size_t count = (size_t)desc->output_channel * desc->input_channel * desc->k_size * desc->k_size;
+
+    if (algo != CONV_ALGO_DIRECT) {
+        void *copy = conv_ws_alloc(NULL, count * sizeof(uint16_t));
+        if (copy) {
+            memcpy(copy, weights, count * sizeof(uint16_t));
+        }
+        return copy;
+    }
+    float *packed = (float *)conv_ws_alloc(NULL, conv_direct_packed_size(desc) * sizeof(float));
+    float *weights_fp32 = (float *)conv_ws_alloc(NULL, count * sizeof(float));
+    if (packed && weights_fp32) {
+        conv_convert_to_fp32(dtype, weights, weights_fp32, count);
+        conv_direct_pack_weights(desc, weights_fp32, packed);
+    } else {
+        conv_ws_free(NULL, packed);
+        packed = NULL;
+    }
+    conv_ws_free(NULL, weights_fp32);
+    return packed;
+}
@@ -0,0 +1,894 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conv_internal.h"
+#include "sgemm.h"
+#include "thread_pool.h"
+
+#ifdef __aarch64__
+#include <arm_neon.h>
+#endif
+
+// 思路二：Im2col + SGEMM (移植自 set2)
+
+// 生成im2col矩阵的列块：图像 [image0, image0 + batch) 中输出行 [row0, row1) 的像素，
+// 完整的矩阵即 image0 = 0、row0 = 0、row1 = output_h
+typedef struct {
+    const char *input_feature;
+    char *im2col_feature;
+    size_t elem_size;        // 每个元素的字节数
+    int pad_byte;            // 补零部分每个字节的值
+    int image0, batch;
+    int row0, row1;
+    int input_channel, input_h, input_w;
+    int k_size;
+    int stride, padding, dilation;
+    int output_h, output_w;
+} im2col_task_t;
+
+// 输入坐标 o * stride + offset 落在 [0, input_size) 内的输出范围 [lo, hi)
+// stride=1 时不做除法（通道多、图像小时每个任务只有几行，除法占了相当一部分时间）
+static void tap_valid_range(int input_size, int output_size, int stride, int offset, int *lo, int *hi)
+{
+    if (stride == 1) {
+        *lo = offset >= 0 ? 0 : -offset;
+        *hi = input_size - offset > 0 ? input_size - offset : 0;
+    } else {
+        *lo = offset >= 0 ? 0 : (-offset + stride - 1) / stride;
+        *hi = input_size - offset > 0 ? (input_size - offset + stride - 1) / stride : 0;
+    }
+    if (*lo > output_size) {
+        *lo = output_size;
+    }
+    if (*hi > output_size) {
+        *hi = output_size;
+    }
+    if (*hi < *lo) {
+        *hi = *lo;
+    }
+}
+
+// im2col按16字节（一个128位向量）搬移数据，ARM64 上为 LDR/STR Q，其余平台为同样宽度的向量类型。
+// 输出行通常只有几十个元素，逐行调用 memcpy / memset 的开销与拷贝本身相当，这里全部内联
+#ifdef __aarch64__
+typedef uint8x16_t im2col_vec_t;
+#else
+typedef uint8_t im2col_vec_t __attribute__((vector_size(16)));
+#endif
+
+static inline im2col_vec_t im2col_load(const char *p)
+{
+#ifdef __aarch64__
+    return vld1q_u8((const uint8_t *)p);
+#else
+    im2col_vec_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+#endif
+}
+
+static inline void im2col_store(char *p, im2col_vec_t v)
+{
+#ifdef __aarch64__
+    vst1q_u8((uint8_t *)p, v);
+#else
+    memcpy(p, &v, sizeof(v));
+#endif
+}
+
+// 拷贝 n 字节：每次4个向量，剩余不足16字节时与前面重叠写最后一个向量；
+// n < 16 时首尾各拷贝8 / 4字节（两段可以重叠）
+static inline void im2col_copy(char *dst, const char *src, size_t n)
+{
+    if (n >= 16) {
+        size_t i = 0;
+        for (; i + 64 <= n; i += 64) {
+            im2col_vec_t v0 = im2col_load(src + i);
+            im2col_vec_t v1 = im2col_load(src + i + 16);
+            im2col_vec_t v2 = im2col_load(src + i + 32);
+            im2col_vec_t v3 = im2col_load(src + i + 48);
+            im2col_store(dst + i, v0);
+            im2col_store(dst + i + 16, v1);
+            im2col_store(dst + i + 32, v2);
+            im2col_store(dst + i + 48, v3);
+        }
+        for (; i + 16 <= n; i += 16) {
+            im2col_store(dst + i, im2col_load(src + i));
+        }
+        if (i < n) {
+            im2col_store(dst + n - 16, im2col_load(src + n - 16));
+        }
+    } else if (n >= 8) {
+        uint64_t head, tail;
+        memcpy(&head, src, 8);
+        memcpy(&tail, src + n - 8, 8);
+        memcpy(dst, &head, 8);
+        memcpy(dst + n - 8, &tail, 8);
+    } else if (n >= 4) {
+        uint32_t head, tail;
+        memcpy(&head, src, 4);
+        memcpy(&tail, src + n - 4, 4);
+        memcpy(dst, &head, 4);
+        memcpy(dst + n - 4, &tail, 4);
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            dst[i] = src[i];
+        }
+    }
+}
+
+static inline im2col_vec_t im2col_splat(int byte)
+{
+#ifdef __aarch64__
+    return vdupq_n_u8((uint8_t)byte);
+#else
+    return (im2col_vec_t){0} + (uint8_t)byte;
+#endif
+}
+
+// n 字节填充 pad_byte，与 im2col_copy 相同：按向量写，不足16字节的尾部重叠写，n < 16 时首尾各写8 / 4字节
+static inline void im2col_fill(char *dst, int pad_byte, size_t n)
+{
+    if (n >= 16) {
+        im2col_vec_t pad = im2col_splat(pad_byte);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16) {
+            im2col_store(dst + i, pad);
+        }
+        if (i < n) {
+            im2col_store(dst + n - 16, pad);
+        }
+    } else if (n >= 8) {
+        uint64_t pad = (uint8_t)pad_byte * 0x0101010101010101ull;
+        memcpy(dst, &pad, 8);
+        memcpy(dst + n - 8, &pad, 8);
+    } else if (n >= 4) {
+        uint32_t pad = (uint8_t)pad_byte * 0x01010101u;
+        memcpy(dst, &pad, 4);
+        memcpy(dst + n - 4, &pad, 4);
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            dst[i] = (char)pad_byte;
+        }
+    }
+}
+
+// 一行 row_bytes 字节的左右补零带 [0, lo) 和 [hi, row_bytes)。补零带不超过16字节时（补零通常只有1~3个元素）
+// 各写一个向量，多写的部分落在中间的有效区域，之后由有效输入覆盖，因此必须在拷贝有效输入之前调用
+static inline void im2col_pad_row(char *dst, size_t row_bytes, size_t lo, size_t hi, int pad_byte)
+{
+    if (row_bytes >= 16 && lo <= 16 && row_bytes - hi <= 16) {
+        im2col_vec_t pad = im2col_splat(pad_byte);
+        if (lo > 0) {
+            im2col_store(dst, pad);
+        }
+        if (hi < row_bytes) {
+            im2col_store(dst + row_bytes - 16, pad);
+        }
+    } else {
+        im2col_fill(dst, pad_byte, lo);
+        im2col_fill(dst + hi, pad_byte, row_bytes - hi);
+    }
+}
+
+// stride=2：dst[j] = src[2 * j]，j < n，元素为 es 字节。ARM64 上用 LD2 解交织，每次输出一个向量；
+// LD2 比所需多读一个元素，最后一组改为逐元素读取，不越过 src[2 * (n - 1)]
+static inline void im2col_gather2(char *dst, const char *src, int n, size_t es)
+{
+    int j = 0;
+
+    if (es == sizeof(float)) {
+        uint32_t *d = (uint32_t *)dst;
+        const uint32_t *s = (const uint32_t *)src;
+#ifdef __aarch64__
+        for (; j + 4 < n; j += 4) {
+            vst1q_u32(d + j, vld2q_u32(s + 2 * j).val[0]);
+        }
+#endif
+        for (; j < n; j++) {
+            d[j] = s[2 * j];
+        }
+    } else if (es == sizeof(uint16_t)) {
+        uint16_t *d = (uint16_t *)dst;
+        const uint16_t *s = (const uint16_t *)src;
+#ifdef __aarch64__
+        for (; j + 8 < n; j += 8) {
+            vst1q_u16(d + j, vld2q_u16(s + 2 * j).val[0]);
+        }
+#endif
+        for (; j < n; j++) {
+            d[j] = s[2 * j];
+        }
+    } else {
+#ifdef __aarch64__
+        for (; j + 16 < n; j += 16) {
+            vst1q_u8((uint8_t *)dst + j, vld2q_u8((const uint8_t *)src + 2 * j).val[0]);
+        }
+#endif
+        for (; j < n; j++) {
+            dst[j] = src[2 * j];
+        }
+    }
+}
+
+// 一个任务生成im2col的一行，对应 (input_filter, row, col)，依次写入块中每张图像的窗口
+// 补零部分按行、列范围整段填充，中间部分不做越界检查：stride=1 整段向量拷贝，
+// 没有左右补零且输入输出同宽时（如 same 补零的中间一列抽头）相邻的行在两侧都连续，合并为一次拷贝；
+// stride=2 用 LD2 解交织；其余步长逐元素读取
+// 只搬移数据，按元素字节数寻址，FP32、16位的低精度类型和INT8共用
+static void im2col_row_task(void *ctx, int task, int thread_id)
+{
+    im2col_task_t *t = (im2col_task_t *)ctx;
+    size_t es = t->elem_size;
+    int k_size = t->k_size;
+    int stride = t->stride;
+    int input_filter = task / (k_size * k_size);
+    int row = task / k_size % k_size;
+    int col = task % k_size;
+    int offset_h = row * t->dilation - t->padding;
+    int offset_w = col * t->dilation - t->padding;
+    size_t input_plane = (size_t)t->input_h * t->input_w;
+    size_t block_plane = (size_t)(t->row1 - t->row0) * t->output_w;
+    size_t row_bytes = (size_t)t->output_w * es;
+    char *dst = t->im2col_feature + (size_t)task * t->batch * block_plane * es;
+    int i_lo, i_hi, j_lo, j_hi;
+
+    (void)thread_id;
+    tap_valid_range(t->input_h, t->output_h, stride, offset_h, &i_lo, &i_hi);
+    tap_valid_range(t->input_w, t->output_w, stride, offset_w, &j_lo, &j_hi);
+    // 有效行裁剪到块的行范围内
+    i_lo = i_lo < t->row0 ? t->row0 : (i_lo > t->row1 ? t->row1 : i_lo);
+    i_hi = i_hi > t->row1 ? t->row1 : (i_hi < i_lo ? i_lo : i_hi);
+    int merge_rows = stride == 1 && j_lo == 0 && j_hi == t->output_w && t->output_w == t->input_w;
+
+    for (int n = 0; n < t->batch; n++) {
+        const char *input_ptr =
+            t->input_feature + ((size_t)(t->image0 + n) * t->input_channel + input_filter) * input_plane * es;
+
+        // 上下补零带
+        im2col_fill(dst, t->pad_byte, (size_t)(i_lo - t->row0) * row_bytes);
+        int i = i_lo;
+        if (merge_rows) {
+            im2col_copy(dst + (size_t)(i_lo - t->row0) * row_bytes,
+                        input_ptr + ((size_t)(i_lo + offset_h) * t->input_w + offset_w) * es,
+                        (size_t)(i_hi - i_lo) * row_bytes);
+            i = i_hi;
+        }
+        for (; i < i_hi; i++) {
+            char *dst_row = dst + (size_t)(i - t->row0) * row_bytes;
+            const char *src = input_ptr + ((size_t)(i * stride + offset_h) * t->input_w + offset_w) * es;
+
+            // 左右补零带，中间为有效输入
+            im2col_pad_row(dst_row, row_bytes, j_lo * es, j_hi * es, t->pad_byte);
+            if (stride == 1) {
+                im2col_copy(dst_row + j_lo * es, src + j_lo * es, (size_t)(j_hi - j_lo) * es);
+            } else if (stride == 2) {
+                im2col_gather2(dst_row + j_lo * es, src + 2 * j_lo * es, j_hi - j_lo, es);
+            } else if (es == sizeof(float)) {
+                for (int j = j_lo; j < j_hi; j++) {
+                    ((float *)dst_row)[j] = ((const float *)src)[j * stride];
+                }
+            } else if (es == sizeof(uint16_t)) {
+                for (int j = j_lo; j < j_hi; j++) {
+                    ((uint16_t *)dst_row)[j] = ((const uint16_t *)src)[j * stride];
+                }
+            } else {
+                for (int j = j_lo; j < j_hi; j++) {
+                    dst_row[j] = src[j * stride];
+                }
+            }
+        }
+        im2col_fill(dst + (size_t)(i_hi - t->row0) * row_bytes, t->pad_byte, (size_t)(t->row1 - i_hi) * row_bytes);
+        dst += block_plane * es;
+    }
+}
+
+// Im2col函数：将输入特征图转换为矩阵形式
+// 矩阵大小：(input_channel * k_size * k_size) x (batch * output_h * output_w)，失败返回NULL
+// batch中的图像沿列方向依次排列；各行互不重叠，按行并行生成
+// 空洞卷积只改变每一行对应的输入偏移（抽头间隔 dilation），生成方式不变
+void *conv_im2col(conv_workspace_t *ws, const void *input_feature, size_t elem_size, int pad_byte, int batch,
+                  int input_channel, int input_h, int input_w, int k_size, int stride, int padding, int dilation,
+                  int output_h, int output_w)
+{
+    im2col_task_t t;
+
+    t.im2col_feature = (char *)conv_ws_alloc(ws, (size_t)input_channel * k_size * k_size * batch * output_h *
+                                                     output_w * elem_size);
+    if (!t.im2col_feature) {
+        return NULL;
+    }
+    t.input_feature = (const char *)input_feature;
+    t.elem_size = elem_size;
+    t.pad_byte = pad_byte;
+    t.image0 = 0;
+    t.batch = batch;
+    t.row0 = 0;
+    t.row1 = output_h;
+    t.input_channel = input_channel;
+    t.input_h = input_h;
+    t.input_w = input_w;
+    t.k_size = k_size;
+    t.stride = stride;
+    t.padding = padding;
+    t.dilation = dilation;
+    t.output_h = output_h;
+    t.output_w = output_w;
+
+    conv_parallel_for(input_channel * k_size * k_size, im2col_row_task, &t);
+
+    return t.im2col_feature;
+}
+
+// 流式im2col的列块：不超过 CONV_IM2COL_BLOCK_BYTES（至少 CONV_IM2COL_MIN_BLOCK_COLS 列）。
+// 一张图像的输出放得下时块由 *images 张完整的图像组成，否则为一张图像中连续的 *rows 个输出行，
+// 两种情况下块内每张图像的列都对应输出中连续的一段，GEMM可以直接写回
+static void im2col_block_shape(const conv_desc_t *desc, int *images, int *rows)
+{
+    int output_h = conv_output_h(desc);
+    int output_w = conv_output_w(desc);
+    size_t k = (size_t)desc->input_channel * desc->k_size * desc->k_size;
+    size_t cols = CONV_IM2COL_BLOCK_BYTES / (k * sizeof(float));
+
+    if (cols < CONV_IM2COL_MIN_BLOCK_COLS) {
+        cols = CONV_IM2COL_MIN_BLOCK_COLS;
+    }
+    if ((size_t)output_h * output_w <= cols) {
+        *images = (int)(cols / ((size_t)output_h * output_w));
+        *images = *images > desc->batch ? desc->batch : *images;
+        *rows = output_h;
+    } else {
+        *images = 1;
+        *rows = (int)(cols / output_w);
+        *rows = *rows < 1 ? 1 : *rows;
+    }
+}
+
+float *src_im2col(const float *input_feature, int batch, int input_channel, int input_h, int input_w,
+                  int k_size, int stride, int padding, int dilation, int output_h, int output_w)
+{
+    return (float *)conv_im2col(NULL, input_feature, sizeof(float), 0, batch, input_channel, input_h, input_w,
+                                k_size, stride, padding, dilation, output_h, output_w);
+}
+
+// 逐点卷积的B矩阵：第 p 行为输入通道 p，列 n 为第 n / (out_h*out_w) 张图像中的一个输出像素，
+// 对应输入像素 (oy * stride, ox * stride)，直接从输入读取
+typedef struct {
+    const float *input_feature;
+    size_t input_image;       // 一张输入图像的大小 C_in * H * W
+    size_t input_plane;       // 一个输入通道的大小 H * W
+    int input_w;
+    int stride;
+    int output_w;
+    int plane;                // 一张图像的输出像素数 out_h * out_w
+} pointwise_b_t;
+
+// 每个NR列微面板先算出各列在输入图像中的偏移（对所有输入通道相同），再逐行写入；
+// stride=1 且微面板不跨图像时各列连续，整段拷贝，否则按偏移收集
+static void pack_pointwise_b(const void *ctx, int k0, int kc, int n0, int nc, float *packed_b)
+{
+    const pointwise_b_t *t = (const pointwise_b_t *)ctx;
+    int nr = sgemm_ukernel()->nr;
+    size_t offset[SGEMM_NR_MAX];
+
+    for (int j = 0; j < nc; j += nr) {
+        int cols = nc - j < nr ? nc - j : nr;
+        for (int c = 0; c < cols; c++) {
+            int col = n0 + j + c;
+            int image = col / t->plane;
+            int pixel = col - image * t->plane;
+            int oy = pixel / t->output_w;
+            int ox = pixel - oy * t->output_w;
+            offset[c] = image * t->input_image + (size_t)oy * t->stride * t->input_w + (size_t)ox * t->stride;
+        }
+        int contiguous = cols == nr && offset[cols - 1] - offset[0] == (size_t)(cols - 1);
+        const float *src = t->input_feature + (size_t)k0 * t->input_plane;
+
+        for (int p = 0; p < kc; p++, src += t->input_plane, packed_b += nr) {
+            if (contiguous) {
+                memcpy(packed_b, src + offset[0], nr * sizeof(float));
+                continue;
+            }
+            for (int c = 0; c < cols; c++) {
+                packed_b[c] = src[offset[c]];
+            }
+            for (int c = cols; c < nr; c++) {
+                packed_b[c] = 0.0f;
+            }
+        }
+    }
+}
+
+// 逐点卷积：B矩阵由 pack_pointwise_b 直接从输入打包，batch同样折叠进N维
+static int pointwise_sgemm(const conv_desc_t *desc, const float *input, const float *weights,
+                           const float *packed_weights, const float *bias, float *output, conv_workspace_t *ws)
+{
+    pointwise_b_t t;
+    int output_w = conv_output_w(desc);
+    int plane = conv_output_h(desc) * output_w;
+
+    t.input_feature = input;
+    t.input_plane = (size_t)desc->input_h * desc->input_w;
+    t.input_image = (size_t)desc->input_channel * t.input_plane;
+    t.input_w = desc->input_w;
+    t.stride = desc->stride;
+    t.output_w = output_w;
+    t.plane = plane;
+
+    int m = desc->output_channel;
+    int k = desc->input_channel;
+    int n = desc->batch * plane;
+    void *workspace = conv_ws_alloc(ws, sgemm_workspace_size(n, packed_weights != NULL));
+    if (!workspace) {
+        return CONV_ERR_NOMEM;
+    }
+    int ret = sgemm_blocked_batched(m, n, k, weights, k, packed_weights, pack_pointwise_b, &t, output, plane, plane,
+                                    (size_t)m * plane, bias, 0, &desc->epilogue, workspace);
+    conv_ws_free(ws, workspace);
+    return ret;
+}
+
+// 整个batch折叠进N维的卷积GEMM：A为权重（M = C_out），B的打包缓冲区从工作区取
+static size_t conv_gemm_workspace_size(const conv_desc_t *desc, int prepacked)
+{
+    return conv_ws_bytes(sgemm_workspace_size(desc->batch * conv_output_h(desc) * conv_output_w(desc), prepacked));
+}
+
+// packed_weights 非NULL时使用预打包的权重（见 conv_prepare），否则每次分块时打包 weights
+// im2col矩阵按列块流式生成（见 im2col_block_shape）：每块生成后立即交给GEMM，打包B时仍在L2中，
+// 临时内存只有一个块，与图像大小和batch无关。小图像时一块包含多张图像，batch仍折叠进GEMM的N维
+static int im2col_sgemm(const conv_desc_t *desc, const float *input, const float *weights,
+                        const float *packed_weights, const float *bias, float *output, conv_workspace_t *ws)
+{
+    int output_h = conv_output_h(desc);
+    int output_w = conv_output_w(desc);
+    int k_size = desc->k_size;
+    int images, rows;
+
+    // 逐点卷积的im2col矩阵就是（按stride取样的）输入本身，不做拷贝
+    if (conv_pointwise(desc)) {
+        return pointwise_sgemm(desc, input, weights, packed_weights, bias, output, ws);
+    }
+
+    int m = desc->output_channel;
+    int k = desc->input_channel * k_size * k_size;
+    int plane = output_h * output_w;
+    im2col_block_shape(desc, &images, &rows);
+    int block_cols = images * rows * output_w;
+    float *block = (float *)conv_ws_alloc(ws, (size_t)k * block_cols * sizeof(float));
+    void *workspace = conv_ws_alloc(ws, sgemm_workspace_size(block_cols, packed_weights != NULL));
+    if (!block || !workspace) {
+        conv_ws_free(ws, workspace);
+        conv_ws_free(ws, block);
+        return CONV_ERR_NOMEM;
+    }
+
+    im2col_task_t t;
+    t.input_feature = (const char *)input;
+    t.im2col_feature = (char *)block;
+    t.elem_size = sizeof(float);
+    t.pad_byte = 0;
+    t.input_channel = desc->input_channel;
+    t.input_h = desc->input_h;
+    t.input_w = desc->input_w;
+    t.k_size = k_size;
+    t.stride = desc->stride;
+    t.padding = desc->padding;
+    t.dilation = desc->dilation;
+    t.output_h = output_h;
+    t.output_w = output_w;
+
+    int ret = CONV_OK;
+    for (int n0 = 0; n0 < desc->batch && ret == CONV_OK; n0 += images) {
+        t.image0 = n0;
+        t.batch = desc->batch - n0 < images ? desc->batch - n0 : images;
+        for (int r0 = 0; r0 < output_h && ret == CONV_OK; r0 += rows) {
+            t.row0 = r0;
+            t.row1 = output_h - r0 < rows ? output_h : r0 + rows;
+
+            // 1. 生成当前块的im2col矩阵：k x (图像数 * 块内像素数)
+            conv_parallel_for(k, im2col_row_task, &t);
+
+            // 2. 矩阵乘法，权重已经是 output_channel x (input_channel * k_size * k_size) 的格式
+            // 块内每张图像的列直接按NCHW写回；偏置、激活和截断在每个结果块写回时完成
+            int image_cols = (t.row1 - t.row0) * output_w;
+            sgemm_dense_b_t dense;
+            dense.b = block;
+            dense.ldb = t.batch * image_cols;
+            ret = sgemm_blocked_batched(m, t.batch * image_cols, k, weights, k, packed_weights, sgemm_pack_dense_b,
+                                        &dense, output + (size_t)n0 * m * plane + (size_t)r0 * output_w, plane,
+                                        image_cols, (size_t)m * plane, bias, 0, &desc->epilogue, workspace);
+        }
+    }
+
+    conv_ws_free(ws, workspace);
+    conv_ws_free(ws, block);
+    return ret;
+}
+
+int conv_run_im2col_sgemm(const conv_desc_t *desc, const float *input, const float *weights,
+                          const float *bias, float *output, conv_workspace_t *ws)
+{
+    return im2col_sgemm(desc, input, weights, NULL, bias, output, ws);
+}
+
+int conv_run_im2col_sgemm_prepacked(const conv_desc_t *desc, const float *input, const float *packed_weights,
+                                    const float *bias, float *output, conv_workspace_t *ws)
+{
+    return im2col_sgemm(desc, input, NULL, packed_weights, bias, output, ws);
+}
+
+// 逐点卷积不生成im2col矩阵，只需要GEMM的打包缓冲区；其余为一个im2col列块和按块宽度的打包缓冲区
+size_t conv_im2col_sgemm_workspace_size(const conv_desc_t *desc, int prepacked)
+{
+    int images, rows;
+
+    if (conv_pointwise(desc)) {
+        return conv_gemm_workspace_size(desc, prepacked);
+    }
+    im2col_block_shape(desc, &images, &rows);
+    size_t block_cols = (size_t)images * rows * conv_output_w(desc);
+    return conv_ws_bytes((size_t)desc->input_channel * desc->k_size * desc->k_size * block_cols * sizeof(float)) +
+           conv_ws_bytes(sgemm_workspace_size((int)block_cols, prepacked));
+}
+
+// 隐式GEMM：B矩阵即im2col矩阵，但不显式生成，分块打包时直接从输入特征图收集
+// 列 n 对应第 n / (out_h*out_w) 张图像中的一个输出像素
+typedef struct {
+    const float *input_feature;
+    size_t input_image;       // 一张输入图像的大小 C_in * H * W
+    int input_h, input_w;
+    int k_size;
+    int stride, padding, dilation;
+    int output_h, output_w;
+} implicit_b_t;
+
+// 向当前微面板行写入一个元素，写满 nr 列后跳到下一个微面板的同一行
+static inline float *panel_put(float *dst, int *lane, int nr, size_t panel_stride, float value)
+{
+    dst[*lane] = value;
+    if (++*lane == nr) {
+        *lane = 0;
+        dst += panel_stride;
+    }
+    return dst;
+}
+
+// 把im2col矩阵的 [k0, k0+kc) 行 x [n0, n0+nc) 列写入NR列微面板
+// 每一行对应一个 (input_filter, kernel_row, kernel_col)，每一列对应一个输出像素
+static void pack_implicit_b(const void *ctx, int k0, int kc, int n0, int nc, float *packed_b)
+{
+    const implicit_b_t *t = (const implicit_b_t *)ctx;
+    int k_size = t->k_size;
+    int stride = t->stride;
+    int input_w = t->input_w;
+    int nr = sgemm_ukernel()->nr;
+    size_t panel_stride = (size_t)kc * nr;
+
+    for (int p = 0; p < kc; p++) {
+        int kidx = k0 + p;
+        int input_filter = kidx / (k_size * k_size);
+        int kernel_row = kidx / k_size % k_size;
+        int kernel_col = kidx % k_size;
+        const float *channel_ptr = t->input_feature + (size_t)input_filter * t->input_h * input_w;
+        int offset_h = kernel_row * t->dilation - t->padding;
+        int offset_w = kernel_col * t->dilation - t->padding;
+
+        // 输入列 ox * stride + offset_w 落在 [0, input_w) 内的输出列范围 [ox_lo, ox_hi)
+        int ox_lo = offset_w >= 0 ? 0 : (-offset_w + stride - 1) / stride;
+        int ox_hi = input_w - offset_w > 0 ? (input_w - offset_w + stride - 1) / stride : 0;
+
+        float *dst = packed_b + (size_t)p * nr;
+        int lane = 0;
+        int oy = n0 / t->output_w;
+        int ox = n0 % t->output_w;
+        int image = oy / t->output_h;
+        oy -= image * t->output_h;
+
+        for (int c = 0; c < nc;) {
+            int seg = t->output_w - ox < nc - c ? t->output_w - ox : nc - c;
+            int iy = oy * stride + offset_h;
+            int q = ox;
+            int q_end = ox + seg;
+
+            // 同一输出行内：左右越界部分补零，中间部分无需逐点检查
+            if (iy >= 0 && iy < t->input_h) {
+                const float *row_ptr = channel_ptr + image * t->input_image + (size_t)iy * input_w;
+                int mid_lo = ox_lo > q ? (ox_lo < q_end ? ox_lo : q_end) : q;
+                int mid_hi = ox_hi < q_end ? (ox_hi > mid_lo ? ox_hi : mid_lo) : q_end;
+                for (; q < mid_lo; q++) {
+                    dst = panel_put(dst, &lane, nr, panel_stride, 0.0f);
+                }
+                for (; q < mid_hi; q++) {
+                    dst = panel_put(dst, &lane, nr, panel_stride, row_ptr[q * stride + offset_w]);
+                }
+            }
+            for (; q < q_end; q++) {
+                dst = panel_put(dst, &lane, nr, panel_stride, 0.0f);
+            }
+            c += seg;
+            ox = 0;
+            if (++oy == t->output_h) {
+                oy = 0;
+                image++;
+            }
+        }
+        // 最后一个微面板不足NR列时补零
+        if (lane > 0) {
+            for (; lane < nr; lane++) {
+                dst[lane] = 0.0f;
+            }
+        }
+    }
+}
+
+static int implicit_gemm(const conv_desc_t *desc, const float *input, const float *weights,
+                         const float *packed_weights, const float *bias, float *output, conv_workspace_t *ws)
+{
+    implicit_b_t t;
+    int output_h = conv_output_h(desc);
+    int output_w = conv_output_w(desc);
+    int k_size = desc->k_size;
+
+    // 逐点卷积无需逐元素判断越界，按微面板整段打包
+    if (conv_pointwise(desc)) {
+        return pointwise_sgemm(desc, input, weights, packed_weights, bias, output, ws);
+    }
+
+    t.input_feature = input;
+    t.input_image = (size_t)desc->input_channel * desc->input_h * desc->input_w;
+    t.input_h = desc->input_h;
+    t.input_w = desc->input_w;
+    t.k_size = k_size;
+    t.stride = desc->stride;
+    t.padding = desc->padding;
+    t.dilation = desc->dilation;
+    t.output_h = output_h;
+    t.output_w = output_w;
+
+    // 与 im2col_sgemm 相同，batch折叠进N维，后处理在结果块写回时完成
+    int m = desc->output_channel;
+    int k = desc->input_channel * k_size * k_size;
+    int plane = output_h * output_w;
+    int n = desc->batch * plane;
+    void *workspace = conv_ws_alloc(ws, sgemm_workspace_size(n, packed_weights != NULL));
+    if (!workspace) {
+        return CONV_ERR_NOMEM;
+    }
+    int ret = sgemm_blocked_batched(m, n, k, weights, k, packed_weights, pack_implicit_b, &t, output, plane, plane,
+                                    (size_t)m * plane, bias, 0, &desc->epilogue, workspace);
+    conv_ws_free(ws, workspace);
+    return ret;
+}
+
+int conv_run_implicit_gemm(const conv_desc_t *desc, const float *input, const float *weights,
+                           const float *bias, float *output, conv_workspace_t *ws)
+{
+    return implicit_gemm(desc, input, weights, NULL, bias, output, ws);
+}
+
+int conv_run_implicit_gemm_prepacked(const conv_desc_t *desc, const float *input, const float *packed_weights,
+                                     const float *bias, float *output, conv_workspace_t *ws)
+{
+    return implicit_gemm(desc, input, NULL, packed_weights, bias, output, ws);
+}
+
+size_t conv_implicit_gemm_workspace_size(const conv_desc_t *desc, int prepacked)
+{
+    return conv_gemm_workspace_size(desc, prepacked);
+}
+
+// 非NCHW布局的GEMM：像素为GEMM的行（M）、输出通道为列（N = C_out），
+// 输入按通道块 cb 存放（NHWC 的 cb 为全部通道），K 按 (输入通道块, kh, kw, 块内通道) 排列，
+// im2row 的每个 (通道块, 抽头) 是 cb 个连续的float，整段拷贝或整段补零。
+// C = im2row(input) * W 的第 p 行正是输出像素 p 的各个通道：
+//   NHWC:           行距 C_out，batch中的图像首尾相接，整个batch一次矩阵乘法
+//   NC4HW4 / NC8HW8: 每 cb 列为一组写回各自的通道块平面（sgemm 的 c_batch_cols / c_batch_stride），
+//                   行距 cb，逐张图像计算
+// 偏置对应列，激活和截断同样在每个结果块写回时完成
+typedef struct {
+    int input_cb, output_cb;        // 输入、输出的通道块大小
+    int input_blocks, output_blocks;
+    int k;                          // K = input_blocks * k * k * input_cb
+} layout_gemm_shape_t;
+
+static void layout_gemm_shape(const conv_desc_t *desc, layout_gemm_shape_t *g)
+{
+    g->input_cb = conv_layout_channel_block(desc->layout, desc->input_channel);
+    g->output_cb = conv_layout_channel_block(desc->layout, desc->output_channel);
+    g->input_blocks = (desc->input_channel + g->input_cb - 1) / g->input_cb;
+    g->output_blocks = (desc->output_channel + g->output_cb - 1) / g->output_cb;
+    g->k = g->input_blocks * desc->k_size * desc->k_size * g->input_cb;
+}
+
+size_t conv_layout_gemm_weights_size(const conv_desc_t *desc)
+{
+    layout_gemm_shape_t g;
+    layout_gemm_shape(desc, &g);
+    return (size_t)g.k * desc->output_channel;
+}
+
+// OIHW -> K x C_out，第 ((ib * k + kh) * k + kw) * cb + i 行对应输入通道 ib * cb + i，补齐的通道为0
+// NHWC 时即 (k*k*C_in) x C_out 的HWIO矩阵
+void conv_layout_gemm_pack_weights(const conv_desc_t *desc, const float *weights, float *packed_weights)
+{
+    layout_gemm_shape_t g;
+    int taps = desc->k_size * desc->k_size;
+    int n = desc->output_channel;
+
+    layout_gemm_shape(desc, &g);
+    memset(packed_weights, 0, conv_layout_gemm_weights_size(desc) * sizeof(float));
+    for (int oc = 0; oc < n; oc++) {
+        for (int ic = 0; ic < desc->input_channel; ic++) {
+            const float *src = weights + ((size_t)oc * desc->input_channel + ic) * taps;
+            float *dst = packed_weights + ((size_t)(ic / g.input_cb) * taps * g.input_cb + ic % g.input_cb) * n + oc;
+            for (int tap = 0; tap < taps; tap++) {
+                dst[(size_t)tap * g.input_cb * n] = src[tap];
+            }
+        }
+    }
+}
+
+typedef struct {
+    const float *input;             // 当前图像（NHWC为整个batch）
+    float *im2row;
+    int row0;                       // 当前分块的第一个像素
+    int rows;
+    int cb, input_blocks;
+    int input_h, input_w;
+    int k_size;
+    int stride, padding, dilation;
+    int output_h, output_w;
+} im2row_task_t;
+
+#define IM2ROW_TASK_ROWS 32
+
+static void im2row_task(void *ctx, int task, int thread_id)
+{
+    im2row_task_t *t = (im2row_task_t *)ctx;
+    int cb = t->cb;
+    size_t block_plane = (size_t)t->input_h * t->input_w * cb;
+    size_t row_size = (size_t)t->input_blocks * t->k_size * t->k_size * cb;
+    int r0 = task * IM2ROW_TASK_ROWS;
+    int r1 = r0 + IM2ROW_TASK_ROWS < t->rows ? r0 + IM2ROW_TASK_ROWS : t->rows;
+
+    (void)thread_id;
+    for (int r = r0; r < r1; r++) {
+        int pixel = t->row0 + r;
+        int ox = pixel % t->output_w;
+        int oy = pixel / t->output_w % t->output_h;
+        int image = pixel / t->output_w / t->output_h;
+        const float *input = t->input + (size_t)image * t->input_blocks * block_plane;
+        float *dst = t->im2row + (size_t)r * row_size;
+
+        for (int ib = 0; ib < t->input_blocks; ib++) {
+            const float *block = input + ib * block_plane;
+            for (int kh = 0; kh < t->k_size; kh++) {
+                int iy = oy * t->stride - t->padding + kh * t->dilation;
+                for (int kw = 0; kw < t->k_size; kw++) {
+                    int ix = ox * t->stride - t->padding + kw * t->dilation;
+                    if (iy >= 0 && iy < t->input_h && ix >= 0 && ix < t->input_w) {
+                        memcpy(dst, block + ((size_t)iy * t->input_w + ix) * cb, cb * sizeof(float));
+                    } else {
+                        memset(dst, 0, cb * sizeof(float));
+                    }
+                    dst += cb;
+                }
+            }
+        }
+    }
+}
+
+// 1x1、stride=1、无补零且只有一个输入通道块：输入本身就是 M x K 的A矩阵，不需要im2row
+static int layout_gemm_zero_copy(const conv_desc_t *desc, const layout_gemm_shape_t *g)
+{
+    return desc->k_size == 1 && desc->stride == 1 && desc->padding == 0 && g->input_blocks == 1;
+}
+
+// im2row按行分块生成，每块不超过 CONV_IM2ROW_MAX_BYTES；块太小时B的打包开销占比过大，至少 CONV_IM2ROW_MIN_CHUNK_ROWS 行
+static int layout_gemm_chunk_rows(const conv_desc_t *desc, const layout_gemm_shape_t *g)
+{
+    int plane = conv_output_h(desc) * conv_output_w(desc);
+    int m = desc->layout == CONV_LAYOUT_NHWC ? desc->batch * plane : plane;
+    int chunk = (int)(CONV_IM2ROW_MAX_BYTES / ((size_t)g->k * sizeof(float)));
+
+    if (chunk < CONV_IM2ROW_MIN_CHUNK_ROWS) {
+        chunk = CONV_IM2ROW_MIN_CHUNK_ROWS;
+    }
+    return chunk > m ? m : chunk;
+}
+
+size_t conv_layout_gemm_workspace_size(const conv_desc_t *desc)
+{
+    layout_gemm_shape_t g;
+    size_t im2row_size = 0;
+
+    layout_gemm_shape(desc, &g);
+    if (!layout_gemm_zero_copy(desc, &g)) {
+        im2row_size = conv_ws_bytes((size_t)layout_gemm_chunk_rows(desc, &g) * g.k * sizeof(float));
+    }
+    return im2row_size + conv_ws_bytes(sgemm_workspace_size(desc->output_channel, 0));
+}
+
+int conv_run_layout_gemm(const conv_desc_t *desc, const float *input, const float *packed_weights,
+                         const float *bias, float *output, conv_workspace_t *ws)
+{
+    layout_gemm_shape_t g;
+    int k_size = desc->k_size;
+    int plane = conv_output_h(desc) * conv_output_w(desc);
+    int n = desc->output_channel;
+    int nhwc = desc->layout == CONV_LAYOUT_NHWC;
+    sgemm_dense_b_t dense;
+
+    layout_gemm_shape(desc, &g);
+    dense.b = packed_weights;
+    dense.ldb = n;
+    int k = g.k;
+    size_t input_image = (size_t)g.input_blocks * desc->input_h * desc->input_w * g.input_cb;
+    size_t output_image = (size_t)g.output_blocks * plane * g.output_cb;
+    // NHWC整个batch作为一个矩阵；分块布局的输出每张图像单独写回
+    int images = nhwc ? 1 : desc->batch;
+    int m = nhwc ? desc->batch * plane : plane;
+    size_t c_block_stride = (size_t)plane * g.output_cb;
+    int ret = CONV_OK;
+
+    if (layout_gemm_zero_copy(desc, &g)) {
+        void *workspace = conv_ws_alloc(ws, sgemm_workspace_size(n, 0));
+        if (!workspace) {
+            return CONV_ERR_NOMEM;
+        }
+        for (int image = 0; image < images && ret == CONV_OK; image++) {
+            ret = sgemm_blocked_batched(m, n, k, input + image * input_image, k, NULL, sgemm_pack_dense_b, &dense,
+                                        output + image * output_image, g.output_cb, g.output_cb, c_block_stride,
+                                        bias, 1, &desc->epilogue, workspace);
+        }
+        conv_ws_free(ws, workspace);
+    } else {
+        int chunk = layout_gemm_chunk_rows(desc, &g);
+        im2row_task_t t;
+        t.im2row = (float *)conv_ws_alloc(ws, (size_t)chunk * k * sizeof(float));
+        void *workspace = conv_ws_alloc(ws, sgemm_workspace_size(n, 0));
+        if (!t.im2row || !workspace) {
+            conv_ws_free(ws, workspace);
+            conv_ws_free(ws, t.im2row);
+            return CONV_ERR_NOMEM;
+        }
+        t.cb = g.input_cb;
+        t.input_blocks = g.input_blocks;
+        t.input_h = desc->input_h;
+        t.input_w = desc->input_w;
+        t.k_size = k_size;
+        t.stride = desc->stride;
+        t.padding = desc->padding;
+        t.dilation = desc->dilation;
+        t.output_h = conv_output_h(desc);
+        t.output_w = conv_output_w(desc);
+
+        for (int image = 0; image < images && ret == CONV_OK; image++) {
+            t.input = input + image * input_image;
+            for (int row0 = 0; row0 < m && ret == CONV_OK; row0 += chunk) {
+                t.row0 = row0;
+                t.rows = m - row0 < chunk ? m - row0 : chunk;
+                conv_parallel_for((t.rows + IM2ROW_TASK_ROWS - 1) / IM2ROW_TASK_ROWS, im2row_task, &t);
+                ret = sgemm_blocked_batched(t.rows, n, k, t.im2row, k, NULL, sgemm_pack_dense_b, &dense,
+                                            output + image * output_image + (size_t)row0 * g.output_cb, g.output_cb,
+                                            g.output_cb, c_block_stride, bias, 1, &desc->epilogue, workspace);
+            }
+        }
+        conv_ws_free(ws, workspace);
+        conv_ws_free(ws, t.im2row);
+    }
+
+    // 最后一个输出通道块中补齐的通道不属于GEMM的列，写0
+    int valid = n - (g.output_blocks - 1) * g.output_cb;
+    if (ret == CONV_OK && valid < g.output_cb) {
+        for (int image = 0; image < images; image++) {
+            float *block = output + image * output_image + (g.output_blocks - 1) * c_block_stride;
+            for (int p = 0; p < plane; p++) {
+                memset(block + (size_t)p * g.output_cb + valid, 0, (g.output_cb - valid) * sizeof(float));
+            }
+        }
+    }
+    return ret;
+}
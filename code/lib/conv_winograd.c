@@ -0,0 +1,508 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conv_internal.h"
+#include "sgemm.h"
+#include "thread_pool.h"
+
+#ifdef __aarch64__
+#include <arm_neon.h>
+#endif
+
+// Winograd快速卷积 F(2x2,3x3) / F(4x4,3x3)，只用于 3x3、stride=1、dilation=1
+//
+// 输出按 m x m 分块（tile），每个tile读取 alpha x alpha (alpha = m + 2) 的输入：
+//   U = G g G^T          卷积核变换，每对 (oc, ic) 一次
+//   V = B^T d B          输入变换，每个 (ic, tile) 一次
+//   M[xi] = U[xi] * V[xi] alpha^2 个独立的矩阵乘法 (C_out x C_in) * (C_in x tiles)，交给SGEMM引擎
+//   Y = A^T M A          输出变换，每个 (oc, tile) 一次
+// 乘法次数相对直接卷积减少到 1/2.25 (F2) 和 1/4 (F4)。
+//
+// 输入/输出变换一次处理同一行中相邻的4个tile，每个向量的4个通道分别对应4个tile。
+// ARM64上用 vld4q/vld2q 按tile步长解交织读取输入，用 vst4q/vst2q 交织写回输出。
+
+#ifdef __aarch64__
+typedef float32x4_t wino_vec_t;
+#else
+typedef float wino_vec_t __attribute__((vector_size(16)));
+#endif
+
+#define WINO_MAX_ALPHA 6
+
+static inline wino_vec_t wino_dup(float x)
+{
+#ifdef __aarch64__
+    return vdupq_n_f32(x);
+#else
+    wino_vec_t v = {x, x, x, x};
+    return v;
+#endif
+}
+
+// 一维输入变换 B^T d
+static inline void input_transform_f2(const wino_vec_t *d, wino_vec_t *t)
+{
+    t[0] = d[0] - d[2];
+    t[1] = d[1] + d[2];
+    t[2] = d[2] - d[1];
+    t[3] = d[1] - d[3];
+}
+
+static inline void input_transform_f4(const wino_vec_t *d, wino_vec_t *t)
+{
+    const wino_vec_t c2 = wino_dup(2.0f);
+    const wino_vec_t c4 = wino_dup(4.0f);
+    const wino_vec_t c5 = wino_dup(5.0f);
+
+    t[0] = c4 * d[0] - c5 * d[2] + d[4];
+    t[1] = d[3] + d[4] - c4 * (d[1] + d[2]);
+    t[2] = c4 * (d[1] - d[2]) + d[4] - d[3];
+    t[3] = c2 * (d[3] - d[1]) + d[4] - d[2];
+    t[4] = c2 * (d[1] - d[3]) + d[4] - d[2];
+    t[5] = c4 * d[1] - c5 * d[3] + d[5];
+}
+
+// 一维输出变换 A^T m
+static inline void output_transform_f2(const wino_vec_t *m, wino_vec_t *y)
+{
+    y[0] = m[0] + m[1] + m[2];
+    y[1] = m[1] - m[2] - m[3];
+}
+
+static inline void output_transform_f4(const wino_vec_t *m, wino_vec_t *y)
+{
+    const wino_vec_t c2 = wino_dup(2.0f);
+    const wino_vec_t c4 = wino_dup(4.0f);
+    const wino_vec_t c8 = wino_dup(8.0f);
+    wino_vec_t s12 = m[1] + m[2];
+    wino_vec_t d12 = m[1] - m[2];
+    wino_vec_t s34 = m[3] + m[4];
+    wino_vec_t d34 = m[3] - m[4];
+
+    y[0] = m[0] + s12 + s34;
+    y[1] = d12 + c2 * d34;
+    y[2] = s12 + c4 * s34;
+    y[3] = d12 + c8 * d34 + m[5];
+}
+
+// 一维卷积核变换 G g
+static void filter_transform_1d(int m, const float *g, int g_stride, float *u, int u_stride)
+{
+    float g0 = g[0], g1 = g[g_stride], g2 = g[2 * g_stride];
+
+    if (m == 2) {
+        u[0] = g0;
+        u[u_stride] = (g0 + g1 + g2) * 0.5f;
+        u[2 * u_stride] = (g0 - g1 + g2) * 0.5f;
+        u[3 * u_stride] = g2;
+    } else {
+        u[0] = g0 * 0.25f;
+        u[u_stride] = -(g0 + g1 + g2) / 6.0f;
+        u[2 * u_stride] = -(g0 - g1 + g2) / 6.0f;
+        u[3 * u_stride] = g0 / 24.0f + g1 / 12.0f + g2 / 6.0f;
+        u[4 * u_stride] = g0 / 24.0f - g1 / 12.0f + g2 / 6.0f;
+        u[5 * u_stride] = g2;
+    }
+}
+
+size_t conv_winograd_filter_size(int m, int output_channel, int input_channel)
+{
+    return (size_t)(m + 2) * (m + 2) * sgemm_packed_a_size(output_channel, input_channel);
+}
+
+// U[xi][oc][ic]：alpha^2 个 C_out x C_in 的矩阵，变换后按 sgemm_prepack_a 打包，直接作为SGEMM的A
+// 变换前的矩阵 u_all 从 ws 中取
+static size_t winograd_u_size(int m, int output_channel, int input_channel)
+{
+    return (size_t)(m + 2) * (m + 2) * output_channel * input_channel * sizeof(float);
+}
+
+int conv_winograd_transform_filter(int m, const float *weights, int output_channel, int input_channel,
+                                   float *transformed, conv_workspace_t *ws)
+{
+    int alpha = m + 2;
+    size_t matrix_size = (size_t)output_channel * input_channel;
+    size_t packed_size = sgemm_packed_a_size(output_channel, input_channel);
+    float *u_all = (float *)conv_ws_alloc(ws, winograd_u_size(m, output_channel, input_channel));
+    if (!u_all) {
+        return CONV_ERR_NOMEM;
+    }
+
+    for (int oc = 0; oc < output_channel; oc++) {
+        for (int ic = 0; ic < input_channel; ic++) {
+            const float *g = weights + ((size_t)oc * input_channel + ic) * 9;
+            float tmp[WINO_MAX_ALPHA * 3];
+            float u[WINO_MAX_ALPHA * WINO_MAX_ALPHA];
+
+            // 先对列变换 (alpha x 3)，再对行变换 (alpha x alpha)
+            for (int j = 0; j < 3; j++) {
+                filter_transform_1d(m, g + j, 3, tmp + j, 3);
+            }
+            for (int i = 0; i < alpha; i++) {
+                filter_transform_1d(m, tmp + i * 3, 1, u + i * alpha, 1);
+            }
+            for (int xi = 0; xi < alpha * alpha; xi++) {
+                u_all[xi * matrix_size + (size_t)oc * input_channel + ic] = u[xi];
+            }
+        }
+    }
+    for (int xi = 0; xi < alpha * alpha; xi++) {
+        sgemm_prepack_a(output_channel, input_channel, u_all + xi * matrix_size, input_channel,
+                        transformed + xi * packed_size);
+    }
+
+    conv_ws_free(ws, u_all);
+    return CONV_OK;
+}
+
+typedef struct {
+    int m, alpha;
+    int input_channel, output_channel;
+    int input_h, input_w;
+    int padding;
+    int output_h, output_w;
+    int tiles_h, tiles_w, tiles;   // 每张图像的tile数
+    int batch;                    // 本组的图像数
+    int batch_tiles;              // GEMM的N维：batch * tiles
+    int padded_h, padded_w;   // 补零后的输入平面，保证所有tile的读取都不越界
+    const float *input;
+    const float *bias;
+    const conv_epilogue_t *epilogue;   // 偏置之后的激活和截断，不需要时为NULL
+    float *output;
+    float *padded;            // 每个线程一个补零平面
+    float *v;                 // V[xi][ic][n * tiles + tile]
+    float *gemm_out;          // M[xi][oc][n * tiles + tile]
+} winograd_plan_t;
+
+// 4个相邻tile的某一输入行：d[j] 的第l个通道为第l个tile的第j列
+static inline void load_tile_row(const winograd_plan_t *p, const float *src, wino_vec_t *d)
+{
+#ifdef __aarch64__
+    if (p->m == 4) {
+        float32x4x4_t lo = vld4q_f32(src);
+        float32x4x4_t hi = vld4q_f32(src + 4);
+        d[0] = lo.val[0];
+        d[1] = lo.val[1];
+        d[2] = lo.val[2];
+        d[3] = lo.val[3];
+        d[4] = hi.val[0];
+        d[5] = hi.val[1];
+    } else {
+        float32x4x2_t lo = vld2q_f32(src);
+        float32x4x2_t hi = vld2q_f32(src + 2);
+        d[0] = lo.val[0];
+        d[1] = lo.val[1];
+        d[2] = hi.val[0];
+        d[3] = hi.val[1];
+    }
+#else
+    int m = p->m;
+    for (int j = 0; j < p->alpha; j++) {
+        wino_vec_t v = {src[j], src[m + j], src[2 * m + j], src[3 * m + j]};
+        d[j] = v;
+    }
+#endif
+}
+
+// 输入变换：一个任务处理一张图像的一个输入通道
+static void winograd_input_task(void *ctx, int task, int thread_id)
+{
+    const winograd_plan_t *p = (const winograd_plan_t *)ctx;
+    int m = p->m;
+    int alpha = p->alpha;
+    int n = task / p->input_channel;
+    int ic = task % p->input_channel;
+    float *padded = p->padded + (size_t)thread_id * p->padded_h * p->padded_w;
+    const float *input_ptr = p->input + (size_t)task * p->input_h * p->input_w;
+    size_t xi_stride = (size_t)p->input_channel * p->batch_tiles;
+
+    // 拷贝到补零平面
+    memset(padded, 0, (size_t)p->padded_h * p->padded_w * sizeof(float));
+    for (int i = 0; i < p->input_h; i++) {
+        memcpy(padded + (size_t)(i + p->padding) * p->padded_w + p->padding,
+               input_ptr + (size_t)i * p->input_w, p->input_w * sizeof(float));
+    }
+
+    for (int ty = 0; ty < p->tiles_h; ty++) {
+        for (int tx = 0; tx < p->tiles_w; tx += 4) {
+            wino_vec_t d[WINO_MAX_ALPHA][WINO_MAX_ALPHA];
+            wino_vec_t t[WINO_MAX_ALPHA][WINO_MAX_ALPHA];
+            const float *src = padded + (size_t)ty * m * p->padded_w + tx * m;
+
+            // 行变换
+            for (int i = 0; i < alpha; i++) {
+                wino_vec_t row[WINO_MAX_ALPHA];
+                load_tile_row(p, src + (size_t)i * p->padded_w, row);
+                if (m == 4) {
+                    input_transform_f4(row, d[i]);
+                } else {
+                    input_transform_f2(row, d[i]);
+                }
+            }
+            // 列变换
+            for (int j = 0; j < alpha; j++) {
+                wino_vec_t col[WINO_MAX_ALPHA];
+                wino_vec_t res[WINO_MAX_ALPHA];
+                for (int i = 0; i < alpha; i++) {
+                    col[i] = d[i][j];
+                }
+                if (m == 4) {
+                    input_transform_f4(col, res);
+                } else {
+                    input_transform_f2(col, res);
+                }
+                for (int i = 0; i < alpha; i++) {
+                    t[i][j] = res[i];
+                }
+            }
+
+            // 写入 V[xi][ic][tile]，4个tile连续
+            int count = p->tiles_w - tx < 4 ? p->tiles_w - tx : 4;
+            float *dst = p->v + (size_t)ic * p->batch_tiles + (size_t)n * p->tiles + (size_t)ty * p->tiles_w + tx;
+            for (int xi = 0; xi < alpha * alpha; xi++) {
+                wino_vec_t value = t[xi / alpha][xi % alpha];
+                if (count == 4) {
+#ifdef __aarch64__
+                    vst1q_f32(dst + xi * xi_stride, value);
+#else
+                    memcpy(dst + xi * xi_stride, &value, sizeof(value));
+#endif
+                } else {
+                    for (int l = 0; l < count; l++) {
+                        dst[xi * xi_stride + l] = value[l];
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 输出变换并加偏置：一个任务处理一张图像的一个输出通道
+// 每行tile写回后，这 m 个输出行还在缓存中，随即做激活和截断
+static void winograd_output_task(void *ctx, int task, int thread_id)
+{
+    const winograd_plan_t *p = (const winograd_plan_t *)ctx;
+    int m = p->m;
+    int alpha = p->alpha;
+    int n = task / p->output_channel;
+    int oc = task % p->output_channel;
+    size_t xi_stride = (size_t)p->output_channel * p->batch_tiles;
+    const float *src_base = p->gemm_out + (size_t)oc * p->batch_tiles + (size_t)n * p->tiles;
+    float *output_ptr = p->output + (size_t)task * p->output_h * p->output_w;
+    wino_vec_t bias = wino_dup(p->bias ? p->bias[oc] : 0.0f);
+
+    (void)thread_id;
+    for (int ty = 0; ty < p->tiles_h; ty++) {
+        for (int tx = 0; tx < p->tiles_w; tx += 4) {
+            int count = p->tiles_w - tx < 4 ? p->tiles_w - tx : 4;
+            const float *src = src_base + (size_t)ty * p->tiles_w + tx;
+            wino_vec_t mv[WINO_MAX_ALPHA][WINO_MAX_ALPHA];
+            wino_vec_t t[4][WINO_MAX_ALPHA];
+            wino_vec_t y[4][4];
+
+            for (int xi = 0; xi < alpha * alpha; xi++) {
+                if (count == 4) {
+#ifdef __aarch64__
+                    mv[xi / alpha][xi % alpha] = vld1q_f32(src + xi * xi_stride);
+#else
+                    memcpy(&mv[xi / alpha][xi % alpha], src + xi * xi_stride, sizeof(wino_vec_t));
+#endif
+                } else {
+                    wino_vec_t value = wino_dup(0.0f);
+                    for (int l = 0; l < count; l++) {
+                        value[l] = src[xi * xi_stride + l];
+                    }
+                    mv[xi / alpha][xi % alpha] = value;
+                }
+            }
+
+            // 列变换 (m x alpha)，再行变换 (m x m)
+            for (int j = 0; j < alpha; j++) {
+                wino_vec_t col[WINO_MAX_ALPHA];
+                wino_vec_t res[4];
+                for (int i = 0; i < alpha; i++) {
+                    col[i] = mv[i][j];
+                }
+                if (m == 4) {
+                    output_transform_f4(col, res);
+                } else {
+                    output_transform_f2(col, res);
+                }
+                for (int i = 0; i < m; i++) {
+                    t[i][j] = res[i];
+                }
+            }
+            for (int i = 0; i < m; i++) {
+                if (m == 4) {
+                    output_transform_f4(t[i], y[i]);
+                } else {
+                    output_transform_f2(t[i], y[i]);
+                }
+                for (int j = 0; j < m; j++) {
+                    y[i][j] = y[i][j] + bias;
+                }
+            }
+
+            // 写回输出：4个tile完整落在输出内时整行交织写回，否则逐点裁剪
+            int oy0 = ty * m;
+            int ox0 = tx * m;
+            for (int i = 0; i < m && oy0 + i < p->output_h; i++) {
+                float *dst = output_ptr + (size_t)(oy0 + i) * p->output_w + ox0;
+#ifdef __aarch64__
+                if (count == 4 && ox0 + 4 * m <= p->output_w) {
+                    if (m == 4) {
+                        float32x4x4_t out = {{y[i][0], y[i][1], y[i][2], y[i][3]}};
+                        vst4q_f32(dst, out);
+                    } else {
+                        float32x4x2_t out = {{y[i][0], y[i][1]}};
+                        vst2q_f32(dst, out);
+                    }
+                    continue;
+                }
+#endif
+                for (int l = 0; l < count; l++) {
+                    for (int j = 0; j < m && ox0 + l * m + j < p->output_w; j++) {
+                        dst[l * m + j] = y[i][j][l];
+                    }
+                }
+            }
+        }
+        for (int i = 0; p->epilogue && i < m && ty * m + i < p->output_h; i++) {
+            conv_epilogue_apply(p->epilogue, 0.0f, output_ptr + (size_t)(ty * m + i) * p->output_w, p->output_w);
+        }
+    }
+}
+
+// 按描述符填写 p 中与数据无关的部分，batch_tiles 为每组的最大tile数
+static void winograd_plan_init(winograd_plan_t *p, const conv_desc_t *desc, int m, int *group)
+{
+    p->m = m;
+    p->alpha = m + 2;
+    p->input_channel = desc->input_channel;
+    p->output_channel = desc->output_channel;
+    p->input_h = desc->input_h;
+    p->input_w = desc->input_w;
+    p->padding = desc->padding;
+    p->output_h = conv_output_h(desc);
+    p->output_w = conv_output_w(desc);
+    p->tiles_h = (p->output_h + m - 1) / m;
+    p->tiles_w = (p->output_w + m - 1) / m;
+    p->tiles = p->tiles_h * p->tiles_w;
+    // batch按组折叠进N维：每组凑够约 CONV_WINOGRAD_BATCH_TILES 个tile，
+    // 既让小图像的矩阵乘法足够宽，又让 V / M 不会随batch增大而溢出缓存
+    *group = CONV_WINOGRAD_BATCH_TILES / p->tiles;
+    *group = *group < 1 ? 1 : (*group > desc->batch ? desc->batch : *group);
+    p->batch_tiles = *group * p->tiles;
+    // tile列数补齐到4的倍数，再为解交织读取多留4列
+    p->padded_h = p->tiles_h * m + 2;
+    p->padded_w = (p->tiles_w + 3) / 4 * 4 * m + 4;
+    p->epilogue = conv_epilogue_active(&desc->epilogue) ? &desc->epilogue : NULL;
+}
+
+// 每个线程的补零输入、V、M 和SGEMM的打包缓冲区（A已预先打包）
+static void winograd_buffer_sizes(const winograd_plan_t *p, size_t sizes[4])
+{
+    size_t alpha2 = (size_t)p->alpha * p->alpha;
+
+    sizes[0] = (size_t)conv_parallel_threads() * p->padded_h * p->padded_w * sizeof(float);
+    sizes[1] = alpha2 * p->input_channel * p->batch_tiles * sizeof(float);
+    sizes[2] = alpha2 * p->output_channel * p->batch_tiles * sizeof(float);
+    sizes[3] = sgemm_workspace_size(p->batch_tiles, 1);
+}
+
+size_t conv_winograd_workspace_size(const conv_desc_t *desc, int m, int prepacked)
+{
+    winograd_plan_t p;
+    size_t sizes[4];
+    size_t run_size = 0;
+    int group;
+
+    winograd_plan_init(&p, desc, m, &group);
+    winograd_buffer_sizes(&p, sizes);
+    for (int i = 0; i < 4; i++) {
+        run_size += conv_ws_bytes(sizes[i]);
+    }
+    if (prepacked) {
+        return run_size;
+    }
+    // 未预先变换时，变换后的滤波器在整个运行期间占用工作区，u_all 只在变换时使用
+    size_t u_size = conv_ws_bytes(winograd_u_size(m, desc->output_channel, desc->input_channel));
+    return conv_ws_bytes(conv_winograd_filter_size(m, desc->output_channel, desc->input_channel) * sizeof(float)) +
+           (u_size > run_size ? u_size : run_size);
+}
+
+int conv_winograd_run(const conv_desc_t *desc, int m, const float *transformed_filter,
+                      const float *input, const float *bias, float *output, conv_workspace_t *ws)
+{
+    winograd_plan_t p;
+    size_t sizes[4];
+    int group;
+    int ret = CONV_OK;
+
+    winograd_plan_init(&p, desc, m, &group);
+    winograd_buffer_sizes(&p, sizes);
+    p.bias = bias;
+
+    int alpha2 = p.alpha * p.alpha;
+    p.padded = (float *)conv_ws_alloc(ws, sizes[0]);
+    p.v = (float *)conv_ws_alloc(ws, sizes[1]);
+    p.gemm_out = (float *)conv_ws_alloc(ws, sizes[2]);
+    void *workspace = conv_ws_alloc(ws, sizes[3]);
+    if (!p.padded || !p.v || !p.gemm_out || !workspace) {
+        ret = CONV_ERR_NOMEM;
+        goto done;
+    }
+
+    size_t packed_size = sgemm_packed_a_size(p.output_channel, p.input_channel);
+    size_t input_image = (size_t)p.input_channel * p.input_h * p.input_w;
+    size_t output_image = (size_t)p.output_channel * p.output_h * p.output_w;
+    for (int n0 = 0; n0 < desc->batch && ret == CONV_OK; n0 += group) {
+        p.batch = desc->batch - n0 < group ? desc->batch - n0 : group;
+        p.batch_tiles = p.batch * p.tiles;
+        p.input = input + n0 * input_image;
+        p.output = output + n0 * output_image;
+
+        conv_parallel_for(p.batch * p.input_channel, winograd_input_task, &p);
+
+        // alpha^2 个逐元素乘积批量交给SGEMM：M[xi] = U[xi] * V[xi]，U已预先打包
+        for (int xi = 0; xi < alpha2 && ret == CONV_OK; xi++) {
+            sgemm_dense_b_t dense;
+            dense.b = p.v + (size_t)xi * p.input_channel * p.batch_tiles;
+            dense.ldb = p.batch_tiles;
+            ret = sgemm_blocked_batched(p.output_channel, p.batch_tiles, p.input_channel, NULL, 0,
+                                        transformed_filter + xi * packed_size, sgemm_pack_dense_b, &dense,
+                                        p.gemm_out + (size_t)xi * p.output_channel * p.batch_tiles, p.batch_tiles,
+                                        p.batch_tiles, 0, NULL, 0, NULL, workspace);
+        }
+        if (ret == CONV_OK) {
+            conv_parallel_for(p.batch * p.output_channel, winograd_output_task, &p);
+        }
+    }
+
+done:
+    // 按分配的逆序归还；ws 为NULL时逐个 free
+    conv_ws_free(ws, workspace);
+    conv_ws_free(ws, p.gemm_out);
+    conv_ws_free(ws, p.v);
+    conv_ws_free(ws, p.padded);
+    return ret;
+}
+
+int conv_run_winograd(const conv_desc_t *desc, int m, const float *input, const float *weights,
+                      const float *bias, float *output, conv_workspace_t *ws)
+{
+    size_t filter_size = conv_winograd_filter_size(m, desc->output_channel, desc->input_channel);
+    float *transformed = (float *)conv_ws_alloc(ws, filter_size * sizeof(float));
+    if (!transformed) {
+        return CONV_ERR_NOMEM;
+    }
+
+    int ret = conv_winograd_transform_filter(m, weights, desc->output_channel, desc->input_channel, transformed, ws);
+    if (ret == CONV_OK) {
+        ret = conv_winograd_run(desc, m, transformed, input, bias, output, ws);
+    }
+
+    conv_ws_free(ws, transformed);
+    return ret;
+}
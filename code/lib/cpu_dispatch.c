@@ -0,0 +1,349 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cpu_dispatch.h"
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#include <sys/prctl.h>
+#elif defined(__aarch64__) && defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+#if CONV_X86_DISPATCH
+#include <cpuid.h>
+#endif
+
+static const struct {
+    unsigned feature;
+    const char *name;
+} feature_names[] = {
+    { CONV_CPU_NEON, "neon" },
+    { CONV_CPU_DOTPROD, "dotprod" },
+    { CONV_CPU_FP16, "fp16" },
+    { CONV_CPU_BF16, "bf16" },
+    { CONV_CPU_I8MM, "i8mm" },
+    { CONV_CPU_SVE, "sve" },
+    { CONV_CPU_SVE2, "sve2" },
+    { CONV_CPU_FHM, "fhm" },
+    { CONV_CPU_AVX2, "avx2" },
+    { CONV_CPU_FMA, "fma" },
+    { CONV_CPU_F16C, "f16c" },
+    { CONV_CPU_AVX512F, "avx512f" },
+    { CONV_CPU_AVX512BW, "avx512bw" },
+    { CONV_CPU_AVX512VNNI, "avx512vnni" },
+    { CONV_CPU_AVX512BF16, "avx512bf16" },
+    { CONV_CPU_AVX512FP16, "avx512fp16" },
+    { CONV_CPU_AVXVNNI, "avxvnni" },
+};
+
+#define FEATURE_COUNT ((int)(sizeof(feature_names) / sizeof(feature_names[0])))
+
+#if defined(__aarch64__) && defined(__linux__)
+// 较老的内核头文件中没有这些定义，取值见 Linux arch/arm64/include/uapi/asm/hwcap.h
+#ifndef AT_HWCAP2
+#define AT_HWCAP2 26
+#endif
+#ifndef HWCAP_ASIMDHP
+#define HWCAP_ASIMDHP (1UL << 10)
+#endif
+#ifndef HWCAP_ASIMDDP
+#define HWCAP_ASIMDDP (1UL << 20)
+#endif
+#ifndef HWCAP_ASIMDFHM
+#define HWCAP_ASIMDFHM (1UL << 23)
+#endif
+#ifndef HWCAP_SVE
+#define HWCAP_SVE (1UL << 22)
+#endif
+#ifndef HWCAP2_SVE2
+#define HWCAP2_SVE2 (1UL << 1)
+#endif
+#ifndef HWCAP2_I8MM
+#define HWCAP2_I8MM (1UL << 13)
+#endif
+#ifndef HWCAP2_BF16
+#define HWCAP2_BF16 (1UL << 14)
+#endif
+
+static unsigned detect_features(void)
+{
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    unsigned long hwcap2 = getauxval(AT_HWCAP2);
+    unsigned features = CONV_CPU_NEON;   // ARM64 必有 Advanced SIMD
+
+    if (hwcap & HWCAP_ASIMDDP) {
+        features |= CONV_CPU_DOTPROD;
+    }
+    if (hwcap & HWCAP_ASIMDHP) {
+        features |= CONV_CPU_FP16;
+    }
+    if (hwcap & HWCAP_ASIMDFHM) {
+        features |= CONV_CPU_FHM;
+    }
+    if (hwcap & HWCAP_SVE) {
+        features |= CONV_CPU_SVE;
+    }
+    if (hwcap2 & HWCAP2_SVE2) {
+        features |= CONV_CPU_SVE2;
+    }
+    if (hwcap2 & HWCAP2_I8MM) {
+        features |= CONV_CPU_I8MM;
+    }
+    if (hwcap2 & HWCAP2_BF16) {
+        features |= CONV_CPU_BF16;
+    }
+    return features;
+}
+
+#ifndef PR_SVE_GET_VL
+#define PR_SVE_GET_VL 51
+#endif
+#ifndef PR_SVE_VL_LEN_MASK
+#define PR_SVE_VL_LEN_MASK 0xffff
+#endif
+
+// 当前线程的SVE向量长度（位），新线程继承该值
+static int sve_vector_bits(void)
+{
+    int vl = prctl(PR_SVE_GET_VL);
+    return vl < 0 ? 0 : (vl & PR_SVE_VL_LEN_MASK) * 8;
+}
+#elif defined(__aarch64__) && defined(__APPLE__)
+static int sysctl_flag(const char *name)
+{
+    int value = 0;
+    size_t size = sizeof(value);
+    return sysctlbyname(name, &value, &size, NULL, 0) == 0 && value != 0;
+}
+
+// Apple 芯片没有SVE
+static unsigned detect_features(void)
+{
+    unsigned features = CONV_CPU_NEON;
+
+    if (sysctl_flag("hw.optional.arm.FEAT_DotProd")) {
+        features |= CONV_CPU_DOTPROD;
+    }
+    if (sysctl_flag("hw.optional.arm.FEAT_FP16")) {
+        features |= CONV_CPU_FP16;
+    }
+    if (sysctl_flag("hw.optional.arm.FEAT_FHM")) {
+        features |= CONV_CPU_FHM;
+    }
+    if (sysctl_flag("hw.optional.arm.FEAT_BF16")) {
+        features |= CONV_CPU_BF16;
+    }
+    if (sysctl_flag("hw.optional.arm.FEAT_I8MM")) {
+        features |= CONV_CPU_I8MM;
+    }
+    return features;
+}
+#elif defined(__aarch64__)
+static unsigned detect_features(void)
+{
+    return CONV_CPU_NEON;
+}
+#elif CONV_X86_DISPATCH
+// XCR0：操作系统在上下文切换时保存的寄存器状态
+static unsigned long long read_xcr0(void)
+{
+    unsigned eax, edx;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+}
+
+static unsigned detect_features(void)
+{
+    unsigned eax, ebx, ecx, edx;
+    unsigned features = 0;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return 0;
+    }
+    // 需要CPU支持AVX、OSXSAVE，并且操作系统保存XMM/YMM状态，否则AVX指令不可用
+    if (!(ecx & (1u << 27)) || !(ecx & (1u << 28))) {
+        return 0;
+    }
+    unsigned long long xcr0 = read_xcr0();
+    if ((xcr0 & 0x6) != 0x6) {
+        return 0;
+    }
+    if (ecx & (1u << 12)) {
+        features |= CONV_CPU_FMA;
+    }
+    if (ecx & (1u << 29)) {
+        features |= CONV_CPU_F16C;
+    }
+    if (__get_cpuid_max(0, NULL) < 7) {
+        return features;
+    }
+
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    unsigned leaf7_ebx = ebx, leaf7_ecx = ecx, leaf7_edx = edx;
+    __cpuid_count(7, 1, eax, ebx, ecx, edx);
+    unsigned leaf7_1_eax = eax;
+
+    if (leaf7_ebx & (1u << 5)) {
+        features |= CONV_CPU_AVX2;
+    }
+    if (leaf7_1_eax & (1u << 4)) {
+        features |= CONV_CPU_AVXVNNI;
+    }
+    // AVX-512 还需要操作系统保存 opmask 和 ZMM 寄存器
+    if ((xcr0 & 0xe6) == 0xe6 && (leaf7_ebx & (1u << 16))) {
+        features |= CONV_CPU_AVX512F;
+        if (leaf7_ebx & (1u << 30)) {
+            features |= CONV_CPU_AVX512BW;
+        }
+        if (leaf7_ecx & (1u << 11)) {
+            features |= CONV_CPU_AVX512VNNI;
+        }
+        if (leaf7_1_eax & (1u << 5)) {
+            features |= CONV_CPU_AVX512BF16;
+        }
+        if (leaf7_edx & (1u << 23)) {
+            features |= CONV_CPU_AVX512FP16;
+        }
+    }
+    return features;
+}
+#else
+static unsigned detect_features(void)
+{
+    return 0;
+}
+#endif
+
+// 解析 CONV_CPU_DISABLE：逗号分隔的特性名，未知名称忽略
+static unsigned disabled_features(const char *list)
+{
+    unsigned features = 0;
+
+    while (list && *list) {
+        size_t len = strcspn(list, ",");
+        for (int i = 0; i < FEATURE_COUNT; i++) {
+            if (strlen(feature_names[i].name) == len && strncmp(feature_names[i].name, list, len) == 0) {
+                features |= feature_names[i].feature;
+            }
+        }
+        list += len;
+        if (*list == ',') {
+            list++;
+        }
+    }
+    return features;
+}
+
+static conv_dispatch_t dispatch_table;
+static pthread_once_t dispatch_once = PTHREAD_ONCE_INIT;
+
+static void dispatch_init(void)
+{
+    conv_dispatch_t *t = &dispatch_table;
+
+    t->features = detect_features() & ~disabled_features(getenv("CONV_CPU_DISABLE"));
+
+    // 每个算子从最快的变体开始，选第一个所需特性都满足的
+    t->sgemm = &sgemm_ukernel_default;
+    t->dilated = &dilated_s1_default;
+    t->direct_3x3 = &direct_3x3_default;
+    t->hgemm_fp16 = &hgemm_ukernel_fp16_default;
+    t->hgemm_bf16 = &hgemm_ukernel_bf16_default;
+    t->qgemm = &qgemm_ukernel_default;
+    t->sve_vector_bits = 0;
+#if defined(__aarch64__)
+    if ((t->features & (CONV_CPU_FP16 | CONV_CPU_FHM)) == (CONV_CPU_FP16 | CONV_CPU_FHM)) {
+        t->hgemm_fp16 = &hgemm_ukernel_fp16_fhm;
+    }
+    if (t->features & CONV_CPU_BF16) {
+        t->hgemm_bf16 = &hgemm_ukernel_bf16_bfdot;
+    }
+    // SMMLA 每条指令的乘加数是 SDOT 的两倍
+    if (t->features & CONV_CPU_I8MM) {
+        t->qgemm = &qgemm_ukernel_smmla;
+    } else if (t->features & CONV_CPU_DOTPROD) {
+        t->qgemm = &qgemm_ukernel_sdot;
+    }
+#endif
+#if CONV_SVE_DISPATCH
+    // SGEMM的 NR = 3VL 需放得进边界块的临时缓冲区，即向量不超过512位
+    if (t->features & CONV_CPU_SVE) {
+        t->sve_vector_bits = sve_vector_bits();
+    }
+    if (t->sve_vector_bits >= 128 && 3 * (t->sve_vector_bits / 32) <= SGEMM_NR_MAX) {
+        t->sgemm = sgemm_ukernel_sve(t->sve_vector_bits / 32);
+        t->direct_3x3 = &direct_3x3_sve;
+    }
+#endif
+#if CONV_X86_DISPATCH
+    unsigned avx2_fma = CONV_CPU_AVX2 | CONV_CPU_FMA;
+    if (t->features & CONV_CPU_AVX512F) {
+        t->sgemm = &sgemm_ukernel_avx512;
+    } else if ((t->features & avx2_fma) == avx2_fma) {
+        t->sgemm = &sgemm_ukernel_avx2;
+    }
+    if ((t->features & avx2_fma) == avx2_fma) {
+        t->dilated = &dilated_s1_avx2;
+    }
+    // 低精度GEMM：FP16 需要 F16C 转换；BF16 转换只是移位，有 AVX512_BF16 时直接用 vdpbf16ps
+    if ((t->features & (CONV_CPU_AVX512F | CONV_CPU_F16C)) == (CONV_CPU_AVX512F | CONV_CPU_F16C)) {
+        t->hgemm_fp16 = &hgemm_ukernel_fp16_avx512;
+    } else if ((t->features & (avx2_fma | CONV_CPU_F16C)) == (avx2_fma | CONV_CPU_F16C)) {
+        t->hgemm_fp16 = &hgemm_ukernel_fp16_avx2;
+    }
+    if ((t->features & (CONV_CPU_AVX512F | CONV_CPU_AVX512BF16)) == (CONV_CPU_AVX512F | CONV_CPU_AVX512BF16)) {
+        t->hgemm_bf16 = &hgemm_ukernel_bf16_avx512bf16;
+    } else if ((t->features & (CONV_CPU_AVX512F | CONV_CPU_F16C)) == (CONV_CPU_AVX512F | CONV_CPU_F16C)) {
+        t->hgemm_bf16 = &hgemm_ukernel_bf16_avx512;
+    } else if ((t->features & (avx2_fma | CONV_CPU_F16C)) == (avx2_fma | CONV_CPU_F16C)) {
+        t->hgemm_bf16 = &hgemm_ukernel_bf16_avx2;
+    }
+    if ((t->features & (CONV_CPU_AVX512F | CONV_CPU_AVX512VNNI)) == (CONV_CPU_AVX512F | CONV_CPU_AVX512VNNI)) {
+        t->qgemm = &qgemm_ukernel_avx512vnni;
+    } else if ((t->features & (CONV_CPU_AVX2 | CONV_CPU_AVXVNNI)) == (CONV_CPU_AVX2 | CONV_CPU_AVXVNNI)) {
+        t->qgemm = &qgemm_ukernel_avxvnni;
+    }
+#endif
+
+    int len = snprintf(t->info, sizeof(t->info), "cpu=");
+    int first = 1;
+    for (int i = 0; i < FEATURE_COUNT && len < (int)sizeof(t->info); i++) {
+        if (t->features & feature_names[i].feature) {
+            len += snprintf(t->info + len, sizeof(t->info) - len, "%s%s", first ? "" : ",", feature_names[i].name);
+            first = 0;
+        }
+    }
+    if (len < (int)sizeof(t->info)) {
+        snprintf(t->info + len, sizeof(t->info) - len, "%s sgemm=%s direct3x3=%s dilated=%s hgemm_fp16=%s hgemm_bf16=%s qgemm=%s",
+                 first ? "none" : "", t->sgemm->name, t->direct_3x3->name, t->dilated->name,
+                 t->hgemm_fp16->name, t->hgemm_bf16->name, t->qgemm->name);
+    }
+}
+
+const conv_dispatch_t *conv_dispatch(void)
+{
+    pthread_once(&dispatch_once, dispatch_init);
+    return &dispatch_table;
+}
+
+unsigned conv_cpu_features(void)
+{
+    return conv_dispatch()->features;
+}
+
+const char *conv_cpu_feature_name(unsigned feature)
+{
+    for (int i = 0; i < FEATURE_COUNT; i++) {
+        if (feature_names[i].feature == feature) {
+            return feature_names[i].name;
+        }
+    }
+    return "unknown";
+}
+
+const char *conv_kernel_info(void)
+{
+    return conv_dispatch()->info;
+}
@@ -0,0 +1,81 @@
+#ifndef ARM64_CPU_DISPATCH_H
+#define ARM64_CPU_DISPATCH_H
+
+// 运行时CPU特性检测与内核调度表
+// 原先各算子的汇编/向量化路径只由 #ifdef __aarch64__ 等编译期条件选择，
+// 为了让一个二进制在较老的核心上也能运行，就不能使用 dotprod、SVE、AVX-512 等扩展。
+// 现在第一次使用时检测一次CPU特性（Linux ARM64: getauxval(AT_HWCAP/AT_HWCAP2)，
+// macOS ARM64: sysctl hw.optional.arm.*，x86-64: cpuid + xgetbv），为每个算子选出内核填入调度表，之后不再改变。
+// 各算子通过 conv_dispatch() 取内核指针，不再直接用编译期条件选择指令集扩展。
+// 所有ARM64核心都支持的NEON仍然在编译期选择。
+
+#include "conv.h"
+#include "hgemm.h"
+#include "qgemm.h"
+#include "sgemm.h"
+
+// x86-64 上各指令集的内核用 __attribute__((target(...))) 单独编译，无需 -mavx2 等编译选项
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define CONV_X86_DISPATCH 1
+#else
+#define CONV_X86_DISPATCH 0
+#endif
+
+// ARM64 上SVE内核用内嵌汇编（.arch_extension sve）编写，无需 -march=armv8-a+sve；
+// 向量长度由 prctl(PR_SVE_GET_VL) 得到，因此只在Linux上启用（macOS的Apple芯片没有SVE）
+#if defined(__aarch64__) && defined(__linux__) && defined(__GNUC__)
+#define CONV_SVE_DISPATCH 1
+#else
+#define CONV_SVE_DISPATCH 0
+#endif
+
+// 空洞卷积内部区域（stride=1、所有抽头都在输入内）：计算 blocks 组、每组 width 个相邻输出，累加到 output 上
+// input 指向第一个输出的左上角抽头
+typedef void (*dilated_s1_fn)(const float *input, int input_w, const float *kernel, int kernel_h, int kernel_w,
+                              int dilation, float *output, int blocks);
+
+typedef struct {
+    const char *name;
+    int width;               // 每组的输出个数
+    dilated_s1_fn run;       // NULL 表示使用编译期选择的实现（ARM64 NEON 或逐点计算）
+} dilated_s1_kernel_t;
+
+extern const dilated_s1_kernel_t dilated_s1_default;
+#if CONV_X86_DISPATCH
+extern const dilated_s1_kernel_t dilated_s1_avx2;
+#endif
+
+// 3x3直接卷积 stride=1 的内部区域：一行输出中 cols 个相邻列 x oc_count（1-4）个输出通道
+// input 指向第0个输入通道中第一个输出的左上角抽头，output 指向第一个输出通道的第一个输出；
+// packed_weights 为这4个输出通道按 [输入通道][抽头][4] 重排的权重（不足4个通道时补零），bias4 为这4个通道的偏置
+typedef void (*direct_3x3_row_fn)(const float *input, long input_w, long input_plane, const float *packed_weights,
+                                  long input_channel, const float *bias4, float *output, long output_plane,
+                                  long oc_count, long cols);
+
+typedef struct {
+    const char *name;
+    direct_3x3_row_fn run;   // NULL 表示使用寄存器分块的通用直接卷积（见 conv_direct.c）
+} direct_3x3_kernel_t;
+
+extern const direct_3x3_kernel_t direct_3x3_default;
+#if CONV_SVE_DISPATCH
+extern const direct_3x3_kernel_t direct_3x3_sve;
+#endif
+
+// 调度表：每个算子一项
+typedef struct {
+    unsigned features;                   // 检测到并且没有被 CONV_CPU_DISABLE 屏蔽的 CONV_CPU_*
+    const sgemm_ukernel_t *sgemm;        // SGEMM微内核（im2col、隐式GEMM、Winograd共用）
+    const dilated_s1_kernel_t *dilated;  // 逐平面空洞卷积的内部区域
+    const direct_3x3_kernel_t *direct_3x3;   // 3x3直接卷积的内部区域
+    const hgemm_ukernel_t *hgemm_fp16;   // 低精度GEMM微内核（16位输入、FP32累加）
+    const hgemm_ukernel_t *hgemm_bf16;
+    const qgemm_ukernel_t *qgemm;        // INT8 GEMM微内核
+    int sve_vector_bits;                 // SVE向量长度，没有SVE时为0
+    char info[384];                      // conv_kernel_info 的返回值
+} conv_dispatch_t;
+
+// 线程安全，第一次调用时检测CPU特性并填充调度表
+const conv_dispatch_t *conv_dispatch(void);
+
+#endif // ARM64_CPU_DISPATCH_H
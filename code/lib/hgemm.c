@@ -0,0 +1,666 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conv_internal.h"
+#include "cpu_dispatch.h"
+#include "hgemm.h"
+#include "thread_pool.h"
+
+#if CONV_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+static int min_int(int a, int b)
+{
+    return a < b ? a : b;
+}
+
+void hgemm_pack_a(const uint16_t *a, int lda, int mc, int kc, int mr, int kpair, uint16_t *packed_a)
+{
+    for (int i = 0; i < mc; i += mr) {
+        int rows = min_int(mr, mc - i);
+        for (int p = 0; p < kc; p += kpair) {
+            for (int r = 0; r < mr; r++) {
+                const uint16_t *a_row = a + (size_t)(i + r) * lda + p;
+                for (int q = 0; q < kpair; q++) {
+                    packed_a[r * kpair + q] = r < rows && p + q < kc ? a_row[q] : 0;
+                }
+            }
+            packed_a += mr * kpair;
+        }
+    }
+}
+
+void hgemm_pack_b(const uint16_t *b, int ldb, int kc, int nc, int nr, int kpair, uint16_t *packed_b)
+{
+    for (int j = 0; j < nc; j += nr) {
+        int cols = min_int(nr, nc - j);
+        for (int p = 0; p < kc; p += kpair) {
+            if (kpair == 1) {
+                const uint16_t *b_row = b + (size_t)p * ldb + j;
+                memcpy(packed_b, b_row, cols * sizeof(uint16_t));
+                memset(packed_b + cols, 0, (nr - cols) * sizeof(uint16_t));
+            } else {
+                // 第c列的一对为 (b[p][c], b[p+1][c])
+                const uint16_t *b_row0 = b + (size_t)p * ldb + j;
+                const uint16_t *b_row1 = p + 1 < kc ? b_row0 + ldb : NULL;
+                for (int c = 0; c < nr; c++) {
+                    packed_b[2 * c] = c < cols ? b_row0[c] : 0;
+                    packed_b[2 * c + 1] = c < cols && b_row1 ? b_row1[c] : 0;
+                }
+            }
+            packed_b += nr * kpair;
+        }
+    }
+}
+
+// 8x12 的C实现：逐元素转换为FP32后乘加，dtype 为常量，内联后两种格式各编译一份
+static inline void hgemm_kernel_c(int kc, const uint16_t *packed_a, const uint16_t *packed_b, float *c, int ldc,
+                                  int accumulate, conv_dtype_t dtype)
+{
+    float acc[8][12];
+
+    for (int r = 0; r < 8; r++) {
+        for (int j = 0; j < 12; j++) {
+            acc[r][j] = accumulate ? c[(size_t)r * ldc + j] : 0.0f;
+        }
+    }
+    for (int p = 0; p < kc; p++) {
+        float b[12];
+        for (int j = 0; j < 12; j++) {
+            b[j] = conv_lowp_to_fp32(dtype, packed_b[j]);
+        }
+        for (int r = 0; r < 8; r++) {
+            float a_val = conv_lowp_to_fp32(dtype, packed_a[r]);
+            for (int j = 0; j < 12; j++) {
+                acc[r][j] += a_val * b[j];
+            }
+        }
+        packed_a += 8;
+        packed_b += 12;
+    }
+    for (int r = 0; r < 8; r++) {
+        for (int j = 0; j < 12; j++) {
+            c[(size_t)r * ldc + j] = acc[r][j];
+        }
+    }
+}
+
+static void hgemm_kernel_c_fp16(int kc, const uint16_t *packed_a, const uint16_t *packed_b, float *c, int ldc,
+                                int accumulate)
+{
+    hgemm_kernel_c(kc, packed_a, packed_b, c, ldc, accumulate, CONV_DTYPE_FP16);
+}
+
+static void hgemm_kernel_c_bf16(int kc, const uint16_t *packed_a, const uint16_t *packed_b, float *c, int ldc,
+                                int accumulate)
+{
+    hgemm_kernel_c(kc, packed_a, packed_b, c, ldc, accumulate, CONV_DTYPE_BF16);
+}
+
+const hgemm_ukernel_t hgemm_ukernel_fp16_default = { "c_8x12", CONV_DTYPE_FP16, 8, 12, 128, 1, hgemm_kernel_c_fp16 };
+const hgemm_ukernel_t hgemm_ukernel_bf16_default = { "c_8x12", CONV_DTYPE_BF16, 8, 12, 128, 1, hgemm_kernel_c_bf16 };
+
+#if CONV_X86_DISPATCH
+// 16个16位元素转换为FP32：FP16 用 vcvtph2ps，BF16 放到高16位即为对应的FP32
+__attribute__((target("avx512f,f16c"), always_inline))
+static inline __m512 load16_avx512(const uint16_t *p, int bf16)
+{
+    __m256i h = _mm256_loadu_si256((const __m256i *)p);
+    return bf16 ? _mm512_castsi512_ps(_mm512_slli_epi32(_mm512_cvtepu16_epi32(h), 16)) : _mm512_cvtph_ps(h);
+}
+
+__attribute__((target("avx512f,f16c"), always_inline))
+static inline __m512 broadcast_avx512(uint16_t h, int bf16)
+{
+    return bf16 ? _mm512_castsi512_ps(_mm512_set1_epi32((int)((uint32_t)h << 16))) : _mm512_set1_ps(_cvtsh_ss(h));
+}
+
+// 14x32：结构与 sgemm_kernel_avx512 相同，B的一行转换为两个zmm，A的元素转换后广播
+__attribute__((target("avx512f,f16c"), always_inline))
+static inline void hgemm_kernel_avx512(int kc, const uint16_t *packed_a, const uint16_t *packed_b, float *c, int ldc,
+                                       int accumulate, int bf16)
+{
+    __m512 acc[14][2];
+
+    _Pragma("GCC unroll 14")
+    for (int r = 0; r < 14; r++) {
+        acc[r][0] = accumulate ? _mm512_loadu_ps(c + (size_t)r * ldc) : _mm512_setzero_ps();
+        acc[r][1] = accumulate ? _mm512_loadu_ps(c + (size_t)r * ldc + 16) : _mm512_setzero_ps();
+    }
+    for (int p = 0; p < kc; p++) {
+        __m512 b0 = load16_avx512(packed_b, bf16);
+        __m512 b1 = load16_avx512(packed_b + 16, bf16);
+        _Pragma("GCC unroll 14")
+        for (int r = 0; r < 14; r++) {
+            __m512 a = broadcast_avx512(packed_a[r], bf16);
+            acc[r][0] = _mm512_fmadd_ps(a, b0, acc[r][0]);
+            acc[r][1] = _mm512_fmadd_ps(a, b1, acc[r][1]);
+        }
+        packed_a += 14;
+        packed_b += 32;
+    }
+    _Pragma("GCC unroll 14")
+    for (int r = 0; r < 14; r++) {
+        _mm512_storeu_ps(c + (size_t)r * ldc, acc[r][0]);
+        _mm512_storeu_ps(c + (size_t)r * ldc + 16, acc[r][1]);
+    }
+}
+
+__attribute__((target("avx512f,f16c")))
+static void hgemm_kernel_avx512_fp16(int kc, const uint16_t *packed_a, const uint16_t *packed_b, float *c, int ldc,
+                                     int accumulate)
+{
+    hgemm_kernel_avx512(kc, packed_a, packed_b, c, ldc, accumulate, 0);
+}
+
+__attribute__((target("avx512f,f16c")))
+static void hgemm_kernel_avx512_bf16(int kc, const uint16_t *packed_a, const uint16_t *packed_b, float *c, int ldc,
+                                     int accumulate)
+{
+    hgemm_kernel_avx512(kc, packed_a, packed_b, c, ldc, accumulate, 1);
+}
+
+// 14x32 BF16：vdpbf16ps 把每个FP32通道上相邻两个k的乘积累加，A的一对 (a[r][k], a[r][k+1]) 作为32位广播
+__attribute__((target("avx512f,avx512bf16")))
+static void hgemm_kernel_avx512bf16(int kc, const uint16_t *packed_a, const uint16_t *packed_b, float *c, int ldc,
+                                    int accumulate)
+{
+    __m512 acc[14][2];
+
+    _Pragma("GCC unroll 14")
+    for (int r = 0; r < 14; r++) {
+        acc[r][0] = accumulate ? _mm512_loadu_ps(c + (size_t)r * ldc) : _mm512_setzero_ps();
+        acc[r][1] = accumulate ? _mm512_loadu_ps(c + (size_t)r * ldc + 16) : _mm512_setzero_ps();
+    }
+    for (int p = 0; p < kc; p += 2) {
+        __m512bh b0 = (__m512bh)_mm512_loadu_si512(packed_b);
+        __m512bh b1 = (__m512bh)_mm512_loadu_si512(packed_b + 32);
+        _Pragma("GCC unroll 14")
+        for (int r = 0; r < 14; r++) {
+            uint32_t pair;
+            memcpy(&pair, packed_a + 2 * r, sizeof(pair));
+            __m512bh a = (__m512bh)_mm512_set1_epi32((int)pair);
+            acc[r][0] = _mm512_dpbf16_ps(acc[r][0], a, b0);
+            acc[r][1] = _mm512_dpbf16_ps(acc[r][1], a, b1);
+        }
+        packed_a += 28;
+        packed_b += 64;
+    }
+    _Pragma("GCC unroll 14")
+    for (int r = 0; r < 14; r++) {
+        _mm512_storeu_ps(c + (size_t)r * ldc, acc[r][0]);
+        _mm512_storeu_ps(c + (size_t)r * ldc + 16, acc[r][1]);
+    }
+}
+
+__attribute__((target("avx2,fma,f16c"), always_inline))
+static inline __m256 load8_avx2(const uint16_t *p, int bf16)
+{
+    __m128i h = _mm_loadu_si128((const __m128i *)p);
+    return bf16 ? _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(h), 16)) : _mm256_cvtph_ps(h);
+}
+
+__attribute__((target("avx2,fma,f16c"), always_inline))
+static inline __m256 broadcast_avx2(uint16_t h, int bf16)
+{
+    return bf16 ? _mm256_castsi256_ps(_mm256_set1_epi32((int)((uint32_t)h << 16))) : _mm256_set1_ps(_cvtsh_ss(h));
+}
+
+// 6x16：与AVX-512版本结构相同，每行两个ymm
+__attribute__((target("avx2,fma,f16c"), always_inline))
+static inline void hgemm_kernel_avx2(int kc, const uint16_t *packed_a, const uint16_t *packed_b, float *c, int ldc,
+                                     int accumulate, int bf16)
+{
+    __m256 acc[6][2];
+
+    _Pragma("GCC unroll 6")
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = accumulate ? _mm256_loadu_ps(c + (size_t)r * ldc) : _mm256_setzero_ps();
+        acc[r][1] = accumulate ? _mm256_loadu_ps(c + (size_t)r * ldc + 8) : _mm256_setzero_ps();
+    }
+    for (int p = 0; p < kc; p++) {
+        __m256 b0 = load8_avx2(packed_b, bf16);
+        __m256 b1 = load8_avx2(packed_b + 8, bf16);
+        _Pragma("GCC unroll 6")
+        for (int r = 0; r < 6; r++) {
+            __m256 a = broadcast_avx2(packed_a[r], bf16);
+            acc[r][0] = _mm256_fmadd_ps(a, b0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_ps(a, b1, acc[r][1]);
+        }
+        packed_a += 6;
+        packed_b += 16;
+    }
+    _Pragma("GCC unroll 6")
+    for (int r = 0; r < 6; r++) {
+        _mm256_storeu_ps(c + (size_t)r * ldc, acc[r][0]);
+        _mm256_storeu_ps(c + (size_t)r * ldc + 8, acc[r][1]);
+    }
+}
+
+__attribute__((target("avx2,fma,f16c")))
+static void hgemm_kernel_avx2_fp16(int kc, const uint16_t *packed_a, const uint16_t *packed_b, float *c, int ldc,
+                                   int accumulate)
+{
+    hgemm_kernel_avx2(kc, packed_a, packed_b, c, ldc, accumulate, 0);
+}
+
+__attribute__((target("avx2,fma,f16c")))
+static void hgemm_kernel_avx2_bf16(int kc, const uint16_t *packed_a, const uint16_t *packed_b, float *c, int ldc,
+                                   int accumulate)
+{
+    hgemm_kernel_avx2(kc, packed_a, packed_b, c, ldc, accumulate, 1);
+}
+
+const hgemm_ukernel_t hgemm_ukernel_fp16_avx512 = { "avx512_14x32", CONV_DTYPE_FP16, 14, 32, 112, 1, hgemm_kernel_avx512_fp16 };
+const hgemm_ukernel_t hgemm_ukernel_bf16_avx512 = { "avx512_14x32", CONV_DTYPE_BF16, 14, 32, 112, 1, hgemm_kernel_avx512_bf16 };
+const hgemm_ukernel_t hgemm_ukernel_bf16_avx512bf16 = { "avx512bf16_14x32", CONV_DTYPE_BF16, 14, 32, 112, 2,
+                                                        hgemm_kernel_avx512bf16 };
+const hgemm_ukernel_t hgemm_ukernel_fp16_avx2 = { "avx2_6x16", CONV_DTYPE_FP16, 6, 16, 120, 1, hgemm_kernel_avx2_fp16 };
+const hgemm_ukernel_t hgemm_ukernel_bf16_avx2 = { "avx2_6x16", CONV_DTYPE_BF16, 6, 16, 120, 1, hgemm_kernel_avx2_bf16 };
+#endif
+
+#if defined(__aarch64__)
+// ARM64 微内核：累加器与 sgemm 的8x12相同（v8-v31，第r行为 v(8+3r)..v(10+3r)），只是乘数为16位
+// FMLAL / BFDOT 以 .inst 编码给出（注释为对应的指令）：较早的汇编器（如 LLVM 14）不接受 .arch_extension fp16fml / bf16，
+// 这样无需 -march=armv8.2-a+fp16fml 等编译选项，内核只在运行时检测到对应特性后调用
+
+// FP16 8x12：FMLAL / FMLAL2 取B一行的低、高4个半精度元素，与A的一个元素相乘后加宽累加到FP32；
+// 按下标的 FMLAL 只能使用 v0-v15，A放在v0
+static void hgemm_kernel_fhm(int kc, const uint16_t *packed_a, const uint16_t *packed_b, float *c, int ldc,
+                             int accumulate)
+{
+    long ldc_bytes = (long)ldc * sizeof(float);
+    __asm__ __volatile__(
+                "mov x9, %[c]                                \n\t"    // x9: C的行指针
+                "cbz %w[accumulate], 1f                      \n\t"    // 首个K分块：累加器清零
+                "ld1 {v8.4s, v9.4s, v10.4s}, [x9], %[ldc]    \n\t"    // 从C读取8行x12列
+                "ld1 {v11.4s, v12.4s, v13.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v14.4s, v15.4s, v16.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v17.4s, v18.4s, v19.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v20.4s, v21.4s, v22.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v23.4s, v24.4s, v25.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v26.4s, v27.4s, v28.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v29.4s, v30.4s, v31.4s}, [x9], %[ldc]  \n\t"
+                "b 2f                                        \n\t"
+                "1:                                          \n\t"
+                "movi v8.4s, #0                              \n\t"
+                "movi v9.4s, #0                              \n\t"
+                "movi v10.4s, #0                             \n\t"
+                "movi v11.4s, #0                             \n\t"
+                "movi v12.4s, #0                             \n\t"
+                "movi v13.4s, #0                             \n\t"
+                "movi v14.4s, #0                             \n\t"
+                "movi v15.4s, #0                             \n\t"
+                "movi v16.4s, #0                             \n\t"
+                "movi v17.4s, #0                             \n\t"
+                "movi v18.4s, #0                             \n\t"
+                "movi v19.4s, #0                             \n\t"
+                "movi v20.4s, #0                             \n\t"
+                "movi v21.4s, #0                             \n\t"
+                "movi v22.4s, #0                             \n\t"
+                "movi v23.4s, #0                             \n\t"
+                "movi v24.4s, #0                             \n\t"
+                "movi v25.4s, #0                             \n\t"
+                "movi v26.4s, #0                             \n\t"
+                "movi v27.4s, #0                             \n\t"
+                "movi v28.4s, #0                             \n\t"
+                "movi v29.4s, #0                             \n\t"
+                "movi v30.4s, #0                             \n\t"
+                "movi v31.4s, #0                             \n\t"
+                "2:                                          \n\t"
+                "ld1 {v0.8h}, [%[pa]], #16                   \n\t"    // A微面板的一列：8个半精度元素
+                "ld1 {v2.8h}, [%[pb]], #16                   \n\t"    // B微面板的一行：前8列
+                "ld1 {v3.4h}, [%[pb]], #8                    \n\t"    // 后4列
+                ".inst 0x4f800048                            \n\t"    // fmlal v8.4s, v2.4h, v0.h[0]，c0x += a[0] * b[0:12]，乘积加宽为FP32
+                ".inst 0x6f808049                            \n\t"    // fmlal2 v9.4s, v2.4h, v0.h[0]
+                ".inst 0x4f80006a                            \n\t"    // fmlal v10.4s, v3.4h, v0.h[0]
+                ".inst 0x4f90004b                            \n\t"    // fmlal v11.4s, v2.4h, v0.h[1]，c1x += a[1] * b[0:12]，乘积加宽为FP32
+                ".inst 0x6f90804c                            \n\t"    // fmlal2 v12.4s, v2.4h, v0.h[1]
+                ".inst 0x4f90006d                            \n\t"    // fmlal v13.4s, v3.4h, v0.h[1]
+                ".inst 0x4fa0004e                            \n\t"    // fmlal v14.4s, v2.4h, v0.h[2]，c2x += a[2] * b[0:12]，乘积加宽为FP32
+                ".inst 0x6fa0804f                            \n\t"    // fmlal2 v15.4s, v2.4h, v0.h[2]
+                ".inst 0x4fa00070                            \n\t"    // fmlal v16.4s, v3.4h, v0.h[2]
+                ".inst 0x4fb00051                            \n\t"    // fmlal v17.4s, v2.4h, v0.h[3]，c3x += a[3] * b[0:12]，乘积加宽为FP32
+                ".inst 0x6fb08052                            \n\t"    // fmlal2 v18.4s, v2.4h, v0.h[3]
+                ".inst 0x4fb00073                            \n\t"    // fmlal v19.4s, v3.4h, v0.h[3]
+                ".inst 0x4f800854                            \n\t"    // fmlal v20.4s, v2.4h, v0.h[4]，c4x += a[4] * b[0:12]，乘积加宽为FP32
+                ".inst 0x6f808855                            \n\t"    // fmlal2 v21.4s, v2.4h, v0.h[4]
+                ".inst 0x4f800876                            \n\t"    // fmlal v22.4s, v3.4h, v0.h[4]
+                ".inst 0x4f900857                            \n\t"    // fmlal v23.4s, v2.4h, v0.h[5]，c5x += a[5] * b[0:12]，乘积加宽为FP32
+                ".inst 0x6f908858                            \n\t"    // fmlal2 v24.4s, v2.4h, v0.h[5]
+                ".inst 0x4f900879                            \n\t"    // fmlal v25.4s, v3.4h, v0.h[5]
+                ".inst 0x4fa0085a                            \n\t"    // fmlal v26.4s, v2.4h, v0.h[6]，c6x += a[6] * b[0:12]，乘积加宽为FP32
+                ".inst 0x6fa0885b                            \n\t"    // fmlal2 v27.4s, v2.4h, v0.h[6]
+                ".inst 0x4fa0087c                            \n\t"    // fmlal v28.4s, v3.4h, v0.h[6]
+                ".inst 0x4fb0085d                            \n\t"    // fmlal v29.4s, v2.4h, v0.h[7]，c7x += a[7] * b[0:12]，乘积加宽为FP32
+                ".inst 0x6fb0885e                            \n\t"    // fmlal2 v30.4s, v2.4h, v0.h[7]
+                ".inst 0x4fb0087f                            \n\t"    // fmlal v31.4s, v3.4h, v0.h[7]
+                "subs %w[kc], %w[kc], #1                     \n\t"    // k--
+                "b.ne 2b                                     \n\t"
+                "mov x9, %[c]                                \n\t"
+                "st1 {v8.4s, v9.4s, v10.4s}, [x9], %[ldc]    \n\t"    // 写回C
+                "st1 {v11.4s, v12.4s, v13.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v14.4s, v15.4s, v16.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v17.4s, v18.4s, v19.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v20.4s, v21.4s, v22.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v23.4s, v24.4s, v25.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v26.4s, v27.4s, v28.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v29.4s, v30.4s, v31.4s}, [x9], %[ldc]  \n\t"
+        : [pa] "+r"(packed_a),
+          [pb] "+r"(packed_b),
+          [kc] "+r"(kc)
+        : [c] "r"(c),
+          [ldc] "r"(ldc_bytes),
+          [accumulate] "r"(accumulate)
+        : "cc", "memory", "x9", "v0", "v2", "v3", "v8", "v9", "v10", "v11", "v12", "v13", "v14", "v15", "v16",
+          "v17", "v18", "v19", "v20", "v21", "v22", "v23", "v24", "v25", "v26", "v27", "v28", "v29", "v30",
+          "v31"
+    );
+}
+
+// BF16 8x12：A、B按相邻两个k成对打包，BFDOT 每个FP32通道累加 b[k][j]*a[k] + b[k+1][j]*a[k+1]，
+// 每条指令完成两个k，kc 为偶数
+static void hgemm_kernel_bfdot(int kc, const uint16_t *packed_a, const uint16_t *packed_b, float *c, int ldc,
+                               int accumulate)
+{
+    long ldc_bytes = (long)ldc * sizeof(float);
+    __asm__ __volatile__(
+                "mov x9, %[c]                                \n\t"    // x9: C的行指针
+                "cbz %w[accumulate], 1f                      \n\t"    // 首个K分块：累加器清零
+                "ld1 {v8.4s, v9.4s, v10.4s}, [x9], %[ldc]    \n\t"    // 从C读取8行x12列
+                "ld1 {v11.4s, v12.4s, v13.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v14.4s, v15.4s, v16.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v17.4s, v18.4s, v19.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v20.4s, v21.4s, v22.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v23.4s, v24.4s, v25.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v26.4s, v27.4s, v28.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v29.4s, v30.4s, v31.4s}, [x9], %[ldc]  \n\t"
+                "b 2f                                        \n\t"
+                "1:                                          \n\t"
+                "movi v8.4s, #0                              \n\t"
+                "movi v9.4s, #0                              \n\t"
+                "movi v10.4s, #0                             \n\t"
+                "movi v11.4s, #0                             \n\t"
+                "movi v12.4s, #0                             \n\t"
+                "movi v13.4s, #0                             \n\t"
+                "movi v14.4s, #0                             \n\t"
+                "movi v15.4s, #0                             \n\t"
+                "movi v16.4s, #0                             \n\t"
+                "movi v17.4s, #0                             \n\t"
+                "movi v18.4s, #0                             \n\t"
+                "movi v19.4s, #0                             \n\t"
+                "movi v20.4s, #0                             \n\t"
+                "movi v21.4s, #0                             \n\t"
+                "movi v22.4s, #0                             \n\t"
+                "movi v23.4s, #0                             \n\t"
+                "movi v24.4s, #0                             \n\t"
+                "movi v25.4s, #0                             \n\t"
+                "movi v26.4s, #0                             \n\t"
+                "movi v27.4s, #0                             \n\t"
+                "movi v28.4s, #0                             \n\t"
+                "movi v29.4s, #0                             \n\t"
+                "movi v30.4s, #0                             \n\t"
+                "movi v31.4s, #0                             \n\t"
+                "2:                                          \n\t"
+                "ld1 {v0.8h, v1.8h}, [%[pa]], #32            \n\t"    // A：8行 x 相邻两个k
+                "ld1 {v2.8h, v3.8h, v4.8h}, [%[pb]], #48     \n\t"    // B：12列 x 相邻两个k
+                ".inst 0x4f40f048                            \n\t"    // bfdot v8.4s, v2.8h, v0.2h[0]，c0x += a[0][k:k+2] . b[k:k+2][0:12]
+                ".inst 0x4f40f069                            \n\t"    // bfdot v9.4s, v3.8h, v0.2h[0]
+                ".inst 0x4f40f08a                            \n\t"    // bfdot v10.4s, v4.8h, v0.2h[0]
+                ".inst 0x4f60f04b                            \n\t"    // bfdot v11.4s, v2.8h, v0.2h[1]，c1x += a[1][k:k+2] . b[k:k+2][0:12]
+                ".inst 0x4f60f06c                            \n\t"    // bfdot v12.4s, v3.8h, v0.2h[1]
+                ".inst 0x4f60f08d                            \n\t"    // bfdot v13.4s, v4.8h, v0.2h[1]
+                ".inst 0x4f40f84e                            \n\t"    // bfdot v14.4s, v2.8h, v0.2h[2]，c2x += a[2][k:k+2] . b[k:k+2][0:12]
+                ".inst 0x4f40f86f                            \n\t"    // bfdot v15.4s, v3.8h, v0.2h[2]
+                ".inst 0x4f40f890                            \n\t"    // bfdot v16.4s, v4.8h, v0.2h[2]
+                ".inst 0x4f60f851                            \n\t"    // bfdot v17.4s, v2.8h, v0.2h[3]，c3x += a[3][k:k+2] . b[k:k+2][0:12]
+                ".inst 0x4f60f872                            \n\t"    // bfdot v18.4s, v3.8h, v0.2h[3]
+                ".inst 0x4f60f893                            \n\t"    // bfdot v19.4s, v4.8h, v0.2h[3]
+                ".inst 0x4f41f054                            \n\t"    // bfdot v20.4s, v2.8h, v1.2h[0]，c4x += a[4][k:k+2] . b[k:k+2][0:12]
+                ".inst 0x4f41f075                            \n\t"    // bfdot v21.4s, v3.8h, v1.2h[0]
+                ".inst 0x4f41f096                            \n\t"    // bfdot v22.4s, v4.8h, v1.2h[0]
+                ".inst 0x4f61f057                            \n\t"    // bfdot v23.4s, v2.8h, v1.2h[1]，c5x += a[5][k:k+2] . b[k:k+2][0:12]
+                ".inst 0x4f61f078                            \n\t"    // bfdot v24.4s, v3.8h, v1.2h[1]
+                ".inst 0x4f61f099                            \n\t"    // bfdot v25.4s, v4.8h, v1.2h[1]
+                ".inst 0x4f41f85a                            \n\t"    // bfdot v26.4s, v2.8h, v1.2h[2]，c6x += a[6][k:k+2] . b[k:k+2][0:12]
+                ".inst 0x4f41f87b                            \n\t"    // bfdot v27.4s, v3.8h, v1.2h[2]
+                ".inst 0x4f41f89c                            \n\t"    // bfdot v28.4s, v4.8h, v1.2h[2]
+                ".inst 0x4f61f85d                            \n\t"    // bfdot v29.4s, v2.8h, v1.2h[3]，c7x += a[7][k:k+2] . b[k:k+2][0:12]
+                ".inst 0x4f61f87e                            \n\t"    // bfdot v30.4s, v3.8h, v1.2h[3]
+                ".inst 0x4f61f89f                            \n\t"    // bfdot v31.4s, v4.8h, v1.2h[3]
+                "subs %w[kc], %w[kc], #2                     \n\t"    // k -= 2
+                "b.ne 2b                                     \n\t"
+                "mov x9, %[c]                                \n\t"
+                "st1 {v8.4s, v9.4s, v10.4s}, [x9], %[ldc]    \n\t"    // 写回C
+                "st1 {v11.4s, v12.4s, v13.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v14.4s, v15.4s, v16.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v17.4s, v18.4s, v19.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v20.4s, v21.4s, v22.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v23.4s, v24.4s, v25.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v26.4s, v27.4s, v28.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v29.4s, v30.4s, v31.4s}, [x9], %[ldc]  \n\t"
+        : [pa] "+r"(packed_a),
+          [pb] "+r"(packed_b),
+          [kc] "+r"(kc)
+        : [c] "r"(c),
+          [ldc] "r"(ldc_bytes),
+          [accumulate] "r"(accumulate)
+        : "cc", "memory", "x9", "v0", "v1", "v2", "v3", "v4", "v8", "v9", "v10", "v11", "v12", "v13", "v14",
+          "v15", "v16", "v17", "v18", "v19", "v20", "v21", "v22", "v23", "v24", "v25", "v26", "v27", "v28",
+          "v29", "v30", "v31"
+    );
+}
+
+const hgemm_ukernel_t hgemm_ukernel_fp16_fhm = { "neon_fhm_8x12", CONV_DTYPE_FP16, 8, 12, 128, 1, hgemm_kernel_fhm };
+const hgemm_ukernel_t hgemm_ukernel_bf16_bfdot = { "neon_bfdot_8x12", CONV_DTYPE_BF16, 8, 12, 128, 2, hgemm_kernel_bfdot };
+#endif
+
+const hgemm_ukernel_t *hgemm_ukernel(conv_dtype_t dtype)
+{
+    const conv_dispatch_t *d = conv_dispatch();
+    return dtype == CONV_DTYPE_BF16 ? d->hgemm_bf16 : d->hgemm_fp16;
+}
+
+// 多线程划分与 sgemm_blocked_batched 相同：C按 m_parts x n_parts 划分为子块，每个子块一个任务
+// C不保存完整的FP32矩阵：每个线程把当前 NC 列的累加结果放在自己的条带缓冲区（子块行数 x nc_max）中，
+// 缓冲区行、列都补齐到 MR / NR 的倍数，微内核总是写完整的块（打包时不足的行、列补零），不需要边界路径
+typedef struct {
+    conv_dtype_t dtype;
+    int m, n, k;
+    const uint16_t *a;
+    int lda;
+    const uint16_t *b;
+    int ldb;
+    uint16_t *c;
+    int ldc;
+    int c_batch_cols;                      // C的列按该列数分组，每组属于一张图像
+    size_t c_batch_stride;                 // 相邻两组的起点间距（元素个数）
+    const float *bias;
+    const conv_epilogue_t *epilogue;       // 写回前的后处理，无偏置也无激活时为NULL
+    int m_parts, n_parts;
+    int nc_max;
+    const hgemm_ukernel_t *uk;
+    size_t packed_a_size, packed_b_size;   // 每个线程的打包缓冲区大小（元素个数）
+    size_t strip_size;                     // 每个线程的FP32条带缓冲区大小（float个数）
+    char *buffers;                         // 所有线程的打包缓冲区和条带缓冲区
+} hgemm_parallel_t;
+
+// 每个线程的缓冲区：打包的A、B（16位）之后是FP32条带，条带按64字节对齐
+static size_t hgemm_thread_bytes(size_t packed_a_size, size_t packed_b_size, size_t strip_size)
+{
+    return conv_ws_bytes((packed_a_size + packed_b_size) * sizeof(uint16_t)) + conv_ws_bytes(strip_size * sizeof(float));
+}
+
+// 条带为 rows 行时的 nc_max：条带不超过 HGEMM_STRIP_BYTES，至少 NR 列，不超过 NC
+static int hgemm_strip_cols(const hgemm_ukernel_t *uk, int rows)
+{
+    int cols = (int)(HGEMM_STRIP_BYTES / ((size_t)rows * sizeof(float))) / uk->nr * uk->nr;
+    return cols < uk->nr ? uk->nr : min_int(cols, HGEMM_NC);
+}
+
+// 最后一个K分块写完 C 的行 [row, row + mc) x 列 [col, col + nc) 后，趁条带还在L2中做后处理，
+// 舍入为16位后按列所属的图像写回；strip 指向该块在条带中的第一行，行距为 nc_max
+static void hgemm_store_block(const hgemm_parallel_t *p, float *strip, int row, int mc, int col, int nc)
+{
+    for (int r = 0; r < mc; r++) {
+        float *src = strip + (size_t)r * p->nc_max;
+        if (p->epilogue) {
+            conv_epilogue_apply(p->epilogue, p->bias ? p->bias[row + r] : 0.0f, src, nc);
+        }
+        for (int j = col; j < col + nc;) {
+            int group = j / p->c_batch_cols;
+            int group_end = min_int((group + 1) * p->c_batch_cols, col + nc);
+            uint16_t *dst = p->c + group * p->c_batch_stride + (size_t)(row + r) * p->ldc + (j - group * p->c_batch_cols);
+            conv_convert_from_fp32(p->dtype, src + (j - col), dst, group_end - j);
+            j = group_end;
+        }
+    }
+}
+
+static void hgemm_block_range(const hgemm_parallel_t *p, int m0, int m1, int n0, int n1,
+                              uint16_t *packed_a, uint16_t *packed_b, float *strip)
+{
+    const hgemm_ukernel_t *uk = p->uk;
+
+    for (int jc = n0; jc < n1; jc += p->nc_max) {
+        int nc = min_int(p->nc_max, n1 - jc);
+        for (int pc = 0; pc < p->k; pc += HGEMM_KC) {
+            int kc = min_int(HGEMM_KC, p->k - pc);
+            int kc_pad = (kc + uk->kpair - 1) / uk->kpair * uk->kpair;
+            // 第一个K分块覆盖条带，之后的K分块在FP32中累加，最后一个K分块之后写回
+            int accumulate = pc > 0;
+            int last = pc + kc == p->k;
+
+            hgemm_pack_b(p->b + (size_t)pc * p->ldb + jc, p->ldb, kc, nc, uk->nr, uk->kpair, packed_b);
+
+            for (int ic = m0; ic < m1; ic += uk->mc) {
+                int mc = min_int(uk->mc, m1 - ic);
+                float *block = strip + (size_t)(ic - m0) * p->nc_max;
+                hgemm_pack_a(p->a + (size_t)ic * p->lda + pc, p->lda, mc, kc, uk->mr, uk->kpair, packed_a);
+
+                for (int jr = 0; jr < nc; jr += uk->nr) {
+                    for (int ir = 0; ir < mc; ir += uk->mr) {
+                        uk->kernel(kc_pad, packed_a + (size_t)ir * kc_pad, packed_b + (size_t)jr * kc_pad,
+                                   block + (size_t)ir * p->nc_max + jr, p->nc_max, accumulate);
+                    }
+                }
+                if (last) {
+                    hgemm_store_block(p, block, ic, mc, jc, nc);
+                }
+            }
+        }
+    }
+}
+
+// 把 units 个单元均匀分成 parts 份，返回第 part 份的起点
+static int split_point(int units, int parts, int part)
+{
+    return (int)((long long)units * part / parts);
+}
+
+static void hgemm_task(void *ctx, int task, int thread_id)
+{
+    hgemm_parallel_t *p = (hgemm_parallel_t *)ctx;
+    int mi = task / p->n_parts;
+    int ni = task % p->n_parts;
+    int mr = p->uk->mr;
+    int nr = p->uk->nr;
+    int m_units = (p->m + mr - 1) / mr;
+    int n_units = (p->n + nr - 1) / nr;
+    int m0 = split_point(m_units, p->m_parts, mi) * mr;
+    int m1 = min_int(split_point(m_units, p->m_parts, mi + 1) * mr, p->m);
+    int n0 = split_point(n_units, p->n_parts, ni) * nr;
+    int n1 = min_int(split_point(n_units, p->n_parts, ni + 1) * nr, p->n);
+    char *buffer = p->buffers + (size_t)thread_id * hgemm_thread_bytes(p->packed_a_size, p->packed_b_size, p->strip_size);
+    uint16_t *packed_a = (uint16_t *)buffer;
+    uint16_t *packed_b = packed_a + p->packed_a_size;
+    float *strip = (float *)(buffer + conv_ws_bytes((p->packed_a_size + p->packed_b_size) * sizeof(uint16_t)));
+
+    if (m0 >= m1 || n0 >= n1) {
+        return;
+    }
+    hgemm_block_range(p, m0, m1, n0, n1, packed_a, packed_b, strip);
+}
+
+// 与划分无关的上界：条带行数不超过 m 补齐到 MR 的倍数，条带不超过 HGEMM_STRIP_BYTES 与 MR 行 x NR 列中的较大者，
+// B块的宽度不超过 NC，也不超过 n 补齐到 NR 的倍数
+size_t hgemm_workspace_size(conv_dtype_t dtype, int m, int n)
+{
+    const hgemm_ukernel_t *uk = hgemm_ukernel(dtype);
+    int m_pad = (m + uk->mr - 1) / uk->mr * uk->mr;
+    size_t strip_size = HGEMM_STRIP_BYTES / sizeof(float);
+    size_t packed_b_size = (size_t)HGEMM_KC * min_int(HGEMM_NC, (n + uk->nr - 1) / uk->nr * uk->nr);
+
+    if (strip_size < (size_t)m_pad * uk->nr) {
+        strip_size = (size_t)m_pad * uk->nr;
+    }
+    return (size_t)conv_parallel_threads() * hgemm_thread_bytes((size_t)uk->mc * HGEMM_KC, packed_b_size, strip_size);
+}
+
+int hgemm_blocked(conv_dtype_t dtype, int m, int n, int k, const uint16_t *a, int lda, const uint16_t *b, int ldb,
+                  uint16_t *c, int ldc, int c_batch_cols, size_t c_batch_stride, const float *bias,
+                  const conv_epilogue_t *epilogue, void *workspace)
+{
+    static const conv_epilogue_t bias_only;   // 只有偏置时：无激活、不截断
+    hgemm_parallel_t p;
+    int num_threads = conv_parallel_threads();
+    const hgemm_ukernel_t *uk = hgemm_ukernel(dtype);
+    int m_units = (m + uk->mr - 1) / uk->mr;
+    int n_units = (n + uk->nr - 1) / uk->nr;
+
+    p.dtype = dtype;
+    p.m = m;
+    p.n = n;
+    p.k = k;
+    p.a = a;
+    p.lda = lda;
+    p.b = b;
+    p.ldb = ldb;
+    p.c = c;
+    p.ldc = ldc;
+    p.c_batch_cols = c_batch_cols;
+    p.c_batch_stride = c_batch_stride;
+    p.bias = bias;
+    p.epilogue = epilogue && conv_epilogue_active(epilogue) ? epilogue : (bias ? &bias_only : NULL);
+    p.uk = uk;
+
+    // 优先沿剩余块数较多的维度继续切分，直到子块数不少于线程数
+    p.m_parts = 1;
+    p.n_parts = 1;
+    while (p.m_parts * p.n_parts < num_threads) {
+        int can_split_m = p.m_parts < m_units;
+        int can_split_n = p.n_parts < n_units;
+        if (can_split_n && (!can_split_m || n_units / p.n_parts >= m_units / p.m_parts)) {
+            p.n_parts++;
+        } else if (can_split_m) {
+            p.m_parts++;
+        } else {
+            break;
+        }
+    }
+
+    // 条带的行数为最大子块的行数（补齐到 MR），列数按 HGEMM_STRIP_BYTES 选择
+    int strip_rows = (m_units + p.m_parts - 1) / p.m_parts * uk->mr;
+    int n_part_max = (n_units + p.n_parts - 1) / p.n_parts * uk->nr;
+    p.nc_max = min_int(hgemm_strip_cols(uk, strip_rows), n_part_max);
+    p.packed_a_size = (size_t)uk->mc * HGEMM_KC;
+    p.packed_b_size = (size_t)HGEMM_KC * p.nc_max;
+    p.strip_size = (size_t)strip_rows * p.nc_max;
+
+    // 缓冲区按64字节（缓存行）对齐，每个线程一份
+    p.buffers = (char *)workspace;
+    if (!workspace &&
+        posix_memalign((void **)&p.buffers, 64,
+                       (size_t)num_threads * hgemm_thread_bytes(p.packed_a_size, p.packed_b_size, p.strip_size)) != 0) {
+        return CONV_ERR_NOMEM;
+    }
+
+    conv_parallel_for(p.m_parts * p.n_parts, hgemm_task, &p);
+
+    if (!workspace) {
+        free(p.buffers);
+    }
+    return CONV_OK;
+}
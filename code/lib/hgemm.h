@@ -0,0 +1,73 @@
+#ifndef ARM64_HGEMM_H
+#define ARM64_HGEMM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "conv.h"
+
+// 16位输入（FP16 / BF16）、FP32累加的分块矩阵乘法，供低精度卷积使用（见 conv2d_lowp）
+//
+// 分块结构与 sgemm.h 相同（NC / KC / MC 三层分块，A、B打包为微面板），区别在于：
+//   A、B按16位打包，同样大小的L1/L2能容纳两倍的K，因此 KC 取 SGEMM_KC 的两倍；
+//   累加始终为FP32，跨K分块的累加不损失精度；完整的FP32结果矩阵并不存在，每个线程只保留当前 NC 列的
+//   FP32条带（不超过 HGEMM_STRIP_BYTES，驻留L2），最后一个K分块之后逐 MC x NC 块加偏置、做后处理并舍入到16位写回。
+// FP16 的 FMLA 在半精度累加器中求和，C_in*k*k 上千时误差远大于输入本身的舍入误差，因此不使用；
+// 各微内核都把16位乘数加宽后在FP32中累加：
+//   ARM64 FP16+FHM:  8x12，FMLAL/FMLAL2 直接把半精度乘积累加到24个FP32累加器（寄存器分配与 sgemm 的8x12相同）
+//   ARM64 BF16:      8x12，BFDOT 每条指令累加相邻两个k的乘积，A、B按k成对交错打包
+//   x86-64 AVX-512:  14x32，FP16 由 vcvtph2ps、BF16 由左移16位转换为FP32后做FMA；
+//                    有 AVX512_BF16 时BF16改用 vdpbf16ps，与BFDOT相同按k成对打包
+//   x86-64 AVX2+FMA: 6x16，FP16 需要 F16C，转换方式与AVX-512版本相同
+//   其他:            8x12 的C实现，逐元素转换
+// 微内核在运行时按CPU特性和数据类型从调度表中选择（见 cpu_dispatch.h）
+
+#define HGEMM_KC   512
+#define HGEMM_NC   3072     // 12、16、32 的公倍数
+#define HGEMM_STRIP_BYTES (256 << 10)   // 每个线程的FP32条带（子块行数 x NC），行数多时按它缩小 NC
+
+// 微内核：C[MR x NR] (+)= packed_a^T * packed_b，kc 为打包后的K长度（kpair 为2时是偶数）
+// accumulate 为0时覆盖C，否则累加到C上；ldc 以float为单位
+typedef void (*hgemm_kernel_fn)(int kc, const uint16_t *packed_a, const uint16_t *packed_b, float *c, int ldc,
+                                int accumulate);
+
+typedef struct {
+    const char *name;
+    conv_dtype_t dtype;     // 处理的16位格式
+    int mr, nr;
+    int mc;                 // A的行分块，mr 的整数倍
+    int kpair;              // 1：微面板内每个k存放 mr / nr 个元素；2：相邻两个k交错成对存放，K补齐为偶数
+    hgemm_kernel_fn kernel;
+} hgemm_ukernel_t;
+
+// 各架构的微内核，由 cpu_dispatch.c 按CPU特性选择；只在对应的架构上存在
+extern const hgemm_ukernel_t hgemm_ukernel_fp16_default;   // C实现
+extern const hgemm_ukernel_t hgemm_ukernel_bf16_default;
+extern const hgemm_ukernel_t hgemm_ukernel_fp16_fhm;       // ARM64
+extern const hgemm_ukernel_t hgemm_ukernel_bf16_bfdot;
+extern const hgemm_ukernel_t hgemm_ukernel_fp16_avx512;    // x86-64
+extern const hgemm_ukernel_t hgemm_ukernel_bf16_avx512;
+extern const hgemm_ukernel_t hgemm_ukernel_bf16_avx512bf16;
+extern const hgemm_ukernel_t hgemm_ukernel_fp16_avx2;
+extern const hgemm_ukernel_t hgemm_ukernel_bf16_avx2;
+
+// 当前使用的微内核（调度表中该数据类型的一项），dtype 为 CONV_DTYPE_FP16 或 CONV_DTYPE_BF16
+const hgemm_ukernel_t *hgemm_ukernel(conv_dtype_t dtype);
+
+// C = epilogue(A * B + bias)，舍入为16位
+// A: m x k（行距 lda），B: k x n（行距 ldb），均为 dtype 的行主序16位矩阵；C: m x n 的 dtype 矩阵，
+// 列每 c_batch_cols 列为一组，第g组从 c + g * c_batch_stride 开始，组内行距为 ldc（与 sgemm_blocked_batched 相同，
+// 卷积把batch折叠进N维时直接按NCHW写回）；第i行加 bias[i] 后按 epilogue 激活和截断，bias、epilogue 都可以为NULL
+// workspace 至少 hgemm_workspace_size 字节、64字节对齐，NULL 时内部分配；成功返回0，分配失败返回 CONV_ERR_NOMEM
+int hgemm_blocked(conv_dtype_t dtype, int m, int n, int k, const uint16_t *a, int lda, const uint16_t *b, int ldb,
+                  uint16_t *c, int ldc, int c_batch_cols, size_t c_batch_stride, const float *bias,
+                  const conv_epilogue_t *epilogue, void *workspace);
+
+// hgemm_blocked 所需的缓冲区字节数（每个线程一份打包的A、B块和FP32条带），按当前线程数计算
+size_t hgemm_workspace_size(conv_dtype_t dtype, int m, int n);
+
+// 打包：与 sgemm_pack_a / sgemm_pack_b 相同，kpair 为2时相邻两个k交错存放，kc 为奇数时最后一对的第二个元素补零
+void hgemm_pack_a(const uint16_t *a, int lda, int mc, int kc, int mr, int kpair, uint16_t *packed_a);
+void hgemm_pack_b(const uint16_t *b, int ldb, int kc, int nc, int nr, int kpair, uint16_t *packed_b);
+
+#endif // ARM64_HGEMM_H
@@ -0,0 +1,563 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conv_internal.h"
+#include "cpu_dispatch.h"
+#include "qgemm.h"
+#include "thread_pool.h"
+
+#if CONV_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+static int min_int(int a, int b)
+{
+    return a < b ? a : b;
+}
+
+static int round_up(int x, int multiple)
+{
+    return (x + multiple - 1) / multiple * multiple;
+}
+
+void qgemm_pack_a(const int8_t *a, int lda, int m, int k, int mr, int kgroup, int8_t *packed_a, int32_t *row_sum)
+{
+    int k_pad = round_up(k, kgroup);
+
+    for (int i = 0; i < m; i += mr) {
+        int rows = min_int(mr, m - i);
+        for (int p = 0; p < k_pad; p += kgroup) {
+            for (int r = 0; r < mr; r++) {
+                const int8_t *a_row = a + (size_t)(i + r) * lda + p;
+                for (int q = 0; q < kgroup; q++) {
+                    packed_a[r * kgroup + q] = r < rows && p + q < k ? a_row[q] : 0;
+                }
+            }
+            packed_a += mr * kgroup;
+        }
+    }
+    for (int i = 0; i < m && row_sum; i++) {
+        int32_t sum = 0;
+        for (int p = 0; p < k; p++) {
+            sum += a[(size_t)i * lda + p];
+        }
+        row_sum[i] = sum;
+    }
+}
+
+// 完整的一组：kgroup 行 x nr 列转置为每列 kgroup 个字节连续；kgroup 为常数时编译器把它向量化为交错写入
+static inline void pack_b_group(const int8_t *b, int ldb, int nr, int kgroup, uint8_t flip, int8_t *packed_b)
+{
+    for (int j = 0; j < nr; j++) {
+        for (int q = 0; q < kgroup; q++) {
+            packed_b[j * kgroup + q] = (int8_t)((uint8_t)b[(size_t)q * ldb + j] ^ flip);
+        }
+    }
+}
+
+void qgemm_pack_b(const int8_t *b, int ldb, int k, int cols, int nr, int kgroup, int b_offset, int8_t *packed_b)
+{
+    int k_pad = round_up(k, kgroup);
+    uint8_t flip = b_offset ? 0x80 : 0;   // int8 的 x + 128 作为uint8即 x ^ 0x80
+    int p = 0;
+
+    if (cols == nr) {
+        for (; p + kgroup <= k; p += kgroup) {
+            if (kgroup == 4) {
+                pack_b_group(b + (size_t)p * ldb, ldb, nr, 4, flip, packed_b);
+            } else if (kgroup == 8) {
+                pack_b_group(b + (size_t)p * ldb, ldb, nr, 8, flip, packed_b);
+            } else {
+                break;
+            }
+            packed_b += nr * kgroup;
+        }
+    }
+    // 其余部分（最后一个不完整的组、不足 nr 的列）逐个元素打包并补0
+    for (; p < k_pad; p += kgroup) {
+        for (int q = 0; q < kgroup; q++) {
+            const int8_t *b_row = b + (size_t)(p + q) * ldb;
+            int valid = p + q < k ? cols : 0;
+            for (int j = 0; j < valid; j++) {
+                packed_b[j * kgroup + q] = (int8_t)((uint8_t)b_row[j] ^ flip);
+            }
+            for (int j = valid; j < nr; j++) {
+                packed_b[j * kgroup + q] = 0;
+            }
+        }
+        packed_b += nr * kgroup;
+    }
+}
+
+// 8x12 的C实现，kgroup 4
+static void qgemm_kernel_c(int kc, const int8_t *packed_a, const int8_t *packed_b, int32_t *c, int ldc)
+{
+    int32_t acc[8][12];
+
+    memset(acc, 0, sizeof(acc));
+    for (int p = 0; p < kc; p += 4) {
+        for (int r = 0; r < 8; r++) {
+            for (int j = 0; j < 12; j++) {
+                for (int q = 0; q < 4; q++) {
+                    acc[r][j] += packed_a[r * 4 + q] * packed_b[j * 4 + q];
+                }
+            }
+        }
+        packed_a += 32;
+        packed_b += 48;
+    }
+    for (int r = 0; r < 8; r++) {
+        memcpy(c + (size_t)r * ldc, acc[r], sizeof(acc[r]));
+    }
+}
+
+const qgemm_ukernel_t qgemm_ukernel_default = { "c_8x12", 8, 12, 4, 0, qgemm_kernel_c };
+
+#if CONV_X86_DISPATCH
+// 14x32：结构与 sgemm_kernel_avx512 相同，B的一组（32列 x 4个k）为两个zmm，A一行的4个k作为32位广播；
+// vpdpbusd 的第一个乘数为无符号字节，因此B（已加128）在前、权重在后
+__attribute__((target("avx512f,avx512vnni")))
+static void qgemm_kernel_avx512vnni(int kc, const int8_t *packed_a, const int8_t *packed_b, int32_t *c, int ldc)
+{
+    __m512i acc[14][2];
+
+    _Pragma("GCC unroll 14")
+    for (int r = 0; r < 14; r++) {
+        acc[r][0] = _mm512_setzero_si512();
+        acc[r][1] = _mm512_setzero_si512();
+    }
+    for (int p = 0; p < kc; p += 4) {
+        __m512i b0 = _mm512_loadu_si512(packed_b);
+        __m512i b1 = _mm512_loadu_si512(packed_b + 64);
+        _Pragma("GCC unroll 14")
+        for (int r = 0; r < 14; r++) {
+            int32_t quad;
+            memcpy(&quad, packed_a + 4 * r, sizeof(quad));
+            __m512i a = _mm512_set1_epi32(quad);
+            acc[r][0] = _mm512_dpbusd_epi32(acc[r][0], b0, a);
+            acc[r][1] = _mm512_dpbusd_epi32(acc[r][1], b1, a);
+        }
+        packed_a += 56;
+        packed_b += 128;
+    }
+    _Pragma("GCC unroll 14")
+    for (int r = 0; r < 14; r++) {
+        _mm512_storeu_si512(c + (size_t)r * ldc, acc[r][0]);
+        _mm512_storeu_si512(c + (size_t)r * ldc + 16, acc[r][1]);
+    }
+}
+
+// 6x16：与AVX-512版本结构相同，每行两个ymm
+__attribute__((target("avx2,avxvnni")))
+static void qgemm_kernel_avxvnni(int kc, const int8_t *packed_a, const int8_t *packed_b, int32_t *c, int ldc)
+{
+    __m256i acc[6][2];
+
+    _Pragma("GCC unroll 6")
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = _mm256_setzero_si256();
+        acc[r][1] = _mm256_setzero_si256();
+    }
+    for (int p = 0; p < kc; p += 4) {
+        __m256i b0 = _mm256_loadu_si256((const __m256i *)packed_b);
+        __m256i b1 = _mm256_loadu_si256((const __m256i *)(packed_b + 32));
+        _Pragma("GCC unroll 6")
+        for (int r = 0; r < 6; r++) {
+            int32_t quad;
+            memcpy(&quad, packed_a + 4 * r, sizeof(quad));
+            __m256i a = _mm256_set1_epi32(quad);
+            acc[r][0] = _mm256_dpbusd_avx_epi32(acc[r][0], b0, a);
+            acc[r][1] = _mm256_dpbusd_avx_epi32(acc[r][1], b1, a);
+        }
+        packed_a += 24;
+        packed_b += 64;
+    }
+    _Pragma("GCC unroll 6")
+    for (int r = 0; r < 6; r++) {
+        _mm256_storeu_si256((__m256i *)(c + (size_t)r * ldc), acc[r][0]);
+        _mm256_storeu_si256((__m256i *)(c + (size_t)r * ldc + 8), acc[r][1]);
+    }
+}
+
+const qgemm_ukernel_t qgemm_ukernel_avx512vnni = { "avx512vnni_14x32", 14, 32, 4, 128, qgemm_kernel_avx512vnni };
+const qgemm_ukernel_t qgemm_ukernel_avxvnni = { "avxvnni_6x16", 6, 16, 4, 128, qgemm_kernel_avxvnni };
+#endif
+
+#if defined(__aarch64__)
+// ARM64 微内核：24个int32累加器常驻 v8-v31，整个K求完后一次写回结果块
+// SDOT / SMMLA 以 .inst 编码给出（注释为对应的指令），与 hgemm.c 相同，不需要汇编器支持 dotprod / i8mm 扩展
+
+// 8x12 SDOT：累加器与 sgemm 的8x12相同（第r行为 v(8+3r)..v(10+3r)），
+// 每个int32通道累加 b[k..k+3][j] . a[r][k..k+3]，一条指令完成4个k
+static void qgemm_kernel_sdot(int kc, const int8_t *packed_a, const int8_t *packed_b, int32_t *c, int ldc)
+{
+    long ldc_bytes = (long)ldc * sizeof(int32_t);
+    __asm__ __volatile__(
+                "movi v8.4s, #0                              \n\t"    // 累加器清零
+                "movi v9.4s, #0                              \n\t"
+                "movi v10.4s, #0                             \n\t"
+                "movi v11.4s, #0                             \n\t"
+                "movi v12.4s, #0                             \n\t"
+                "movi v13.4s, #0                             \n\t"
+                "movi v14.4s, #0                             \n\t"
+                "movi v15.4s, #0                             \n\t"
+                "movi v16.4s, #0                             \n\t"
+                "movi v17.4s, #0                             \n\t"
+                "movi v18.4s, #0                             \n\t"
+                "movi v19.4s, #0                             \n\t"
+                "movi v20.4s, #0                             \n\t"
+                "movi v21.4s, #0                             \n\t"
+                "movi v22.4s, #0                             \n\t"
+                "movi v23.4s, #0                             \n\t"
+                "movi v24.4s, #0                             \n\t"
+                "movi v25.4s, #0                             \n\t"
+                "movi v26.4s, #0                             \n\t"
+                "movi v27.4s, #0                             \n\t"
+                "movi v28.4s, #0                             \n\t"
+                "movi v29.4s, #0                             \n\t"
+                "movi v30.4s, #0                             \n\t"
+                "movi v31.4s, #0                             \n\t"
+                "1:                                          \n\t"
+                "ld1 {v0.16b, v1.16b}, [%[pa]], #32          \n\t"    // A：8行 x 相邻4个k
+                "ld1 {v2.16b, v3.16b, v4.16b}, [%[pb]], #48  \n\t"    // B：12列 x 相邻4个k
+                ".inst 0x4f80e048                            \n\t"    // sdot v8.4s, v2.16b, v0.4b[0]，c0x += a[0][k:k+4] . b[k:k+4][0:12]
+                ".inst 0x4f80e069                            \n\t"    // sdot v9.4s, v3.16b, v0.4b[0]
+                ".inst 0x4f80e08a                            \n\t"    // sdot v10.4s, v4.16b, v0.4b[0]
+                ".inst 0x4fa0e04b                            \n\t"    // sdot v11.4s, v2.16b, v0.4b[1]，c1x += a[1][k:k+4] . b[k:k+4][0:12]
+                ".inst 0x4fa0e06c                            \n\t"    // sdot v12.4s, v3.16b, v0.4b[1]
+                ".inst 0x4fa0e08d                            \n\t"    // sdot v13.4s, v4.16b, v0.4b[1]
+                ".inst 0x4f80e84e                            \n\t"    // sdot v14.4s, v2.16b, v0.4b[2]，c2x += a[2][k:k+4] . b[k:k+4][0:12]
+                ".inst 0x4f80e86f                            \n\t"    // sdot v15.4s, v3.16b, v0.4b[2]
+                ".inst 0x4f80e890                            \n\t"    // sdot v16.4s, v4.16b, v0.4b[2]
+                ".inst 0x4fa0e851                            \n\t"    // sdot v17.4s, v2.16b, v0.4b[3]，c3x += a[3][k:k+4] . b[k:k+4][0:12]
+                ".inst 0x4fa0e872                            \n\t"    // sdot v18.4s, v3.16b, v0.4b[3]
+                ".inst 0x4fa0e893                            \n\t"    // sdot v19.4s, v4.16b, v0.4b[3]
+                ".inst 0x4f81e054                            \n\t"    // sdot v20.4s, v2.16b, v1.4b[0]，c4x += a[4][k:k+4] . b[k:k+4][0:12]
+                ".inst 0x4f81e075                            \n\t"    // sdot v21.4s, v3.16b, v1.4b[0]
+                ".inst 0x4f81e096                            \n\t"    // sdot v22.4s, v4.16b, v1.4b[0]
+                ".inst 0x4fa1e057                            \n\t"    // sdot v23.4s, v2.16b, v1.4b[1]，c5x += a[5][k:k+4] . b[k:k+4][0:12]
+                ".inst 0x4fa1e078                            \n\t"    // sdot v24.4s, v3.16b, v1.4b[1]
+                ".inst 0x4fa1e099                            \n\t"    // sdot v25.4s, v4.16b, v1.4b[1]
+                ".inst 0x4f81e85a                            \n\t"    // sdot v26.4s, v2.16b, v1.4b[2]，c6x += a[6][k:k+4] . b[k:k+4][0:12]
+                ".inst 0x4f81e87b                            \n\t"    // sdot v27.4s, v3.16b, v1.4b[2]
+                ".inst 0x4f81e89c                            \n\t"    // sdot v28.4s, v4.16b, v1.4b[2]
+                ".inst 0x4fa1e85d                            \n\t"    // sdot v29.4s, v2.16b, v1.4b[3]，c7x += a[7][k:k+4] . b[k:k+4][0:12]
+                ".inst 0x4fa1e87e                            \n\t"    // sdot v30.4s, v3.16b, v1.4b[3]
+                ".inst 0x4fa1e89f                            \n\t"    // sdot v31.4s, v4.16b, v1.4b[3]
+                "subs %w[kc], %w[kc], #4                     \n\t"    // k -= 4
+                "b.ne 1b                                     \n\t"
+                "mov x9, %[c]                                \n\t"
+                "st1 {v8.4s, v9.4s, v10.4s}, [x9], %[ldc]    \n\t"    // 写回int32结果块
+                "st1 {v11.4s, v12.4s, v13.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v14.4s, v15.4s, v16.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v17.4s, v18.4s, v19.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v20.4s, v21.4s, v22.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v23.4s, v24.4s, v25.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v26.4s, v27.4s, v28.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v29.4s, v30.4s, v31.4s}, [x9], %[ldc]  \n\t"
+        : [pa] "+r"(packed_a),
+          [pb] "+r"(packed_b),
+          [kc] "+r"(kc)
+        : [c] "r"(c),
+          [ldc] "r"(ldc_bytes)
+        : "cc", "memory", "x9", "v0", "v1", "v2", "v3", "v4", "v8", "v9", "v10", "v11", "v12", "v13", "v14",
+          "v15", "v16", "v17", "v18", "v19", "v20", "v21", "v22", "v23", "v24", "v25", "v26", "v27", "v28",
+          "v29", "v30", "v31"
+    );
+}
+
+// 8x12 SMMLA：v(8+6i+j) 为第i个行对与第j个列对的2x2块 [c(2i,2j) c(2i,2j+1) c(2i+1,2j) c(2i+1,2j+1)]，
+// 一条指令完成 2x2x8 = 32次乘加（SDOT为16次）；写回前用 zip1 / zip2 把2x2块拼回行
+static void qgemm_kernel_smmla(int kc, const int8_t *packed_a, const int8_t *packed_b, int32_t *c, int ldc)
+{
+    long ldc_bytes = (long)ldc * sizeof(int32_t);
+    __asm__ __volatile__(
+                "movi v8.4s, #0                              \n\t"    // 累加器清零
+                "movi v9.4s, #0                              \n\t"
+                "movi v10.4s, #0                             \n\t"
+                "movi v11.4s, #0                             \n\t"
+                "movi v12.4s, #0                             \n\t"
+                "movi v13.4s, #0                             \n\t"
+                "movi v14.4s, #0                             \n\t"
+                "movi v15.4s, #0                             \n\t"
+                "movi v16.4s, #0                             \n\t"
+                "movi v17.4s, #0                             \n\t"
+                "movi v18.4s, #0                             \n\t"
+                "movi v19.4s, #0                             \n\t"
+                "movi v20.4s, #0                             \n\t"
+                "movi v21.4s, #0                             \n\t"
+                "movi v22.4s, #0                             \n\t"
+                "movi v23.4s, #0                             \n\t"
+                "movi v24.4s, #0                             \n\t"
+                "movi v25.4s, #0                             \n\t"
+                "movi v26.4s, #0                             \n\t"
+                "movi v27.4s, #0                             \n\t"
+                "movi v28.4s, #0                             \n\t"
+                "movi v29.4s, #0                             \n\t"
+                "movi v30.4s, #0                             \n\t"
+                "movi v31.4s, #0                             \n\t"
+                "1:                                          \n\t"
+                "ld1 {v0.16b, v1.16b, v2.16b, v3.16b}, [%[pa]], #64 \n\t"    // A：4个行对，每对2行 x 8个k
+                "ld1 {v4.16b, v5.16b, v6.16b, v7.16b}, [%[pb]], #64 \n\t"    // B：列对0-3，每对2列 x 8个k
+                ".inst 0x4e84a408                            \n\t"    // smmla v8.4s, v0.16b, v4.16b，行对0 x 列对0
+                ".inst 0x4e84a42e                            \n\t"    // smmla v14.4s, v1.16b, v4.16b
+                ".inst 0x4e84a454                            \n\t"    // smmla v20.4s, v2.16b, v4.16b
+                ".inst 0x4e84a47a                            \n\t"    // smmla v26.4s, v3.16b, v4.16b
+                ".inst 0x4e85a409                            \n\t"    // smmla v9.4s, v0.16b, v5.16b
+                ".inst 0x4e85a42f                            \n\t"    // smmla v15.4s, v1.16b, v5.16b
+                ".inst 0x4e85a455                            \n\t"    // smmla v21.4s, v2.16b, v5.16b
+                ".inst 0x4e85a47b                            \n\t"    // smmla v27.4s, v3.16b, v5.16b
+                ".inst 0x4e86a40a                            \n\t"    // smmla v10.4s, v0.16b, v6.16b
+                ".inst 0x4e86a430                            \n\t"    // smmla v16.4s, v1.16b, v6.16b
+                ".inst 0x4e86a456                            \n\t"    // smmla v22.4s, v2.16b, v6.16b
+                ".inst 0x4e86a47c                            \n\t"    // smmla v28.4s, v3.16b, v6.16b
+                ".inst 0x4e87a40b                            \n\t"    // smmla v11.4s, v0.16b, v7.16b
+                ".inst 0x4e87a431                            \n\t"    // smmla v17.4s, v1.16b, v7.16b
+                ".inst 0x4e87a457                            \n\t"    // smmla v23.4s, v2.16b, v7.16b
+                ".inst 0x4e87a47d                            \n\t"    // smmla v29.4s, v3.16b, v7.16b
+                "ld1 {v4.16b, v5.16b}, [%[pb]], #32          \n\t"    // 列对4-5
+                ".inst 0x4e84a40c                            \n\t"    // smmla v12.4s, v0.16b, v4.16b
+                ".inst 0x4e84a432                            \n\t"    // smmla v18.4s, v1.16b, v4.16b
+                ".inst 0x4e84a458                            \n\t"    // smmla v24.4s, v2.16b, v4.16b
+                ".inst 0x4e84a47e                            \n\t"    // smmla v30.4s, v3.16b, v4.16b
+                ".inst 0x4e85a40d                            \n\t"    // smmla v13.4s, v0.16b, v5.16b
+                ".inst 0x4e85a433                            \n\t"    // smmla v19.4s, v1.16b, v5.16b
+                ".inst 0x4e85a459                            \n\t"    // smmla v25.4s, v2.16b, v5.16b
+                ".inst 0x4e85a47f                            \n\t"    // smmla v31.4s, v3.16b, v5.16b
+                "subs %w[kc], %w[kc], #8                     \n\t"    // k -= 8
+                "b.ne 1b                                     \n\t"
+                "mov x9, %[c]                                \n\t"
+                "zip1 v0.2d, v8.2d, v9.2d                    \n\t"    // 2x2块的低64位为第0行，高64位为第1行
+                "zip1 v1.2d, v10.2d, v11.2d                  \n\t"
+                "zip1 v2.2d, v12.2d, v13.2d                  \n\t"
+                "zip2 v3.2d, v8.2d, v9.2d                    \n\t"
+                "zip2 v4.2d, v10.2d, v11.2d                  \n\t"
+                "zip2 v5.2d, v12.2d, v13.2d                  \n\t"
+                "st1 {v0.4s, v1.4s, v2.4s}, [x9], %[ldc]     \n\t"
+                "st1 {v3.4s, v4.4s, v5.4s}, [x9], %[ldc]     \n\t"
+                "zip1 v0.2d, v14.2d, v15.2d                  \n\t"
+                "zip1 v1.2d, v16.2d, v17.2d                  \n\t"
+                "zip1 v2.2d, v18.2d, v19.2d                  \n\t"
+                "zip2 v3.2d, v14.2d, v15.2d                  \n\t"
+                "zip2 v4.2d, v16.2d, v17.2d                  \n\t"
+                "zip2 v5.2d, v18.2d, v19.2d                  \n\t"
+                "st1 {v0.4s, v1.4s, v2.4s}, [x9], %[ldc]     \n\t"
+                "st1 {v3.4s, v4.4s, v5.4s}, [x9], %[ldc]     \n\t"
+                "zip1 v0.2d, v20.2d, v21.2d                  \n\t"
+                "zip1 v1.2d, v22.2d, v23.2d                  \n\t"
+                "zip1 v2.2d, v24.2d, v25.2d                  \n\t"
+                "zip2 v3.2d, v20.2d, v21.2d                  \n\t"
+                "zip2 v4.2d, v22.2d, v23.2d                  \n\t"
+                "zip2 v5.2d, v24.2d, v25.2d                  \n\t"
+                "st1 {v0.4s, v1.4s, v2.4s}, [x9], %[ldc]     \n\t"
+                "st1 {v3.4s, v4.4s, v5.4s}, [x9], %[ldc]     \n\t"
+                "zip1 v0.2d, v26.2d, v27.2d                  \n\t"
+                "zip1 v1.2d, v28.2d, v29.2d                  \n\t"
+                "zip1 v2.2d, v30.2d, v31.2d                  \n\t"
+                "zip2 v3.2d, v26.2d, v27.2d                  \n\t"
+                "zip2 v4.2d, v28.2d, v29.2d                  \n\t"
+                "zip2 v5.2d, v30.2d, v31.2d                  \n\t"
+                "st1 {v0.4s, v1.4s, v2.4s}, [x9], %[ldc]     \n\t"
+                "st1 {v3.4s, v4.4s, v5.4s}, [x9], %[ldc]     \n\t"
+        : [pa] "+r"(packed_a),
+          [pb] "+r"(packed_b),
+          [kc] "+r"(kc)
+        : [c] "r"(c),
+          [ldc] "r"(ldc_bytes)
+        : "cc", "memory", "x9", "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7", "v8", "v9", "v10", "v11",
+          "v12", "v13", "v14", "v15", "v16", "v17", "v18", "v19", "v20", "v21", "v22", "v23", "v24", "v25",
+          "v26", "v27", "v28", "v29", "v30", "v31"
+    );
+}
+
+const qgemm_ukernel_t qgemm_ukernel_sdot = { "neon_sdot_8x12", 8, 12, 4, 0, qgemm_kernel_sdot };
+const qgemm_ukernel_t qgemm_ukernel_smmla = { "neon_smmla_8x12", 8, 12, 8, 0, qgemm_kernel_smmla };
+#endif
+
+const qgemm_ukernel_t *qgemm_ukernel(void)
+{
+    return conv_dispatch()->qgemm;
+}
+
+// 多线程划分与 sgemm_blocked_batched 相同：C按 m_parts x n_parts 划分为子块，每个子块一个任务
+typedef struct {
+    int m, n, k, k_pad;
+    const int8_t *packed_a;     // 整个A，所有线程共享
+    const int8_t *b;
+    int ldb;
+    const int32_t *bias;        // 已包含零点修正：bias[i] - (b_zero_point + b_offset) * sum_k a[i][k]
+    const float *scale;
+    int zero_point;
+    int min, max;
+    int8_t *c;
+    int ldc;
+    int c_batch_cols;
+    size_t c_batch_stride;
+    int m_parts, n_parts;
+    const qgemm_ukernel_t *uk;
+    int8_t *packed_b;           // 每个线程一个B面板
+} qgemm_parallel_t;
+
+// 四舍五入并饱和：加 128.5 后截到 [min + 128, max + 128]（非负整数），非负数截断即向下取整；
+// 比较写成 v > lo ? v : lo 的形式，编译器可以直接生成 max / min 指令，循环得以向量化
+static inline int8_t qgemm_requant(int32_t acc, float scale, float offset, float lo, float hi)
+{
+    float v = (float)acc * scale + offset;
+    v = v > lo ? v : lo;
+    v = v < hi ? v : hi;
+    return (int8_t)((int)v - 128);
+}
+
+// 把 rows x cols 的int32结果块重新量化后写回C；跨越两组（两张图像）的块按组拆开
+// int8_t 的写入可能与 p 的成员重叠，循环中用到的值都先读到局部变量里，内层循环才能向量化
+static void qgemm_store_tile(const qgemm_parallel_t *p, const int32_t *tile, int tile_ld, int i0, int rows,
+                             int j0, int cols)
+{
+    float offset = (float)p->zero_point + 128.5f;
+    float lo = (float)(p->min + 128);
+    float hi = (float)(p->max + 128);
+
+    for (int r = 0; r < rows; r++) {
+        int i = i0 + r;
+        int32_t bias = p->bias[i];
+        float scale = p->scale[i];
+        for (int jj = 0; jj < cols;) {
+            int j = j0 + jj;
+            int group = j / p->c_batch_cols;
+            int col = j % p->c_batch_cols;
+            int count = min_int(cols - jj, p->c_batch_cols - col);
+            int8_t *dst = p->c + group * p->c_batch_stride + (size_t)i * p->ldc + col;
+            const int32_t *src = tile + r * tile_ld + jj;
+            for (int q = 0; q < count; q++) {
+                dst[q] = qgemm_requant(src[q] + bias, scale, offset, lo, hi);
+            }
+            jj += count;
+        }
+    }
+}
+
+// B的每个 nr 列面板打包一次，与范围内所有行块相乘；结果块在L1中重新量化后写回
+static void qgemm_block_range(const qgemm_parallel_t *p, int m0, int m1, int n0, int n1, int8_t *packed_b)
+{
+    const qgemm_ukernel_t *uk = p->uk;
+    int32_t tile[QGEMM_MR_MAX * QGEMM_NR_MAX];
+
+    for (int jr = n0; jr < n1; jr += uk->nr) {
+        int nr = min_int(uk->nr, n1 - jr);
+        qgemm_pack_b(p->b + jr, p->ldb, p->k, nr, uk->nr, uk->kgroup, uk->b_offset, packed_b);
+        for (int ir = m0; ir < m1; ir += uk->mr) {
+            int mr = min_int(uk->mr, m1 - ir);
+            uk->kernel(p->k_pad, p->packed_a + (size_t)ir * p->k_pad, packed_b, tile, uk->nr);
+            qgemm_store_tile(p, tile, uk->nr, ir, mr, jr, nr);
+        }
+    }
+}
+
+// 把 units 个单元均匀分成 parts 份，返回第 part 份的起点
+static int split_point(int units, int parts, int part)
+{
+    return (int)((long long)units * part / parts);
+}
+
+static void qgemm_task(void *ctx, int task, int thread_id)
+{
+    qgemm_parallel_t *p = (qgemm_parallel_t *)ctx;
+    int mi = task / p->n_parts;
+    int ni = task % p->n_parts;
+    int mr = p->uk->mr;
+    int nr = p->uk->nr;
+    int m_units = (p->m + mr - 1) / mr;
+    int n_units = (p->n + nr - 1) / nr;
+    int m0 = split_point(m_units, p->m_parts, mi) * mr;
+    int m1 = min_int(split_point(m_units, p->m_parts, mi + 1) * mr, p->m);
+    int n0 = split_point(n_units, p->n_parts, ni) * nr;
+    int n1 = min_int(split_point(n_units, p->n_parts, ni + 1) * nr, p->n);
+
+    if (m0 >= m1 || n0 >= n1) {
+        return;
+    }
+    qgemm_block_range(p, m0, m1, n0, n1, p->packed_b + (size_t)thread_id * p->k_pad * nr);
+}
+
+// 缓冲区依次为打包的A、每个线程一个B面板和修正后的偏置，各自按64字节（缓存行）对齐
+static size_t qgemm_packed_a_bytes(const qgemm_ukernel_t *uk, int m, int k)
+{
+    return conv_ws_bytes((size_t)(m + uk->mr - 1) / uk->mr * uk->mr * round_up(k, uk->kgroup));
+}
+
+static size_t qgemm_packed_b_bytes(const qgemm_ukernel_t *uk, int k)
+{
+    return conv_ws_bytes((size_t)conv_parallel_threads() * round_up(k, uk->kgroup) * uk->nr);
+}
+
+size_t qgemm_workspace_size(int m, int k)
+{
+    const qgemm_ukernel_t *uk = qgemm_ukernel();
+
+    return qgemm_packed_a_bytes(uk, m, k) + qgemm_packed_b_bytes(uk, k) + conv_ws_bytes((size_t)m * sizeof(int32_t));
+}
+
+int qgemm_blocked(int m, int n, int k, const int8_t *a, int lda, const int8_t *b, int ldb, const qgemm_requant_t *rq,
+                  int8_t *c, int ldc, int c_batch_cols, size_t c_batch_stride, void *workspace)
+{
+    qgemm_parallel_t p;
+    int num_threads = conv_parallel_threads();
+    const qgemm_ukernel_t *uk = qgemm_ukernel();
+    int m_units = (m + uk->mr - 1) / uk->mr;
+    int n_units = (n + uk->nr - 1) / uk->nr;
+    int k_pad = round_up(k, uk->kgroup);
+    size_t packed_a_bytes = qgemm_packed_a_bytes(uk, m, k);
+    size_t packed_b_bytes = qgemm_packed_b_bytes(uk, k);
+    int8_t *packed = (int8_t *)workspace;
+
+    if (!workspace && posix_memalign((void **)&packed, 64, qgemm_workspace_size(m, k)) != 0) {
+        return CONV_ERR_NOMEM;
+    }
+    int32_t *bias = (int32_t *)(packed + packed_a_bytes + packed_b_bytes);
+    qgemm_pack_a(a, lda, m, k, uk->mr, uk->kgroup, packed, bias);
+    for (int i = 0; i < m; i++) {
+        bias[i] = (rq->bias ? rq->bias[i] : 0) - (rq->b_zero_point + uk->b_offset) * bias[i];
+    }
+
+    p.m = m;
+    p.n = n;
+    p.k = k;
+    p.k_pad = k_pad;
+    p.packed_a = packed;
+    p.b = b;
+    p.ldb = ldb;
+    p.bias = bias;
+    p.scale = rq->scale;
+    p.zero_point = rq->zero_point;
+    p.min = rq->min;
+    p.max = rq->max;
+    p.c = c;
+    p.ldc = ldc;
+    p.c_batch_cols = c_batch_cols;
+    p.c_batch_stride = c_batch_stride;
+    p.uk = uk;
+    p.packed_b = packed + packed_a_bytes;
+
+    // 优先沿剩余块数较多的维度继续切分，直到子块数不少于线程数
+    p.m_parts = 1;
+    p.n_parts = 1;
+    while (p.m_parts * p.n_parts < num_threads) {
+        int can_split_m = p.m_parts < m_units;
+        int can_split_n = p.n_parts < n_units;
+        if (can_split_n && (!can_split_m || n_units / p.n_parts >= m_units / p.m_parts)) {
+            p.n_parts++;
+        } else if (can_split_m) {
+            p.m_parts++;
+        } else {
+            break;
+        }
+    }
+
+    conv_parallel_for(p.m_parts * p.n_parts, qgemm_task, &p);
+
+    if (!workspace) {
+        free(packed);
+    }
+    return CONV_OK;
+}
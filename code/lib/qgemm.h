@@ -0,0 +1,75 @@
+#ifndef ARM64_QGEMM_H
+#define ARM64_QGEMM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "conv.h"
+
+// INT8 矩阵乘法：int8 x int8，int32 累加，写回时重新量化为 int8，供INT8卷积使用（见 conv2d_int8）
+//
+// 与 sgemm.h / hgemm.h 的分块方式不同：
+//   不在K上分块，微内核一次求完整个K的内积，MR x NR 的int32结果块留在栈上，
+//   随即加偏置、乘以该行的比例、加零点并饱和到int8写回，不需要完整的int32中间矩阵；
+//   A（权重）整体打包一次，在所有线程间共享；B 按 NR 列的面板在各线程内打包，面板在所有行块间复用。
+//   打包时K每 kgroup 个一组：每组内第r行（第j列）的 kgroup 个元素连续存放，K补齐部分为0
+// 微内核在运行时按CPU特性从调度表中选择（见 cpu_dispatch.h）：
+//   ARM64 I8MM:         8x12，SMMLA 每条指令计算 2x8 与 8x2 的乘积（2x2块），kgroup 8
+//   ARM64 DOTPROD:      8x12，SDOT 每个int32通道累加相邻4个k的乘积，kgroup 4
+//   x86-64 AVX512_VNNI: 14x32，vpdpbusd，kgroup 4
+//   x86-64 AVX_VNNI:    6x16，VEX编码的 vpdpbusd，kgroup 4
+//   其他:               8x12 的C实现
+// vpdpbusd 为无符号 x 有符号：B打包时每个字节异或0x80（即加128），偏置中减去 128 * 该行权重之和
+
+#define QGEMM_MR_MAX 14     // 所有微内核中最大的 MR / NR，用于结果块的栈缓冲区
+#define QGEMM_NR_MAX 32
+#define QGEMM_KGROUP_MAX 8
+
+// 微内核：C[MR x NR] = packed_a^T * packed_b（int32，覆盖C），kc 为补齐到 kgroup 整数倍的K长度；ldc 以int32为单位
+typedef void (*qgemm_kernel_fn)(int kc, const int8_t *packed_a, const int8_t *packed_b, int32_t *c, int ldc);
+
+typedef struct {
+    const char *name;
+    int mr, nr;
+    int kgroup;             // 打包时K的分组大小
+    int b_offset;           // B打包时每个元素加上的偏移：0，或 vpdpbusd 的128
+    qgemm_kernel_fn kernel;
+} qgemm_ukernel_t;
+
+// 各架构的微内核，由 cpu_dispatch.c 按CPU特性选择；只在对应的架构上存在
+extern const qgemm_ukernel_t qgemm_ukernel_default;    // C实现
+extern const qgemm_ukernel_t qgemm_ukernel_sdot;       // ARM64
+extern const qgemm_ukernel_t qgemm_ukernel_smmla;
+extern const qgemm_ukernel_t qgemm_ukernel_avx512vnni; // x86-64
+extern const qgemm_ukernel_t qgemm_ukernel_avxvnni;
+
+// 当前使用的微内核（调度表中的一项）
+const qgemm_ukernel_t *qgemm_ukernel(void);
+
+// 重新量化参数：y[i][j] = saturate(round((acc[i][j] + bias[i]) * scale[i]) + zero_point)
+// 其中 acc[i][j] = sum_k a[i][k] * (b[k][j] - b_zero_point)，round 为四舍五入（0.5 向上），
+// saturate 截到 [min, max]（ReLU 等后处理换算成的量化区间，不需要时为 [-128, 127]）
+typedef struct {
+    const int32_t *bias;    // m 个，可以为NULL
+    const float *scale;     // m 个
+    int b_zero_point;
+    int zero_point;
+    int min, max;           // -128 <= min <= max <= 127
+} qgemm_requant_t;
+
+// C = requant(A * B)
+// A: m x k（行距 lda），B: k x n（行距 ldb），均为行主序int8矩阵；
+// C 的列与 sgemm_blocked_batched 相同按组写回：每 c_batch_cols 列为一组，第g组从 c + g * c_batch_stride 开始，组内行距为 ldc
+// workspace 至少 qgemm_workspace_size 字节、64字节对齐，NULL 时内部分配；成功返回0，分配失败返回 CONV_ERR_NOMEM
+int qgemm_blocked(int m, int n, int k, const int8_t *a, int lda, const int8_t *b, int ldb, const qgemm_requant_t *rq,
+                  int8_t *c, int ldc, int c_batch_cols, size_t c_batch_stride, void *workspace);
+
+// qgemm_blocked 所需的缓冲区字节数（打包的A、每个线程一个B面板和修正后的偏置），按当前线程数计算
+size_t qgemm_workspace_size(int m, int k);
+
+// 打包：qgemm_pack_a 打包整个A（m 补齐到 mr 的整数倍），row_sum 非NULL时输出每行之和；
+// qgemm_pack_b 打包B的一个 nr 列面板（cols <= nr，不足部分补0）
+void qgemm_pack_a(const int8_t *a, int lda, int m, int k, int mr, int kgroup, int8_t *packed_a, int32_t *row_sum);
+void qgemm_pack_b(const int8_t *b, int ldb, int k, int cols, int nr, int kgroup, int b_offset, int8_t *packed_b);
+
+#endif // ARM64_QGEMM_H
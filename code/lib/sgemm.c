@@ -0,0 +1,1348 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conv_internal.h"
+#include "cpu_dispatch.h"
+#include "sgemm.h"
+#include "thread_pool.h"
+
+#if CONV_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+static int min_int(int a, int b)
+{
+    return a < b ? a : b;
+}
+
+void sgemm_pack_a(const float *a, int lda, int mc, int kc, int mr, float *packed_a)
+{
+    for (int i = 0; i < mc; i += mr) {
+        int rows = min_int(mr, mc - i);
+        for (int p = 0; p < kc; p++) {
+            for (int r = 0; r < rows; r++) {
+                packed_a[r] = a[(size_t)(i + r) * lda + p];
+            }
+            for (int r = rows; r < mr; r++) {
+                packed_a[r] = 0.0f;
+            }
+            packed_a += mr;
+        }
+    }
+}
+
+void sgemm_pack_b(const float *b, int ldb, int kc, int nc, int nr, float *packed_b)
+{
+    for (int j = 0; j < nc; j += nr) {
+        int cols = min_int(nr, nc - j);
+        for (int p = 0; p < kc; p++) {
+            const float *b_row = b + (size_t)p * ldb + j;
+            if (cols == nr) {
+                memcpy(packed_b, b_row, nr * sizeof(float));
+            } else {
+                for (int c = 0; c < cols; c++) {
+                    packed_b[c] = b_row[c];
+                }
+                for (int c = cols; c < nr; c++) {
+                    packed_b[c] = 0.0f;
+                }
+            }
+            packed_b += nr;
+        }
+    }
+}
+
+// C实现的后处理：对行距为 ld 的 mr x nr 块依次加偏置、激活、截断（与 conv_epilogue_apply 相同）
+// C微内核直接作用在累加器数组上；汇编微内核的寄存器放不下 exp 多项式的常数，SiLU 块写回后趁在L1中由这里完成
+static void sgemm_epilogue_tile(const sgemm_epilogue_t *epilogue, const float *bias, float *tile, int ld,
+                                int mr, int nr)
+{
+    for (int r = 0; r < mr; r++) {
+        float *row = tile + (size_t)r * ld;
+        if (bias) {
+            for (int j = 0; j < nr; j++) {
+                row[j] += epilogue->bias_on_cols ? bias[j] : bias[r];
+            }
+        }
+        if (epilogue->activation == CONV_ACT_LEAKY_RELU) {
+            for (int j = 0; j < nr; j++) {
+                row[j] = row[j] > 0.0f ? row[j] : row[j] * epilogue->alpha;
+            }
+        } else if (epilogue->activation == CONV_ACT_SILU) {
+            conv_silu(0.0f, row, nr);
+        }
+        if (epilogue->clamp) {
+            for (int j = 0; j < nr; j++) {
+                float v = row[j] > epilogue->lo ? row[j] : epilogue->lo;
+                row[j] = v < epilogue->hi ? v : epilogue->hi;
+            }
+        }
+    }
+}
+
+// 8x12 微内核：ARM64上为NEON汇编，其他架构为C实现
+static void sgemm_kernel_8x12(int kc, const float *packed_a, const float *packed_b, float *c, int ldc, int accumulate,
+                              const float *bias, const sgemm_epilogue_t *epilogue)
+{
+#if defined(__aarch64__)
+    // v8-v31: 8x12 累加器（第r行为 v(8+3r)..v(10+3r)），v0-v1: A，v2-v4: B；后处理时 v0-v7 为临时寄存器
+    // 后处理在写回前对累加器进行：行偏置用 fmla 按元素广播，LeakyReLU 用比较和按位选择，
+    // 截断用 fmaxnm / fminnm（NaN 截断为下界，与 conv_epilogue_apply 一致）；SiLU 时汇编只加偏置
+    long ldc_bytes = (long)ldc * sizeof(float);
+    int silu = epilogue && epilogue->activation == CONV_ACT_SILU;
+    const float *bias_ptr = epilogue ? bias : NULL;
+    long bias_cols = epilogue && epilogue->bias_on_cols;
+    long leaky = epilogue && epilogue->activation == CONV_ACT_LEAKY_RELU;
+    long clamp = epilogue && epilogue->clamp && !silu;
+    const float *params = epilogue ? &epilogue->alpha : NULL;
+    __asm__ __volatile__(
+                "mov x9, %[c]                                \n\t"    // x9: C的行指针
+                "cbz %w[accumulate], 1f                      \n\t"    // 首个K分块：累加器清零
+                "ld1 {v8.4s, v9.4s, v10.4s}, [x9], %[ldc]    \n\t"    // 从C读取8行x12列
+                "ld1 {v11.4s, v12.4s, v13.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v14.4s, v15.4s, v16.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v17.4s, v18.4s, v19.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v20.4s, v21.4s, v22.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v23.4s, v24.4s, v25.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v26.4s, v27.4s, v28.4s}, [x9], %[ldc]  \n\t"
+                "ld1 {v29.4s, v30.4s, v31.4s}, [x9], %[ldc]  \n\t"
+                "b 2f                                        \n\t"
+                "1:                                          \n\t"
+                "movi v8.4s, #0                              \n\t"
+                "movi v9.4s, #0                              \n\t"
+                "movi v10.4s, #0                             \n\t"
+                "movi v11.4s, #0                             \n\t"
+                "movi v12.4s, #0                             \n\t"
+                "movi v13.4s, #0                             \n\t"
+                "movi v14.4s, #0                             \n\t"
+                "movi v15.4s, #0                             \n\t"
+                "movi v16.4s, #0                             \n\t"
+                "movi v17.4s, #0                             \n\t"
+                "movi v18.4s, #0                             \n\t"
+                "movi v19.4s, #0                             \n\t"
+                "movi v20.4s, #0                             \n\t"
+                "movi v21.4s, #0                             \n\t"
+                "movi v22.4s, #0                             \n\t"
+                "movi v23.4s, #0                             \n\t"
+                "movi v24.4s, #0                             \n\t"
+                "movi v25.4s, #0                             \n\t"
+                "movi v26.4s, #0                             \n\t"
+                "movi v27.4s, #0                             \n\t"
+                "movi v28.4s, #0                             \n\t"
+                "movi v29.4s, #0                             \n\t"
+                "movi v30.4s, #0                             \n\t"
+                "movi v31.4s, #0                             \n\t"
+                "2:                                          \n\t"
+                "ld1 {v0.4s, v1.4s}, [%[pa]], #32            \n\t"    // A微面板的一列：8个元素
+                "ld1 {v2.4s, v3.4s, v4.4s}, [%[pb]], #48     \n\t"    // B微面板的一行：12个元素
+                "fmla v8.4s, v2.4s, v0.s[0]                  \n\t"    // c0x += a[0] * b[0:12]
+                "fmla v9.4s, v3.4s, v0.s[0]                  \n\t"
+                "fmla v10.4s, v4.4s, v0.s[0]                 \n\t"
+                "fmla v11.4s, v2.4s, v0.s[1]                 \n\t"    // c1x += a[1] * b[0:12]
+                "fmla v12.4s, v3.4s, v0.s[1]                 \n\t"
+                "fmla v13.4s, v4.4s, v0.s[1]                 \n\t"
+                "fmla v14.4s, v2.4s, v0.s[2]                 \n\t"    // c2x += a[2] * b[0:12]
+                "fmla v15.4s, v3.4s, v0.s[2]                 \n\t"
+                "fmla v16.4s, v4.4s, v0.s[2]                 \n\t"
+                "fmla v17.4s, v2.4s, v0.s[3]                 \n\t"    // c3x += a[3] * b[0:12]
+                "fmla v18.4s, v3.4s, v0.s[3]                 \n\t"
+                "fmla v19.4s, v4.4s, v0.s[3]                 \n\t"
+                "fmla v20.4s, v2.4s, v1.s[0]                 \n\t"    // c4x += a[4] * b[0:12]
+                "fmla v21.4s, v3.4s, v1.s[0]                 \n\t"
+                "fmla v22.4s, v4.4s, v1.s[0]                 \n\t"
+                "fmla v23.4s, v2.4s, v1.s[1]                 \n\t"    // c5x += a[5] * b[0:12]
+                "fmla v24.4s, v3.4s, v1.s[1]                 \n\t"
+                "fmla v25.4s, v4.4s, v1.s[1]                 \n\t"
+                "fmla v26.4s, v2.4s, v1.s[2]                 \n\t"    // c6x += a[6] * b[0:12]
+                "fmla v27.4s, v3.4s, v1.s[2]                 \n\t"
+                "fmla v28.4s, v4.4s, v1.s[2]                 \n\t"
+                "fmla v29.4s, v2.4s, v1.s[3]                 \n\t"    // c7x += a[7] * b[0:12]
+                "fmla v30.4s, v3.4s, v1.s[3]                 \n\t"
+                "fmla v31.4s, v4.4s, v1.s[3]                 \n\t"
+                "subs %w[kc], %w[kc], #1                     \n\t"    // k--
+                "b.ne 2b                                     \n\t"
+                "cbz %[bias], 5f                             \n\t"    // 后处理：加偏置
+                "cbnz %[bias_cols], 4f                       \n\t"
+                "ld1 {v0.4s, v1.4s}, [%[bias]]               \n\t"    // 行偏置 bias[0:8]
+                "fmov v5.4s, #1.0                            \n\t"
+                "fmla v8.4s, v5.4s, v0.s[0]                  \n\t"    // c0x += bias[0]
+                "fmla v9.4s, v5.4s, v0.s[0]                  \n\t"
+                "fmla v10.4s, v5.4s, v0.s[0]                 \n\t"
+                "fmla v11.4s, v5.4s, v0.s[1]                 \n\t"    // c1x += bias[1]
+                "fmla v12.4s, v5.4s, v0.s[1]                 \n\t"
+                "fmla v13.4s, v5.4s, v0.s[1]                 \n\t"
+                "fmla v14.4s, v5.4s, v0.s[2]                 \n\t"    // c2x += bias[2]
+                "fmla v15.4s, v5.4s, v0.s[2]                 \n\t"
+                "fmla v16.4s, v5.4s, v0.s[2]                 \n\t"
+                "fmla v17.4s, v5.4s, v0.s[3]                 \n\t"    // c3x += bias[3]
+                "fmla v18.4s, v5.4s, v0.s[3]                 \n\t"
+                "fmla v19.4s, v5.4s, v0.s[3]                 \n\t"
+                "fmla v20.4s, v5.4s, v1.s[0]                 \n\t"    // c4x += bias[4]
+                "fmla v21.4s, v5.4s, v1.s[0]                 \n\t"
+                "fmla v22.4s, v5.4s, v1.s[0]                 \n\t"
+                "fmla v23.4s, v5.4s, v1.s[1]                 \n\t"    // c5x += bias[5]
+                "fmla v24.4s, v5.4s, v1.s[1]                 \n\t"
+                "fmla v25.4s, v5.4s, v1.s[1]                 \n\t"
+                "fmla v26.4s, v5.4s, v1.s[2]                 \n\t"    // c6x += bias[6]
+                "fmla v27.4s, v5.4s, v1.s[2]                 \n\t"
+                "fmla v28.4s, v5.4s, v1.s[2]                 \n\t"
+                "fmla v29.4s, v5.4s, v1.s[3]                 \n\t"    // c7x += bias[7]
+                "fmla v30.4s, v5.4s, v1.s[3]                 \n\t"
+                "fmla v31.4s, v5.4s, v1.s[3]                 \n\t"
+                "b 5f                                        \n\t"
+                "4:                                          \n\t"
+                "ld1 {v2.4s, v3.4s, v4.4s}, [%[bias]]        \n\t"    // 列偏置 bias[0:12]
+                "fadd v8.4s, v8.4s, v2.4s                    \n\t"
+                "fadd v9.4s, v9.4s, v3.4s                    \n\t"
+                "fadd v10.4s, v10.4s, v4.4s                  \n\t"
+                "fadd v11.4s, v11.4s, v2.4s                  \n\t"
+                "fadd v12.4s, v12.4s, v3.4s                  \n\t"
+                "fadd v13.4s, v13.4s, v4.4s                  \n\t"
+                "fadd v14.4s, v14.4s, v2.4s                  \n\t"
+                "fadd v15.4s, v15.4s, v3.4s                  \n\t"
+                "fadd v16.4s, v16.4s, v4.4s                  \n\t"
+                "fadd v17.4s, v17.4s, v2.4s                  \n\t"
+                "fadd v18.4s, v18.4s, v3.4s                  \n\t"
+                "fadd v19.4s, v19.4s, v4.4s                  \n\t"
+                "fadd v20.4s, v20.4s, v2.4s                  \n\t"
+                "fadd v21.4s, v21.4s, v3.4s                  \n\t"
+                "fadd v22.4s, v22.4s, v4.4s                  \n\t"
+                "fadd v23.4s, v23.4s, v2.4s                  \n\t"
+                "fadd v24.4s, v24.4s, v3.4s                  \n\t"
+                "fadd v25.4s, v25.4s, v4.4s                  \n\t"
+                "fadd v26.4s, v26.4s, v2.4s                  \n\t"
+                "fadd v27.4s, v27.4s, v3.4s                  \n\t"
+                "fadd v28.4s, v28.4s, v4.4s                  \n\t"
+                "fadd v29.4s, v29.4s, v2.4s                  \n\t"
+                "fadd v30.4s, v30.4s, v3.4s                  \n\t"
+                "fadd v31.4s, v31.4s, v4.4s                  \n\t"
+                "5:                                          \n\t"
+                "cbz %[leaky], 6f                            \n\t"    // LeakyReLU：v > 0 ? v : v * alpha
+                "ld1r {v5.4s}, [%[params]]                   \n\t"    // alpha
+                "fmul v0.4s, v8.4s, v5.4s                    \n\t"
+                "fcmgt v1.4s, v8.4s, #0.0                    \n\t"
+                "bif v8.16b, v0.16b, v1.16b                  \n\t"
+                "fmul v2.4s, v9.4s, v5.4s                    \n\t"
+                "fcmgt v3.4s, v9.4s, #0.0                    \n\t"
+                "bif v9.16b, v2.16b, v3.16b                  \n\t"
+                "fmul v0.4s, v10.4s, v5.4s                   \n\t"
+                "fcmgt v1.4s, v10.4s, #0.0                   \n\t"
+                "bif v10.16b, v0.16b, v1.16b                 \n\t"
+                "fmul v2.4s, v11.4s, v5.4s                   \n\t"
+                "fcmgt v3.4s, v11.4s, #0.0                   \n\t"
+                "bif v11.16b, v2.16b, v3.16b                 \n\t"
+                "fmul v0.4s, v12.4s, v5.4s                   \n\t"
+                "fcmgt v1.4s, v12.4s, #0.0                   \n\t"
+                "bif v12.16b, v0.16b, v1.16b                 \n\t"
+                "fmul v2.4s, v13.4s, v5.4s                   \n\t"
+                "fcmgt v3.4s, v13.4s, #0.0                   \n\t"
+                "bif v13.16b, v2.16b, v3.16b                 \n\t"
+                "fmul v0.4s, v14.4s, v5.4s                   \n\t"
+                "fcmgt v1.4s, v14.4s, #0.0                   \n\t"
+                "bif v14.16b, v0.16b, v1.16b                 \n\t"
+                "fmul v2.4s, v15.4s, v5.4s                   \n\t"
+                "fcmgt v3.4s, v15.4s, #0.0                   \n\t"
+                "bif v15.16b, v2.16b, v3.16b                 \n\t"
+                "fmul v0.4s, v16.4s, v5.4s                   \n\t"
+                "fcmgt v1.4s, v16.4s, #0.0                   \n\t"
+                "bif v16.16b, v0.16b, v1.16b                 \n\t"
+                "fmul v2.4s, v17.4s, v5.4s                   \n\t"
+                "fcmgt v3.4s, v17.4s, #0.0                   \n\t"
+                "bif v17.16b, v2.16b, v3.16b                 \n\t"
+                "fmul v0.4s, v18.4s, v5.4s                   \n\t"
+                "fcmgt v1.4s, v18.4s, #0.0                   \n\t"
+                "bif v18.16b, v0.16b, v1.16b                 \n\t"
+                "fmul v2.4s, v19.4s, v5.4s                   \n\t"
+                "fcmgt v3.4s, v19.4s, #0.0                   \n\t"
+                "bif v19.16b, v2.16b, v3.16b                 \n\t"
+                "fmul v0.4s, v20.4s, v5.4s                   \n\t"
+                "fcmgt v1.4s, v20.4s, #0.0                   \n\t"
+                "bif v20.16b, v0.16b, v1.16b                 \n\t"
+                "fmul v2.4s, v21.4s, v5.4s                   \n\t"
+                "fcmgt v3.4s, v21.4s, #0.0                   \n\t"
+                "bif v21.16b, v2.16b, v3.16b                 \n\t"
+                "fmul v0.4s, v22.4s, v5.4s                   \n\t"
+                "fcmgt v1.4s, v22.4s, #0.0                   \n\t"
+                "bif v22.16b, v0.16b, v1.16b                 \n\t"
+                "fmul v2.4s, v23.4s, v5.4s                   \n\t"
+                "fcmgt v3.4s, v23.4s, #0.0                   \n\t"
+                "bif v23.16b, v2.16b, v3.16b                 \n\t"
+                "fmul v0.4s, v24.4s, v5.4s                   \n\t"
+                "fcmgt v1.4s, v24.4s, #0.0                   \n\t"
+                "bif v24.16b, v0.16b, v1.16b                 \n\t"
+                "fmul v2.4s, v25.4s, v5.4s                   \n\t"
+                "fcmgt v3.4s, v25.4s, #0.0                   \n\t"
+                "bif v25.16b, v2.16b, v3.16b                 \n\t"
+                "fmul v0.4s, v26.4s, v5.4s                   \n\t"
+                "fcmgt v1.4s, v26.4s, #0.0                   \n\t"
+                "bif v26.16b, v0.16b, v1.16b                 \n\t"
+                "fmul v2.4s, v27.4s, v5.4s                   \n\t"
+                "fcmgt v3.4s, v27.4s, #0.0                   \n\t"
+                "bif v27.16b, v2.16b, v3.16b                 \n\t"
+                "fmul v0.4s, v28.4s, v5.4s                   \n\t"
+                "fcmgt v1.4s, v28.4s, #0.0                   \n\t"
+                "bif v28.16b, v0.16b, v1.16b                 \n\t"
+                "fmul v2.4s, v29.4s, v5.4s                   \n\t"
+                "fcmgt v3.4s, v29.4s, #0.0                   \n\t"
+                "bif v29.16b, v2.16b, v3.16b                 \n\t"
+                "fmul v0.4s, v30.4s, v5.4s                   \n\t"
+                "fcmgt v1.4s, v30.4s, #0.0                   \n\t"
+                "bif v30.16b, v0.16b, v1.16b                 \n\t"
+                "fmul v2.4s, v31.4s, v5.4s                   \n\t"
+                "fcmgt v3.4s, v31.4s, #0.0                   \n\t"
+                "bif v31.16b, v2.16b, v3.16b                 \n\t"
+                "6:                                          \n\t"
+                "cbz %[clamp], 7f                            \n\t"    // 截断到 [lo, hi]
+                "add x10, %[params], #4                      \n\t"
+                "ld1r {v6.4s}, [x10], #4                     \n\t"    // lo
+                "ld1r {v7.4s}, [x10]                         \n\t"    // hi
+                "fmaxnm v8.4s, v8.4s, v6.4s                  \n\t"
+                "fminnm v8.4s, v8.4s, v7.4s                  \n\t"
+                "fmaxnm v9.4s, v9.4s, v6.4s                  \n\t"
+                "fminnm v9.4s, v9.4s, v7.4s                  \n\t"
+                "fmaxnm v10.4s, v10.4s, v6.4s                \n\t"
+                "fminnm v10.4s, v10.4s, v7.4s                \n\t"
+                "fmaxnm v11.4s, v11.4s, v6.4s                \n\t"
+                "fminnm v11.4s, v11.4s, v7.4s                \n\t"
+                "fmaxnm v12.4s, v12.4s, v6.4s                \n\t"
+                "fminnm v12.4s, v12.4s, v7.4s                \n\t"
+                "fmaxnm v13.4s, v13.4s, v6.4s                \n\t"
+                "fminnm v13.4s, v13.4s, v7.4s                \n\t"
+                "fmaxnm v14.4s, v14.4s, v6.4s                \n\t"
+                "fminnm v14.4s, v14.4s, v7.4s                \n\t"
+                "fmaxnm v15.4s, v15.4s, v6.4s                \n\t"
+                "fminnm v15.4s, v15.4s, v7.4s                \n\t"
+                "fmaxnm v16.4s, v16.4s, v6.4s                \n\t"
+                "fminnm v16.4s, v16.4s, v7.4s                \n\t"
+                "fmaxnm v17.4s, v17.4s, v6.4s                \n\t"
+                "fminnm v17.4s, v17.4s, v7.4s                \n\t"
+                "fmaxnm v18.4s, v18.4s, v6.4s                \n\t"
+                "fminnm v18.4s, v18.4s, v7.4s                \n\t"
+                "fmaxnm v19.4s, v19.4s, v6.4s                \n\t"
+                "fminnm v19.4s, v19.4s, v7.4s                \n\t"
+                "fmaxnm v20.4s, v20.4s, v6.4s                \n\t"
+                "fminnm v20.4s, v20.4s, v7.4s                \n\t"
+                "fmaxnm v21.4s, v21.4s, v6.4s                \n\t"
+                "fminnm v21.4s, v21.4s, v7.4s                \n\t"
+                "fmaxnm v22.4s, v22.4s, v6.4s                \n\t"
+                "fminnm v22.4s, v22.4s, v7.4s                \n\t"
+                "fmaxnm v23.4s, v23.4s, v6.4s                \n\t"
+                "fminnm v23.4s, v23.4s, v7.4s                \n\t"
+                "fmaxnm v24.4s, v24.4s, v6.4s                \n\t"
+                "fminnm v24.4s, v24.4s, v7.4s                \n\t"
+                "fmaxnm v25.4s, v25.4s, v6.4s                \n\t"
+                "fminnm v25.4s, v25.4s, v7.4s                \n\t"
+                "fmaxnm v26.4s, v26.4s, v6.4s                \n\t"
+                "fminnm v26.4s, v26.4s, v7.4s                \n\t"
+                "fmaxnm v27.4s, v27.4s, v6.4s                \n\t"
+                "fminnm v27.4s, v27.4s, v7.4s                \n\t"
+                "fmaxnm v28.4s, v28.4s, v6.4s                \n\t"
+                "fminnm v28.4s, v28.4s, v7.4s                \n\t"
+                "fmaxnm v29.4s, v29.4s, v6.4s                \n\t"
+                "fminnm v29.4s, v29.4s, v7.4s                \n\t"
+                "fmaxnm v30.4s, v30.4s, v6.4s                \n\t"
+                "fminnm v30.4s, v30.4s, v7.4s                \n\t"
+                "fmaxnm v31.4s, v31.4s, v6.4s                \n\t"
+                "fminnm v31.4s, v31.4s, v7.4s                \n\t"
+                "7:                                          \n\t"
+                "mov x9, %[c]                                \n\t"
+                "st1 {v8.4s, v9.4s, v10.4s}, [x9], %[ldc]    \n\t"    // 写回C
+                "st1 {v11.4s, v12.4s, v13.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v14.4s, v15.4s, v16.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v17.4s, v18.4s, v19.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v20.4s, v21.4s, v22.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v23.4s, v24.4s, v25.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v26.4s, v27.4s, v28.4s}, [x9], %[ldc]  \n\t"
+                "st1 {v29.4s, v30.4s, v31.4s}, [x9], %[ldc]  \n\t"
+        : [pa] "+r"(packed_a),
+          [pb] "+r"(packed_b),
+          [kc] "+r"(kc)
+        : [c] "r"(c),
+          [ldc] "r"(ldc_bytes),
+          [accumulate] "r"(accumulate),
+          [bias] "r"(bias_ptr),
+          [bias_cols] "r"(bias_cols),
+          [leaky] "r"(leaky),
+          [clamp] "r"(clamp),
+          [params] "r"(params)
+        : "cc", "memory", "x9", "x10",
+          "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7", "v8", "v9", "v10", "v11", "v12", "v13", "v14", "v15",
+          "v16", "v17", "v18", "v19", "v20", "v21", "v22", "v23", "v24", "v25", "v26", "v27",
+          "v28", "v29", "v30", "v31"
+    );
+    if (silu) {
+        sgemm_epilogue_tile(epilogue, NULL, c, ldc, 8, 12);
+    }
+#else
+    // 其他架构使用C语言实现
+    float acc[8][12];
+
+    for (int r = 0; r < 8; r++) {
+        for (int j = 0; j < 12; j++) {
+            acc[r][j] = accumulate ? c[(size_t)r * ldc + j] : 0.0f;
+        }
+    }
+    for (int p = 0; p < kc; p++) {
+        for (int r = 0; r < 8; r++) {
+            float a_val = packed_a[r];
+            for (int j = 0; j < 12; j++) {
+                acc[r][j] += a_val * packed_b[j];
+            }
+        }
+        packed_a += 8;
+        packed_b += 12;
+    }
+    if (epilogue) {
+        sgemm_epilogue_tile(epilogue, bias, &acc[0][0], 12, 8, 12);
+    }
+    for (int r = 0; r < 8; r++) {
+        for (int j = 0; j < 12; j++) {
+            c[(size_t)r * ldc + j] = acc[r][j];
+        }
+    }
+#endif
+}
+
+#if defined(__aarch64__)
+const sgemm_ukernel_t sgemm_ukernel_default = { "neon_8x12", 8, 12, 128, sgemm_kernel_8x12, NULL };
+#else
+const sgemm_ukernel_t sgemm_ukernel_default = { "c_8x12", 8, 12, 128, sgemm_kernel_8x12, NULL };
+#endif
+
+#if CONV_X86_DISPATCH
+// x86-64 微内核用 target 属性单独开启AVX2/AVX-512，不依赖编译选项，只在运行时检测到对应特性后调用
+// 后处理在写回前对累加器进行，SiLU 的 exp 与 conv_silu 的算法相同：x = n * ln2 + r，exp(r) 用 Cephes expf 的多项式
+__attribute__((target("avx512f")))
+static inline __m512 sgemm_exp_avx512(__m512 x)
+{
+    x = _mm512_max_ps(_mm512_min_ps(x, _mm512_set1_ps(88.0f)), _mm512_set1_ps(-87.0f));
+    __m512 n = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(1.44269504088896341f)),
+                                    _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(0.693359375f), x);
+    r = _mm512_fmadd_ps(n, _mm512_set1_ps(2.12194440e-4f), r);
+    __m512 y = _mm512_fmadd_ps(r, _mm512_set1_ps(1.9875691500e-4f), _mm512_set1_ps(1.3981999507e-3f));
+    y = _mm512_fmadd_ps(y, r, _mm512_set1_ps(8.3334519073e-3f));
+    y = _mm512_fmadd_ps(y, r, _mm512_set1_ps(4.1665795894e-2f));
+    y = _mm512_fmadd_ps(y, r, _mm512_set1_ps(1.6666665459e-1f));
+    y = _mm512_fmadd_ps(y, r, _mm512_set1_ps(5.0000001201e-1f));
+    y = _mm512_add_ps(_mm512_fmadd_ps(y, _mm512_mul_ps(r, r), r), _mm512_set1_ps(1.0f));
+    return _mm512_scalef_ps(y, n);   // y * 2^n
+}
+
+// v / (1 + exp(-v))
+__attribute__((target("avx512f")))
+static inline __m512 sgemm_silu_avx512(__m512 v)
+{
+    __m512 e = sgemm_exp_avx512(_mm512_sub_ps(_mm512_setzero_ps(), v));
+    return _mm512_div_ps(v, _mm512_add_ps(_mm512_set1_ps(1.0f), e));
+}
+
+// 14x32：acc[r][0..1] 为第r行的两个zmm，每步k广播A的一个元素，与B的两个zmm做FMA
+// 循环完全展开后28个累加器全部分到寄存器上
+__attribute__((target("avx512f")))
+static void sgemm_kernel_avx512(int kc, const float *packed_a, const float *packed_b, float *c, int ldc, int accumulate,
+                                const float *bias, const sgemm_epilogue_t *epilogue)
+{
+    __m512 acc[14][2];
+
+    _Pragma("GCC unroll 14")
+    for (int r = 0; r < 14; r++) {
+        acc[r][0] = accumulate ? _mm512_loadu_ps(c + (size_t)r * ldc) : _mm512_setzero_ps();
+        acc[r][1] = accumulate ? _mm512_loadu_ps(c + (size_t)r * ldc + 16) : _mm512_setzero_ps();
+    }
+    for (int p = 0; p < kc; p++) {
+        __m512 b0 = _mm512_loadu_ps(packed_b);
+        __m512 b1 = _mm512_loadu_ps(packed_b + 16);
+        _Pragma("GCC unroll 14")
+        for (int r = 0; r < 14; r++) {
+            __m512 a = _mm512_set1_ps(packed_a[r]);
+            acc[r][0] = _mm512_fmadd_ps(a, b0, acc[r][0]);
+            acc[r][1] = _mm512_fmadd_ps(a, b1, acc[r][1]);
+        }
+        packed_a += 14;
+        packed_b += 32;
+    }
+    if (epilogue) {
+        if (bias && epilogue->bias_on_cols) {
+            __m512 b0 = _mm512_loadu_ps(bias);
+            __m512 b1 = _mm512_loadu_ps(bias + 16);
+            _Pragma("GCC unroll 14")
+            for (int r = 0; r < 14; r++) {
+                acc[r][0] = _mm512_add_ps(acc[r][0], b0);
+                acc[r][1] = _mm512_add_ps(acc[r][1], b1);
+            }
+        } else if (bias) {
+            _Pragma("GCC unroll 14")
+            for (int r = 0; r < 14; r++) {
+                __m512 b = _mm512_set1_ps(bias[r]);
+                acc[r][0] = _mm512_add_ps(acc[r][0], b);
+                acc[r][1] = _mm512_add_ps(acc[r][1], b);
+            }
+        }
+        // LeakyReLU：不大于0（含NaN）的元素乘 alpha；截断与 v > lo ? v : lo 相同（NaN 截断为下界）
+        if (epilogue->activation == CONV_ACT_LEAKY_RELU) {
+            __m512 alpha = _mm512_set1_ps(epilogue->alpha);
+            _Pragma("GCC unroll 14")
+            for (int r = 0; r < 14; r++) {
+                for (int h = 0; h < 2; h++) {
+                    __mmask16 negative = _mm512_cmp_ps_mask(acc[r][h], _mm512_setzero_ps(), _CMP_NGT_UQ);
+                    acc[r][h] = _mm512_mask_mul_ps(acc[r][h], negative, acc[r][h], alpha);
+                }
+            }
+        } else if (epilogue->activation == CONV_ACT_SILU) {
+            _Pragma("GCC unroll 14")
+            for (int r = 0; r < 14; r++) {
+                acc[r][0] = sgemm_silu_avx512(acc[r][0]);
+                acc[r][1] = sgemm_silu_avx512(acc[r][1]);
+            }
+        }
+        if (epilogue->clamp) {
+            __m512 lo = _mm512_set1_ps(epilogue->lo);
+            __m512 hi = _mm512_set1_ps(epilogue->hi);
+            _Pragma("GCC unroll 14")
+            for (int r = 0; r < 14; r++) {
+                acc[r][0] = _mm512_min_ps(_mm512_max_ps(acc[r][0], lo), hi);
+                acc[r][1] = _mm512_min_ps(_mm512_max_ps(acc[r][1], lo), hi);
+            }
+        }
+    }
+    _Pragma("GCC unroll 14")
+    for (int r = 0; r < 14; r++) {
+        _mm512_storeu_ps(c + (size_t)r * ldc, acc[r][0]);
+        _mm512_storeu_ps(c + (size_t)r * ldc + 16, acc[r][1]);
+    }
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 sgemm_exp_avx2(__m256 x)
+{
+    x = _mm256_max_ps(_mm256_min_ps(x, _mm256_set1_ps(88.0f)), _mm256_set1_ps(-87.0f));
+    __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                               _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), x);
+    r = _mm256_fmadd_ps(n, _mm256_set1_ps(2.12194440e-4f), r);
+    __m256 y = _mm256_fmadd_ps(r, _mm256_set1_ps(1.9875691500e-4f), _mm256_set1_ps(1.3981999507e-3f));
+    y = _mm256_fmadd_ps(y, r, _mm256_set1_ps(8.3334519073e-3f));
+    y = _mm256_fmadd_ps(y, r, _mm256_set1_ps(4.1665795894e-2f));
+    y = _mm256_fmadd_ps(y, r, _mm256_set1_ps(1.6666665459e-1f));
+    y = _mm256_fmadd_ps(y, r, _mm256_set1_ps(5.0000001201e-1f));
+    y = _mm256_add_ps(_mm256_fmadd_ps(y, _mm256_mul_ps(r, r), r), _mm256_set1_ps(1.0f));
+    // 2^n 直接写入指数位，n 在 [-125, 127] 内
+    __m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(e));
+}
+
+__attribute__((target("avx2,fma")))
+static inline __m256 sgemm_silu_avx2(__m256 v)
+{
+    __m256 e = sgemm_exp_avx2(_mm256_sub_ps(_mm256_setzero_ps(), v));
+    return _mm256_div_ps(v, _mm256_add_ps(_mm256_set1_ps(1.0f), e));
+}
+
+// 6x16：与AVX-512版本结构相同，每行两个ymm
+__attribute__((target("avx2,fma")))
+static void sgemm_kernel_avx2(int kc, const float *packed_a, const float *packed_b, float *c, int ldc, int accumulate,
+                              const float *bias, const sgemm_epilogue_t *epilogue)
+{
+    __m256 acc[6][2];
+
+    _Pragma("GCC unroll 6")
+    for (int r = 0; r < 6; r++) {
+        acc[r][0] = accumulate ? _mm256_loadu_ps(c + (size_t)r * ldc) : _mm256_setzero_ps();
+        acc[r][1] = accumulate ? _mm256_loadu_ps(c + (size_t)r * ldc + 8) : _mm256_setzero_ps();
+    }
+    for (int p = 0; p < kc; p++) {
+        __m256 b0 = _mm256_loadu_ps(packed_b);
+        __m256 b1 = _mm256_loadu_ps(packed_b + 8);
+        _Pragma("GCC unroll 6")
+        for (int r = 0; r < 6; r++) {
+            __m256 a = _mm256_broadcast_ss(packed_a + r);
+            acc[r][0] = _mm256_fmadd_ps(a, b0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_ps(a, b1, acc[r][1]);
+        }
+        packed_a += 6;
+        packed_b += 16;
+    }
+    if (epilogue) {
+        if (bias && epilogue->bias_on_cols) {
+            __m256 b0 = _mm256_loadu_ps(bias);
+            __m256 b1 = _mm256_loadu_ps(bias + 8);
+            _Pragma("GCC unroll 6")
+            for (int r = 0; r < 6; r++) {
+                acc[r][0] = _mm256_add_ps(acc[r][0], b0);
+                acc[r][1] = _mm256_add_ps(acc[r][1], b1);
+            }
+        } else if (bias) {
+            _Pragma("GCC unroll 6")
+            for (int r = 0; r < 6; r++) {
+                __m256 b = _mm256_broadcast_ss(bias + r);
+                acc[r][0] = _mm256_add_ps(acc[r][0], b);
+                acc[r][1] = _mm256_add_ps(acc[r][1], b);
+            }
+        }
+        if (epilogue->activation == CONV_ACT_LEAKY_RELU) {
+            __m256 alpha = _mm256_set1_ps(epilogue->alpha);
+            _Pragma("GCC unroll 6")
+            for (int r = 0; r < 6; r++) {
+                for (int h = 0; h < 2; h++) {
+                    __m256 positive = _mm256_cmp_ps(acc[r][h], _mm256_setzero_ps(), _CMP_GT_OQ);
+                    acc[r][h] = _mm256_blendv_ps(_mm256_mul_ps(acc[r][h], alpha), acc[r][h], positive);
+                }
+            }
+        } else if (epilogue->activation == CONV_ACT_SILU) {
+            _Pragma("GCC unroll 6")
+            for (int r = 0; r < 6; r++) {
+                acc[r][0] = sgemm_silu_avx2(acc[r][0]);
+                acc[r][1] = sgemm_silu_avx2(acc[r][1]);
+            }
+        }
+        if (epilogue->clamp) {
+            __m256 lo = _mm256_set1_ps(epilogue->lo);
+            __m256 hi = _mm256_set1_ps(epilogue->hi);
+            _Pragma("GCC unroll 6")
+            for (int r = 0; r < 6; r++) {
+                acc[r][0] = _mm256_min_ps(_mm256_max_ps(acc[r][0], lo), hi);
+                acc[r][1] = _mm256_min_ps(_mm256_max_ps(acc[r][1], lo), hi);
+            }
+        }
+    }
+    _Pragma("GCC unroll 6")
+    for (int r = 0; r < 6; r++) {
+        _mm256_storeu_ps(c + (size_t)r * ldc, acc[r][0]);
+        _mm256_storeu_ps(c + (size_t)r * ldc + 8, acc[r][1]);
+    }
+}
+
+const sgemm_ukernel_t sgemm_ukernel_avx512 = { "avx512_14x32", 14, 32, 112, sgemm_kernel_avx512, NULL };
+const sgemm_ukernel_t sgemm_ukernel_avx2 = { "avx2_6x16", 6, 16, 120, sgemm_kernel_avx2, NULL };
+#endif
+
+#if CONV_SVE_DISPATCH
+// SVE 8 x 3VL：寄存器分配与NEON版本相同，z8-z31 为累加器（第r行为 z(8+3r)..z(10+3r)），z0-z1: A，z2-z4: B
+// A按 ld1rqw 读入，使每个128位段都含 a[0:4] / a[4:8]，按下标的 fmla 就不依赖向量长度
+// 只读写C的前 rows 行、前 cols 列：列由 whilelt 生成的谓词控制，不需要标量的剩余循环
+// 后处理与NEON版本相同，在写回前对累加器进行；列偏置按 p1-p3 只读取有效列，LeakyReLU 用 fcmgt 生成的谓词 p4 选择
+// 向量寄存器的低128位即 v0-v31，在被破坏列表中按 v 寄存器声明
+static void sgemm_tile_sve(int kc, const float *packed_a, const float *packed_b, float *c, int ldc, int accumulate,
+                           const float *bias, const sgemm_epilogue_t *epilogue, int mr, int nr)
+{
+    long ldc_bytes = (long)ldc * sizeof(float);
+    long rows = mr;
+    long cols = nr;
+    int silu = epilogue && epilogue->activation == CONV_ACT_SILU;
+    const float *bias_ptr = epilogue ? bias : NULL;
+    long bias_cols = epilogue && epilogue->bias_on_cols;
+    long leaky = epilogue && epilogue->activation == CONV_ACT_LEAKY_RELU;
+    long clamp = epilogue && epilogue->clamp && !silu;
+    const float *params = epilogue ? &epilogue->alpha : NULL;
+    __asm__ __volatile__(
+                ".arch_extension sve                         \n\t"
+                "ptrue p0.s                                  \n\t"    // A、B按整向量读取
+                "cntw x10                                    \n\t"    // x10: 每个向量的float个数 VL
+                "mov x11, #0                                 \n\t"
+                "whilelt p1.s, x11, %[cols]                  \n\t"    // p1-p3: C每行3个向量中的有效列
+                "whilelt p2.s, x10, %[cols]                  \n\t"
+                "add x11, x10, x10                           \n\t"
+                "whilelt p3.s, x11, %[cols]                  \n\t"
+                "dup z8.s, #0                                \n\t"    // 累加器清零
+                "dup z9.s, #0                                \n\t"
+                "dup z10.s, #0                               \n\t"
+                "dup z11.s, #0                               \n\t"
+                "dup z12.s, #0                               \n\t"
+                "dup z13.s, #0                               \n\t"
+                "dup z14.s, #0                               \n\t"
+                "dup z15.s, #0                               \n\t"
+                "dup z16.s, #0                               \n\t"
+                "dup z17.s, #0                               \n\t"
+                "dup z18.s, #0                               \n\t"
+                "dup z19.s, #0                               \n\t"
+                "dup z20.s, #0                               \n\t"
+                "dup z21.s, #0                               \n\t"
+                "dup z22.s, #0                               \n\t"
+                "dup z23.s, #0                               \n\t"
+                "dup z24.s, #0                               \n\t"
+                "dup z25.s, #0                               \n\t"
+                "dup z26.s, #0                               \n\t"
+                "dup z27.s, #0                               \n\t"
+                "dup z28.s, #0                               \n\t"
+                "dup z29.s, #0                               \n\t"
+                "dup z30.s, #0                               \n\t"
+                "dup z31.s, #0                               \n\t"
+                "cbz %w[accumulate], 2f                      \n\t"    // 首个K分块不读C
+                "mov x9, %[c]                                \n\t"
+                "mov x12, %[rows]                            \n\t"
+                "ld1w {z8.s}, p1/z, [x9]                     \n\t"    // 只读取前 rows 行
+                "ld1w {z9.s}, p2/z, [x9, #1, mul vl]         \n\t"
+                "ld1w {z10.s}, p3/z, [x9, #2, mul vl]        \n\t"
+                "subs x12, x12, #1                           \n\t"
+                "b.eq 2f                                     \n\t"
+                "add x9, x9, %[ldc]                          \n\t"
+                "ld1w {z11.s}, p1/z, [x9]                    \n\t"
+                "ld1w {z12.s}, p2/z, [x9, #1, mul vl]        \n\t"
+                "ld1w {z13.s}, p3/z, [x9, #2, mul vl]        \n\t"
+                "subs x12, x12, #1                           \n\t"
+                "b.eq 2f                                     \n\t"
+                "add x9, x9, %[ldc]                          \n\t"
+                "ld1w {z14.s}, p1/z, [x9]                    \n\t"
+                "ld1w {z15.s}, p2/z, [x9, #1, mul vl]        \n\t"
+                "ld1w {z16.s}, p3/z, [x9, #2, mul vl]        \n\t"
+                "subs x12, x12, #1                           \n\t"
+                "b.eq 2f                                     \n\t"
+                "add x9, x9, %[ldc]                          \n\t"
+                "ld1w {z17.s}, p1/z, [x9]                    \n\t"
+                "ld1w {z18.s}, p2/z, [x9, #1, mul vl]        \n\t"
+                "ld1w {z19.s}, p3/z, [x9, #2, mul vl]        \n\t"
+                "subs x12, x12, #1                           \n\t"
+                "b.eq 2f                                     \n\t"
+                "add x9, x9, %[ldc]                          \n\t"
+                "ld1w {z20.s}, p1/z, [x9]                    \n\t"
+                "ld1w {z21.s}, p2/z, [x9, #1, mul vl]        \n\t"
+                "ld1w {z22.s}, p3/z, [x9, #2, mul vl]        \n\t"
+                "subs x12, x12, #1                           \n\t"
+                "b.eq 2f                                     \n\t"
+                "add x9, x9, %[ldc]                          \n\t"
+                "ld1w {z23.s}, p1/z, [x9]                    \n\t"
+                "ld1w {z24.s}, p2/z, [x9, #1, mul vl]        \n\t"
+                "ld1w {z25.s}, p3/z, [x9, #2, mul vl]        \n\t"
+                "subs x12, x12, #1                           \n\t"
+                "b.eq 2f                                     \n\t"
+                "add x9, x9, %[ldc]                          \n\t"
+                "ld1w {z26.s}, p1/z, [x9]                    \n\t"
+                "ld1w {z27.s}, p2/z, [x9, #1, mul vl]        \n\t"
+                "ld1w {z28.s}, p3/z, [x9, #2, mul vl]        \n\t"
+                "subs x12, x12, #1                           \n\t"
+                "b.eq 2f                                     \n\t"
+                "add x9, x9, %[ldc]                          \n\t"
+                "ld1w {z29.s}, p1/z, [x9]                    \n\t"
+                "ld1w {z30.s}, p2/z, [x9, #1, mul vl]        \n\t"
+                "ld1w {z31.s}, p3/z, [x9, #2, mul vl]        \n\t"
+                "2:                                          \n\t"
+                "ld1rqw {z0.s}, p0/z, [%[pa]]                \n\t"    // A微面板的一列：a[0:4]、a[4:8] 复制到每个128位段
+                "ld1rqw {z1.s}, p0/z, [%[pa], #16]           \n\t"
+                "ld1w {z2.s}, p0/z, [%[pb]]                  \n\t"    // B微面板的一行：3个向量
+                "ld1w {z3.s}, p0/z, [%[pb], #1, mul vl]      \n\t"
+                "ld1w {z4.s}, p0/z, [%[pb], #2, mul vl]      \n\t"
+                "add %[pa], %[pa], #32                       \n\t"
+                "addvl %[pb], %[pb], #3                      \n\t"
+                "fmla z8.s, z2.s, z0.s[0]                    \n\t"    // c0x += a[0] * b
+                "fmla z9.s, z3.s, z0.s[0]                    \n\t"
+                "fmla z10.s, z4.s, z0.s[0]                   \n\t"
+                "fmla z11.s, z2.s, z0.s[1]                   \n\t"    // c1x += a[1] * b
+                "fmla z12.s, z3.s, z0.s[1]                   \n\t"
+                "fmla z13.s, z4.s, z0.s[1]                   \n\t"
+                "fmla z14.s, z2.s, z0.s[2]                   \n\t"    // c2x += a[2] * b
+                "fmla z15.s, z3.s, z0.s[2]                   \n\t"
+                "fmla z16.s, z4.s, z0.s[2]                   \n\t"
+                "fmla z17.s, z2.s, z0.s[3]                   \n\t"    // c3x += a[3] * b
+                "fmla z18.s, z3.s, z0.s[3]                   \n\t"
+                "fmla z19.s, z4.s, z0.s[3]                   \n\t"
+                "fmla z20.s, z2.s, z1.s[0]                   \n\t"    // c4x += a[4] * b
+                "fmla z21.s, z3.s, z1.s[0]                   \n\t"
+                "fmla z22.s, z4.s, z1.s[0]                   \n\t"
+                "fmla z23.s, z2.s, z1.s[1]                   \n\t"    // c5x += a[5] * b
+                "fmla z24.s, z3.s, z1.s[1]                   \n\t"
+                "fmla z25.s, z4.s, z1.s[1]                   \n\t"
+                "fmla z26.s, z2.s, z1.s[2]                   \n\t"    // c6x += a[6] * b
+                "fmla z27.s, z3.s, z1.s[2]                   \n\t"
+                "fmla z28.s, z4.s, z1.s[2]                   \n\t"
+                "fmla z29.s, z2.s, z1.s[3]                   \n\t"    // c7x += a[7] * b
+                "fmla z30.s, z3.s, z1.s[3]                   \n\t"
+                "fmla z31.s, z4.s, z1.s[3]                   \n\t"
+                "subs %w[kc], %w[kc], #1                     \n\t"    // k--
+                "b.ne 2b                                     \n\t"
+                "cbz %[bias], 5f                             \n\t"    // 后处理：加偏置
+                "cbnz %[bias_cols], 4f                       \n\t"
+                "ld1rqw {z0.s}, p0/z, [%[bias]]              \n\t"    // 行偏置 bias[0:4]、bias[4:8] 复制到每个128位段
+                "ld1rqw {z1.s}, p0/z, [%[bias], #16]         \n\t"
+                "fmov z5.s, #1.0                             \n\t"
+                "fmla z8.s, z5.s, z0.s[0]                    \n\t"    // c0x += bias[0]
+                "fmla z9.s, z5.s, z0.s[0]                    \n\t"
+                "fmla z10.s, z5.s, z0.s[0]                   \n\t"
+                "fmla z11.s, z5.s, z0.s[1]                   \n\t"    // c1x += bias[1]
+                "fmla z12.s, z5.s, z0.s[1]                   \n\t"
+                "fmla z13.s, z5.s, z0.s[1]                   \n\t"
+                "fmla z14.s, z5.s, z0.s[2]                   \n\t"    // c2x += bias[2]
+                "fmla z15.s, z5.s, z0.s[2]                   \n\t"
+                "fmla z16.s, z5.s, z0.s[2]                   \n\t"
+                "fmla z17.s, z5.s, z0.s[3]                   \n\t"    // c3x += bias[3]
+                "fmla z18.s, z5.s, z0.s[3]                   \n\t"
+                "fmla z19.s, z5.s, z0.s[3]                   \n\t"
+                "fmla z20.s, z5.s, z1.s[0]                   \n\t"    // c4x += bias[4]
+                "fmla z21.s, z5.s, z1.s[0]                   \n\t"
+                "fmla z22.s, z5.s, z1.s[0]                   \n\t"
+                "fmla z23.s, z5.s, z1.s[1]                   \n\t"    // c5x += bias[5]
+                "fmla z24.s, z5.s, z1.s[1]                   \n\t"
+                "fmla z25.s, z5.s, z1.s[1]                   \n\t"
+                "fmla z26.s, z5.s, z1.s[2]                   \n\t"    // c6x += bias[6]
+                "fmla z27.s, z5.s, z1.s[2]                   \n\t"
+                "fmla z28.s, z5.s, z1.s[2]                   \n\t"
+                "fmla z29.s, z5.s, z1.s[3]                   \n\t"    // c7x += bias[7]
+                "fmla z30.s, z5.s, z1.s[3]                   \n\t"
+                "fmla z31.s, z5.s, z1.s[3]                   \n\t"
+                "b 5f                                        \n\t"
+                "4:                                          \n\t"
+                "ld1w {z2.s}, p1/z, [%[bias]]                \n\t"    // 列偏置，只读取有效列
+                "ld1w {z3.s}, p2/z, [%[bias], #1, mul vl]    \n\t"
+                "ld1w {z4.s}, p3/z, [%[bias], #2, mul vl]    \n\t"
+                "fadd z8.s, z8.s, z2.s                       \n\t"
+                "fadd z9.s, z9.s, z3.s                       \n\t"
+                "fadd z10.s, z10.s, z4.s                     \n\t"
+                "fadd z11.s, z11.s, z2.s                     \n\t"
+                "fadd z12.s, z12.s, z3.s                     \n\t"
+                "fadd z13.s, z13.s, z4.s                     \n\t"
+                "fadd z14.s, z14.s, z2.s                     \n\t"
+                "fadd z15.s, z15.s, z3.s                     \n\t"
+                "fadd z16.s, z16.s, z4.s                     \n\t"
+                "fadd z17.s, z17.s, z2.s                     \n\t"
+                "fadd z18.s, z18.s, z3.s                     \n\t"
+                "fadd z19.s, z19.s, z4.s                     \n\t"
+                "fadd z20.s, z20.s, z2.s                     \n\t"
+                "fadd z21.s, z21.s, z3.s                     \n\t"
+                "fadd z22.s, z22.s, z4.s                     \n\t"
+                "fadd z23.s, z23.s, z2.s                     \n\t"
+                "fadd z24.s, z24.s, z3.s                     \n\t"
+                "fadd z25.s, z25.s, z4.s                     \n\t"
+                "fadd z26.s, z26.s, z2.s                     \n\t"
+                "fadd z27.s, z27.s, z3.s                     \n\t"
+                "fadd z28.s, z28.s, z4.s                     \n\t"
+                "fadd z29.s, z29.s, z2.s                     \n\t"
+                "fadd z30.s, z30.s, z3.s                     \n\t"
+                "fadd z31.s, z31.s, z4.s                     \n\t"
+                "5:                                          \n\t"
+                "cbz %[leaky], 6f                            \n\t"    // LeakyReLU：v > 0 ? v : v * alpha
+                "ld1rw {z5.s}, p0/z, [%[params]]             \n\t"    // alpha
+                "fmul z0.s, z8.s, z5.s                       \n\t"
+                "fcmgt p4.s, p0/z, z8.s, #0.0                \n\t"
+                "sel z8.s, p4, z8.s, z0.s                    \n\t"
+                "fmul z1.s, z9.s, z5.s                       \n\t"
+                "fcmgt p4.s, p0/z, z9.s, #0.0                \n\t"
+                "sel z9.s, p4, z9.s, z1.s                    \n\t"
+                "fmul z0.s, z10.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z10.s, #0.0               \n\t"
+                "sel z10.s, p4, z10.s, z0.s                  \n\t"
+                "fmul z1.s, z11.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z11.s, #0.0               \n\t"
+                "sel z11.s, p4, z11.s, z1.s                  \n\t"
+                "fmul z0.s, z12.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z12.s, #0.0               \n\t"
+                "sel z12.s, p4, z12.s, z0.s                  \n\t"
+                "fmul z1.s, z13.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z13.s, #0.0               \n\t"
+                "sel z13.s, p4, z13.s, z1.s                  \n\t"
+                "fmul z0.s, z14.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z14.s, #0.0               \n\t"
+                "sel z14.s, p4, z14.s, z0.s                  \n\t"
+                "fmul z1.s, z15.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z15.s, #0.0               \n\t"
+                "sel z15.s, p4, z15.s, z1.s                  \n\t"
+                "fmul z0.s, z16.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z16.s, #0.0               \n\t"
+                "sel z16.s, p4, z16.s, z0.s                  \n\t"
+                "fmul z1.s, z17.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z17.s, #0.0               \n\t"
+                "sel z17.s, p4, z17.s, z1.s                  \n\t"
+                "fmul z0.s, z18.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z18.s, #0.0               \n\t"
+                "sel z18.s, p4, z18.s, z0.s                  \n\t"
+                "fmul z1.s, z19.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z19.s, #0.0               \n\t"
+                "sel z19.s, p4, z19.s, z1.s                  \n\t"
+                "fmul z0.s, z20.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z20.s, #0.0               \n\t"
+                "sel z20.s, p4, z20.s, z0.s                  \n\t"
+                "fmul z1.s, z21.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z21.s, #0.0               \n\t"
+                "sel z21.s, p4, z21.s, z1.s                  \n\t"
+                "fmul z0.s, z22.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z22.s, #0.0               \n\t"
+                "sel z22.s, p4, z22.s, z0.s                  \n\t"
+                "fmul z1.s, z23.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z23.s, #0.0               \n\t"
+                "sel z23.s, p4, z23.s, z1.s                  \n\t"
+                "fmul z0.s, z24.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z24.s, #0.0               \n\t"
+                "sel z24.s, p4, z24.s, z0.s                  \n\t"
+                "fmul z1.s, z25.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z25.s, #0.0               \n\t"
+                "sel z25.s, p4, z25.s, z1.s                  \n\t"
+                "fmul z0.s, z26.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z26.s, #0.0               \n\t"
+                "sel z26.s, p4, z26.s, z0.s                  \n\t"
+                "fmul z1.s, z27.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z27.s, #0.0               \n\t"
+                "sel z27.s, p4, z27.s, z1.s                  \n\t"
+                "fmul z0.s, z28.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z28.s, #0.0               \n\t"
+                "sel z28.s, p4, z28.s, z0.s                  \n\t"
+                "fmul z1.s, z29.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z29.s, #0.0               \n\t"
+                "sel z29.s, p4, z29.s, z1.s                  \n\t"
+                "fmul z0.s, z30.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z30.s, #0.0               \n\t"
+                "sel z30.s, p4, z30.s, z0.s                  \n\t"
+                "fmul z1.s, z31.s, z5.s                      \n\t"
+                "fcmgt p4.s, p0/z, z31.s, #0.0               \n\t"
+                "sel z31.s, p4, z31.s, z1.s                  \n\t"
+                "6:                                          \n\t"
+                "cbz %[clamp], 7f                            \n\t"    // 截断到 [lo, hi]
+                "ld1rw {z6.s}, p0/z, [%[params], #4]         \n\t"    // lo
+                "ld1rw {z7.s}, p0/z, [%[params], #8]         \n\t"    // hi
+                "fmaxnm z8.s, p0/m, z8.s, z6.s               \n\t"
+                "fminnm z8.s, p0/m, z8.s, z7.s               \n\t"
+                "fmaxnm z9.s, p0/m, z9.s, z6.s               \n\t"
+                "fminnm z9.s, p0/m, z9.s, z7.s               \n\t"
+                "fmaxnm z10.s, p0/m, z10.s, z6.s             \n\t"
+                "fminnm z10.s, p0/m, z10.s, z7.s             \n\t"
+                "fmaxnm z11.s, p0/m, z11.s, z6.s             \n\t"
+                "fminnm z11.s, p0/m, z11.s, z7.s             \n\t"
+                "fmaxnm z12.s, p0/m, z12.s, z6.s             \n\t"
+                "fminnm z12.s, p0/m, z12.s, z7.s             \n\t"
+                "fmaxnm z13.s, p0/m, z13.s, z6.s             \n\t"
+                "fminnm z13.s, p0/m, z13.s, z7.s             \n\t"
+                "fmaxnm z14.s, p0/m, z14.s, z6.s             \n\t"
+                "fminnm z14.s, p0/m, z14.s, z7.s             \n\t"
+                "fmaxnm z15.s, p0/m, z15.s, z6.s             \n\t"
+                "fminnm z15.s, p0/m, z15.s, z7.s             \n\t"
+                "fmaxnm z16.s, p0/m, z16.s, z6.s             \n\t"
+                "fminnm z16.s, p0/m, z16.s, z7.s             \n\t"
+                "fmaxnm z17.s, p0/m, z17.s, z6.s             \n\t"
+                "fminnm z17.s, p0/m, z17.s, z7.s             \n\t"
+                "fmaxnm z18.s, p0/m, z18.s, z6.s             \n\t"
+                "fminnm z18.s, p0/m, z18.s, z7.s             \n\t"
+                "fmaxnm z19.s, p0/m, z19.s, z6.s             \n\t"
+                "fminnm z19.s, p0/m, z19.s, z7.s             \n\t"
+                "fmaxnm z20.s, p0/m, z20.s, z6.s             \n\t"
+                "fminnm z20.s, p0/m, z20.s, z7.s             \n\t"
+                "fmaxnm z21.s, p0/m, z21.s, z6.s             \n\t"
+                "fminnm z21.s, p0/m, z21.s, z7.s             \n\t"
+                "fmaxnm z22.s, p0/m, z22.s, z6.s             \n\t"
+                "fminnm z22.s, p0/m, z22.s, z7.s             \n\t"
+                "fmaxnm z23.s, p0/m, z23.s, z6.s             \n\t"
+                "fminnm z23.s, p0/m, z23.s, z7.s             \n\t"
+                "fmaxnm z24.s, p0/m, z24.s, z6.s             \n\t"
+                "fminnm z24.s, p0/m, z24.s, z7.s             \n\t"
+                "fmaxnm z25.s, p0/m, z25.s, z6.s             \n\t"
+                "fminnm z25.s, p0/m, z25.s, z7.s             \n\t"
+                "fmaxnm z26.s, p0/m, z26.s, z6.s             \n\t"
+                "fminnm z26.s, p0/m, z26.s, z7.s             \n\t"
+                "fmaxnm z27.s, p0/m, z27.s, z6.s             \n\t"
+                "fminnm z27.s, p0/m, z27.s, z7.s             \n\t"
+                "fmaxnm z28.s, p0/m, z28.s, z6.s             \n\t"
+                "fminnm z28.s, p0/m, z28.s, z7.s             \n\t"
+                "fmaxnm z29.s, p0/m, z29.s, z6.s             \n\t"
+                "fminnm z29.s, p0/m, z29.s, z7.s             \n\t"
+                "fmaxnm z30.s, p0/m, z30.s, z6.s             \n\t"
+                "fminnm z30.s, p0/m, z30.s, z7.s             \n\t"
+                "fmaxnm z31.s, p0/m, z31.s, z6.s             \n\t"
+                "fminnm z31.s, p0/m, z31.s, z7.s             \n\t"
+                "7:                                          \n\t"
+                "mov x9, %[c]                                \n\t"
+                "mov x12, %[rows]                            \n\t"
+                "st1w {z8.s}, p1, [x9]                       \n\t"    // 写回C的前 rows 行
+                "st1w {z9.s}, p2, [x9, #1, mul vl]           \n\t"
+                "st1w {z10.s}, p3, [x9, #2, mul vl]          \n\t"
+                "subs x12, x12, #1                           \n\t"
+                "b.eq 3f                                     \n\t"
+                "add x9, x9, %[ldc]                          \n\t"
+                "st1w {z11.s}, p1, [x9]                      \n\t"
+                "st1w {z12.s}, p2, [x9, #1, mul vl]          \n\t"
+                "st1w {z13.s}, p3, [x9, #2, mul vl]          \n\t"
+                "subs x12, x12, #1                           \n\t"
+                "b.eq 3f                                     \n\t"
+                "add x9, x9, %[ldc]                          \n\t"
+                "st1w {z14.s}, p1, [x9]                      \n\t"
+                "st1w {z15.s}, p2, [x9, #1, mul vl]          \n\t"
+                "st1w {z16.s}, p3, [x9, #2, mul vl]          \n\t"
+                "subs x12, x12, #1                           \n\t"
+                "b.eq 3f                                     \n\t"
+                "add x9, x9, %[ldc]                          \n\t"
+                "st1w {z17.s}, p1, [x9]                      \n\t"
+                "st1w {z18.s}, p2, [x9, #1, mul vl]          \n\t"
+                "st1w {z19.s}, p3, [x9, #2, mul vl]          \n\t"
+                "subs x12, x12, #1                           \n\t"
+                "b.eq 3f                                     \n\t"
+                "add x9, x9, %[ldc]                          \n\t"
+                "st1w {z20.s}, p1, [x9]                      \n\t"
+                "st1w {z21.s}, p2, [x9, #1, mul vl]          \n\t"
+                "st1w {z22.s}, p3, [x9, #2, mul vl]          \n\t"
+                "subs x12, x12, #1                           \n\t"
+                "b.eq 3f                                     \n\t"
+                "add x9, x9, %[ldc]                          \n\t"
+                "st1w {z23.s}, p1, [x9]                      \n\t"
+                "st1w {z24.s}, p2, [x9, #1, mul vl]          \n\t"
+                "st1w {z25.s}, p3, [x9, #2, mul vl]          \n\t"
+                "subs x12, x12, #1                           \n\t"
+                "b.eq 3f                                     \n\t"
+                "add x9, x9, %[ldc]                          \n\t"
+                "st1w {z26.s}, p1, [x9]                      \n\t"
+                "st1w {z27.s}, p2, [x9, #1, mul vl]          \n\t"
+                "st1w {z28.s}, p3, [x9, #2, mul vl]          \n\t"
+                "subs x12, x12, #1                           \n\t"
+                "b.eq 3f                                     \n\t"
+                "add x9, x9, %[ldc]                          \n\t"
+                "st1w {z29.s}, p1, [x9]                      \n\t"
+                "st1w {z30.s}, p2, [x9, #1, mul vl]          \n\t"
+                "st1w {z31.s}, p3, [x9, #2, mul vl]          \n\t"
+                "3:                                          \n\t"
+
+        : [pa] "+r"(packed_a),
+          [pb] "+r"(packed_b),
+          [kc] "+r"(kc)
+        : [c] "r"(c),
+          [ldc] "r"(ldc_bytes),
+          [accumulate] "r"(accumulate),
+          [rows] "r"(rows),
+          [cols] "r"(cols),
+          [bias] "r"(bias_ptr),
+          [bias_cols] "r"(bias_cols),
+          [leaky] "r"(leaky),
+          [clamp] "r"(clamp),
+          [params] "r"(params)
+        : "cc", "memory", "x9", "x10", "x11", "x12", "p0", "p1", "p2", "p3", "p4",
+          "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7", "v8", "v9", "v10", "v11", "v12", "v13", "v14", "v15",
+          "v16", "v17", "v18", "v19", "v20", "v21", "v22", "v23", "v24", "v25", "v26", "v27",
+          "v28", "v29", "v30", "v31"
+    );
+    if (silu) {
+        sgemm_epilogue_tile(epilogue, NULL, c, ldc, mr, nr);
+    }
+}
+
+static sgemm_ukernel_t sgemm_sve;
+static char sgemm_sve_name[16];
+
+// 整块：cols 为 3VL，所有列都有效
+static void sgemm_kernel_sve(int kc, const float *packed_a, const float *packed_b, float *c, int ldc, int accumulate,
+                             const float *bias, const sgemm_epilogue_t *epilogue)
+{
+    sgemm_tile_sve(kc, packed_a, packed_b, c, ldc, accumulate, bias, epilogue, 8, sgemm_sve.nr);
+}
+
+const sgemm_ukernel_t *sgemm_ukernel_sve(int vector_floats)
+{
+    snprintf(sgemm_sve_name, sizeof(sgemm_sve_name), "sve_8x%d", 3 * vector_floats);
+    sgemm_sve.name = sgemm_sve_name;
+    sgemm_sve.mr = 8;
+    sgemm_sve.nr = 3 * vector_floats;
+    sgemm_sve.mc = 128;
+    sgemm_sve.kernel = sgemm_kernel_sve;
+    sgemm_sve.partial = sgemm_tile_sve;
+    return &sgemm_sve;
+}
+#endif
+
+const sgemm_ukernel_t *sgemm_ukernel(void)
+{
+    return conv_dispatch()->sgemm;
+}
+
+// 多线程：把C按 m_parts x n_parts 划分为子块，行边界对齐 MR，列边界对齐 NR，每个子块一个任务
+typedef struct {
+    int m, n, k;
+    const float *a;
+    int lda;
+    const float *prepacked_a;
+    sgemm_pack_b_fn pack_b;
+    const void *pack_b_ctx;
+    float *c;
+    int ldc;
+    int c_batch_cols;                      // C的列按该列数分组，每组属于一张图像
+    size_t c_batch_stride;                 // 相邻两组的起点间距（float个数）
+    const float *bias;                     // 融合后处理，epilogue 为NULL时没有后处理
+    int bias_on_cols;                      // 非0时偏置按列（NHWC的输出通道）而不是按行
+    const sgemm_epilogue_t *epilogue;      // 由微内核在最后一个K分块写回前完成
+    int m_parts, n_parts;
+    int nc_max;
+    const sgemm_ukernel_t *uk;             // 调度表选择的微内核
+    size_t packed_a_size, packed_b_size;   // 每个线程的打包缓冲区大小（float个数）
+    float *packed;                         // 所有线程的打包缓冲区
+} sgemm_parallel_t;
+
+// C 中第 row 行、第 col 列（全局列号）的地址
+static inline float *sgemm_c_at(const sgemm_parallel_t *p, int row, int col)
+{
+    int group = col / p->c_batch_cols;
+    return p->c + group * p->c_batch_stride + (size_t)row * p->ldc + (col - group * p->c_batch_cols);
+}
+
+// 结果块的偏置：行偏置从第 row 行、列偏置从第 col 列开始；微内核总是读取完整的 MR / NR 个，
+// 不足的边界块拷贝到 pad（至少 SGEMM_NR_MAX 个）中补零
+static const float *sgemm_tile_bias(const sgemm_parallel_t *p, int row, int col, int mr, int nr, float *pad)
+{
+    if (!p->bias) {
+        return NULL;
+    }
+    const float *bias = p->bias_on_cols ? p->bias + col : p->bias + row;
+    int count = p->bias_on_cols ? nr : mr;
+    int full = p->bias_on_cols ? p->uk->nr : p->uk->mr;
+    if (count == full) {
+        return bias;
+    }
+    memcpy(pad, bias, count * sizeof(float));
+    memset(pad + count, 0, (full - count) * sizeof(float));
+    return pad;
+}
+
+// 边界块：行或列不足 MR x NR、或列跨越两张图像时，先在临时块上计算，再拷回有效部分
+// last 非0时为最后一个K分块，微内核写回临时块之前完成后处理
+static void sgemm_kernel_edge(const sgemm_parallel_t *p, int mr, int nr, int kc,
+                              const float *packed_a, const float *packed_b, int row, int col, int accumulate,
+                              int last)
+{
+    int tile_nr = p->uk->nr;
+    float tile[SGEMM_MR_MAX * SGEMM_NR_MAX];
+    float *c_col[SGEMM_NR_MAX];
+    float bias_pad[SGEMM_NR_MAX];
+    const sgemm_epilogue_t *epilogue = last ? p->epilogue : NULL;
+    const float *bias = epilogue ? sgemm_tile_bias(p, row, col, mr, nr, bias_pad) : NULL;
+
+    for (int j = 0; j < nr; j++) {
+        c_col[j] = sgemm_c_at(p, row, col + j);
+    }
+    if (accumulate) {
+        for (int r = 0; r < mr; r++) {
+            for (int j = 0; j < nr; j++) {
+                tile[r * tile_nr + j] = c_col[j][(size_t)r * p->ldc];
+            }
+        }
+    }
+    p->uk->kernel(kc, packed_a, packed_b, tile, tile_nr, accumulate, bias, epilogue);
+    for (int r = 0; r < mr; r++) {
+        for (int j = 0; j < nr; j++) {
+            c_col[j][(size_t)r * p->ldc] = tile[r * tile_nr + j];
+        }
+    }
+}
+
+// 单线程分块计算 C 的子块 [m0, m1) x [n0, n1)，packed_a / packed_b 为当前线程的打包缓冲区
+// 有预打包的A时直接使用，不再调用 sgemm_pack_a
+static void sgemm_block_range(const sgemm_parallel_t *p, int m0, int m1, int n0, int n1,
+                              float *packed_a, float *packed_b)
+{
+    const sgemm_ukernel_t *uk = p->uk;
+    int m_pad = (p->m + uk->mr - 1) / uk->mr * uk->mr;
+
+    for (int jc = n0; jc < n1; jc += p->nc_max) {
+        int nc = min_int(p->nc_max, n1 - jc);
+        for (int pc = 0; pc < p->k; pc += SGEMM_KC) {
+            int kc = min_int(SGEMM_KC, p->k - pc);
+            // 第一个K分块覆盖C，之后的K分块累加；最后一个K分块由微内核在写回前做后处理
+            int accumulate = pc > 0;
+            int last = pc + kc == p->k;
+            const sgemm_epilogue_t *epilogue = last ? p->epilogue : NULL;
+
+            p->pack_b(p->pack_b_ctx, pc, kc, jc, nc, packed_b);
+
+            for (int ic = m0; ic < m1; ic += uk->mc) {
+                int mc = min_int(uk->mc, m1 - ic);
+                const float *block_a;
+
+                if (p->prepacked_a) {
+                    block_a = p->prepacked_a + (size_t)pc * m_pad + (size_t)ic * kc;
+                } else {
+                    sgemm_pack_a(p->a + (size_t)ic * p->lda + pc, p->lda, mc, kc, uk->mr, packed_a);
+                    block_a = packed_a;
+                }
+
+                for (int jr = 0; jr < nc; jr += uk->nr) {
+                    int nr = min_int(uk->nr, nc - jr);
+                    int col = jc + jr;
+                    // 该列块是否整块落在同一张图像内
+                    int in_group = col % p->c_batch_cols + nr <= p->c_batch_cols;
+                    for (int ir = 0; ir < mc; ir += uk->mr) {
+                        int mr = min_int(uk->mr, mc - ir);
+                        const float *pa = block_a + (size_t)ir * kc;
+                        const float *pb = packed_b + (size_t)jr * kc;
+                        int full = mr == uk->mr && nr == uk->nr;
+
+                        if (in_group && (full || uk->partial)) {
+                            float *c = sgemm_c_at(p, ic + ir, col);
+                            float bias_pad[SGEMM_NR_MAX];
+                            const float *bias = epilogue ? sgemm_tile_bias(p, ic + ir, col, mr, nr, bias_pad) : NULL;
+                            if (full) {
+                                uk->kernel(kc, pa, pb, c, p->ldc, accumulate, bias, epilogue);
+                            } else {
+                                uk->partial(kc, pa, pb, c, p->ldc, accumulate, bias, epilogue, mr, nr);
+                            }
+                        } else {
+                            sgemm_kernel_edge(p, mr, nr, kc, pa, pb, ic + ir, col, accumulate, last);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 把融合后处理换算为微内核的形式：ReLU / ReLU6 并入截断区间（见 conv_epilogue_bounds）；epilogue 为NULL时只加偏置
+static void sgemm_epilogue_init(sgemm_epilogue_t *fused, const conv_epilogue_t *epilogue, int bias_on_cols)
+{
+    conv_act_t activation = epilogue ? epilogue->activation : CONV_ACT_NONE;
+
+    fused->bias_on_cols = bias_on_cols;
+    fused->activation = activation == CONV_ACT_LEAKY_RELU || activation == CONV_ACT_SILU ? activation : CONV_ACT_NONE;
+    fused->clamp = epilogue && (epilogue->clamp || activation == CONV_ACT_RELU || activation == CONV_ACT_RELU6);
+    fused->alpha = epilogue ? epilogue->alpha : 0.0f;
+    fused->lo = 0.0f;
+    fused->hi = 0.0f;
+    if (fused->clamp) {
+        conv_epilogue_bounds(epilogue, &fused->lo, &fused->hi);
+    }
+}
+
+// 把 units 个单元均匀分成 parts 份，返回第 part 份的起点
+static int split_point(int units, int parts, int part)
+{
+    return (int)((long long)units * part / parts);
+}
+
+static void sgemm_task(void *ctx, int task, int thread_id)
+{
+    sgemm_parallel_t *p = (sgemm_parallel_t *)ctx;
+    int mi = task / p->n_parts;
+    int ni = task % p->n_parts;
+    int mr = p->uk->mr;
+    int nr = p->uk->nr;
+    int m_units = (p->m + mr - 1) / mr;
+    int n_units = (p->n + nr - 1) / nr;
+    int m0 = split_point(m_units, p->m_parts, mi) * mr;
+    int m1 = min_int(split_point(m_units, p->m_parts, mi + 1) * mr, p->m);
+    int n0 = split_point(n_units, p->n_parts, ni) * nr;
+    int n1 = min_int(split_point(n_units, p->n_parts, ni + 1) * nr, p->n);
+    float *packed_a = p->packed + (size_t)thread_id * (p->packed_a_size + p->packed_b_size);
+    float *packed_b = packed_a + p->packed_a_size;
+
+    if (m0 >= m1 || n0 >= n1) {
+        return;
+    }
+    sgemm_block_range(p, m0, m1, n0, n1, packed_a, packed_b);
+}
+
+int sgemm_blocked_batched(int m, int n, int k, const float *a, int lda, const float *prepacked_a,
+                          sgemm_pack_b_fn pack_b, const void *pack_b_ctx,
+                          float *c, int ldc, int c_batch_cols, size_t c_batch_stride,
+                          const float *bias, int bias_on_cols, const conv_epilogue_t *epilogue, void *workspace)
+{
+    sgemm_parallel_t p;
+    sgemm_epilogue_t fused;
+    int num_threads = conv_parallel_threads();
+    const sgemm_ukernel_t *uk = sgemm_ukernel();
+    int m_units = (m + uk->mr - 1) / uk->mr;
+    int n_units = (n + uk->nr - 1) / uk->nr;
+
+    p.m = m;
+    p.n = n;
+    p.k = k;
+    p.a = a;
+    p.lda = lda;
+    p.prepacked_a = prepacked_a;
+    p.pack_b = pack_b;
+    p.pack_b_ctx = pack_b_ctx;
+    p.c = c;
+    p.ldc = ldc;
+    p.c_batch_cols = c_batch_cols;
+    p.c_batch_stride = c_batch_stride;
+    p.bias = bias;
+    p.bias_on_cols = bias_on_cols;
+    p.epilogue = NULL;
+    if (bias || (epilogue && conv_epilogue_active(epilogue))) {
+        sgemm_epilogue_init(&fused, epilogue, bias_on_cols);
+        p.epilogue = &fused;
+    }
+    p.uk = uk;
+
+    // 优先沿剩余块数较多的维度继续切分，直到子块数不少于线程数
+    p.m_parts = 1;
+    p.n_parts = 1;
+    while (p.m_parts * p.n_parts < num_threads) {
+        int can_split_m = p.m_parts < m_units;
+        int can_split_n = p.n_parts < n_units;
+        if (can_split_n && (!can_split_m || n_units / p.n_parts >= m_units / p.m_parts)) {
+            p.n_parts++;
+        } else if (can_split_m) {
+            p.m_parts++;
+        } else {
+            break;
+        }
+    }
+
+    // 子块不超过 NC 列时只需打包子块宽度的B
+    int n_part_max = (n_units + p.n_parts - 1) / p.n_parts * uk->nr;
+    p.nc_max = min_int(SGEMM_NC, n_part_max);
+    // 使用预打包的A时不需要A的打包缓冲区
+    p.packed_a_size = prepacked_a ? 0 : (size_t)uk->mc * SGEMM_KC;
+    p.packed_b_size = (size_t)SGEMM_KC * p.nc_max;
+
+    // 打包缓冲区按64字节（缓存行）对齐，每个线程一份
+    p.packed = (float *)workspace;
+    if (!workspace && posix_memalign((void **)&p.packed, 64,
+                                     (size_t)num_threads * (p.packed_a_size + p.packed_b_size) * sizeof(float)) != 0) {
+        return CONV_ERR_NOMEM;
+    }
+
+    conv_parallel_for(p.m_parts * p.n_parts, sgemm_task, &p);
+
+    if (!workspace) {
+        free(p.packed);
+    }
+    return CONV_OK;
+}
+
+// 与 sgemm_blocked_batched 的划分无关的上界：B块的宽度不超过 NC，也不超过 n 补齐到 NR 的倍数
+size_t sgemm_workspace_size(int n, int prepacked_a)
+{
+    const sgemm_ukernel_t *uk = sgemm_ukernel();
+    size_t packed_a_size = prepacked_a ? 0 : (size_t)uk->mc * SGEMM_KC;
+    size_t packed_b_size = (size_t)SGEMM_KC * min_int(SGEMM_NC, (n + uk->nr - 1) / uk->nr * uk->nr);
+
+    return (size_t)conv_parallel_threads() * (packed_a_size + packed_b_size) * sizeof(float);
+}
+
+int sgemm_blocked_ex(int m, int n, int k, const float *a, int lda, const float *prepacked_a,
+                     sgemm_pack_b_fn pack_b, const void *pack_b_ctx, float *c, int ldc)
+{
+    return sgemm_blocked_batched(m, n, k, a, lda, prepacked_a, pack_b, pack_b_ctx, c, ldc, n, 0, NULL, 0, NULL, NULL);
+}
+
+void sgemm_pack_dense_b(const void *ctx, int k0, int kc, int n0, int nc, float *packed_b)
+{
+    const sgemm_dense_b_t *dense = (const sgemm_dense_b_t *)ctx;
+    sgemm_pack_b(dense->b + (size_t)k0 * dense->ldb + n0, dense->ldb, kc, nc, sgemm_ukernel()->nr, packed_b);
+}
+
+int sgemm_blocked(int m, int n, int k, const float *a, int lda, const float *b, int ldb,
+                  float *c, int ldc)
+{
+    sgemm_dense_b_t dense;
+    dense.b = b;
+    dense.ldb = ldb;
+    return sgemm_blocked_ex(m, n, k, a, lda, NULL, sgemm_pack_dense_b, &dense, c, ldc);
+}
+
+size_t sgemm_packed_a_size(int m, int k)
+{
+    int mr = sgemm_ukernel()->mr;
+    return (size_t)(m + mr - 1) / mr * mr * k;
+}
+
+void sgemm_prepack_a(int m, int k, const float *a, int lda, float *packed_a)
+{
+    int mr = sgemm_ukernel()->mr;
+    size_t m_pad = (size_t)(m + mr - 1) / mr * mr;
+
+    // 每个K分块整体打包全部行，任意从MR倍数行开始的子块都与 sgemm_pack_a 的输出一致
+    for (int pc = 0; pc < k; pc += SGEMM_KC) {
+        int kc = min_int(SGEMM_KC, k - pc);
+        sgemm_pack_a(a + pc, lda, m, kc, mr, packed_a + (size_t)pc * m_pad);
+    }
+}
+
+int sgemm_prepacked(int m, int n, int k, const float *packed_a, const float *b, int ldb,
+                    float *c, int ldc)
+{
+    sgemm_dense_b_t dense;
+    dense.b = b;
+    dense.ldb = ldb;
+    return sgemm_blocked_ex(m, n, k, NULL, 0, packed_a, sgemm_pack_dense_b, &dense, c, ldc);
+}
@@ -0,0 +1,120 @@
+#ifndef ARM64_SGEMM_H
+#define ARM64_SGEMM_H
+
+#include <stddef.h>
+
+#include "conv.h"
+
+// 分块打包的SGEMM引擎（GotoBLAS结构），替代 set2 中的 asm_Sgemm_op16
+//
+// asm_Sgemm_op16 对每个4x4块遍历整个K维：A按列跨步逐个标量读取，B按 wh_3*4 字节跨行读取，
+// 输出较大时每一步k都会缓存缺失。这里采用三层分块：
+//   NC: B的列分块，打包后的 KC x NC 块驻留L3
+//   KC: K维分块，打包后的 MC x KC 的A块驻留L2，KC x NR 的B微面板驻留L1
+//   MC: A的行分块
+// A、B在分块内重新打包为连续的微面板，微内核每次计算 MR x NR 的C块，所有累加器常驻寄存器。
+// 微内核及其尺寸 MR x NR 在运行时按CPU特性选择（调度表见 cpu_dispatch.h），同一个二进制在不同机器上使用不同的微内核：
+//   ARM64:           8x12，24个累加器 + A、B共5个，使用全部32个NEON寄存器
+//   ARM64 SVE:       8 x 3VL（VL为向量的float个数，256位时为8x24），寄存器分配与NEON版本相同，
+//                    边界块用谓词只读写有效的行列
+//   x86-64 AVX-512:  14x32，每行2个zmm，28个累加器 + A、B共3个
+//   x86-64 AVX2+FMA: 6x16，每行2个ymm，12个累加器 + A、B共3个，16个寄存器全部用上
+//   其他:            8x12 的C实现
+// 打包格式随 MR/NR 改变；调度表在首次使用时确定之后不再改变，预打包的权重始终与当前微内核一致
+
+#define SGEMM_MR_MAX 14     // 所有微内核中最大的 MR / NR，用于边界块的临时缓冲区
+#define SGEMM_NR_MAX 48     // SVE 微内核只在向量不超过512位时使用
+#define SGEMM_KC   256
+#define SGEMM_NC   3072     // 常见 NR（12、16、24、32、48）的公倍数
+
+// 微内核写回前在累加器上完成的后处理，由 sgemm_blocked_batched 从 conv_epilogue_t 换算：
+// ReLU / ReLU6 与截断区间合并，激活只剩 LeakyReLU 和 SiLU；顺序与 conv_epilogue_apply 相同（加偏置 -> 激活 -> 截断）
+typedef struct {
+    int bias_on_cols;         // 0：第i行加 bias[i]；非0：第j列加 bias[j]
+    conv_act_t activation;    // CONV_ACT_NONE / CONV_ACT_LEAKY_RELU / CONV_ACT_SILU
+    int clamp;                // 非0时截断到 [lo, hi]
+    float alpha, lo, hi;      // 连续存放，汇编微内核从 &alpha 起读取
+} sgemm_epilogue_t;
+
+// 微内核：C[MR x NR] (+)= packed_a[kc x MR]^T * packed_b[kc x NR]，kc >= 1
+// accumulate 为0时覆盖C，否则累加到C上；ldc 以float为单位
+// epilogue 非NULL时（最后一个K分块）在写回之前直接对累加器做后处理，C写回后不再读取；
+// bias 为该块的 MR 个行偏置（按列时为 NR 个列偏置），总是可以读满 MR / NR 个，NULL 时不加偏置
+typedef void (*sgemm_kernel_fn)(int kc, const float *packed_a, const float *packed_b, float *c, int ldc,
+                                int accumulate, const float *bias, const sgemm_epilogue_t *epilogue);
+
+// 边界块：只读写C的前 mr 行、前 nr 列，其余与 sgemm_kernel_fn 相同
+typedef void (*sgemm_partial_fn)(int kc, const float *packed_a, const float *packed_b, float *c, int ldc,
+                                 int accumulate, const float *bias, const sgemm_epilogue_t *epilogue, int mr, int nr);
+
+typedef struct {
+    const char *name;
+    int mr, nr;
+    int mc;                 // A的行分块，mr 的整数倍
+    sgemm_kernel_fn kernel;
+    sgemm_partial_fn partial;   // NULL 时边界块先在临时缓冲区上计算再拷回
+} sgemm_ukernel_t;
+
+// 各架构的微内核，由 cpu_dispatch.c 按CPU特性选择；x86-64 的两个微内核只在 CONV_X86_DISPATCH 时存在
+extern const sgemm_ukernel_t sgemm_ukernel_default;   // ARM64 NEON 或C实现
+extern const sgemm_ukernel_t sgemm_ukernel_avx2;
+extern const sgemm_ukernel_t sgemm_ukernel_avx512;
+// SVE 微内核，NR 由向量长度决定（vector_floats 为每个向量的float个数）；只在 CONV_SVE_DISPATCH 时存在
+const sgemm_ukernel_t *sgemm_ukernel_sve(int vector_floats);
+
+// 当前使用的微内核（调度表中的SGEMM项）
+const sgemm_ukernel_t *sgemm_ukernel(void);
+
+// C = A * B
+// A: m x k（行距 lda），B: k x n（行距 ldb），C: m x n（行距 ldc），均为行主序
+// 成功返回0，打包缓冲区分配失败返回 CONV_ERR_NOMEM
+int sgemm_blocked(int m, int n, int k, const float *a, int lda, const float *b, int ldb,
+                  float *c, int ldc);
+
+// B打包回调：把逻辑矩阵B的 [k0, k0+kc) 行 x [n0, n0+nc) 列打包成与 sgemm_pack_b 相同的微面板格式
+// 隐式GEMM通过它直接从输入特征图收集卷积窗口，无需先生成完整的im2col矩阵
+typedef void (*sgemm_pack_b_fn)(const void *ctx, int k0, int kc, int n0, int nc, float *packed_b);
+
+// C = A * B，B不显式存储，分块时由 pack_b 现场生成
+// prepacked_a 非NULL时使用 sgemm_prepack_a 的结果，忽略 a / lda
+int sgemm_blocked_ex(int m, int n, int k, const float *a, int lda, const float *prepacked_a,
+                     sgemm_pack_b_fn pack_b, const void *pack_b_ctx, float *c, int ldc);
+
+// 批量输出：C的列每 c_batch_cols 列为一组，第g组从 c + g * c_batch_stride 开始，组内行距为 ldc
+// 卷积把batch折叠进GEMM的N维（N = batch * out_h * out_w）时，用它直接按NCHW写回每张图像；
+// 跨越两组的 MR x NR 块走边界路径
+// 融合后处理：最后一个K分块的微内核在写回每个 MR x NR 结果块之前，直接在累加器上
+// 给第i行加 bias[i]（bias_on_cols 非0时第j列加 bias[j]，用于输出通道为列的NHWC），
+// 再按 epilogue 激活和截断（见 sgemm_epilogue_t）；bias、epilogue 都可以为NULL
+// workspace 为打包缓冲区（至少 sgemm_workspace_size 字节、64字节对齐），NULL 时内部分配
+int sgemm_blocked_batched(int m, int n, int k, const float *a, int lda, const float *prepacked_a,
+                          sgemm_pack_b_fn pack_b, const void *pack_b_ctx,
+                          float *c, int ldc, int c_batch_cols, size_t c_batch_stride,
+                          const float *bias, int bias_on_cols, const conv_epilogue_t *epilogue, void *workspace);
+
+// N = n 的矩阵乘法所需的打包缓冲区字节数（每个线程一份A、B块，A已预打包时不含A块），按当前线程数计算
+size_t sgemm_workspace_size(int n, int prepacked_a);
+
+// 显式存储的行主序B，配合 sgemm_pack_dense_b 使用
+typedef struct {
+    const float *b;
+    int ldb;
+} sgemm_dense_b_t;
+void sgemm_pack_dense_b(const void *ctx, int k0, int kc, int n0, int nc, float *packed_b);
+
+// 预打包A：权重在多次调用间不变时只打包一次，之后每次矩阵乘法都跳过A的打包
+// 布局：按KC把K维分块，第 pc 个K分块从 pc * m_pad 处开始（m_pad 为 m 向上对齐到 MR），
+// 分块内是整个A的 sgemm_pack_a 格式，因此从任意MR倍数行开始的子块可以直接交给微内核
+size_t sgemm_packed_a_size(int m, int k);   // float个数
+void sgemm_prepack_a(int m, int k, const float *a, int lda, float *packed_a);
+
+// C = A * B，A为 sgemm_prepack_a 的结果
+int sgemm_prepacked(int m, int n, int k, const float *packed_a, const float *b, int ldb,
+                    float *c, int ldc);
+
+// 打包：A的 mc x kc 块按 mr 行一组排成微面板，每个微面板内按k连续存放 mr 个元素，不足补零
+void sgemm_pack_a(const float *a, int lda, int mc, int kc, int mr, float *packed_a);
+// 打包：B的 kc x nc 块按 nr 列一组排成微面板，每个微面板内按k连续存放 nr 个元素，不足补零
+void sgemm_pack_b(const float *b, int ldb, int kc, int nc, int nr, float *packed_b);
+
+#endif // ARM64_SGEMM_H
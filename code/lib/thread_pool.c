@@ -0,0 +1,197 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "conv_internal.h"
+#include "thread_pool.h"
+
+typedef struct {
+    pthread_t *threads;          // 工作线程（不含调用线程），共 num_threads - 1 个
+    int num_threads;
+
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;    // 通知工作线程有新任务
+    pthread_cond_t done_cond;    // 通知调用线程任务全部完成
+
+    conv_task_fn fn;
+    void *ctx;
+    int num_tasks;
+    int next_task;               // 下一个待领取的任务，原子递增
+    int active_workers;          // 尚未完成本轮的工作线程数
+    unsigned generation;         // 每轮任务加一，工作线程据此判断是否有新任务
+    int busy;                    // 本轮任务进行中
+    int shutdown;
+} thread_pool_t;
+
+typedef struct {
+    thread_pool_t *pool;
+    int thread_id;
+} worker_arg_t;
+
+static pthread_mutex_t g_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static thread_pool_t *g_pool = NULL;
+static int g_num_threads = 1;
+
+// 领取并执行任务，直到全部任务被领取
+static void run_tasks(thread_pool_t *pool, int thread_id)
+{
+    int task;
+    while ((task = __atomic_fetch_add(&pool->next_task, 1, __ATOMIC_RELAXED)) < pool->num_tasks) {
+        pool->fn(pool->ctx, task, thread_id);
+    }
+}
+
+static void *worker_main(void *arg)
+{
+    worker_arg_t *worker = (worker_arg_t *)arg;
+    thread_pool_t *pool = worker->pool;
+    int thread_id = worker->thread_id;
+    unsigned seen_generation = 0;
+
+    free(worker);
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->shutdown && pool->generation == seen_generation) {
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        }
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        seen_generation = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+
+        run_tasks(pool, thread_id);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->active_workers == 0) {
+            pthread_cond_signal(&pool->done_cond);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+    return NULL;
+}
+
+static void thread_pool_destroy(thread_pool_t *pool)
+{
+    if (!pool) {
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->num_threads - 1; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    free(pool->threads);
+    free(pool);
+}
+
+static thread_pool_t *thread_pool_create(int num_threads)
+{
+    thread_pool_t *pool = (thread_pool_t *)calloc(1, sizeof(thread_pool_t));
+    if (!pool) {
+        return NULL;
+    }
+    pool->threads = (pthread_t *)calloc(num_threads, sizeof(pthread_t));
+    if (!pool->threads) {
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    // 调用线程作为0号线程，只需创建 num_threads - 1 个工作线程
+    pool->num_threads = 1;
+    for (int i = 1; i < num_threads; i++) {
+        worker_arg_t *worker = (worker_arg_t *)malloc(sizeof(worker_arg_t));
+        if (!worker) {
+            break;
+        }
+        worker->pool = pool;
+        worker->thread_id = i;
+        if (pthread_create(&pool->threads[i - 1], NULL, worker_main, worker) != 0) {
+            free(worker);
+            break;
+        }
+        pool->num_threads++;
+    }
+    return pool;
+}
+
+int conv_set_num_threads(int num_threads)
+{
+    if (num_threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cpus > 0 ? (int)cpus : 1;
+    }
+
+    pthread_mutex_lock(&g_pool_lock);
+    thread_pool_destroy(g_pool);
+    g_pool = NULL;
+    if (num_threads > 1) {
+        g_pool = thread_pool_create(num_threads);
+    }
+    g_num_threads = g_pool ? g_pool->num_threads : 1;
+    pthread_mutex_unlock(&g_pool_lock);
+
+    return g_num_threads == num_threads ? CONV_OK : CONV_ERR_NOMEM;
+}
+
+int conv_get_num_threads(void)
+{
+    return g_num_threads;
+}
+
+int conv_parallel_threads(void)
+{
+    return g_num_threads;
+}
+
+void conv_parallel_for(int num_tasks, conv_task_fn fn, void *ctx)
+{
+    thread_pool_t *pool = g_pool;
+    int use_pool = 0;
+
+    if (pool && num_tasks > 1) {
+        pthread_mutex_lock(&pool->lock);
+        if (!pool->busy) {
+            pool->busy = 1;
+            pool->fn = fn;
+            pool->ctx = ctx;
+            pool->num_tasks = num_tasks;
+            pool->next_task = 0;
+            pool->active_workers = pool->num_threads - 1;
+            pool->generation++;
+            pthread_cond_broadcast(&pool->work_cond);
+            use_pool = 1;
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    if (!use_pool) {
+        // 单线程或线程池已被占用：串行执行
+        for (int task = 0; task < num_tasks; task++) {
+            fn(ctx, task, 0);
+        }
+        return;
+    }
+
+    run_tasks(pool, 0);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->active_workers > 0) {
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    }
+    pool->busy = 0;
+    pthread_mutex_unlock(&pool->lock);
+}
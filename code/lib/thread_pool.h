@@ -0,0 +1,17 @@
+#ifndef ARM64_THREAD_POOL_H
+#define ARM64_THREAD_POOL_H
+
+// 库内部的全局线程池
+// 线程数由 conv_set_num_threads 配置，工作线程常驻，调用 conv_parallel_for 时唤醒。
+
+// 任务函数：task 为任务编号 [0, num_tasks)，thread_id 为执行线程编号 [0, 线程数)
+typedef void (*conv_task_fn)(void *ctx, int task, int thread_id);
+
+// 并行执行 num_tasks 个任务，调用线程也参与计算，全部完成后返回
+// 线程池正被其他调用占用（例如任务内部再次调用）时退化为在当前线程串行执行
+void conv_parallel_for(int num_tasks, conv_task_fn fn, void *ctx);
+
+// 当前线程数（至少为1），thread_id 均小于该值
+int conv_parallel_threads(void);
+
+#endif // ARM64_THREAD_POOL_H
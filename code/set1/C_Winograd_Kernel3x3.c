@@ -0,0 +1,225 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../lib/conv.h"
+
+// Winograd F(2x2,3x3) / F(4x4,3x3) 与 C_loop_Origin.c 中 convolution 的对比，无补零和 padding=1 各一组
+// 每个输出需满足 |y - y_ref| <= bound * sum_ic sum|w| * max|x|（max 取所在tile的输入窗口，bound 见 conv.h），
+// 否则返回非0
+// 编译：clang -O3 -o C_Winograd_Kernel3x3 C_Winograd_Kernel3x3.c ../lib/*.c -lm -lpthread
+
+// 主卷积函数（与 C_loop_Origin.c 相同，作为参考结果）
+void convolution(float *input_feature, const float *weights, const float *bias, float *output_feature, int output_channel, int input_channel,
+                 int k_size, int output_wh, int input_wh)
+{
+    int row, col, output_filter, input_filter, kernel_row, kernel_col;
+
+    for (row = 0; row < output_wh; row++) {
+        for (col = 0; col < output_wh; col++) {
+            for (output_filter = 0; output_filter < output_channel; output_filter++) {
+                float temp = 0;
+                for (input_filter = 0; input_filter < input_channel; input_filter++) {
+                    for (kernel_row = 0; kernel_row < k_size; kernel_row++) {
+                        for (kernel_col = 0; kernel_col < k_size; kernel_col++) {
+                            temp = temp + (input_feature[input_filter * input_wh * input_wh + (row + kernel_row) * input_wh + (col + kernel_col)]
+                                        * weights[output_filter * input_channel * k_size * k_size + input_filter * k_size * k_size +
+                                                 kernel_row * k_size + kernel_col]);
+                        }
+                    }
+                }
+                output_feature[output_filter * output_wh * output_wh + row * output_wh + col] = temp + bias[output_filter];
+            }
+        }
+    }
+}
+
+// 补零后的输入：每边补 padding 个0，补零后与无补零的卷积相同，可以直接交给 convolution
+void pad_input(const float *input_feature, float *padded, int input_channel, int input_wh, int padding)
+{
+    int padded_wh = input_wh + 2 * padding;
+    memset(padded, 0, (size_t)input_channel * padded_wh * padded_wh * sizeof(float));
+    for (int ic = 0; ic < input_channel; ic++) {
+        for (int row = 0; row < input_wh; row++) {
+            memcpy(padded + ((size_t)ic * padded_wh + row + padding) * padded_wh + padding,
+                   input_feature + ((size_t)ic * input_wh + row) * input_wh, input_wh * sizeof(float));
+        }
+    }
+}
+
+// 每个输出的误差尺度 sum_ic sum|w[oc][ic]| * max|x_ic|，max 取输出所在 m x m tile 读取的
+// (m+2) x (m+2) 输入窗口（padded 为补零后的输入，窗口超出部分为 Winograd 补的0）
+void tile_error_scale(const float *padded, const float *weights, float *scale, int output_channel,
+                      int input_channel, int k_size, int output_wh, int padded_wh, int m)
+{
+    int tiles = (output_wh + m - 1) / m;
+    float *tile_max = (float *)malloc((size_t)input_channel * tiles * tiles * sizeof(float));
+    float *weight_sum = (float *)malloc((size_t)output_channel * input_channel * sizeof(float));
+
+    for (int ic = 0; ic < input_channel; ic++) {
+        for (int ty = 0; ty < tiles; ty++) {
+            for (int tx = 0; tx < tiles; tx++) {
+                float max = 0;
+                for (int i = ty * m; i < ty * m + m + k_size - 1 && i < padded_wh; i++) {
+                    for (int j = tx * m; j < tx * m + m + k_size - 1 && j < padded_wh; j++) {
+                        float x = fabsf(padded[((size_t)ic * padded_wh + i) * padded_wh + j]);
+                        max = x > max ? x : max;
+                    }
+                }
+                tile_max[((size_t)ic * tiles + ty) * tiles + tx] = max;
+            }
+        }
+    }
+    for (int oc = 0; oc < output_channel; oc++) {
+        for (int ic = 0; ic < input_channel; ic++) {
+            double sum = 0;
+            for (int t = 0; t < k_size * k_size; t++) {
+                sum += fabs(weights[(size_t)(oc * input_channel + ic) * k_size * k_size + t]);
+            }
+            weight_sum[oc * input_channel + ic] = (float)sum;
+        }
+    }
+    for (int oc = 0; oc < output_channel; oc++) {
+        for (int row = 0; row < output_wh; row++) {
+            for (int col = 0; col < output_wh; col++) {
+                double sum = 0;
+                for (int ic = 0; ic < input_channel; ic++) {
+                    sum += (double)weight_sum[oc * input_channel + ic] *
+                           tile_max[((size_t)ic * tiles + row / m) * tiles + col / m];
+                }
+                scale[((size_t)oc * output_wh + row) * output_wh + col] = (float)sum;
+            }
+        }
+    }
+    free(tile_max);
+    free(weight_sum);
+}
+
+// 主函数用于测试
+int main()
+{
+    // 固定参数
+    int input_channels = 32;
+    int output_channels = 32;
+    int kernel_size = 3;
+    int input_size = 128;
+    int paddings[2] = { 0, 1 };   // 无补零：输出 126 x 126；padding=1：输出 128 x 128，覆盖补零边界
+    int max_output = input_size + 2 - kernel_size + 1;
+    int max_output_count = output_channels * max_output * max_output;
+    int padded_max = input_size + 2;
+
+    printf("卷积参数:\n");
+    printf("输入尺寸: %d x %d x %d\n", input_channels, input_size, input_size);
+    printf("卷积核大小: %d x %d\n", kernel_size, kernel_size);
+    printf("\n");
+
+    // 分配内存
+    float *input = (float *)malloc(input_channels * input_size * input_size * sizeof(float));
+    float *padded = (float *)malloc((size_t)input_channels * padded_max * padded_max * sizeof(float));
+    float *weights_data = (float *)malloc(output_channels * input_channels * kernel_size * kernel_size * sizeof(float));
+    float *bias_data = (float *)malloc(output_channels * sizeof(float));
+    float *reference = (float *)malloc(max_output_count * sizeof(float));
+    float *scale = (float *)malloc(max_output_count * sizeof(float));
+    float *output = (float *)malloc(max_output_count * sizeof(float));
+
+    if (!input || !padded || !weights_data || !bias_data || !reference || !scale || !output) {
+        printf("内存分配失败!\n");
+        free(input);
+        free(padded);
+        free(weights_data);
+        free(bias_data);
+        free(reference);
+        free(scale);
+        free(output);
+        return -1;
+    }
+
+    // 初始化数据（有正有负，使抵消误差能体现出来）
+    printf("初始化数据...\n");
+    for (int i = 0; i < input_channels * input_size * input_size; i++) {
+        input[i] = (float)(rand() % 21 - 10) / 10.0f;
+    }
+    for (int i = 0; i < output_channels * input_channels * kernel_size * kernel_size; i++) {
+        weights_data[i] = (float)(rand() % 21 - 10) / 10.0f;
+    }
+    for (int i = 0; i < output_channels; i++) {
+        bias_data[i] = 0.1f;
+    }
+
+    conv_algo_t algos[2] = { CONV_ALGO_WINOGRAD_2X2, CONV_ALGO_WINOGRAD_4X4 };
+    int tile_sizes[2] = { 2, 4 };
+    float bounds[2] = { CONV_WINOGRAD_2X2_ERROR_BOUND, CONV_WINOGRAD_4X4_ERROR_BOUND };
+    int failed = 0;
+    int ret = CONV_OK;
+    for (int p = 0; p < 2 && ret == CONV_OK; p++) {
+        int padding = paddings[p];
+        int padded_size = input_size + 2 * padding;
+        int output_size = padded_size - kernel_size + 1;
+        int output_count = output_channels * output_size * output_size;
+        long long total_operations = (long long)output_channels * output_size * output_size *
+                                     input_channels * kernel_size * kernel_size * 2; // 乘法和加法
+
+        // 参考结果：对补零后的输入做无补零卷积
+        pad_input(input, padded, input_channels, input_size, padding);
+        clock_t start_time = clock();
+        convolution(padded, weights_data, bias_data, reference, output_channels, input_channels,
+                    kernel_size, output_size, padded_size);
+        double reference_time = ((double)(clock() - start_time)) / CLOCKS_PER_SEC;
+        printf("\npadding=%d，输出尺寸: %d x %d x %d\n", padding, output_channels, output_size, output_size);
+        printf("%-14s %12s %10s %14s %12s\n", "算法", "时间(秒)", "GFLOPS", "最大相对误差", "误差上界");
+        printf("%-14s %12.6f %10.2f %14s %12s\n", "convolution", reference_time,
+               (total_operations / 1e9) / reference_time, "-", "-");
+
+        conv_desc_t desc;
+        conv_desc_init(&desc, input_channels, input_size, input_size, output_channels, kernel_size);
+        desc.padding = padding;
+
+        for (int a = 0; a < 2; a++) {
+            memset(output, 0, output_count * sizeof(float));
+
+            start_time = clock();
+            ret = conv2d(&desc, algos[a], input, weights_data, bias_data, output);
+            double cpu_time_used = ((double)(clock() - start_time)) / CLOCKS_PER_SEC;
+            if (ret != CONV_OK) {
+                printf("卷积计算失败: %d\n", ret);
+                failed = 1;
+                break;
+            }
+
+            // 相对误差 |y - y_ref| / (sum_ic sum|w| * max|x|)
+            tile_error_scale(padded, weights_data, scale, output_channels, input_channels, kernel_size,
+                             output_size, padded_size, tile_sizes[a]);
+            float max_error = 0;
+            for (int i = 0; i < output_count; i++) {
+                float error = fabsf(output[i] - reference[i]) / (scale[i] > 0 ? scale[i] : 1.0f);
+                if (!(error <= max_error)) {
+                    max_error = error;
+                }
+            }
+            printf("%-14s %12.6f %10.2f %14.3e %12.1e %s\n", conv_algo_name(algos[a]), cpu_time_used,
+                   (total_operations / 1e9) / cpu_time_used, max_error, bounds[a],
+                   max_error <= bounds[a] ? "通过" : "超出上界!");
+            if (!(max_error <= bounds[a])) {
+                failed = 1;
+            }
+        }
+    }
+
+    printf("\n输出样本值:\n");
+    for (int i = 0; i < 5; i++) {
+        printf("output[%d] = %.4f (参考 %.4f)\n", i, output[i], reference[i]);
+    }
+
+    // 释放内存
+    free(input);
+    free(padded);
+    free(weights_data);
+    free(bias_data);
+    free(reference);
+    free(scale);
+    free(output);
+
+    return failed;
+}
@@ -17,7 +17,19 @@ void convolution_any_kernel(float *input_feature, const float *weights, const fl
                         for (kernel_col = 0; kernel_col < k_size; kernel_col+=4) {
                             ind = input_filter * input_wh * input_wh + (row + kernel_row) * input_wh + (col + kernel_col);
                             wind = output_filter * input_channel * k_size * k_size + input_filter * k_size * k_size + kernel_row * k_size + kernel_col;
-                            
+
+                            // k_size 不是4的倍数时，最后一行/列的块不足4x4，逐元素累加，不越过卷积核边界
+                            if (kernel_row + 4 > k_size || kernel_col + 4 > k_size) {
+                                int rows_to_process = k_size - kernel_row < 4 ? k_size - kernel_row : 4;
+                                int cols_to_process = k_size - kernel_col < 4 ? k_size - kernel_col : 4;
+                                for (int r = 0; r < rows_to_process; r++) {
+                                    for (int c = 0; c < cols_to_process; c++) {
+                                        temp += input_feature[ind + r * input_wh + c] * weights[wind + r * k_size + c];
+                                    }
+                                }
+                                continue;
+                            }
+
                             temp += input_feature[ind] * weights[wind];
                             temp += input_feature[ind+1] * weights[wind+1];
                             temp += input_feature[ind+2] * weights[wind+2];
@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../bench/bench.h"
+#include "../lib/conv.h"
+
+// 批量卷积：batch折叠进GEMM的N维，权重只打包一次（conv_prepare），整个batch中常驻缓存
+// 输出 batch = 1, 2, 4, ..., 64 时的单次延迟和吞吐（图像/秒）
+// 编译：clang -O3 -o asm_Sgemm_batch asm_Sgemm_batch.c ../bench/bench.c ../lib/*.c -lm -lpthread
+
+// 被计时的一次运行
+typedef struct {
+    conv_handle_t *handle;
+    const float *input;
+    float *output;
+    int ret;
+} batch_run_t;
+
+static void batch_run(void *ctx)
+{
+    batch_run_t *t = (batch_run_t *)ctx;
+    int ret = conv2d_prepared(t->handle, t->input, t->output);
+    if (ret != CONV_OK) {
+        t->ret = ret;
+    }
+}
+
+int main()
+{
+    // 固定参数
+    int input_channels = 64;
+    int output_channels = 64;
+    int kernel_size = 3;
+    int input_size = 28;
+    int max_batch = 64;
+    int repeats = 5;
+
+    conv_desc_t desc;
+    conv_desc_init(&desc, input_channels, input_size, input_size, output_channels, kernel_size);
+    desc.padding = 1;
+    int output_size = conv_output_h(&desc);
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    conv_set_num_threads(cpus > 0 ? (int)cpus : 1);
+
+    printf("卷积参数:\n");
+    printf("输入尺寸: N x %d x %d x %d\n", input_channels, input_size, input_size);
+    printf("输出尺寸: N x %d x %d x %d\n", output_channels, output_size, output_size);
+    printf("卷积核大小: %d x %d，填充: %d\n", kernel_size, kernel_size, desc.padding);
+    printf("线程数: %d\n", conv_get_num_threads());
+    printf("\n");
+
+    // 分配内存
+    size_t input_image = (size_t)input_channels * input_size * input_size;
+    size_t output_image = (size_t)output_channels * output_size * output_size;
+    float *input = (float *)malloc(max_batch * input_image * sizeof(float));
+    float *weights_data = (float *)malloc(output_channels * input_channels * kernel_size * kernel_size * sizeof(float));
+    float *bias_data = (float *)malloc(output_channels * sizeof(float));
+    float *output = (float *)malloc(max_batch * output_image * sizeof(float));
+
+    if (!input || !weights_data || !bias_data || !output) {
+        printf("内存分配失败!\n");
+        return -1;
+    }
+
+    // 初始化数据（示例）
+    printf("初始化数据...\n");
+    for (size_t i = 0; i < max_batch * input_image; i++) {
+        input[i] = (float)(rand() % 10) / 10.0f;
+    }
+    for (int i = 0; i < output_channels * input_channels * kernel_size * kernel_size; i++) {
+        weights_data[i] = (float)(rand() % 10) / 10.0f;
+    }
+    for (int i = 0; i < output_channels; i++) {
+        bias_data[i] = 0.1f;
+    }
+
+    long long image_operations = (long long)output_channels * output_size * output_size *
+                                 input_channels * kernel_size * kernel_size * 2; // 乘法和加法
+
+    printf("\n%6s %-14s %12s %12s %10s\n", "batch", "算法", "延迟(毫秒)", "图像/秒", "GFLOPS");
+    for (int batch = 1; batch <= max_batch; batch *= 2) {
+        conv_handle_t *handle;
+        desc.batch = batch;
+        if (conv_prepare(&desc, CONV_ALGO_AUTO, weights_data, bias_data, &handle) != CONV_OK) {
+            printf("权重打包失败!\n");
+            break;
+        }
+
+        // 预热一次，排除首次缺页的开销；之后计时 repeats 次取中位数
+        batch_run_t t = { handle, input, output, CONV_OK };
+        bench_config_t config = { 1, repeats };
+        bench_stats_t stats;
+        int ret = bench_measure(&config, batch_run, &t, &stats);
+        if (ret == CONV_OK) {
+            ret = t.ret;
+        }
+        if (ret != CONV_OK) {
+            printf("卷积计算失败: %d\n", ret);
+            conv_handle_destroy(handle);
+            break;
+        }
+        double median = stats.median;
+
+        printf("%6d %-14s %12.3f %12.1f %10.2f\n", batch, conv_algo_name(conv_handle_algo(handle)),
+               median * 1e3, batch / median, (image_operations * batch / 1e9) / median);
+        conv_handle_destroy(handle);
+    }
+
+    printf("\n输出样本值:\n");
+    for (int i = 0; i < 5; i++) {
+        printf("output[%d] = %.4f\n", i, output[i]);
+    }
+
+    // 释放内存
+    conv_set_num_threads(1);
+    free(input);
+    free(weights_data);
+    free(bias_data);
+    free(output);
+
+    return 0;
+}
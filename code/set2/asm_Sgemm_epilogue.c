@@ -0,0 +1,209 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../bench/bench.h"
+#include "../lib/conv.h"
+
+// 融合后处理（desc.epilogue）与“卷积 + 单独的偏置/激活遍历”的对比
+// 单独遍历要把整个输出从内存再读写一遍；融合后由SGEMM微内核在写回每个结果块之前直接对累加器完成
+// 两种方式的结果逐个比较，相对误差超过1e-5返回非0
+// 编译：clang -O3 -o asm_Sgemm_epilogue asm_Sgemm_epilogue.c ../bench/bench.c ../lib/*.c -lm -lpthread
+
+// 单独的后处理遍历：加偏置、激活、截断
+static void epilogue_pass(const conv_epilogue_t *epilogue, const float *bias, float *output, int output_channel,
+                          int plane)
+{
+    for (int oc = 0; oc < output_channel; oc++) {
+        float *out = output + (size_t)oc * plane;
+        for (int i = 0; i < plane; i++) {
+            float v = out[i] + bias[oc];
+            switch (epilogue->activation) {
+            case CONV_ACT_RELU:
+                v = v > 0.0f ? v : 0.0f;
+                break;
+            case CONV_ACT_RELU6:
+                v = v > 0.0f ? (v < 6.0f ? v : 6.0f) : 0.0f;
+                break;
+            case CONV_ACT_LEAKY_RELU:
+                v = v > 0.0f ? v : v * epilogue->alpha;
+                break;
+            case CONV_ACT_SILU:
+                v = v / (1.0f + expf(-v));
+                break;
+            default:
+                break;
+            }
+            if (epilogue->clamp) {
+                v = v < epilogue->clamp_min ? epilogue->clamp_min : (v > epilogue->clamp_max ? epilogue->clamp_max : v);
+            }
+            out[i] = v;
+        }
+    }
+}
+
+// 被计时的一次运行；fused 为0时卷积不加偏置，之后单独遍历输出
+typedef struct {
+    const conv_desc_t *desc;
+    int fused;
+    const float *input, *weights, *bias;
+    float *output;
+    int ret;
+} epilogue_run_t;
+
+static void epilogue_run(void *ctx)
+{
+    epilogue_run_t *t = (epilogue_run_t *)ctx;
+    const conv_desc_t *desc = t->desc;
+    int ret;
+    if (t->fused) {
+        ret = conv2d(desc, CONV_ALGO_AUTO, t->input, t->weights, t->bias, t->output);
+    } else {
+        conv_desc_t plain = *desc;
+        memset(&plain.epilogue, 0, sizeof(plain.epilogue));
+        ret = conv2d(&plain, CONV_ALGO_AUTO, t->input, t->weights, NULL, t->output);
+        if (ret == CONV_OK) {
+            epilogue_pass(&desc->epilogue, t->bias, t->output, desc->output_channel * desc->batch,
+                          conv_output_h(desc) * conv_output_w(desc));
+        }
+    }
+    if (ret != CONV_OK) {
+        t->ret = ret;
+    }
+}
+
+// 用 bench_measure 预热一次后计时 repeats 次，返回中位数（秒）
+static double median_time(const conv_desc_t *desc, int fused, const float *input, const float *weights,
+                          const float *bias, float *output, int repeats, int *ret)
+{
+    epilogue_run_t t = { desc, fused, input, weights, bias, output, CONV_OK };
+    bench_config_t config = { 1, repeats };
+    bench_stats_t stats;
+    *ret = bench_measure(&config, epilogue_run, &t, &stats);
+    if (*ret == CONV_OK) {
+        *ret = t.ret;
+    }
+    return *ret == CONV_OK ? stats.median : 0;
+}
+
+// 主函数用于测试
+int main()
+{
+    // 每组参数：输入通道，输出通道，卷积核大小，输入尺寸（补零使输出尺寸不变）
+    static const int shapes[][4] = {
+        { 32, 64, 3, 112 },
+        { 64, 64, 3, 56 },
+        { 128, 128, 3, 28 },
+        { 256, 256, 1, 14 },
+    };
+    int shape_count = (int)(sizeof(shapes) / sizeof(shapes[0]));
+    int repeats = 5;
+    int failed = 0;
+
+    conv_epilogue_t epilogues[CONV_ACT_COUNT + 1];
+    int epilogue_count = CONV_ACT_COUNT + 1;
+    memset(epilogues, 0, sizeof(epilogues));
+    for (int a = 0; a < CONV_ACT_COUNT; a++) {
+        epilogues[a].activation = (conv_act_t)a;
+        epilogues[a].alpha = 0.1f;
+    }
+    // 最后一组：LeakyReLU 之后截断到 [-1, 4]
+    epilogues[CONV_ACT_COUNT].activation = CONV_ACT_LEAKY_RELU;
+    epilogues[CONV_ACT_COUNT].alpha = 0.1f;
+    epilogues[CONV_ACT_COUNT].clamp = 1;
+    epilogues[CONV_ACT_COUNT].clamp_min = -1.0f;
+    epilogues[CONV_ACT_COUNT].clamp_max = 4.0f;
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    conv_set_num_threads(cpus > 0 ? (int)cpus : 1);
+
+    printf("线程数: %d\n", conv_get_num_threads());
+    printf("内核: %s\n", conv_kernel_info());
+    printf("\n%-20s %-18s %12s %12s %8s %10s\n", "参数(ic,oc,k,尺寸)", "后处理", "单独遍历(秒)", "融合(秒)", "加速比",
+           "最大误差");
+
+    for (int s = 0; s < shape_count; s++) {
+        int input_channels = shapes[s][0];
+        int output_channels = shapes[s][1];
+        int kernel_size = shapes[s][2];
+        int input_size = shapes[s][3];
+
+        conv_desc_t desc;
+        conv_desc_init(&desc, input_channels, input_size, input_size, output_channels, kernel_size);
+        desc.padding = kernel_size / 2;
+
+        // 分配内存
+        int input_count = input_channels * input_size * input_size;
+        int weight_count = output_channels * input_channels * kernel_size * kernel_size;
+        int output_count = output_channels * conv_output_h(&desc) * conv_output_w(&desc);
+        float *input = (float *)malloc(input_count * sizeof(float));
+        float *weights_data = (float *)malloc(weight_count * sizeof(float));
+        float *bias_data = (float *)malloc(output_channels * sizeof(float));
+        float *reference = (float *)malloc(output_count * sizeof(float));
+        float *output = (float *)malloc(output_count * sizeof(float));
+
+        if (!input || !weights_data || !bias_data || !reference || !output) {
+            printf("内存分配失败!\n");
+            return -1;
+        }
+
+        // 初始化数据（示例）：权重按 1/sqrt(C_in*k*k) 缩放，输出大致落在 [-6, 6]，各激活的分段都会用到
+        float weight_range = 6.0f / sqrtf((float)(input_channels * kernel_size * kernel_size));
+        for (int i = 0; i < input_count; i++) {
+            input[i] = (float)(rand() % 2001 - 1000) / 1000.0f;
+        }
+        for (int i = 0; i < weight_count; i++) {
+            weights_data[i] = (float)(rand() % 2001 - 1000) / 1000.0f * weight_range;
+        }
+        for (int i = 0; i < output_channels; i++) {
+            bias_data[i] = (float)(rand() % 2001 - 1000) / 1000.0f;
+        }
+
+        int ret = CONV_OK;
+        for (int e = 0; e < epilogue_count && ret == CONV_OK; e++) {
+            desc.epilogue = epilogues[e];
+            double separate_time = median_time(&desc, 0, input, weights_data, bias_data, reference, repeats, &ret);
+            if (ret != CONV_OK) {
+                break;
+            }
+            double fused_time = median_time(&desc, 1, input, weights_data, bias_data, output, repeats, &ret);
+            if (ret != CONV_OK) {
+                break;
+            }
+
+            float max_error = 0.0f;
+            for (int i = 0; i < output_count; i++) {
+                float error = fabsf(output[i] - reference[i]) / (1.0f + fabsf(reference[i]));
+                if (!(error <= max_error)) {
+                    max_error = error;
+                }
+            }
+            char name[32], epilogue_name[32];
+            snprintf(name, sizeof(name), "%d,%d,%d,%d", input_channels, output_channels, kernel_size, input_size);
+            snprintf(epilogue_name, sizeof(epilogue_name), "%s%s", conv_act_name(desc.epilogue.activation),
+                     desc.epilogue.clamp ? "+clamp" : "");
+            printf("%-20s %-18s %12.6f %12.6f %8.2f %10.2e %s\n", name, epilogue_name, separate_time, fused_time,
+                   separate_time / fused_time, max_error, max_error <= 1e-5f ? "通过" : "错误!");
+            if (!(max_error <= 1e-5f)) {
+                failed = 1;
+            }
+        }
+
+        // 释放内存
+        free(input);
+        free(weights_data);
+        free(bias_data);
+        free(reference);
+        free(output);
+
+        if (ret != CONV_OK) {
+            printf("卷积计算失败: %d\n", ret);
+            return -1;
+        }
+    }
+
+    conv_set_num_threads(1);
+    return failed;
+}
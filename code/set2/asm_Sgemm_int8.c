@@ -0,0 +1,206 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../bench/bench.h"
+#include "../lib/conv.h"
+
+// INT8量化卷积（conv2d_int8）与FP32 Im2col + SGEMM 的对比
+// 第一组参数与 asm_Sgemm_op16.c 相同；INT8结果与整数参考实现逐个比较，重新量化的舍入差不超过1，否则返回非0
+// 编译：clang -O3 -o asm_Sgemm_int8 asm_Sgemm_int8.c ../bench/bench.c ../lib/*.c -lm -lpthread
+
+// 整数参考实现：acc = bias + sum w * (x - zx)，再按与 conv2d_int8 相同的方式重新量化
+void convolution_int8(const int8_t *input_feature, const int8_t *weights, const int32_t *bias, const conv_quant_t *quant,
+                      int8_t *output_feature, int output_channel, int input_channel, int k_size, int output_wh, int input_wh)
+{
+    for (int oc = 0; oc < output_channel; oc++) {
+        float scale = quant->input_scale * quant->weight_scale[oc] / quant->output_scale;
+        for (int row = 0; row < output_wh; row++) {
+            for (int col = 0; col < output_wh; col++) {
+                int32_t acc = bias[oc];
+                for (int ic = 0; ic < input_channel; ic++) {
+                    for (int kr = 0; kr < k_size; kr++) {
+                        for (int kc = 0; kc < k_size; kc++) {
+                            acc += weights[((oc * input_channel + ic) * k_size + kr) * k_size + kc] *
+                                   (input_feature[ic * input_wh * input_wh + (row + kr) * input_wh + (col + kc)] -
+                                    quant->input_zero_point);
+                        }
+                    }
+                }
+                float v = (float)acc * scale + (float)quant->output_zero_point + 128.5f;
+                v = v < 0.0f ? 0.0f : (v > 255.0f ? 255.0f : v);
+                output_feature[(oc * output_wh + row) * output_wh + col] = (int8_t)((int)v - 128);
+            }
+        }
+    }
+}
+
+// 被计时的一次运行；int8 为0时运行FP32卷积
+typedef struct {
+    const conv_desc_t *desc;
+    int int8;
+    const void *input, *weights, *bias;
+    const conv_quant_t *quant;
+    void *output;
+    int ret;
+} int8_run_t;
+
+static void int8_run(void *ctx)
+{
+    int8_run_t *t = (int8_run_t *)ctx;
+    int ret;
+    if (t->int8) {
+        ret = conv2d_int8(t->desc, t->quant, (const int8_t *)t->input, (const int8_t *)t->weights,
+                          (const int32_t *)t->bias, (int8_t *)t->output);
+    } else {
+        ret = conv2d(t->desc, CONV_ALGO_IM2COL_SGEMM, (const float *)t->input, (const float *)t->weights,
+                     (const float *)t->bias, (float *)t->output);
+    }
+    if (ret != CONV_OK) {
+        t->ret = ret;
+    }
+}
+
+// 用 bench_measure 预热一次后计时 repeats 次，返回中位数（秒）
+static double median_time(const conv_desc_t *desc, int int8, const void *input, const void *weights, const void *bias,
+                          const conv_quant_t *quant, void *output, int repeats, int *ret)
+{
+    int8_run_t t = { desc, int8, input, weights, bias, quant, output, CONV_OK };
+    bench_config_t config = { 1, repeats };
+    bench_stats_t stats;
+    *ret = bench_measure(&config, int8_run, &t, &stats);
+    if (*ret == CONV_OK) {
+        *ret = t.ret;
+    }
+    return *ret == CONV_OK ? stats.median : 0;
+}
+
+// 主函数用于测试
+int main()
+{
+    // 每组参数：输入通道，输出通道，卷积核大小，输入尺寸
+    static const int shapes[][4] = {
+        { 1, 16, 3, 256 },      // asm_Sgemm_op16.c
+        { 32, 64, 3, 58 },
+        { 64, 64, 3, 56 },
+        { 128, 128, 3, 28 },
+        { 256, 256, 1, 14 },
+    };
+    int shape_count = (int)(sizeof(shapes) / sizeof(shapes[0]));
+    int repeats = 5;
+    int failed = 0;
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    conv_set_num_threads(cpus > 0 ? (int)cpus : 1);
+
+    printf("线程数: %d\n", conv_get_num_threads());
+    printf("内核: %s\n", conv_kernel_info());
+    printf("\n%-22s %12s %10s %12s %10s %8s %10s\n", "参数(ic,oc,k,尺寸)", "FP32(秒)", "GFLOPS", "INT8(秒)", "GOPS",
+           "加速比", "最大误差");
+
+    for (int s = 0; s < shape_count; s++) {
+        int input_channels = shapes[s][0];
+        int output_channels = shapes[s][1];
+        int kernel_size = shapes[s][2];
+        int input_size = shapes[s][3];
+        int output_size = input_size - kernel_size + 1;
+
+        // 分配内存
+        int input_count = input_channels * input_size * input_size;
+        int weight_count = output_channels * input_channels * kernel_size * kernel_size;
+        int output_count = output_channels * output_size * output_size;
+        float *input = (float *)malloc(input_count * sizeof(float));
+        float *weights_data = (float *)malloc(weight_count * sizeof(float));
+        float *bias_data = (float *)malloc(output_channels * sizeof(float));
+        float *output = (float *)malloc(output_count * sizeof(float));
+        int8_t *input_q = (int8_t *)malloc(input_count);
+        int8_t *weights_q = (int8_t *)malloc(weight_count);
+        int32_t *bias_q = (int32_t *)malloc(output_channels * sizeof(int32_t));
+        float *weight_scale = (float *)malloc(output_channels * sizeof(float));
+        int8_t *output_q = (int8_t *)malloc(output_count);
+        int8_t *reference = (int8_t *)malloc(output_count);
+
+        if (!input || !weights_data || !bias_data || !output || !input_q || !weights_q || !bias_q || !weight_scale ||
+            !output_q || !reference) {
+            printf("内存分配失败!\n");
+            return -1;
+        }
+
+        // 初始化数据（示例）：先生成量化值，FP32数据由其反量化得到，两种卷积计算同一个问题
+        conv_quant_t quant;
+        quant.input_scale = 0.02f;
+        quant.input_zero_point = -10;
+        quant.weight_scale = weight_scale;
+        quant.output_zero_point = 3;
+        for (int i = 0; i < input_count; i++) {
+            input_q[i] = (int8_t)(rand() % 256 - 128);
+            input[i] = (input_q[i] - quant.input_zero_point) * quant.input_scale;
+        }
+        for (int oc = 0; oc < output_channels; oc++) {
+            weight_scale[oc] = 0.004f + 0.0001f * (oc % 7);
+            bias_q[oc] = rand() % 2001 - 1000;
+            bias_data[oc] = bias_q[oc] * quant.input_scale * weight_scale[oc];
+        }
+        for (int i = 0; i < weight_count; i++) {
+            weights_q[i] = (int8_t)(rand() % 255 - 127);
+            weights_data[i] = weights_q[i] * weight_scale[i / (weight_count / output_channels)];
+        }
+        // 输出比例：使输出的标准差约为30个量化单位
+        quant.output_scale = quant.input_scale * 0.004f * 128.0f * 0.6f *
+                             sqrtf((float)(input_channels * kernel_size * kernel_size)) / 30.0f;
+
+        long long total_operations = (long long)output_channels * output_size * output_size *
+                                    input_channels * kernel_size * kernel_size * 2; // 乘法和加法
+
+        conv_desc_t desc;
+        conv_desc_init(&desc, input_channels, input_size, input_size, output_channels, kernel_size);
+
+        int ret;
+        double fp32_time = median_time(&desc, 0, input, weights_data, bias_data, NULL, output, repeats, &ret);
+        if (ret == CONV_OK) {
+            double int8_time = median_time(&desc, 1, input_q, weights_q, bias_q, &quant, output_q, repeats, &ret);
+            if (ret == CONV_OK) {
+                convolution_int8(input_q, weights_q, bias_q, &quant, reference, output_channels, input_channels,
+                                 kernel_size, output_size, input_size);
+                int max_error = 0;
+                for (int i = 0; i < output_count; i++) {
+                    int error = abs(output_q[i] - reference[i]);
+                    if (error > max_error) {
+                        max_error = error;
+                    }
+                }
+                char name[32];
+                snprintf(name, sizeof(name), "%d,%d,%d,%d", input_channels, output_channels, kernel_size, input_size);
+                printf("%-22s %12.6f %10.2f %12.6f %10.2f %8.2f %10d %s\n", name, fp32_time,
+                       (total_operations / 1e9) / fp32_time, int8_time, (total_operations / 1e9) / int8_time,
+                       fp32_time / int8_time, max_error, max_error <= 1 ? "通过" : "错误!");
+                if (max_error > 1) {
+                    failed = 1;
+                }
+            }
+        }
+
+        // 释放内存
+        free(input);
+        free(weights_data);
+        free(bias_data);
+        free(output);
+        free(input_q);
+        free(weights_q);
+        free(bias_q);
+        free(weight_scale);
+        free(output_q);
+        free(reference);
+
+        if (ret != CONV_OK) {
+            printf("卷积计算失败: %d\n", ret);
+            return -1;
+        }
+    }
+
+    conv_set_num_threads(1);
+    return failed;
+}
@@ -0,0 +1,167 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../bench/bench.h"
+#include "../lib/conv.h"
+
+// 各数据布局（NCHW / NHWC / NC4HW4 / NC8HW8）下卷积的时间，以及布局转换的时间
+// 每种布局的结果转换回NCHW后与NCHW的结果比较，相对误差超过1e-4返回非0
+// 编译：clang -O3 -o asm_Sgemm_layout asm_Sgemm_layout.c ../bench/bench.c ../lib/*.c -lm -lpthread
+
+// 被计时的一次运行
+typedef struct {
+    const conv_desc_t *desc;
+    conv_algo_t algo;
+    const float *input, *weights, *bias;
+    float *output;
+    int ret;
+} layout_run_t;
+
+static void layout_run(void *ctx)
+{
+    layout_run_t *t = (layout_run_t *)ctx;
+    int ret = conv2d(t->desc, t->algo, t->input, t->weights, t->bias, t->output);
+    if (ret != CONV_OK) {
+        t->ret = ret;
+    }
+}
+
+// 用 bench_measure 预热一次后计时 repeats 次，返回中位数（秒）
+static double median_time(const conv_desc_t *desc, conv_algo_t algo, const float *input, const float *weights,
+                          const float *bias, float *output, int repeats, int *ret)
+{
+    layout_run_t t = { desc, algo, input, weights, bias, output, CONV_OK };
+    bench_config_t config = { 1, repeats };
+    bench_stats_t stats;
+    *ret = bench_measure(&config, layout_run, &t, &stats);
+    if (*ret == CONV_OK) {
+        *ret = t.ret;
+    }
+    return *ret == CONV_OK ? stats.median : 0;
+}
+
+// 主函数用于测试
+int main()
+{
+    // 每组参数：输入通道，输出通道，卷积核大小，输入尺寸，步长（补零 k/2）
+    static const int shapes[][5] = {
+        { 16, 32, 3, 112, 1 },
+        { 64, 64, 3, 56, 1 },
+        { 64, 128, 3, 56, 2 },
+        { 128, 128, 1, 28, 1 },
+        { 256, 64, 1, 14, 1 },
+    };
+    int shape_count = (int)(sizeof(shapes) / sizeof(shapes[0]));
+    int repeats = 5;
+    int failed = 0;
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    conv_set_num_threads(cpus > 0 ? (int)cpus : 1);
+
+    printf("线程数: %d\n", conv_get_num_threads());
+    printf("内核: %s\n", conv_kernel_info());
+    printf("\n%-20s %-8s %-14s %12s %10s %14s %10s\n", "参数(ic,oc,k,尺寸,s)", "布局", "算法", "卷积(秒)", "GFLOPS",
+           "转换(秒)", "最大误差");
+
+    for (int s = 0; s < shape_count; s++) {
+        conv_desc_t desc;
+        conv_desc_init(&desc, shapes[s][0], shapes[s][3], shapes[s][3], shapes[s][1], shapes[s][2]);
+        desc.stride = shapes[s][4];
+        desc.padding = shapes[s][2] / 2;
+        int output_size = conv_output_h(&desc);
+
+        // 分配内存，按补齐通道最多的布局分配
+        int input_count = desc.input_channel * desc.input_h * desc.input_w;
+        int weight_count = desc.output_channel * desc.input_channel * desc.k_size * desc.k_size;
+        int output_count = desc.output_channel * output_size * output_size;
+        size_t input_max = conv_layout_size(CONV_LAYOUT_NC8HW8, 1, desc.input_channel, desc.input_h, desc.input_w);
+        size_t output_max = conv_layout_size(CONV_LAYOUT_NC8HW8, 1, desc.output_channel, output_size, output_size);
+        float *input = (float *)malloc(input_count * sizeof(float));
+        float *weights_data = (float *)malloc(weight_count * sizeof(float));
+        float *bias_data = (float *)malloc(desc.output_channel * sizeof(float));
+        float *reference = (float *)malloc(output_count * sizeof(float));
+        float *output = (float *)malloc(output_count * sizeof(float));
+        float *input_layout = (float *)malloc(input_max * sizeof(float));
+        float *output_layout = (float *)malloc(output_max * sizeof(float));
+
+        if (!input || !weights_data || !bias_data || !reference || !output || !input_layout || !output_layout) {
+            printf("内存分配失败!\n");
+            return -1;
+        }
+
+        // 初始化数据（示例）
+        for (int i = 0; i < input_count; i++) {
+            input[i] = (float)(rand() % 2001 - 1000) / 1000.0f;
+        }
+        for (int i = 0; i < weight_count; i++) {
+            weights_data[i] = (float)(rand() % 2001 - 1000) / 1000.0f;
+        }
+        for (int i = 0; i < desc.output_channel; i++) {
+            bias_data[i] = 0.1f;
+        }
+
+        long long total_operations = (long long)output_count * desc.input_channel * desc.k_size * desc.k_size * 2;
+        char name[32];
+        snprintf(name, sizeof(name), "%d,%d,%d,%d,%d", shapes[s][0], shapes[s][1], shapes[s][2], shapes[s][3],
+                 shapes[s][4]);
+
+        int ret = CONV_OK;
+        for (int layout = CONV_LAYOUT_NCHW; layout < CONV_LAYOUT_COUNT && ret == CONV_OK; layout++) {
+            desc.layout = (conv_layout_t)layout;
+            conv_algo_t algo = conv_select_algo(&desc);
+
+            // 输入、输出各转换一次的时间：整个网络保持同一布局时只在两端发生
+            double start = bench_wall_time();
+            conv_layout_transform(CONV_LAYOUT_NCHW, input, desc.layout, input_layout, 1, desc.input_channel,
+                                  desc.input_h, desc.input_w);
+            double transform_time = bench_wall_time() - start;
+
+            double conv_time = median_time(&desc, algo, input_layout, weights_data, bias_data, output_layout,
+                                           repeats, &ret);
+            if (ret != CONV_OK) {
+                break;
+            }
+            start = bench_wall_time();
+            conv_layout_transform(desc.layout, output_layout, CONV_LAYOUT_NCHW, output, 1, desc.output_channel,
+                                  output_size, output_size);
+            transform_time += bench_wall_time() - start;
+
+            if (layout == CONV_LAYOUT_NCHW) {
+                memcpy(reference, output, output_count * sizeof(float));
+            }
+            float max_error = 0.0f;
+            for (int i = 0; i < output_count; i++) {
+                float error = fabsf(output[i] - reference[i]) / (1.0f + fabsf(reference[i]));
+                if (!(error <= max_error)) {
+                    max_error = error;
+                }
+            }
+            printf("%-20s %-8s %-14s %12.6f %10.2f %14.6f %10.2e %s\n", name, conv_layout_name(desc.layout),
+                   conv_algo_name(algo), conv_time, (total_operations / 1e9) / conv_time, transform_time, max_error,
+                   max_error <= 1e-4f ? "通过" : "错误!");
+            if (!(max_error <= 1e-4f)) {
+                failed = 1;
+            }
+        }
+
+        // 释放内存
+        free(input);
+        free(weights_data);
+        free(bias_data);
+        free(reference);
+        free(output);
+        free(input_layout);
+        free(output_layout);
+
+        if (ret != CONV_OK) {
+            printf("卷积计算失败: %d\n", ret);
+            return -1;
+        }
+    }
+
+    conv_set_num_threads(1);
+    return failed;
+}
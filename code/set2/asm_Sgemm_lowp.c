@@ -0,0 +1,218 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../bench/bench.h"
+#include "../lib/conv.h"
+
+// 低精度卷积（FP16 / BF16 存储，FP32 累加）与 C_loop_Origin.c 中 convolution 的对比
+// 每个输出需满足 |y - y_ref| <= bound * (|b| + sum|w * x|)（bound 见 conv.h），否则返回非0；
+// 参考结果使用舍入前的FP32输入和权重，误差包含输入、权重和输出三次舍入
+// 编译：clang -O3 -o asm_Sgemm_lowp asm_Sgemm_lowp.c ../bench/bench.c ../lib/*.c -lm -lpthread
+
+// 主卷积函数（与 C_loop_Origin.c 相同，作为参考结果）
+void convolution(float *input_feature, const float *weights, const float *bias, float *output_feature, int output_channel, int input_channel,
+                 int k_size, int output_wh, int input_wh)
+{
+    int row, col, output_filter, input_filter, kernel_row, kernel_col;
+
+    for (row = 0; row < output_wh; row++) {
+        for (col = 0; col < output_wh; col++) {
+            for (output_filter = 0; output_filter < output_channel; output_filter++) {
+                float temp = 0;
+                for (input_filter = 0; input_filter < input_channel; input_filter++) {
+                    for (kernel_row = 0; kernel_row < k_size; kernel_row++) {
+                        for (kernel_col = 0; kernel_col < k_size; kernel_col++) {
+                            temp = temp + (input_feature[input_filter * input_wh * input_wh + (row + kernel_row) * input_wh + (col + kernel_col)]
+                                        * weights[output_filter * input_channel * k_size * k_size + input_filter * k_size * k_size +
+                                                 kernel_row * k_size + kernel_col]);
+                        }
+                    }
+                }
+                output_feature[output_filter * output_wh * output_wh + row * output_wh + col] = temp + bias[output_filter];
+            }
+        }
+    }
+}
+
+// 每个输出的误差尺度 |b| + sum|w * x|
+void abs_product_sum(const float *input_feature, const float *weights, const float *bias, float *scale, int output_channel,
+                     int input_channel, int k_size, int output_wh, int input_wh)
+{
+    for (int oc = 0; oc < output_channel; oc++) {
+        for (int row = 0; row < output_wh; row++) {
+            for (int col = 0; col < output_wh; col++) {
+                double sum = fabs(bias[oc]);
+                for (int ic = 0; ic < input_channel; ic++) {
+                    for (int kr = 0; kr < k_size; kr++) {
+                        for (int kc = 0; kc < k_size; kc++) {
+                            sum += fabs((double)input_feature[ic * input_wh * input_wh + (row + kr) * input_wh + (col + kc)] *
+                                        weights[((oc * input_channel + ic) * k_size + kr) * k_size + kc]);
+                        }
+                    }
+                }
+                scale[(oc * output_wh + row) * output_wh + col] = (float)sum;
+            }
+        }
+    }
+}
+
+// 被计时的一次低精度卷积
+typedef struct {
+    const conv_desc_t *desc;
+    conv_algo_t algo;
+    conv_dtype_t dtype;
+    const void *input, *weights;
+    const float *bias;
+    void *output;
+    int ret;
+} lowp_run_t;
+
+static void lowp_run(void *ctx)
+{
+    lowp_run_t *t = (lowp_run_t *)ctx;
+    int ret = conv2d_lowp(t->desc, t->algo, t->dtype, t->input, t->weights, t->bias, t->output);
+    if (ret != CONV_OK) {
+        t->ret = ret;
+    }
+}
+
+// 主函数用于测试
+int main()
+{
+    // 固定参数
+    int input_channels = 32;
+    int output_channels = 64;
+    int kernel_size = 3;
+    int input_size = 58;
+    int output_size = input_size - kernel_size + 1;
+    int repeats = 5;
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    conv_set_num_threads(cpus > 0 ? (int)cpus : 1);
+
+    printf("卷积参数:\n");
+    printf("输入尺寸: %d x %d x %d\n", input_channels, input_size, input_size);
+    printf("输出尺寸: %d x %d x %d\n", output_channels, output_size, output_size);
+    printf("卷积核大小: %d x %d\n", kernel_size, kernel_size);
+    printf("线程数: %d\n", conv_get_num_threads());
+    printf("内核: %s\n", conv_kernel_info());
+    printf("\n");
+
+    // 分配内存
+    int input_count = input_channels * input_size * input_size;
+    int weight_count = output_channels * input_channels * kernel_size * kernel_size;
+    int output_count = output_channels * output_size * output_size;
+    float *input = (float *)malloc(input_count * sizeof(float));
+    float *weights_data = (float *)malloc(weight_count * sizeof(float));
+    float *bias_data = (float *)malloc(output_channels * sizeof(float));
+    float *reference = (float *)malloc(output_count * sizeof(float));
+    float *scale = (float *)malloc(output_count * sizeof(float));
+    float *output = (float *)malloc(output_count * sizeof(float));
+    // 16位数据的缓冲区按FP32大小分配，同时用于FP32
+    void *input_lowp = malloc(input_count * sizeof(float));
+    void *weights_lowp = malloc(weight_count * sizeof(float));
+    void *output_lowp = malloc(output_count * sizeof(float));
+
+    if (!input || !weights_data || !bias_data || !reference || !scale || !output ||
+        !input_lowp || !weights_lowp || !output_lowp) {
+        printf("内存分配失败!\n");
+        return -1;
+    }
+
+    // 初始化数据（示例）：输入和权重含非二进制小数，舍入到16位时有误差
+    printf("初始化数据...\n");
+    for (int i = 0; i < input_count; i++) {
+        input[i] = (float)(rand() % 1000) / 300.0f;
+    }
+    for (int i = 0; i < weight_count; i++) {
+        weights_data[i] = (float)(rand() % 2001 - 1000) / 1300.0f;
+    }
+    for (int i = 0; i < output_channels; i++) {
+        bias_data[i] = 0.1f;
+    }
+
+    long long total_operations = (long long)output_channels * output_size * output_size *
+                                input_channels * kernel_size * kernel_size * 2; // 乘法和加法
+
+    // 参考结果
+    double start_time = bench_wall_time();
+    convolution(input, weights_data, bias_data, reference, output_channels, input_channels,
+                kernel_size, output_size, input_size);
+    double reference_time = bench_wall_time() - start_time;
+    abs_product_sum(input, weights_data, bias_data, scale, output_channels, input_channels,
+                    kernel_size, output_size, input_size);
+    printf("\n%-14s %-6s %12s %10s %14s %12s %12s\n", "算法", "类型", "时间(秒)", "GFLOPS", "最大相对误差",
+           "均方根误差", "误差上界");
+    printf("%-14s %-6s %12.6f %10.2f %14s %12s %12s\n", "convolution", "fp32", reference_time,
+           (total_operations / 1e9) / reference_time, "-", "-", "-");
+
+    conv_desc_t desc;
+    conv_desc_init(&desc, input_channels, input_size, input_size, output_channels, kernel_size);
+
+    conv_algo_t algos[2] = { CONV_ALGO_IM2COL_SGEMM, CONV_ALGO_DIRECT };
+    conv_dtype_t dtypes[3] = { CONV_DTYPE_FP32, CONV_DTYPE_FP16, CONV_DTYPE_BF16 };
+    int failed = 0;
+    for (int d = 0; d < 3; d++) {
+        conv_dtype_t dtype = dtypes[d];
+        // FP32 的上界取 FP16 的值，只用于检查结果是否正确
+        float bound = dtype == CONV_DTYPE_BF16 ? CONV_BF16_ERROR_BOUND : CONV_FP16_ERROR_BOUND;
+        conv_convert_from_fp32(dtype, input, input_lowp, input_count);
+        conv_convert_from_fp32(dtype, weights_data, weights_lowp, weight_count);
+
+        for (int a = 0; a < 2; a++) {
+            // 预热一次，排除首次缺页的开销；之后计时 repeats 次取中位数
+            lowp_run_t t = { &desc, algos[a], dtype, input_lowp, weights_lowp, bias_data, output_lowp, CONV_OK };
+            bench_config_t config = { 1, repeats };
+            bench_stats_t stats;
+            int ret = bench_measure(&config, lowp_run, &t, &stats);
+            if (ret == CONV_OK) {
+                ret = t.ret;
+            }
+            if (ret != CONV_OK) {
+                printf("卷积计算失败: %d\n", ret);
+                return -1;
+            }
+            conv_convert_to_fp32(dtype, output_lowp, output, output_count);
+
+            // 相对误差 |y - y_ref| / (|b| + sum|w * x|)，均方根误差为绝对误差
+            float max_error = 0;
+            double square_sum = 0;
+            for (int i = 0; i < output_count; i++) {
+                float error = fabsf(output[i] - reference[i]);
+                square_sum += (double)error * error;
+                error /= scale[i] > 0 ? scale[i] : 1.0f;
+                if (!(error <= max_error)) {
+                    max_error = error;
+                }
+            }
+            printf("%-14s %-6s %12.6f %10.2f %14.3e %12.3e %12.1e %s\n", conv_algo_name(algos[a]),
+                   conv_dtype_name(dtype), stats.median, (total_operations / 1e9) / stats.median, max_error,
+                   sqrt(square_sum / output_count), bound, max_error <= bound ? "通过" : "超出上界!");
+            if (!(max_error <= bound)) {
+                failed = 1;
+            }
+        }
+    }
+
+    printf("\n输出样本值:\n");
+    for (int i = 0; i < 5; i++) {
+        printf("output[%d] = %.4f (参考 %.4f)\n", i, output[i], reference[i]);
+    }
+
+    // 释放内存
+    conv_set_num_threads(1);
+    free(input);
+    free(weights_data);
+    free(bias_data);
+    free(reference);
+    free(scale);
+    free(output);
+    free(input_lowp);
+    free(weights_lowp);
+    free(output_lowp);
+
+    return failed;
+}
@@ -0,0 +1,258 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../bench/bench.h"
+#include "../lib/conv.h"
+
+// 多线程 Im2col + SGEMM：按输出通道(M)和像素(N)分块并行
+// 之后是分组卷积在各线程数下的时间，结果与单线程比较
+// 编译：clang -O3 -o asm_Sgemm_mt asm_Sgemm_mt.c ../bench/bench.c ../lib/*.c -lm -lpthread
+
+// 被计时的一次运行，使用预先分配的工作区
+typedef struct {
+    const conv_desc_t *desc;
+    conv_algo_t algo;
+    const float *input, *weights, *bias;
+    float *output;
+    void *workspace;
+    size_t workspace_size;
+    int ret;
+} mt_run_t;
+
+static void mt_run(void *ctx)
+{
+    mt_run_t *t = (mt_run_t *)ctx;
+    int ret = conv2d_ws(t->desc, t->algo, t->input, t->weights, t->bias, t->output, t->workspace,
+                        t->workspace_size);
+    if (ret != CONV_OK) {
+        t->ret = ret;
+    }
+}
+
+// 用 bench_measure 计时（墙上时间；clock() 统计的是所有线程的CPU时间之和，不能用来衡量多线程加速）
+// 预热一次，排除线程创建和首次缺页的开销，之后计时 repeats 次，返回中位数（秒）
+static double median_time(const conv_desc_t *desc, conv_algo_t algo, const float *input, const float *weights,
+                          const float *bias, float *output, void *workspace, size_t workspace_size, int repeats,
+                          int *ret)
+{
+    mt_run_t t = { desc, algo, input, weights, bias, output, workspace, workspace_size, CONV_OK };
+    bench_config_t config = { 1, repeats };
+    bench_stats_t stats;
+    *ret = bench_measure(&config, mt_run, &t, &stats);
+    if (*ret == CONV_OK) {
+        *ret = t.ret;
+    }
+    return *ret == CONV_OK ? stats.median : 0;
+}
+
+// 分组卷积（ResNeXt，128通道分32组，每组4个输入通道）：(图像, 分组) 之间并行
+// 线程数为 1, 2, 4, ... 以及全部核心（至少到4，单核机器上也检查多线程的划分），
+// 各线程数的结果与单线程的结果逐个比较，误差超过1e-5返回非0
+static int grouped_threads(int max_threads, int repeats)
+{
+    int thread_counts[32];
+    int num_counts = 0;
+    if (max_threads < 4) {
+        max_threads = 4;
+    }
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts[num_counts++] = threads;
+    }
+    thread_counts[num_counts++] = max_threads;
+
+    conv_desc_t desc;
+    conv_desc_init(&desc, 128, 56, 56, 128, 3);
+    desc.padding = 1;
+    desc.groups = 32;
+    size_t input_count = (size_t)desc.input_channel * desc.input_h * desc.input_w;
+    size_t weight_count = (size_t)desc.output_channel * (desc.input_channel / desc.groups) * 9;
+    size_t output_count = (size_t)desc.output_channel * conv_output_h(&desc) * conv_output_w(&desc);
+    long long total_operations = (long long)output_count * (desc.input_channel / desc.groups) * 9 * 2;
+
+    float *input = (float *)malloc(input_count * sizeof(float));
+    float *weights_data = (float *)malloc(weight_count * sizeof(float));
+    float *bias_data = (float *)malloc(desc.output_channel * sizeof(float));
+    float *output = (float *)malloc(output_count * sizeof(float));
+    float *reference = (float *)malloc(output_count * sizeof(float));
+    if (!input || !weights_data || !bias_data || !output || !reference) {
+        printf("内存分配失败!\n");
+        free(input);
+        free(weights_data);
+        free(bias_data);
+        free(output);
+        free(reference);
+        return -1;
+    }
+    for (size_t i = 0; i < input_count; i++) {
+        input[i] = (float)(rand() % 10) / 10.0f;
+    }
+    for (size_t i = 0; i < weight_count; i++) {
+        weights_data[i] = (float)(rand() % 10) / 10.0f;
+    }
+    for (int i = 0; i < desc.output_channel; i++) {
+        bias_data[i] = 0.1f;
+    }
+
+    printf("\n分组卷积: %d -> %d 通道, %d 组, %dx%d, 算法 %s\n", desc.input_channel, desc.output_channel,
+           desc.groups, desc.input_h, desc.input_w, conv_algo_name(conv_select_algo(&desc)));
+    printf("%8s %12s %10s %10s %12s\n", "线程数", "时间(秒)", "GFLOPS", "加速比", "最大误差");
+    int failed = 0;
+    double base_time = 0;
+    for (int t = 0; t < num_counts; t++) {
+        if (conv_set_num_threads(thread_counts[t]) != CONV_OK) {
+            printf("线程池创建失败!\n");
+            failed = 1;
+            break;
+        }
+        size_t workspace_size = conv_workspace_size(&desc, CONV_ALGO_AUTO);
+        void *workspace = NULL;
+        if (workspace_size && posix_memalign(&workspace, CONV_WORKSPACE_ALIGN, workspace_size) != 0) {
+            printf("内存分配失败!\n");
+            failed = 1;
+            break;
+        }
+        float *result = t == 0 ? reference : output;
+        int ret;
+        double elapsed = median_time(&desc, CONV_ALGO_AUTO, input, weights_data, bias_data, result, workspace,
+                                     workspace_size, repeats, &ret);
+        free(workspace);
+        if (ret != CONV_OK) {
+            printf("卷积计算失败: %d\n", ret);
+            failed = 1;
+            break;
+        }
+
+        float max_error = 0;
+        for (size_t i = 0; i < output_count && t > 0; i++) {
+            float error = fabsf(output[i] - reference[i]);
+            if (!(error <= max_error)) {
+                max_error = error;
+            }
+        }
+        if (!(max_error <= 1e-5f)) {
+            failed = 1;
+        }
+        if (t == 0) {
+            base_time = elapsed;
+        }
+        printf("%8d %12.6f %10.2f %10.2f %12.2e\n", thread_counts[t], elapsed, (total_operations / 1e9) / elapsed,
+               base_time / elapsed, max_error);
+    }
+
+    conv_set_num_threads(1);
+    free(input);
+    free(weights_data);
+    free(bias_data);
+    free(output);
+    free(reference);
+    return failed;
+}
+
+int main()
+{
+    // 固定参数
+    int input_channels = 32;
+    int output_channels = 64;
+    int kernel_size = 3;
+    int input_size = 256;
+    int repeats = 3;
+
+    conv_desc_t desc;
+    conv_desc_init(&desc, input_channels, input_size, input_size, output_channels, kernel_size);
+    int output_size = conv_output_h(&desc);
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = cpus > 0 ? (int)cpus : 1;
+
+    printf("卷积参数:\n");
+    printf("输入尺寸: %d x %d x %d\n", input_channels, input_size, input_size);
+    printf("输出尺寸: %d x %d x %d\n", output_channels, output_size, output_size);
+    printf("卷积核大小: %d x %d\n", kernel_size, kernel_size);
+    printf("优化方式: 分块打包SGEMM + 多线程（最多 %d 线程）\n", max_threads);
+    printf("\n");
+
+    // 分配内存
+    float *input = (float *)malloc(input_channels * input_size * input_size * sizeof(float));
+    float *weights_data = (float *)malloc(output_channels * input_channels * kernel_size * kernel_size * sizeof(float));
+    float *bias_data = (float *)malloc(output_channels * sizeof(float));
+    float *output = (float *)malloc(output_channels * output_size * output_size * sizeof(float));
+
+    if (!input || !weights_data || !bias_data || !output) {
+        printf("内存分配失败!\n");
+        return -1;
+    }
+
+    // 初始化数据（示例）
+    printf("初始化数据...\n");
+    for (int i = 0; i < input_channels * input_size * input_size; i++) {
+        input[i] = (float)(rand() % 10) / 10.0f;
+    }
+    for (int i = 0; i < output_channels * input_channels * kernel_size * kernel_size; i++) {
+        weights_data[i] = (float)(rand() % 10) / 10.0f;
+    }
+    for (int i = 0; i < output_channels; i++) {
+        bias_data[i] = 0.1f;
+    }
+
+    long long total_operations = (long long)output_channels * output_size * output_size *
+                                input_channels * kernel_size * kernel_size * 2; // 乘法和加法
+
+    // 线程数 1, 2, 4, ... 以及全部核心
+    int thread_counts[32];
+    int num_counts = 0;
+    for (int threads = 1; threads < max_threads; threads *= 2) {
+        thread_counts[num_counts++] = threads;
+    }
+    thread_counts[num_counts++] = max_threads;
+
+    printf("\n%8s %12s %10s %10s %10s\n", "线程数", "时间(秒)", "GFLOPS", "加速比", "并行效率");
+    double base_time = 0;
+    for (int t = 0; t < num_counts; t++) {
+        int threads = thread_counts[t];
+        if (conv_set_num_threads(threads) != CONV_OK) {
+            printf("线程池创建失败!\n");
+            break;
+        }
+
+        // 工作区大小与线程数有关，每次改变线程数后重新查询；之后的调用都复用它，不再分配内存
+        size_t workspace_size = conv_workspace_size(&desc, CONV_ALGO_IM2COL_SGEMM);
+        void *workspace = NULL;
+        if (posix_memalign(&workspace, CONV_WORKSPACE_ALIGN, workspace_size) != 0) {
+            printf("内存分配失败!\n");
+            break;
+        }
+
+        int ret;
+        double elapsed = median_time(&desc, CONV_ALGO_IM2COL_SGEMM, input, weights_data, bias_data, output, workspace,
+                                     workspace_size, repeats, &ret);
+        free(workspace);
+        if (ret != CONV_OK) {
+            printf("卷积计算失败: %d\n", ret);
+            break;
+        }
+
+        if (threads == 1) {
+            base_time = elapsed;
+        }
+        double speedup = base_time / elapsed;
+        printf("%8d %12.6f %10.2f %10.2f %9.1f%%\n", threads, elapsed,
+               (total_operations / 1e9) / elapsed, speedup, speedup / threads * 100.0);
+    }
+
+    printf("\n输出样本值:\n");
+    for (int i = 0; i < 5; i++) {
+        printf("output[%d] = %.4f\n", i, output[i]);
+    }
+
+    // 释放内存
+    conv_set_num_threads(1);
+    free(input);
+    free(weights_data);
+    free(bias_data);
+    free(output);
+
+    return grouped_threads(max_threads, repeats);
+}
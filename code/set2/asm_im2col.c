@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../bench/bench.h"
+#include "../lib/conv.h"
+#include "../lib/conv_internal.h"
+
+// im2col的带宽测试：库中向量化的 conv_im2col 与逐元素的原始实现（set2/C_Sgemm_op1.c 的循环，加上步长和补零），
+// 以及同样字节数的 memcpy 对比。im2col矩阵是输入的约 k*k/stride^2 倍，读取基本命中缓存，
+// 耗时由写出矩阵决定，按写出的字节数计算 GB/s，接近 memcpy 即达到内存带宽。
+// 单线程运行，矩阵写入预先分配并预热过的工作区，不计缺页；两种实现的结果逐字节比较，不一致返回非0
+// 编译：clang -O3 -o asm_im2col asm_im2col.c ../bench/bench.c ../lib/*.c -lm -lpthread
+
+// 原始实现：每个元素重新计算输入下标，补零部分逐个判断
+static void naive_im2col(const float *input_feature, float *im2col_feature, int input_channel, int input_h,
+                         int input_w, int k_size, int stride, int padding, int output_h, int output_w)
+{
+    int index = 0;
+    for (int input_filter = 0; input_filter < input_channel; input_filter++) {
+        for (int row = 0; row < k_size; row++) {
+            for (int col = 0; col < k_size; col++) {
+                for (int i = 0; i < output_h; i++) {
+                    for (int j = 0; j < output_w; j++) {
+                        int y = i * stride - padding + row;
+                        int x = j * stride - padding + col;
+                        im2col_feature[index++] = y < 0 || y >= input_h || x < 0 || x >= input_w
+                                                      ? 0.0f
+                                                      : input_feature[input_filter * input_h * input_w +
+                                                                      y * input_w + x];
+                    }
+                }
+            }
+        }
+    }
+}
+
+// 一个形状的参数和缓冲区，三种被计时的实现共用
+typedef struct {
+    const float *input;
+    float *reference;
+    void *buffer;
+    const char *source;
+    int channels, size, k_size, stride, padding, output_size;
+    size_t matrix_bytes;
+    float *matrix;
+} im2col_run_t;
+
+static void naive_run(void *ctx)
+{
+    im2col_run_t *t = (im2col_run_t *)ctx;
+    naive_im2col(t->input, t->reference, t->channels, t->size, t->size, t->k_size, t->stride, t->padding,
+                 t->output_size, t->output_size);
+}
+
+static void vector_run(void *ctx)
+{
+    im2col_run_t *t = (im2col_run_t *)ctx;
+    conv_workspace_t ws;
+    conv_workspace_init(&ws, t->buffer, conv_ws_bytes(t->matrix_bytes), conv_ws_bytes(t->matrix_bytes));
+    t->matrix = (float *)conv_im2col(&ws, t->input, sizeof(float), 0, 1, t->channels, t->size, t->size, t->k_size,
+                                     t->stride, t->padding, 1, t->output_size, t->output_size);
+}
+
+static void copy_run(void *ctx)
+{
+    im2col_run_t *t = (im2col_run_t *)ctx;
+    memcpy(t->buffer, t->source, t->matrix_bytes);
+}
+
+// 用 bench_measure 预热一次后计时 repeats 次，返回中位数（秒），内存不足返回负数
+static double median_time(bench_fn fn, im2col_run_t *t, int repeats)
+{
+    bench_config_t config = { 1, repeats };
+    bench_stats_t stats;
+    return bench_measure(&config, fn, t, &stats) == CONV_OK ? stats.median : -1;
+}
+
+// 主函数用于测试
+int main()
+{
+    // 每组参数：输入通道，输入尺寸，卷积核大小，步长，补零
+    static const int shapes[][5] = {
+        { 64, 56, 3, 1, 1 },
+        { 128, 28, 3, 1, 1 },
+        { 256, 14, 3, 1, 1 },
+        { 512, 7, 3, 1, 1 },
+        { 64, 112, 3, 2, 1 },
+        { 3, 224, 7, 2, 3 },
+        { 32, 64, 5, 1, 2 },
+        { 16, 256, 3, 1, 0 },
+    };
+    int shape_count = (int)(sizeof(shapes) / sizeof(shapes[0]));
+    int repeats = 10;
+    int failed = 0;
+
+    conv_set_num_threads(1);
+
+    printf("%-22s %10s %12s %12s %12s %10s %10s %10s %8s\n", "参数(C,尺寸,k,s,p)", "矩阵(MB)", "逐元素(ms)",
+           "向量化(ms)", "memcpy(ms)", "逐元素GB/s", "向量化GB/s", "memcpyGB/s", "加速比");
+
+    for (int s = 0; s < shape_count; s++) {
+        int channels = shapes[s][0];
+        int size = shapes[s][1];
+        int k_size = shapes[s][2];
+        int stride = shapes[s][3];
+        int padding = shapes[s][4];
+        int output_size = (size + 2 * padding - k_size) / stride + 1;
+        size_t input_count = (size_t)channels * size * size;
+        size_t matrix_bytes = (size_t)channels * k_size * k_size * output_size * output_size * sizeof(float);
+
+        float *input = (float *)malloc(input_count * sizeof(float));
+        float *reference = (float *)malloc(matrix_bytes);
+        char *source = (char *)malloc(matrix_bytes);
+        void *buffer = NULL;
+        if (!input || !reference || !source ||
+            posix_memalign(&buffer, CONV_WORKSPACE_ALIGN, conv_ws_bytes(matrix_bytes)) != 0) {
+            printf("内存分配失败!\n");
+            return -1;
+        }
+        for (size_t i = 0; i < input_count; i++) {
+            input[i] = (float)(rand() % 2001 - 1000) / 1000.0f;
+        }
+        // 预先写一遍，计时中不出现首次缺页
+        memset(buffer, 0, conv_ws_bytes(matrix_bytes));
+        memset(reference, 0, matrix_bytes);
+        memset(source, 1, matrix_bytes);
+
+        im2col_run_t t = { input, reference, buffer, source, channels, size, k_size, stride, padding, output_size,
+                           matrix_bytes, NULL };
+        double naive_time = median_time(naive_run, &t, repeats);
+        double vector_time = median_time(vector_run, &t, repeats);
+        double copy_time = median_time(copy_run, &t, repeats);
+        if (naive_time < 0 || vector_time < 0 || copy_time < 0) {
+            printf("内存分配失败!\n");
+            return -1;
+        }
+        // memcpy 覆盖了工作区，最后再生成一次用于比较
+        conv_workspace_t ws;
+        conv_workspace_init(&ws, buffer, conv_ws_bytes(matrix_bytes), conv_ws_bytes(matrix_bytes));
+        float *matrix = (float *)conv_im2col(&ws, input, sizeof(float), 0, 1, channels, size, size, k_size, stride,
+                                             padding, 1, output_size, output_size);
+        int match = matrix && memcmp(matrix, reference, matrix_bytes) == 0;
+
+        char name[32];
+        snprintf(name, sizeof(name), "%d,%d,%d,%d,%d", channels, size, k_size, stride, padding);
+        printf("%-22s %10.2f %12.3f %12.3f %12.3f %10.2f %10.2f %10.2f %8.2f %s\n", name, matrix_bytes / 1048576.0,
+               naive_time * 1e3, vector_time * 1e3, copy_time * 1e3, matrix_bytes / naive_time / 1e9,
+               matrix_bytes / vector_time / 1e9, matrix_bytes / copy_time / 1e9, naive_time / vector_time,
+               match ? "通过" : "错误!");
+        if (!match) {
+            failed = 1;
+        }
+
+        free(input);
+        free(reference);
+        free(source);
+        free(buffer);
+    }
+
+    return failed;
+}
@@ -0,0 +1,284 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../bench/bench.h"
+#include "../lib/conv.h"
+
+// 向量化空洞卷积（lib/conv_dilated.c）与 C_delated.c 中 dilated_convolution_2d 的对比
+// 内部区域一次计算多个相邻输出、卷积核常驻寄存器，只有边界带做越界检查
+// 之后按 DeepLab ASPP 的形状比较多通道空洞卷积：逐平面内核与空洞im2col + SGEMM，
+// 每个算法的首个和最后一个输出通道与逐平面的基础版本累加的结果比较
+// 计时使用 bench_measure（墙上时间，取中位数），误差超过1e-4返回非0
+// 编译：clang -O3 -o asm_delated_vec asm_delated_vec.c ../bench/bench.c ../lib/*.c -lm -lpthread
+
+// 空洞卷积基础版本（与 C_delated.c 相同，作为参考结果）
+void dilated_convolution_2d(
+    float* input, int input_h, int input_w,
+    float* kernel, int kernel_h, int kernel_w,
+    float* output, int output_h, int output_w,
+    int dilation, int stride, int padding
+) {
+    memset(output, 0, output_h * output_w * sizeof(float));
+
+    for (int oh = 0; oh < output_h; oh++) {
+        for (int ow = 0; ow < output_w; ow++) {
+            float sum = 0.0f;
+            int ih_start = oh * stride - padding;
+            int iw_start = ow * stride - padding;
+
+            for (int kh = 0; kh < kernel_h; kh++) {
+                for (int kw = 0; kw < kernel_w; kw++) {
+                    int ih = ih_start + kh * dilation;
+                    int iw = iw_start + kw * dilation;
+                    if (ih >= 0 && ih < input_h && iw >= 0 && iw < input_w) {
+                        sum += input[ih * input_w + iw] * kernel[kh * kernel_w + kw];
+                    }
+                }
+            }
+
+            output[oh * output_w + ow] = sum;
+        }
+    }
+}
+
+// 被计时的一次运行：单通道的基础版本、conv2d，以及预先打包的多通道卷积
+typedef struct {
+    const conv_desc_t *desc;
+    conv_handle_t *handle;
+    const float *input, *kernel;
+    float *output;
+    int ret;
+} dilated_run_t;
+
+static void base_run(void *ctx)
+{
+    dilated_run_t *t = (dilated_run_t *)ctx;
+    const conv_desc_t *desc = t->desc;
+    dilated_convolution_2d((float *)t->input, desc->input_h, desc->input_w, (float *)t->kernel, desc->k_size,
+                           desc->k_size, t->output, conv_output_h(desc), conv_output_w(desc), desc->dilation,
+                           desc->stride, desc->padding);
+}
+
+static void vector_run(void *ctx)
+{
+    dilated_run_t *t = (dilated_run_t *)ctx;
+    int ret = conv2d(t->desc, CONV_ALGO_DILATED, t->input, t->kernel, NULL, t->output);
+    if (ret != CONV_OK) {
+        t->ret = ret;
+    }
+}
+
+static void prepared_run(void *ctx)
+{
+    dilated_run_t *t = (dilated_run_t *)ctx;
+    int ret = conv2d_prepared(t->handle, t->input, t->output);
+    if (ret != CONV_OK) {
+        t->ret = ret;
+    }
+}
+
+// 用 bench_measure 预热一次后计时 repeats 次，返回中位数（秒）
+static double median_time(bench_fn fn, dilated_run_t *t, int repeats)
+{
+    bench_config_t config = { 1, repeats };
+    bench_stats_t stats;
+    int ret = bench_measure(&config, fn, t, &stats);
+    if (ret != CONV_OK) {
+        t->ret = ret;
+        return 0;
+    }
+    return stats.median;
+}
+
+// 多通道空洞卷积中一个输出通道的参考结果：各输入通道用基础版本计算后累加，plane 为临时平面
+static void aspp_reference(const float *feature, const float *weights, int channels, int size, int oc,
+                           int dilation, float *plane, float *result)
+{
+    memset(result, 0, (size_t)size * size * sizeof(float));
+    for (int ic = 0; ic < channels; ic++) {
+        dilated_convolution_2d((float *)feature + (size_t)ic * size * size, size, size,
+                               (float *)weights + ((size_t)oc * channels + ic) * 9, 3, 3,
+                               plane, size, size, dilation, 1, dilation);
+        for (int i = 0; i < size * size; i++) {
+            result[i] += plane[i];
+        }
+    }
+}
+
+int main()
+{
+    printf("=== 向量化空洞卷积测试 ===\n\n");
+
+    // 输入参数设置：分割网络中常见的几种空洞卷积
+    int input_size = 256;
+    int configs[][4] = {
+        // 卷积核, 空洞率, 步长, 填充
+        { 3, 2, 1, 2 },
+        { 3, 4, 1, 4 },
+        { 3, 2, 2, 2 },
+        { 5, 2, 1, 4 },
+    };
+    int config_count = sizeof(configs) / sizeof(configs[0]);
+    int repeats = 20;
+
+    float *input = (float *)malloc(input_size * input_size * sizeof(float));
+    float *kernel = (float *)malloc(5 * 5 * sizeof(float));
+    float *reference = (float *)malloc(input_size * input_size * sizeof(float));
+    float *output = (float *)malloc(input_size * input_size * sizeof(float));
+
+    if (!input || !kernel || !reference || !output) {
+        printf("内存分配失败!\n");
+        free(input);
+        free(kernel);
+        free(reference);
+        free(output);
+        return -1;
+    }
+
+    for (int i = 0; i < input_size * input_size; i++) {
+        input[i] = (float)(rand() % 256) / 255.0f;
+    }
+    for (int i = 0; i < 5 * 5; i++) {
+        kernel[i] = ((float)(rand() % 200) - 100) / 100.0f;
+    }
+
+    printf("输入尺寸: %dx%d\n\n", input_size, input_size);
+    printf("%-22s %12s %12s %8s %12s\n", "卷积核/空洞/步长/填充", "基础(毫秒)", "向量化(毫秒)", "加速比", "最大误差");
+
+    int failed = 0;
+    for (int c = 0; c < config_count; c++) {
+        conv_desc_t desc;
+        conv_desc_init(&desc, 1, input_size, input_size, 1, configs[c][0]);
+        desc.dilation = configs[c][1];
+        desc.stride = configs[c][2];
+        desc.padding = configs[c][3];
+        int output_h = conv_output_h(&desc);
+        int output_w = conv_output_w(&desc);
+
+        // 各取多次运行的中位数
+        dilated_run_t t = { &desc, NULL, input, kernel, reference, CONV_OK };
+        double time_ref = median_time(base_run, &t, repeats);
+        t.output = output;
+        double time_vec = median_time(vector_run, &t, repeats);
+        int ret = t.ret;
+        if (ret != CONV_OK) {
+            printf("卷积计算失败!\n");
+            free(input);
+            free(kernel);
+            free(reference);
+            free(output);
+            return -1;
+        }
+
+        float max_error = 0;
+        for (int i = 0; i < output_h * output_w; i++) {
+            float error = fabsf(output[i] - reference[i]);
+            if (error > max_error) {
+                max_error = error;
+            }
+        }
+        if (max_error > 1e-4f) {
+            failed = 1;
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "%d / %d / %d / %d", desc.k_size, desc.dilation, desc.stride, desc.padding);
+        printf("%-22s %12.3f %12.3f %8.2f %12.2e\n", name, time_ref * 1e3, time_vec * 1e3,
+               time_ref / time_vec, max_error);
+    }
+
+    free(input);
+    free(kernel);
+    free(reference);
+    free(output);
+
+    // ASPP：256 -> 256 通道，33x33，空洞率 6 / 12 / 18，填充等于空洞率
+    int channels = 256;
+    int aspp_size = 33;
+    int rates[3] = { 6, 12, 18 };
+    conv_algo_t algos[3] = { CONV_ALGO_DILATED, CONV_ALGO_IM2COL_SGEMM, CONV_ALGO_AUTO };
+    size_t feature_size = (size_t)channels * aspp_size * aspp_size;
+    float *feature = (float *)malloc(feature_size * sizeof(float));
+    float *weights_data = (float *)malloc((size_t)channels * channels * 9 * sizeof(float));
+    float *aspp_output = (float *)malloc(feature_size * sizeof(float));
+    float *aspp_reference_output = (float *)malloc((size_t)aspp_size * aspp_size * sizeof(float));
+    float *plane = (float *)malloc((size_t)aspp_size * aspp_size * sizeof(float));
+    int aspp_repeats = 5;
+
+    if (!feature || !weights_data || !aspp_output || !aspp_reference_output || !plane) {
+        printf("内存分配失败!\n");
+        free(feature);
+        free(weights_data);
+        free(aspp_output);
+        free(aspp_reference_output);
+        free(plane);
+        return -1;
+    }
+    for (size_t i = 0; i < feature_size; i++) {
+        feature[i] = (float)(rand() % 256) / 255.0f;
+    }
+    for (size_t i = 0; i < (size_t)channels * channels * 9; i++) {
+        weights_data[i] = ((float)(rand() % 200) - 100) / 10000.0f;
+    }
+
+    printf("\nASPP: %d -> %d 通道, %dx%d，预热一次后取 %d 次的中位数\n\n", channels, channels, aspp_size,
+           aspp_size, aspp_repeats);
+    printf("%8s %-14s %12s %10s %12s\n", "空洞率", "算法", "时间(毫秒)", "GFLOPS", "最大误差");
+    int ret = CONV_OK;
+    for (int r = 0; r < 3 && ret == CONV_OK; r++) {
+        conv_desc_t desc;
+        conv_desc_init(&desc, channels, aspp_size, aspp_size, channels, 3);
+        desc.dilation = rates[r];
+        desc.padding = rates[r];
+        long long operations = (long long)channels * conv_output_h(&desc) * conv_output_w(&desc) * channels * 9 * 2;
+        size_t plane_size = (size_t)aspp_size * aspp_size;
+
+        for (int a = 0; a < 3 && ret == CONV_OK; a++) {
+            conv_handle_t *handle;
+            ret = conv_prepare(&desc, algos[a], weights_data, NULL, &handle);
+            if (ret != CONV_OK) {
+                printf("权重打包失败!\n");
+                break;
+            }
+            dilated_run_t t = { &desc, handle, feature, NULL, aspp_output, CONV_OK };
+            double elapsed = median_time(prepared_run, &t, aspp_repeats);
+            ret = t.ret;
+            if (ret != CONV_OK) {
+                printf("卷积计算失败!\n");
+                conv_handle_destroy(handle);
+                break;
+            }
+
+            // 首个和最后一个输出通道与参考结果比较
+            float max_error = 0;
+            int check_channels[2] = { 0, channels - 1 };
+            for (int c = 0; c < 2; c++) {
+                aspp_reference(feature, weights_data, channels, aspp_size, check_channels[c], rates[r], plane,
+                               aspp_reference_output);
+                const float *out = aspp_output + check_channels[c] * plane_size;
+                for (size_t i = 0; i < plane_size; i++) {
+                    float error = fabsf(out[i] - aspp_reference_output[i]);
+                    if (!(error <= max_error)) {
+                        max_error = error;
+                    }
+                }
+            }
+            if (!(max_error <= 1e-4f)) {
+                failed = 1;
+            }
+            printf("%8d %-14s %12.3f %10.2f %12.2e %s\n", rates[r], conv_algo_name(conv_handle_algo(handle)),
+                   elapsed * 1e3, (operations / 1e9) / elapsed, max_error, max_error <= 1e-4f ? "通过" : "错误!");
+            conv_handle_destroy(handle);
+        }
+    }
+
+    free(feature);
+    free(weights_data);
+    free(aspp_output);
+    free(aspp_reference_output);
+    free(plane);
+
+    return ret != CONV_OK ? -1 : failed;
+}